@@ -48,8 +48,81 @@ typedef struct {
     uint32_t BlockSize;     /*!< 块大小 */
     uint32_t LogBlockNbr;   /*!< 逻辑块数量 */
     uint32_t LogBlockSize;  /*!< 逻辑块大小 */
+    uint32_t Cmd23Supported; /*!< SCR声明支持CMD23（SET_BLOCK_COUNT） */
+    uint32_t BusSpeedMode;  /*!< 总线速度模式：SD_BUS_SPEED_xxx */
+    uint32_t BusClockHz;    /*!< 当前SDMMC_CK频率（Hz） */
+    uint32_t AuBlocks;      /*!< 分配单元（AU）块数，来自SD Status（ACMD13），0表示未知 */
+    uint32_t SpeedClass;    /*!< Speed Class：0/2/4/6/10 */
+    uint32_t UhsSpeedGrade; /*!< UHS Speed Grade：0/1/3 */
+    uint32_t VideoSpeedClass; /*!< Video Speed Class：0/6/10/30/60/90 */
+    uint32_t ReadAccessUs;  /*!< 读访问超时（微秒）：SDSC由CSD的TAAC/NSAC按当前时钟算出，SDHC/SDXC为SD_TIMEOUT_READ_MAX_MS */
+    uint32_t WriteBusyUs;   /*!< 写入编程忙超时（微秒）：SDSC再乘2^R2W_FACTOR，SDHC/SDXC为SD_TIMEOUT_WRITE_MAX_MS/SD_TIMEOUT_WRITE_SDXC_MS */
+    uint32_t EraseAuMs;     /*!< 每个AU的擦除超时（毫秒）：SD Status的ERASE_TIMEOUT/ERASE_SIZE，卡未给出时按编程忙超时计 */
+    uint32_t EraseOffsetMs; /*!< 擦除超时的固定部分（毫秒）：SD Status的ERASE_OFFSET */
 } SD_CardInfoTypeDef;
 
+/**
+ * @brief 单类操作的计数与延迟直方图
+ * @note 延迟单位为CPU周期（DWT->CYCCNT），除以SD_StatsTypeDef.CyclesPerUs得到微秒
+ */
+typedef struct {
+    uint32_t Ops;           /*!< 调用次数 */
+    uint32_t Errors;        /*!< 返回非HAL_OK的次数 */
+    uint64_t Bytes;         /*!< 成功传输的字节数（擦除为擦除区间字节数） */
+    uint64_t Cycles;        /*!< 累计耗时（周期） */
+    uint32_t MaxCycles;     /*!< 单次最长耗时（周期） */
+    uint32_t Hist[32];      /*!< Hist[k]：耗时在[2^k, 2^(k+1))周期内的次数（0周期计入Hist[0]） */
+} SD_OpStatsTypeDef;
+
+/**
+ * @brief 驱动运行统计（SD_GetStats()）
+ */
+typedef struct {
+    SD_OpStatsTypeDef Read;      /*!< 读卡：SD_Dev_ReadBlocksDirect()，前门与各层经它读卡（缓存命中不计）；异步请求不计 */
+    SD_OpStatsTypeDef Write;     /*!< 写卡：SD_Dev_WriteBlocksDirect()，前门与各层经它写卡；异步请求不计 */
+    SD_OpStatsTypeDef Erase;     /*!< SD_Dev_EraseBlocks() */
+    SD_OpStatsTypeDef WaitReady; /*!< SD_WaitReady()，包括读写内部的等待；Cycles即忙等卡就绪的总时间 */
+    uint32_t WaitPolls;          /*!< SD_WaitReady()中查询卡状态（CMD13）的次数 */
+    uint32_t WaitBusyEnds;       /*!< SD_WaitReady()经DAT0忙结束检测（BUSYD0END）等到卡编程完成的次数 */
+    uint64_t WaitYieldCycles;    /*!< 等待卡就绪期间在SD_WaitYield()中度过的时间（周期），即可让给其他任务的CPU时间 */
+    uint64_t RequestWaitCycles;  /*!< SD_WaitRequest()等待IDMA完成的总时间（周期） */
+    uint32_t DmaZeroCopy;        /*!< 阻塞读写直接在调用者缓冲区上传输的次数 */
+    uint32_t DmaSplit;           /*!< 读取缓冲区未按缓存行对齐：中间直接传输、首尾块经跳板的次数 */
+    uint32_t DmaBounced;         /*!< 缓冲区未4字节对齐或IDMA不可访问，全部经跳板的次数 */
+    uint32_t BounceBlocks;       /*!< 经跳板缓冲区中转的块数 */
+    uint32_t CyclesPerUs;        /*!< 每微秒的周期数（SystemCoreClock / 1000000） */
+} SD_StatsTypeDef;
+
+struct __SD_RequestTypeDef;
+struct __SD_DeviceTypeDef;
+
+/**
+ * @brief 异步传输完成回调（在SDMMC中断上下文中调用）
+ */
+typedef void (*SD_RequestCallbackTypeDef)(struct __SD_RequestTypeDef *pReq);
+
+/**
+ * @brief IDMA双缓冲模式下单个缓冲区传输完成回调（在SDMMC中断上下文中调用）
+ * @note BufferIndex为刚被IDMA取空、可以重新填充的缓冲区（0或1）
+ */
+typedef void (*SD_BufferCallbackTypeDef)(struct __SD_RequestTypeDef *pReq, uint32_t BufferIndex);
+
+/**
+ * @brief 异步传输请求（完成令牌）
+ * @note 请求在完成前必须保持有效，不能放在会被释放的栈帧中
+ */
+typedef struct __SD_RequestTypeDef {
+    volatile uint32_t          Done;       /*!< 0:进行中 1:已完成，可轮询 */
+    volatile HAL_StatusTypeDef Status;     /*!< 完成状态 */
+    uint32_t                   ErrorCode;  /*!< 完成时的HAL_SD_GetError() */
+    SD_RequestCallbackTypeDef  Callback;   /*!< 完成回调，可为NULL */
+    SD_BufferCallbackTypeDef   BufferCallback; /*!< 双缓冲切换回调，仅双缓冲传输使用 */
+    void                      *pContext;   /*!< 用户上下文，回调中使用 */
+    struct __SD_DeviceTypeDef *pDev;       /*!< 所属实例，由驱动在启动时填写 */
+    uint32_t                   TimeoutMs;  /*!< 启动时按块数算出的超时（毫秒，SD_Dev_GetTimeout()），由驱动填写；0表示不限制 */
+    uint32_t                   BufferBlocks; /*!< 双缓冲传输每个缓冲区的块数，由驱动填写；其他传输为0 */
+} SD_RequestTypeDef;
+
 /* USER CODE END Exported types */
 
 /* USER CODE BEGIN Private defines */
@@ -76,15 +149,383 @@ typedef struct {
  * @}
  */
 
+/**
+ * @defgroup SD_Timeout_Derived 按卡寄存器计算的超时
+ * @note 初始化时读CSD（TAAC、NSAC、R2W_FACTOR）与SD Status（ERASE_SIZE、ERASE_TIMEOUT、ERASE_OFFSET），
+ *       每次读写、擦除按块数与当前总线时钟算出SD规范允许的最长时间（SD_GetTimeout()）。
+ *       调用者传入的Timeout只作为上限，实际等待取两者中较小的一个：卡停止响应时在百毫秒量级返回HAL_TIMEOUT，
+ *       而不是等满SD_TIMEOUT_DEFAULT/SD_TIMEOUT_LONG
+ * @{
+ */
+#ifndef SD_TIMEOUT_DERIVED
+#define SD_TIMEOUT_DERIVED        1U      /*!< 1: 读写、擦除与等待就绪按计算的超时提前返回；0: 只用调用者的Timeout */
+#endif
+#ifndef SD_TIMEOUT_READ_MAX_MS
+#define SD_TIMEOUT_READ_MAX_MS    100U    /*!< 读访问时间上限：SDHC/SDXC取此值，SDSC按CSD计算且不超过此值 */
+#endif
+#ifndef SD_TIMEOUT_WRITE_MAX_MS
+#define SD_TIMEOUT_WRITE_MAX_MS   250U    /*!< 写入编程忙上限：SDHC取此值，SDSC按CSD计算且不超过此值 */
+#endif
+#ifndef SD_TIMEOUT_WRITE_SDXC_MS
+#define SD_TIMEOUT_WRITE_SDXC_MS  500U    /*!< SDXC（容量大于32GB）的写入编程忙上限 */
+#endif
+#ifndef SD_TIMEOUT_ERASE_MAX_MS
+#define SD_TIMEOUT_ERASE_MAX_MS   60000U  /*!< 擦除超时上限（毫秒） */
+#endif
+#ifndef SD_TIMEOUT_WRITE_MIN_KBPS
+#define SD_TIMEOUT_WRITE_MIN_KBPS 1000U   /*!< 假定卡接收并编程数据至少有此速度（KB/s），总线更慢时按总线计；
+                                               合并、垃圾回收等编程忙另按编程忙上限计一次 */
+#endif
+#ifndef SD_TIMEOUT_BUS_MARGIN
+#define SD_TIMEOUT_BUS_MARGIN     2U      /*!< 总线传输时间的倍数，留给块间等待与IDMA仲裁 */
+#endif
+#ifndef SD_TIMEOUT_SLACK_MS
+#define SD_TIMEOUT_SLACK_MS       5U      /*!< 另加的固定余量：命令开销、SysTick的1ms粒度、任务切换 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Timeout_Op SD_GetTimeout()的操作类型
+ * @{
+ */
+#define SD_OP_READ         0U  /*!< 读：读访问时间 + 传输时间 */
+#define SD_OP_WRITE        1U  /*!< 写：传输时间 + 编程忙，也用作写入之后等待就绪的超时 */
+#define SD_OP_ERASE        2U  /*!< 擦除：按涉及的AU数计的擦除忙 */
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Transfer_Mode 阻塞读写的传输方式
+ * @{
+ */
+#ifndef SD_USE_IDMA
+#define SD_USE_IDMA        1U  /*!< 1: SD_ReadBlocks/SD_WriteBlocks走IDMA+等待完成，不关中断
+                                    0: 旧的查询模式（传输期间__disable_irq） */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_DMA_Config IDMA缓冲区与D-Cache
+ * @note 阻塞读写时，4字节对齐且IDMA可访问的缓冲区直接传输（读取还要求32字节对齐）；
+ *       其余缓冲区经跳板缓冲区中转，见SD_StatsTypeDef.DmaBounced
+ * @{
+ */
+#define SD_DCACHE_LINE     32U  /*!< Cortex-M7 D-Cache行大小 */
+
+#ifndef SD_BOUNCE_COUNT
+#define SD_BOUNCE_COUNT    2U  /*!< 跳板缓冲区个数 */
+#endif
+
+#ifndef SD_BOUNCE_BLOCKS
+#define SD_BOUNCE_BLOCKS   8U  /*!< 每个跳板缓冲区的块数，RAM = SD_BOUNCE_COUNT * SD_BOUNCE_BLOCKS * 512字节 */
+#endif
+
+#ifndef SD_BOUNCE_SECTION
+#define SD_BOUNCE_SECTION      /*!< 跳板缓冲区所在段，须为IDMA可访问的AXI SRAM，如 __attribute__((section(".RAM_D1"))) */
+#endif
+/**
+ * @}
+ */
+
+#if ((SD_BOUNCE_COUNT == 0U) || (SD_BOUNCE_COUNT > 32U) || (SD_BOUNCE_BLOCKS == 0U))
+  #error "SD_BOUNCE_COUNT must be 1..32 and SD_BOUNCE_BLOCKS greater than 0"
+#endif
+
+/**
+ * @defgroup SD_Write_Mode 多块写入方式
+ * @{
+ */
+#define SD_WRITE_MODE_OPEN_ENDED  0U  /*!< CMD25 ... CMD12，不预告块数 */
+#define SD_WRITE_MODE_PREDEFINED  1U  /*!< 先发ACMD23预擦除提示；卡支持时再发CMD23预定义块数，省去CMD12 */
+
+#ifndef SD_WRITE_MODE_DEFAULT
+#define SD_WRITE_MODE_DEFAULT     SD_WRITE_MODE_PREDEFINED
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Bus_Speed 总线速度协商
+ * @{
+ */
+#define SD_BUS_SPEED_DEFAULT      0U  /*!< Default Speed，SDMMC_CK不超过25MHz */
+#define SD_BUS_SPEED_HIGH         1U  /*!< High Speed（SDR25），SDMMC_CK不超过50MHz */
+#define SD_DEFAULT_SPEED_MAX_HZ   25000000U   /*!< Default Speed时SDMMC_CK上限（Hz） */
+#define SD_CLOCKDIV_DEFAULT       0xFFFFFFFFU /*!< SD_SetClockDiv()参数：恢复SD_Init时（CubeMX配置）的分频 */
+
+#ifndef SD_HIGH_SPEED_ENABLE
+#define SD_HIGH_SPEED_ENABLE      1U  /*!< 1: SD_Init用CMD6切换High Speed并提高SDMMC_CK */
+#endif
+
+#ifndef SD_HIGH_SPEED_MAX_HZ
+#define SD_HIGH_SPEED_MAX_HZ      50000000U  /*!< High Speed时SDMMC_CK上限（Hz），板子走线差时可调低 */
+#endif
+
+#ifndef SD_SPEED_VERIFY_BLOCKS
+#define SD_SPEED_VERIFY_BLOCKS    4U  /*!< 提速后重读比较的块数（从块0开始，只读） */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Wait_Config 等待卡就绪
+ * @note SD_WaitReady()不再连续发CMD13：卡在编程且DAT0忙时只看SDMMC的BUSYD0END标志（不占总线），
+ *       其他情况下CMD13的查询间隔从SD_WAIT_POLL_MIN_US起加倍到SD_WAIT_POLL_MAX_US，间隙中调用SD_WaitYield()
+ * @{
+ */
+#ifndef SD_WAIT_BUSY_DETECT
+#define SD_WAIT_BUSY_DETECT       1U     /*!< 1: 用DAT0忙结束检测等待卡编程完成；0: 只用CMD13查询 */
+#endif
+
+#ifndef SD_WAIT_POLL_MIN_US
+#define SD_WAIT_POLL_MIN_US       8U     /*!< CMD13查询间隔初值（微秒）；0: 不退避，连续查询 */
+#endif
+
+#ifndef SD_WAIT_POLL_MAX_US
+#define SD_WAIT_POLL_MAX_US       1024U  /*!< CMD13查询间隔上限（微秒），长时间擦除时每秒约1000次 */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_WAIT_POLL_MAX_US < SD_WAIT_POLL_MIN_US)
+  #error "SD_WAIT_POLL_MAX_US must not be less than SD_WAIT_POLL_MIN_US"
+#endif
+
+/**
+ * @defgroup SD_Cache_Enable 块缓存开关（参数见sd_cache.h）
+ * @{
+ */
+#ifndef SD_CACHE_ENABLE
+#define SD_CACHE_ENABLE    0U  /*!< 1: SD_ReadBlocks/SD_WriteBlocks经过组相联写回块缓存 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Prefetch_Enable 顺序读预取开关（参数见sd_prefetch.h）
+ * @{
+ */
+#ifndef SD_PREFETCH_ENABLE
+#define SD_PREFETCH_ENABLE 0U  /*!< 1: SD_ReadBlocks检测顺序访问并用IDMA在后台预读下一个窗口 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Queue_Enable 写合并队列开关（参数见sd_queue.h）
+ * @{
+ */
+#ifndef SD_QUEUE_ENABLE
+#define SD_QUEUE_ENABLE    0U  /*!< 1: SD_WriteBlocks的小块写入先进入队列，排序合并后以多块写入写卡 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Plan_Enable AU对齐写入规划开关（参数见sd_plan.h）
+ * @{
+ */
+#ifndef SD_PLAN_ENABLE
+#define SD_PLAN_ENABLE     0U  /*!< 1: 提供SD_Plan_xxx()，把流式数据按AU/RU对齐、补齐后写卡 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Stats_Enable 运行统计开关
+ * @{
+ */
+#ifndef SD_STATS_ENABLE
+#define SD_STATS_ENABLE    1U  /*!< 1: 读写、擦除、等待就绪计入SD_GetStats()（每次调用约数十个周期）；0: 不编译 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Trace_Enable 事件跟踪开关（参数见sd_trace.h）
+ * @{
+ */
+#ifndef SD_TRACE_ENABLE
+#define SD_TRACE_ENABLE    0U  /*!< 1: 驱动把命令、IDMA、忙等待和错误记入环形缓冲区，SD_Trace_Dump()导出；只记录默认实例 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Bench_Enable 性能测试套件开关（参数见sd_bench.h）
+ * @{
+ */
+#ifndef SD_BENCH_ENABLE
+#define SD_BENCH_ENABLE    0U  /*!< 1: 提供SD_Bench_Run()，输出各种访问模式的MB/s、IOPS与延迟分位数 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Calib_Enable 时钟校准开关（参数见sd_calib.h）
+ * @{
+ */
+#ifndef SD_CALIB_ENABLE
+#define SD_CALIB_ENABLE    0U  /*!< 1: 提供SD_Calibrate()，按CRC错误反馈找出板子能稳定工作的最高SDMMC_CK */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Sched_Enable 多任务调度开关（参数见sd_sched.h）
+ * @{
+ */
+#ifndef SD_SCHED_ENABLE
+#define SD_SCHED_ENABLE    0U  /*!< 1: 提供SD_Sched_xxx()，多个任务经按优先级分开的队列提交请求，由一个执行者独占访问卡 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_DiskIo_Enable FatFs底层接口开关（参数见sd_diskio.h）
+ * @{
+ */
+#ifndef SD_DISKIO_ENABLE
+#define SD_DISKIO_ENABLE   0U  /*!< 1: 提供FatFs的disk_xxx()（需要工程中有FatFs） */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Discard_Enable 丢弃区间记录开关（参数见sd_discard.h）
+ * @{
+ */
+#ifndef SD_DISCARD_ENABLE
+#define SD_DISCARD_ENABLE  0U  /*!< 1: 提供SD_Discard()，记录不再需要的块区间，空闲时批量擦除 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Log_Enable 日志结构追加存储开关（参数见sd_log.h）
+ * @{
+ */
+#ifndef SD_LOG_ENABLE
+#define SD_LOG_ENABLE      0U  /*!< 1: 提供SD_Log_xxx()，不经文件系统在块区域上追加记录，掉电后快速恢复 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Crc_Enable 逐块CRC完整性校验开关（参数见sd_crc.h）
+ * @{
+ */
+#ifndef SD_CRC_ENABLE
+#define SD_CRC_ENABLE      0U  /*!< 1: SD_Crc_Attach()指定的区域经SD_WriteBlocks()写入时记录每块的CRC32，SD_ReadBlocks()读出时校验 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Recover_Enable 错误恢复开关（参数见sd_recover.h）
+ * @{
+ */
+#ifndef SD_RECOVER_ENABLE
+#define SD_RECOVER_ENABLE  0U  /*!< 1: 直接读写失败时按错误类别退避重试，连续CRC错误时降频或降为1线，超时时发CMD12或重新初始化卡 */
+#endif
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Device_Config 多实例
+ * @note 每个SDMMC控制器对应一个SD_DeviceTypeDef，各自的状态、统计与IDMA请求互不影响，两张卡可同时传输。
+ *       缓存、队列、预取、丢弃、CRC与错误恢复等前门层只作用于默认实例sddev1（hsd1）
+ * @{
+ */
+#ifndef SD_MAX_DEVICES
+#define SD_MAX_DEVICES     2U  /*!< 最多登记的实例数（HAL回调按句柄查找实例） */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_MAX_DEVICES == 0U)
+  #error "SD_MAX_DEVICES must be greater than 0"
+#endif
+
+/**
+ * @defgroup SD_Raid_Enable 双卡条带/镜像开关（参数见sd_raid.h）
+ * @{
+ */
+#ifndef SD_RAID_ENABLE
+#define SD_RAID_ENABLE     0U  /*!< 1: 提供SD_Raid_xxx()，把两个实例上的卡当作一个块设备（RAID-0条带或RAID-1镜像） */
+#endif
+/**
+ * @}
+ */
+
 /**
  * @defgroup SD_Block_Size SD卡块大小定义
  * @{
  */
 #define SD_BLOCK_SIZE      ((uint32_t)512U)    /*!< SD卡标准块大小 */
+#define SD_DOUBLEBUF_MAX_BLOCKS ((uint32_t)65535U) /*!< 单次双缓冲传输最大块数（DLEN为25位） */
 /**
  * @}
  */
 
+/**
+ * @brief SD卡实例：一个SDMMC控制器及其上的卡
+ * @note 由SD_Dev_Init()填写，调用者只需提供存储；hsd须为第一个成员
+ */
+typedef struct __SD_DeviceTypeDef {
+    SD_HandleTypeDef             *hsd;            /*!< HAL句柄（hsd1、hsd2） */
+    SD_RequestTypeDef * volatile ActiveReq;       /*!< 正在进行的IDMA请求，NULL表示空闲 */
+    uint32_t                     WriteMode;       /*!< 多块写入方式：SD_WRITE_MODE_xxx */
+    uint8_t                      Cmd23Supported;  /*!< SCR声明支持CMD23 */
+    uint8_t                      CardStatusValid; /*!< CardStatus已读到 */
+    uint8_t                      ClockRaised;     /*!< 时钟已高于初始化时的分频 */
+    uint32_t                     BusSpeed;        /*!< SD_BUS_SPEED_xxx */
+    uint32_t                     DefaultClkDiv;   /*!< 初始化时的分频 */
+    HAL_SD_CardStatusTypeDef     CardStatus;      /*!< SD Status（ACMD13） */
+    uint32_t                     TaacNs;          /*!< CSD.TAAC：与时钟无关的读访问时间（纳秒） */
+    uint32_t                     NsacClocks;      /*!< CSD.NSAC×100：与时钟有关的读访问时间（SDMMC_CK周期） */
+    uint8_t                      R2wFactor;       /*!< CSD.R2W_FACTOR：写入时间为读访问时间的2^R2W_FACTOR倍 */
+    uint8_t                      CsdTimeouts;     /*!< 1: SDSC，读写超时按上面三项计算；0: SDHC/SDXC，用规范规定的固定值 */
+    uint32_t                     BusyTimeoutMs;   /*!< 最近一次读写、擦除之后等待就绪的超时，SD_Dev_WaitReady()取它与参数中较小的一个；0不限制 */
+    uint8_t                      *DmaRxBuf;       /*!< IDMA读取中的缓冲区，完成后再作废一次D-Cache */
+    uint32_t                     DmaRxLen;
+#if (SD_USE_IDMA != 0U)
+    SD_RequestTypeDef            SyncReq;         /*!< 阻塞读写使用的令牌 */
+#endif
+#if (SD_TRACE_ENABLE != 0U)
+    uint8_t                      TraceCmd;        /*!< 正在进行的IDMA传输的命令与起始块，完成事件中使用 */
+    uint32_t                     TraceBlk;
+#endif
+#if (SD_STATS_ENABLE != 0U)
+    SD_StatsTypeDef              Stats;           /*!< 运行统计 */
+#endif
+} SD_DeviceTypeDef;
+
+extern SD_DeviceTypeDef sddev1;  /*!< 默认实例（hsd1），下面不带hdev参数的接口都作用于它 */
+
 /**
  * @brief SD卡初始化函数
  * @retval HAL_StatusTypeDef 返回操作状态
@@ -101,34 +542,270 @@ HAL_StatusTypeDef SD_Check(void);
 
 /**
  * @brief 等待SD卡就绪
- * @param  Timeout: 超时时间（毫秒）
+ * @param  Timeout: 超时时间上限（毫秒）
  * @retval HAL_StatusTypeDef 返回操作状态
- * @note 等待SD卡进入传输状态
+ * @note 等待SD卡进入传输状态；查询方式见SD_Wait_Config
+ * @note 最近一次读写或擦除按块数算出的超时（SD_Timeout_Derived）比Timeout短时按它返回HAL_TIMEOUT
+ * @note 卡无响应或不在传输、收发、编程状态时立即返回HAL_ERROR
  */
 HAL_StatusTypeDef SD_WaitReady(uint32_t Timeout);
 
+/**
+ * @brief 等待卡就绪期间让出CPU（弱定义）
+ * @param  Us: 驱动下一次检查前可以让出的时间（微秒）
+ * @note 默认立即返回（仍在查询寄存器，但不发命令）；RTOS下可重新实现为osDelay()等，
+ *       裸机下可用__WFI()睡到下一个中断。返回得晚只会推迟发现卡就绪，不影响正确性
+ */
+void SD_WaitYield(uint32_t Us);
+
 /**
  * @brief SD卡多块写入
- * @param  pData: 数据缓冲区指针（必须4字节对齐）
+ * @param  pData: 数据缓冲区指针（建议32字节对齐且IDMA可访问，否则经跳板缓冲区中转）
  * @param  BlockAdd: 起始块地址
  * @param  NumberOfBlocks: 块数量
  * @param  Timeout: 超时时间（毫秒）
  * @retval HAL_StatusTypeDef 返回操作状态
- * @note 使用查询模式进行多块写入，避免FIFO溢出
+ * @note 使能SD_CACHE_ENABLE时写入块缓存、使能SD_QUEUE_ENABLE时进入写合并队列，需SD_Flush()才保证落盘
  */
 HAL_StatusTypeDef SD_WriteBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
 
 /**
  * @brief SD卡多块读取
- * @param  pData: 数据缓冲区指针（必须4字节对齐）
+ * @param  pData: 数据缓冲区指针（建议32字节对齐且IDMA可访问，否则经跳板缓冲区中转）
  * @param  BlockAdd: 起始块地址
  * @param  NumberOfBlocks: 块数量
  * @param  Timeout: 超时时间（毫秒）
  * @retval HAL_StatusTypeDef 返回操作状态
- * @note 使用查询模式进行多块读取，避免FIFO溢出
+ * @note 使能SD_CACHE_ENABLE时优先从块缓存读取；使能SD_PREFETCH_ENABLE时顺序小块读取从预取缓冲返回
+ * @note 使能SD_CRC_ENABLE时受保护区域的块读出后校验CRC，不一致返回HAL_ERROR
  */
 HAL_StatusTypeDef SD_ReadBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
 
+/**
+ * @brief SD卡多块写入（直接访问卡，不经过缓存）
+ * @param  pData: 数据缓冲区指针（建议32字节对齐且IDMA可访问，否则经跳板缓冲区中转）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间上限（毫秒），实际按SD_GetTimeout(SD_OP_WRITE, NumberOfBlocks)提前返回
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note SD_USE_IDMA时IDMA传输并等待完成，否则查询模式（关中断，避免FIFO溢出）
+ * @note 使能SD_RECOVER_ENABLE时失败后按错误类别恢复并重试，重试用尽才返回错误
+ * @note 不经过块缓存和写合并队列，写同一区间前应先SD_Flush()
+ */
+HAL_StatusTypeDef SD_WriteBlocksDirect(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief SD卡多块读取（直接访问卡，不经过缓存）
+ * @param  pData: 数据缓冲区指针（建议32字节对齐且IDMA可访问，否则经跳板缓冲区中转）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间上限（毫秒），实际按SD_GetTimeout(SD_OP_READ, NumberOfBlocks)提前返回
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note SD_USE_IDMA时IDMA传输并等待完成，否则查询模式（关中断，避免FIFO溢出）
+ * @note 使能SD_RECOVER_ENABLE时失败后按错误类别恢复并重试，重试用尽才返回错误
+ */
+HAL_StatusTypeDef SD_ReadBlocksDirect(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 将驱动内部缓存的数据写入卡
+ * @param  Timeout: 每次写入的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 断电或拔卡前必须调用；先写回块缓存再刷新写合并队列，最后写回CRC表，都未使能时为空操作
+ */
+HAL_StatusTypeDef SD_Flush(uint32_t Timeout);
+
+/**
+ * @brief SD卡擦除块
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 等待卡就绪的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 擦除命令发出后即返回，卡在后台擦除，之后等待就绪的超时按SD_GetTimeout(SD_OP_ERASE, NumberOfBlocks)计；
+ *       区间内的缓存行和写合并队列中的块作废
+ */
+HAL_StatusTypeDef SD_EraseBlocks(uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 设置SDMMC_CK分频
+ * @param  ClkDiv: CLKCR.CLKDIV（0为直通，SDMMC_CK = 内核时钟 / (2 * ClkDiv)）；SD_CLOCKDIV_DEFAULT恢复SD_Init时的分频
+ * @retval HAL_StatusTypeDef 传输进行中返回HAL_BUSY
+ * @note 调用者负责不超过卡当前速度模式的上限；高于SD_Init时的时钟出现数据错误会自动退回
+ */
+HAL_StatusTypeDef SD_SetClockDiv(uint32_t ClkDiv);
+
+/**
+ * @brief 读取当前SDMMC_CK分频
+ * @retval uint32_t CLKCR.CLKDIV
+ */
+uint32_t SD_GetClockDiv(void);
+
+/**
+ * @brief 分频系数对应的SDMMC_CK
+ * @param  ClkDiv: CLKCR.CLKDIV
+ * @retval uint32_t 频率（Hz）
+ */
+uint32_t SD_ClockDivToHz(uint32_t ClkDiv);
+
+/**
+ * @brief 使SDMMC_CK不超过MaxHz的最小分频系数
+ * @param  MaxHz: 频率上限（Hz）
+ * @retval uint32_t CLKCR.CLKDIV
+ */
+uint32_t SD_ClockDivForHz(uint32_t MaxHz);
+
+/**
+ * @brief 设置数据线宽度（ACMD6）
+ * @param  BusWidth: SDMMC_BUS_WIDE_1B 或 SDMMC_BUS_WIDE_4B
+ * @retval HAL_StatusTypeDef 传输进行中返回HAL_BUSY
+ * @note 保持当前分频不变
+ */
+HAL_StatusTypeDef SD_SetBusWidth(uint32_t BusWidth);
+
+/**
+ * @brief 读取当前数据线宽度
+ * @retval uint32_t SDMMC_BUS_WIDE_1B 或 SDMMC_BUS_WIDE_4B
+ */
+uint32_t SD_GetBusWidth(void);
+
+/**
+ * @brief 重新初始化卡（从CMD0开始识别），之后恢复原来的线宽、High Speed模式和分频
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 用于卡无响应时恢复；卡重新切换High Speed失败时分频退回SD_Init时的值
+ */
+HAL_StatusTypeDef SD_ResetCard(void);
+
+/**
+ * @brief 设置多块写入方式
+ * @param  Mode: SD_WRITE_MODE_OPEN_ENDED 或 SD_WRITE_MODE_PREDEFINED
+ * @retval HAL_StatusTypeDef 参数非法返回HAL_ERROR
+ * @note 只影响之后启动的写入
+ */
+HAL_StatusTypeDef SD_SetWriteMode(uint32_t Mode);
+
+/**
+ * @brief 读取当前多块写入方式
+ * @retval uint32_t SD_WRITE_MODE_xxx
+ */
+uint32_t SD_GetWriteMode(void);
+
+/**
+ * @brief 判断缓冲区能否由SDMMC1 IDMA直接访问（弱定义）
+ * @param  pData: 缓冲区
+ * @param  Length: 字节数
+ * @retval uint8_t 1: 可以；0: 位于ITCM、DTCM或D2/D3域SRAM
+ * @note 外部存储器等需要排除的区域可重新实现
+ * @note SDMMC2也按此判断：SDMMC1能访问的区域SDMMC2都能访问
+ */
+uint8_t SD_IsDmaReachable(const void *pData, uint32_t Length);
+
+/**
+ * @brief 清理（写回）缓冲区所在的D-Cache行
+ * @param  pData: 缓冲区
+ * @param  Length: 字节数
+ * @note 异步写入启动时驱动已清理；双缓冲写入中重新填好的缓冲区由调用者在交给IDMA前清理
+ */
+void SD_DCacheClean(const void *pData, uint32_t Length);
+
+/**
+ * @brief 作废缓冲区所在的D-Cache行
+ * @param  pData: 缓冲区
+ * @param  Length: 字节数
+ * @param  Clean: 1: 作废前先写回脏行
+ * @note 按缓存行向外取整，首尾行须归调用者所有；双缓冲读取中，缓冲区填满后由调用者在读取前作废
+ */
+void SD_DCacheInvalidate(const void *pData, uint32_t Length, uint8_t Clean);
+
+/**
+ * @brief SD卡异步多块写入（IDMA）
+ * @param  pData: 数据缓冲区指针（必须4字节对齐且IDMA可访问，完成前不得修改）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  pReq: 完成令牌，Callback/pContext由调用者预先填写
+ * @retval HAL_StatusTypeDef HAL_OK已启动；HAL_BUSY卡或控制器忙，稍后重试
+ * @note 启动后立即返回，CPU和其他中断在传输期间照常运行
+ * @note 需在CubeMX中使能SDMMC1全局中断
+ * @note SD_WRITE_MODE_PREDEFINED且块数大于1时，启动前先发ACMD23/CMD23
+ */
+HAL_StatusTypeDef SD_WriteBlocksAsync(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                      SD_RequestTypeDef *pReq);
+
+/**
+ * @brief SD卡异步多块读取（IDMA）
+ * @param  pData: 数据缓冲区指针（必须32字节对齐且IDMA可访问，否则返回HAL_ERROR）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  pReq: 完成令牌，Callback/pContext由调用者预先填写
+ * @retval HAL_StatusTypeDef HAL_OK已启动；HAL_BUSY卡或控制器忙，稍后重试
+ * @note 启动前和完成时（回调之前）驱动作废缓冲区的D-Cache行，传输期间不得访问缓冲区
+ */
+HAL_StatusTypeDef SD_ReadBlocksAsync(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                     SD_RequestTypeDef *pReq);
+
+/**
+ * @brief SD卡IDMA双缓冲多块写入（异步）
+ * @param  pBuf0: 缓冲区0（BufferBlocks块，必须32字节对齐）
+ * @param  pBuf1: 缓冲区1（BufferBlocks块，必须32字节对齐）
+ * @param  BufferBlocks: 每个缓冲区的块数
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 总块数（BufferBlocks的整数倍，不超过SD_DOUBLEBUF_MAX_BLOCKS）
+ * @param  pReq: 完成令牌，BufferCallback在每个缓冲区被取空后调用
+ * @retval HAL_StatusTypeDef HAL_OK已启动；HAL_BUSY卡或控制器忙
+ * @note 整个传输只发一次CMD25，IDMA在两个缓冲区之间自动切换（IDMABASE0/IDMABASE1），
+ *       调用者必须在另一个缓冲区传完之前重新填好刚取空的缓冲区，并用SD_DCacheClean()清理
+ */
+HAL_StatusTypeDef SD_WriteBlocksDoubleBufferAsync(uint8_t *pBuf0, uint8_t *pBuf1, uint32_t BufferBlocks,
+                                                  uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                                  SD_RequestTypeDef *pReq);
+
+/**
+ * @brief SD卡IDMA双缓冲多块读取（异步）
+ * @param  pBuf0: 缓冲区0（BufferBlocks块，必须32字节对齐）
+ * @param  pBuf1: 缓冲区1（BufferBlocks块，必须32字节对齐）
+ * @param  BufferBlocks: 每个缓冲区的块数
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 总块数（BufferBlocks的整数倍，不超过SD_DOUBLEBUF_MAX_BLOCKS）
+ * @param  pReq: 完成令牌，BufferCallback在每个缓冲区被填满后调用
+ * @retval HAL_StatusTypeDef HAL_OK已启动；HAL_BUSY卡或控制器忙
+ * @note 整个传输只发一次CMD18；调用者必须在另一个缓冲区填满之前取走刚填满的缓冲区
+ *       （先用SD_DCacheInvalidate()作废），或用SD_ChangeDoubleBuffer()换成新的缓冲区
+ */
+HAL_StatusTypeDef SD_ReadBlocksDoubleBufferAsync(uint8_t *pBuf0, uint8_t *pBuf1, uint32_t BufferBlocks,
+                                                 uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                                 SD_RequestTypeDef *pReq);
+
+/**
+ * @brief 双缓冲传输中更换缓冲区的地址（IDMABASE0/IDMABASE1）
+ * @param  BufferIndex: 缓冲区号（0或1），只能是BufferCallback刚报告的缓冲区
+ * @param  pBuf: 新的缓冲区（BufferBlocks块，4字节对齐且IDMA可访问）
+ * @retval HAL_StatusTypeDef 没有进行中的双缓冲请求、地址未4字节对齐或IDMA不可访问时返回HAL_ERROR
+ * @note 在BufferCallback中调用，从该缓冲区的下一轮起生效；写入前须清理、读取前须写回并作废新缓冲区的D-Cache
+ */
+HAL_StatusTypeDef SD_ChangeDoubleBuffer(uint32_t BufferIndex, uint8_t *pBuf);
+
+/**
+ * @brief 中止正在进行的异步请求
+ * @param  pReq: 完成令牌
+ * @param  Status: 写入令牌的完成状态
+ * @retval HAL_StatusTypeDef pReq不是当前请求时返回HAL_ERROR
+ * @note 发送CMD12停止传输，可在中断上下文中调用；已完成的回调照常调用
+ */
+HAL_StatusTypeDef SD_AbortRequest(SD_RequestTypeDef *pReq, HAL_StatusTypeDef Status);
+
+/**
+ * @brief 查询异步请求状态
+ * @param  pReq: 完成令牌
+ * @retval HAL_StatusTypeDef 未完成返回HAL_BUSY，否则返回请求的完成状态
+ */
+HAL_StatusTypeDef SD_PollRequest(const SD_RequestTypeDef *pReq);
+
+/**
+ * @brief 等待异步请求完成
+ * @param  pReq: 完成令牌
+ * @param  Timeout: 超时时间上限（毫秒）；请求的TimeoutMs更短时按TimeoutMs
+ * @retval HAL_StatusTypeDef 请求的完成状态；超时则中止传输并返回HAL_TIMEOUT
+ */
+HAL_StatusTypeDef SD_WaitRequest(SD_RequestTypeDef *pReq, uint32_t Timeout);
+
 #ifdef DEBUG
 
 /**
@@ -137,7 +814,6 @@ HAL_StatusTypeDef SD_ReadBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t Numb
  */
 #define SD_TEST_BLOCKS      32           /* 测试块数 - 建议值范围[32, 256]。越大越准确, 消耗0.5倍RAM(KB) */
 #define SD_TEST_BLOCK_START 1000        /* 测试起始块地址 */
-#define SD_TIMEOUT_MS       16000        /* 超时时间 */
 /**
  * @}
  */
@@ -145,7 +821,7 @@ HAL_StatusTypeDef SD_ReadBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t Numb
 /**
  * @brief SD卡性能测试函数
  * @retval HAL_StatusTypeDef 返回操作状态
- * @note 仅在DEBUG模式下可用，用于测试SD卡读写性能
+ * @note 仅在DEBUG模式下可用，用于快速检查读写与速度；各种访问模式的完整测试见SD_Bench_Run()
  */
 HAL_StatusTypeDef SD_MeasureTest(void);
 #endif
@@ -158,6 +834,154 @@ HAL_StatusTypeDef SD_MeasureTest(void);
  */
 HAL_StatusTypeDef SD_GetCardInfo(SD_CardInfoTypeDef *pCardInfo);
 
+/**
+ * @brief 按卡寄存器与当前总线时钟计算一次操作的超时
+ * @param  Op: SD_OP_READ/SD_OP_WRITE/SD_OP_ERASE
+ * @param  NumberOfBlocks: 块数
+ * @retval uint32_t 超时（毫秒）
+ * @note 读：读访问时间 + 总线传输时间×SD_TIMEOUT_BUS_MARGIN + SD_TIMEOUT_SLACK_MS；
+ *       写：编程忙超时 + 按总线时间×SD_TIMEOUT_BUS_MARGIN与SD_TIMEOUT_WRITE_MIN_KBPS中较慢者计的数据时间 + SD_TIMEOUT_SLACK_MS；
+ *       擦除：每个AU的擦除超时×涉及的AU数 + ERASE_OFFSET，不超过SD_TIMEOUT_ERASE_MAX_MS
+ * @note 规范按块规定读访问与编程忙的上限，这里对整次传输只计一次，块间的等待由传输时间的倍数承担
+ */
+uint32_t SD_GetTimeout(uint32_t Op, uint32_t NumberOfBlocks);
+
+/**
+ * @brief 读取运行统计
+ * @param  pStats: 统计结构体指针
+ * @note SD_STATS_ENABLE为0时结构体清零
+ */
+void SD_GetStats(SD_StatsTypeDef *pStats);
+
+/**
+ * @brief 清零运行统计
+ */
+void SD_ResetStats(void);
+
+/**
+ * @brief 登记实例并初始化卡
+ * @param  hdev: 实例存储，如sddev1或调用者定义的SD_DeviceTypeDef
+ * @param  hsd: 已由MX_SDMMCx_SD_Init()初始化的HAL句柄
+ * @retval HAL_StatusTypeDef 句柄已属于其他实例或已登记SD_MAX_DEVICES个实例时返回HAL_ERROR
+ * @note 同SD_Init()，作用于hdev；重复调用时重新初始化
+ */
+HAL_StatusTypeDef SD_Dev_Init(SD_DeviceTypeDef *hdev, SD_HandleTypeDef *hsd);
+
+/**
+ * @brief 同SD_Check()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_Check(SD_DeviceTypeDef *hdev);
+
+/**
+ * @brief 同SD_WaitReady()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_WaitReady(SD_DeviceTypeDef *hdev, uint32_t Timeout);
+
+/**
+ * @brief 同SD_WriteBlocksDirect()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_WriteBlocksDirect(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                           uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 同SD_ReadBlocksDirect()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_ReadBlocksDirect(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                          uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 同SD_EraseBlocks()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_EraseBlocks(SD_DeviceTypeDef *hdev, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                     uint32_t Timeout);
+
+/**
+ * @brief 同SD_SetClockDiv()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_SetClockDiv(SD_DeviceTypeDef *hdev, uint32_t ClkDiv);
+
+/**
+ * @brief 同SD_GetClockDiv()，作用于hdev
+ */
+uint32_t SD_Dev_GetClockDiv(const SD_DeviceTypeDef *hdev);
+
+/**
+ * @brief 同SD_SetBusWidth()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_SetBusWidth(SD_DeviceTypeDef *hdev, uint32_t BusWidth);
+
+/**
+ * @brief 同SD_GetBusWidth()，作用于hdev
+ */
+uint32_t SD_Dev_GetBusWidth(const SD_DeviceTypeDef *hdev);
+
+/**
+ * @brief 同SD_ResetCard()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_ResetCard(SD_DeviceTypeDef *hdev);
+
+/**
+ * @brief 同SD_SetWriteMode()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_SetWriteMode(SD_DeviceTypeDef *hdev, uint32_t Mode);
+
+/**
+ * @brief 同SD_GetWriteMode()，作用于hdev
+ */
+uint32_t SD_Dev_GetWriteMode(const SD_DeviceTypeDef *hdev);
+
+/**
+ * @brief 同SD_WriteBlocksAsync()，作用于hdev
+ * @note 各实例的请求互不影响，可同时进行；令牌由SD_PollRequest()/SD_WaitRequest()/SD_AbortRequest()处理
+ */
+HAL_StatusTypeDef SD_Dev_WriteBlocksAsync(SD_DeviceTypeDef *hdev, const uint8_t *pData, uint32_t BlockAdd,
+                                          uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq);
+
+/**
+ * @brief 同SD_ReadBlocksAsync()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_ReadBlocksAsync(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                         uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq);
+
+/**
+ * @brief 同SD_WriteBlocksDoubleBufferAsync()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_WriteBlocksDoubleBufferAsync(SD_DeviceTypeDef *hdev, uint8_t *pBuf0, uint8_t *pBuf1,
+                                                      uint32_t BufferBlocks, uint32_t BlockAdd,
+                                                      uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq);
+
+/**
+ * @brief 同SD_ReadBlocksDoubleBufferAsync()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_ReadBlocksDoubleBufferAsync(SD_DeviceTypeDef *hdev, uint8_t *pBuf0, uint8_t *pBuf1,
+                                                     uint32_t BufferBlocks, uint32_t BlockAdd,
+                                                     uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq);
+
+/**
+ * @brief 同SD_ChangeDoubleBuffer()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_ChangeDoubleBuffer(SD_DeviceTypeDef *hdev, uint32_t BufferIndex, uint8_t *pBuf);
+
+/**
+ * @brief 同SD_GetCardInfo()，作用于hdev
+ */
+HAL_StatusTypeDef SD_Dev_GetCardInfo(const SD_DeviceTypeDef *hdev, SD_CardInfoTypeDef *pCardInfo);
+
+/**
+ * @brief 同SD_GetTimeout()，作用于hdev
+ */
+uint32_t SD_Dev_GetTimeout(const SD_DeviceTypeDef *hdev, uint32_t Op, uint32_t NumberOfBlocks);
+
+/**
+ * @brief 同SD_GetStats()，作用于hdev；每个实例各自统计读写、擦除与等待就绪
+ */
+void SD_Dev_GetStats(const SD_DeviceTypeDef *hdev, SD_StatsTypeDef *pStats);
+
+/**
+ * @brief 同SD_ResetStats()，作用于hdev
+ */
+void SD_Dev_ResetStats(SD_DeviceTypeDef *hdev);
+
 /* USER CODE END Private defines */
 
 
@@ -171,17 +995,13 @@ HAL_StatusTypeDef SD_GetCardInfo(SD_CardInfoTypeDef *pCardInfo);
  * @brief 获取SD卡状态
  * @retval HAL_SD_CardStateTypeDef SD卡状态
  */
-#define SD_GetStatus() HAL_SD_GetCardState(&hsd1)
+#define SD_GetStatus() HAL_SD_GetCardState(sddev1.hsd)
 
 /**
- * @brief SD卡擦除块
- * @param  BlockAdd: 起始块地址
- * @param  NumberOfBlocks: 块数量
- * @param  Timeout: 超时时间（毫秒）
- * @retval HAL_StatusTypeDef 返回操作状态
+ * @brief 获取实例上的SD卡状态
+ * @retval HAL_SD_CardStateTypeDef SD卡状态
  */
-#define SD_EraseBlocks(BlockAdd, NumberOfBlocks, Timeout) \
-        HAL_SD_EraseBlocks(&hsd1, (BlockAdd), (NumberOfBlocks), (Timeout))
+#define SD_Dev_GetStatus(hdev) HAL_SD_GetCardState((hdev)->hsd)
 
 /* USER CODE END Exported macro */
 
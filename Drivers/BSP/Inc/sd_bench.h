@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file    sd_bench.h
+  * @brief   SD卡性能测试套件
+  * @author  STMicroelectronics
+  * @date    2025-10-31
+  * @version 1.0
+  * @note    在sd.h中定义SD_BENCH_ENABLE为1后可用；顺序/随机读写的传输大小扫描与混合读写，
+  *          每项输出MB/s、IOPS与延迟分位数（p50/p99/max），默认以CSV行经printf输出
+  * @note    计时使用DWT->CYCCNT（主机仿真中为虚拟时间），目标板与仿真输出格式相同，可直接比对
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_BENCH_H__
+#define __SD_BENCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Bench_Config 测试套件配置
+ * @{
+ */
+#ifndef SD_BENCH_MAX_OPS
+#define SD_BENCH_MAX_OPS      256U    /*!< 每项最多的传输次数（延迟样本数），RAM = 4 * SD_BENCH_MAX_OPS字节 */
+#endif
+
+#ifndef SD_BENCH_MIX_BLOCKS
+#define SD_BENCH_MIX_BLOCKS   8U      /*!< 混合读写测试的传输块数（4KB） */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_BENCH_MAX_OPS == 0U)
+  #error "SD_BENCH_MAX_OPS must be greater than 0"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 测试配置
+ */
+typedef struct {
+    uint32_t  StartBlock;    /*!< 测试区起始块（内容会被覆盖，不备份） */
+    uint32_t  AreaBlocks;    /*!< 测试区块数，不少于MaxBlocks */
+    uint8_t  *pBuf;          /*!< 传输缓冲区（32字节对齐，位于IDMA可访问的RAM） */
+    uint32_t  MaxBlocks;     /*!< 缓冲区块数，即传输大小扫描的上限（1、2、4 ... MaxBlocks） */
+    uint32_t  Ops;           /*!< 每项的传输次数，不超过SD_BENCH_MAX_OPS */
+    uint32_t  Seed;          /*!< 随机地址的种子，相同种子结果可复现 */
+} SD_BenchConfigTypeDef;
+
+/**
+ * @brief 单项测试结果
+ */
+typedef struct {
+    const char *Test;        /*!< 测试名："seq"、"rand"、"mix" */
+    uint32_t    Blocks;      /*!< 每次传输块数 */
+    uint32_t    ReadPercent; /*!< 读所占百分比：100为纯读，0为纯写 */
+    uint32_t    Ops;         /*!< 传输次数 */
+    uint32_t    Bytes;       /*!< 传输字节数 */
+    uint32_t    TotalUs;     /*!< 总耗时（微秒），写入项含最后的SD_Flush()/SD_WaitReady() */
+    uint32_t    KBps;        /*!< 吞吐（1000字节/秒） */
+    uint32_t    Iops;        /*!< 每秒传输次数 */
+    uint32_t    P50Us;       /*!< 延迟中位数（微秒） */
+    uint32_t    P99Us;       /*!< 延迟99分位（微秒） */
+    uint32_t    MaxUs;       /*!< 最大延迟（微秒） */
+} SD_BenchResultTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 运行全部测试项
+ * @param  pConfig: 测试配置
+ * @retval HAL_StatusTypeDef 任一次传输失败即返回该状态
+ * @note 需在SD_Init()之后调用；依次为顺序读、顺序写、随机读、随机写（各自扫描传输大小）和混合读写，
+ *       每项结果交给SD_Bench_Output()
+ * @note 单次延迟从调用SD_ReadBlocks()/SD_WriteBlocks()到卡重新就绪（写入含编程忙）；卡同一时刻只执行一个请求，
+ *       上一次就绪后才发下一次
+ */
+HAL_StatusTypeDef SD_Bench_Run(const SD_BenchConfigTypeDef *pConfig);
+
+/**
+ * @brief 输出一项结果（弱定义，默认打印CSV行）
+ * @param  pResult: 测试结果；为NULL时输出表头
+ * @note 行以"sdbench,"开头，便于从混合日志中提取；用户可重新实现，写入文件或经其他接口上传
+ */
+void SD_Bench_Output(const SD_BenchResultTypeDef *pResult);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_BENCH_H__ */
@@ -0,0 +1,142 @@
+/**
+  ******************************************************************************
+  * @file    sd_cache.h
+  * @brief   SD卡组相联写回块缓存
+  * @author  STMicroelectronics
+  * @date    2025-10-24
+  * @version 1.0
+  * @note    在sd.h中定义SD_CACHE_ENABLE为1后，SD_ReadBlocks/SD_WriteBlocks自动经过本缓存
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_CACHE_H__
+#define __SD_CACHE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Cache_Config 块缓存配置
+ * @{
+ */
+#ifndef SD_CACHE_LINES
+#define SD_CACHE_LINES          32U   /*!< 缓存行数（每行SD_BLOCK_SIZE字节），必须是SD_CACHE_WAYS的整数倍 */
+#endif
+
+#ifndef SD_CACHE_WAYS
+#define SD_CACHE_WAYS           4U    /*!< 组相联路数 */
+#endif
+
+#ifndef SD_CACHE_BYPASS_BLOCKS
+#define SD_CACHE_BYPASS_BLOCKS  8U    /*!< 不少于该块数的读写绕过缓存直接访问卡，避免冲掉热点扇区 */
+#endif
+
+#ifndef SD_CACHE_SECTION
+#define SD_CACHE_SECTION              /*!< 缓存数据所在段，如 __attribute__((section(".RAM_D1")))；
+                                           启用IDMA时不能放在DTCM（IDMA不可访问） */
+#endif
+/**
+ * @}
+ */
+
+#define SD_CACHE_SETS           (SD_CACHE_LINES / SD_CACHE_WAYS)
+
+#if ((SD_CACHE_LINES % SD_CACHE_WAYS) != 0U) || (SD_CACHE_SETS == 0U)
+  #error "SD_CACHE_LINES must be a non-zero multiple of SD_CACHE_WAYS"
+#endif
+
+#if ((SD_CACHE_SETS & (SD_CACHE_SETS - 1U)) != 0U)
+  #error "SD_CACHE_LINES / SD_CACHE_WAYS must be a power of two"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 块缓存统计
+ */
+typedef struct {
+    uint32_t Hits;          /*!< 命中块数 */
+    uint32_t Misses;        /*!< 未命中块数 */
+    uint32_t Evictions;     /*!< 被替换出的有效行数 */
+    uint32_t WriteBacks;    /*!< 脏行写回次数（替换与SD_Flush） */
+    uint32_t Bypasses;      /*!< 绕过缓存的大块读写次数 */
+    uint32_t DirtyLines;    /*!< 当前脏行数 */
+} SD_CacheStatsTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 经缓存读取
+ * @param  pData: 数据缓冲区指针（必须4字节对齐）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 连续未命中的块合并为一次多块读取
+ */
+HAL_StatusTypeDef SD_Cache_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 经缓存写入（写回）
+ * @param  pData: 数据缓冲区指针（必须4字节对齐）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 小块写入只更新缓存并标记为脏，替换或SD_Flush()时才写卡
+ */
+HAL_StatusTypeDef SD_Cache_Write(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 按块地址升序写回全部脏行
+ * @param  Timeout: 每次写入的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Cache_Flush(uint32_t Timeout);
+
+/**
+ * @brief 作废指定区间的缓存行（不写回）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ */
+void SD_Cache_Invalidate(uint32_t BlockAdd, uint32_t NumberOfBlocks);
+
+/**
+ * @brief 读取缓存统计
+ * @param  pStats: 统计结构体指针
+ */
+void SD_Cache_GetStats(SD_CacheStatsTypeDef *pStats);
+
+/**
+ * @brief 清零缓存统计（DirtyLines除外）
+ */
+void SD_Cache_ResetStats(void);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_CACHE_H__ */
@@ -0,0 +1,134 @@
+/**
+  ******************************************************************************
+  * @file    sd_calib.h
+  * @brief   SD卡总线时钟自校准
+  * @author  STMicroelectronics
+  * @date    2025-10-29
+  * @version 1.0
+  * @note    在sd.h中定义SD_CALIB_ENABLE为1后可用；从卡当前速度模式允许的最高时钟开始逐级降低分频，
+  *          在暂存区反复写入/读回/比较，选出没有CRC错误的最高时钟并留出余量
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_CALIB_H__
+#define __SD_CALIB_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Calib_Config 时钟校准配置
+ * @{
+ */
+#ifndef SD_CALIB_BLOCKS
+#define SD_CALIB_BLOCKS          8U    /*!< 每轮测试的块数（暂存区大小）；RAM = 3 * SD_CALIB_BLOCKS * 512字节 */
+#endif
+
+#ifndef SD_CALIB_ROUNDS
+#define SD_CALIB_ROUNDS          8U    /*!< 每个分频下的写入/读回轮数，全部通过才算稳定 */
+#endif
+
+#ifndef SD_CALIB_MARGIN_PERCENT
+#define SD_CALIB_MARGIN_PERCENT  10U   /*!< 安全余量：有更快分频失败时，选用不超过最高稳定时钟 * (100 - 余量) / 100 的分频 */
+#endif
+
+#ifndef SD_CALIB_SECTION
+#define SD_CALIB_SECTION               /*!< 测试缓冲所在段，如 __attribute__((section(".RAM_D1")))；
+                                            IDMA不能访问DTCM */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_CALIB_BLOCKS == 0U) || (SD_CALIB_ROUNDS == 0U) || (SD_CALIB_MARGIN_PERCENT >= 100U)
+  #error "SD_CALIB: need BLOCKS > 0, ROUNDS > 0 and MARGIN_PERCENT < 100"
+#endif
+
+#define SD_CALIB_MAGIC           0x53444341U  /*!< "SDCA"，持久化记录标识 */
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 时钟校准结果（可整体保存，下次上电用SD_Calib_Apply()直接套用）
+ */
+typedef struct {
+    uint32_t Magic;          /*!< SD_CALIB_MAGIC */
+    uint32_t KernelClockHz;  /*!< 校准时的SDMMC内核时钟，变化后结果作废 */
+    uint32_t BusSpeedMode;   /*!< 校准时的总线速度模式：SD_BUS_SPEED_xxx */
+    uint32_t MaxStableDiv;   /*!< 全部轮次通过的最快分频 */
+    uint32_t MaxStableHz;    /*!< 对应的SDMMC_CK（Hz） */
+    uint32_t ClockDiv;       /*!< 留出余量后选用的分频 */
+    uint32_t ClockHz;        /*!< 对应的SDMMC_CK（Hz） */
+    uint32_t StepsTried;     /*!< 测试过的分频个数 */
+    uint32_t CrcErrors;      /*!< 过程中出现的CRC错误次数 */
+    uint32_t Checksum;       /*!< 以上各字段的校验 */
+} SD_CalibResultTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 校准并应用最高稳定时钟
+ * @param  ScratchBlock: 暂存区起始块，占SD_CALIB_BLOCKS块，内容在SD_Init时的时钟下备份并还原
+ * @param  pResult: 输出，校准结果
+ * @retval HAL_StatusTypeDef 连SD_Init时的时钟也不能通过时返回HAL_ERROR，并保持该时钟
+ * @note 需在SD_Init()之后调用；暂存区不能与正在使用的数据重叠，缓存/写合并队列中的数据先SD_Flush()
+ * @note 成功后调用SD_Calib_SaveHook()保存结果
+ */
+HAL_StatusTypeDef SD_Calibrate(uint32_t ScratchBlock, SD_CalibResultTypeDef *pResult);
+
+/**
+ * @brief 套用已保存的校准结果
+ * @param  pResult: 校准结果
+ * @retval HAL_StatusTypeDef 记录损坏、内核时钟或速度模式与当前不一致时返回HAL_ERROR，时钟不变
+ */
+HAL_StatusTypeDef SD_Calib_Apply(const SD_CalibResultTypeDef *pResult);
+
+/**
+ * @brief 通过SD_Calib_LoadHook()读取并套用保存的结果
+ * @retval HAL_StatusTypeDef 没有保存的结果或结果无效时返回HAL_ERROR
+ */
+HAL_StatusTypeDef SD_Calib_Restore(void);
+
+/**
+ * @brief 保存校准结果（弱定义，默认不保存）
+ * @param  pResult: 校准结果
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 用户可重新实现，写入内部Flash、备份SRAM或EEPROM
+ */
+HAL_StatusTypeDef SD_Calib_SaveHook(const SD_CalibResultTypeDef *pResult);
+
+/**
+ * @brief 读取保存的校准结果（弱定义，默认返回HAL_ERROR）
+ * @param  pResult: 输出，校准结果
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Calib_LoadHook(SD_CalibResultTypeDef *pResult);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_CALIB_H__ */
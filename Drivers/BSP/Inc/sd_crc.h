@@ -0,0 +1,230 @@
+/**
+  ******************************************************************************
+  * @file    sd_crc.h
+  * @brief   SD卡CRC32计算与逐块完整性校验
+  * @author  STMicroelectronics
+  * @date    2025-11-08
+  * @version 1.0
+  * @note    SD_Crc32()总是可用（软件4路查表，或SD_CRC_USE_HW为1时用STM32H7的CRC外设），日志存储等模块共用。
+  * @note    在sd.h中定义SD_CRC_ENABLE为1后提供完整性校验层：SD_Crc_Attach()指定一段受保护的数据区和存放CRC表的元数据区，
+  *          之后经SD_WriteBlocks()写入的每个块都记下CRC32（以块地址为初值，写错地址也能发现），SD_ReadBlocks()读出时自动校验，
+  *          不一致时返回HAL_ERROR并计入统计。CRC表经一个小的写回缓存访问，SD_Flush()时在数据之后写卡
+  * @note    CRC计算与IDMA传输重叠：写入时在等待IDMA完成的循环中逐块计算；直接读卡时按SD_CRC_CHUNK_BLOCKS分片做双缓冲读取，
+  *          校验已收到的分片的同时IDMA继续接收后面的分片
+  * @note    SD_WriteBlocksDirect()等绕过前门的写入不更新CRC表（SD_WriteBlocksV()除外）；未经本层写过的块（表项为0）不校验
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_CRC_H__
+#define __SD_CRC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Crc_Config CRC配置
+ * @{
+ */
+#ifndef SD_CRC_USE_HW
+#define SD_CRC_USE_HW         0U   /*!< 1: SD_Crc32()用CRC外设（独占，不能在中断中与其他用户共用）；0: 软件查表 */
+#endif
+
+#ifndef SD_CRC_META_LINES
+#define SD_CRC_META_LINES     4U   /*!< CRC表缓存行数，每行一个元数据块（128个块的CRC） */
+#endif
+
+#ifndef SD_CRC_CHUNK_BLOCKS
+#define SD_CRC_CHUNK_BLOCKS   8U   /*!< 流水读取的分片块数；一次读取至少2个分片才走流水 */
+#endif
+
+#ifndef SD_CRC_SECTION
+#define SD_CRC_SECTION               /*!< CRC表缓存所在段，如 __attribute__((section(".RAM_D1")))；
+                                          启用IDMA时不能放在DTCM（IDMA不可访问） */
+#endif
+
+#ifndef SD_CRC_COST
+#define SD_CRC_COST(Bytes)    ((void)0)  /*!< 软件计算Bytes字节CRC时调用，仿真中用于计入CPU时间 */
+#endif
+/**
+ * @}
+ */
+
+#define SD_CRC_PER_BLOCK      128U   /*!< 每个元数据块存放的CRC个数（512/4） */
+
+#if (SD_CRC_META_LINES == 0U)
+  #error "SD_CRC_META_LINES must be greater than 0"
+#endif
+
+#if (SD_CRC_CHUNK_BLOCKS == 0U) || ((128U % SD_CRC_CHUNK_BLOCKS) != 0U)
+  #error "SD_CRC_CHUNK_BLOCKS must divide 128"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 完整性校验统计
+ */
+typedef struct {
+    uint64_t BlocksHashed;     /*!< 写入时计算CRC的块数 */
+    uint64_t BlocksVerified;   /*!< 读出时校验通过的块数 */
+    uint64_t Unrecorded;       /*!< 读出时没有CRC记录、未校验的块数 */
+    uint32_t Mismatches;       /*!< CRC不一致的块数 */
+    uint32_t LastBadBlock;     /*!< 最近一个CRC不一致的块 */
+    uint64_t Overlapped;       /*!< 在IDMA传输期间完成计算或校验的块数 */
+    uint32_t MetaReads;        /*!< 读元数据块的次数 */
+    uint32_t MetaWrites;       /*!< 写元数据块的命令数（相邻的表块一次写入） */
+} SD_CrcStatsTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 计算CRC32（IEEE 802.3，与zlib相同）
+ * @param  Crc: 初值，首次为0；分段计算时传入上一段的结果
+ * @param  pData: 数据，任意对齐
+ * @param  Length: 字节数
+ * @retval uint32_t 累计的CRC
+ */
+uint32_t SD_Crc32(uint32_t Crc, const uint8_t *pData, uint32_t Length);
+
+#if (SD_CRC_ENABLE != 0U)
+
+/**
+ * @brief 元数据区需要的块数
+ * @param  DataBlocks: 受保护的数据块数
+ * @retval uint32_t 1个头块加上每128个数据块1个CRC表块
+ */
+uint32_t SD_Crc_MetaBlocks(uint32_t DataBlocks);
+
+/**
+ * @brief 开始保护一段数据区
+ * @param  DataStart: 数据区起始块
+ * @param  DataBlocks: 数据区块数
+ * @param  MetaStart: 元数据区起始块（SD_Crc_MetaBlocks(DataBlocks)块，不能与数据区重叠）
+ * @param  Format: 1: 清空CRC表（全部记为未记录）；0: 沿用元数据区中已有的表，头块与参数不符时返回HAL_ERROR
+ * @param  Timeout: 每次读写的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Crc_Attach(uint32_t DataStart, uint32_t DataBlocks, uint32_t MetaStart, uint8_t Format,
+                                uint32_t Timeout);
+
+/**
+ * @brief 写回CRC表并停止保护
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Crc_Detach(uint32_t Timeout);
+
+/**
+ * @brief 把CRC表缓存中修改过的行写卡（SD_Flush()调用）
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 调用时数据已经写回；CRC表总是在对应的数据之后写卡，掉电时最多把刚写的块误报为不一致
+ */
+HAL_StatusTypeDef SD_Crc_Flush(uint32_t Timeout);
+
+/**
+ * @brief 打开或关闭CRC计算与IDMA传输的重叠（默认打开，关闭后先传输再计算，用于对比）
+ * @param  Enable: 1打开 0关闭
+ */
+void SD_Crc_SetPipeline(uint8_t Enable);
+
+/**
+ * @brief 读取完整性校验统计
+ * @param  pStats: 统计结构体指针
+ */
+void SD_Crc_GetStats(SD_CrcStatsTypeDef *pStats);
+
+/**
+ * @brief 前门写入开始前登记要计算CRC的块（驱动内部调用）
+ * @param  pData: 写入的数据
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 读入CRC表的超时时间（毫秒）
+ */
+void SD_Crc_BeginWrite(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 前门写入结束后算完剩下的CRC并记入表中（驱动内部调用）
+ * @param  Status: 写入的状态，失败时这些块改为未记录
+ * @param  Timeout: 读写CRC表的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 写入失败时原样返回Status，否则为CRC表的读写状态
+ */
+HAL_StatusTypeDef SD_Crc_EndWrite(HAL_StatusTypeDef Status, uint32_t Timeout);
+
+/**
+ * @brief 等待IDMA传输期间计算一个登记块的CRC（驱动内部调用）
+ */
+void SD_Crc_Poll(void);
+
+/**
+ * @brief 直接读卡并校验，满足条件时与IDMA传输重叠（驱动内部调用，代替SD_ReadBlocksDirect()）
+ * @param  pData: 数据缓冲区
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef CRC不一致时返回HAL_ERROR
+ * @note 整段在保护区内、缓冲区32字节对齐且IDMA可访问时，按CRC表块分段、每段按SD_CRC_CHUNK_BLOCKS分片双缓冲读取
+ */
+HAL_StatusTypeDef SD_Crc_ReadDirect(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 校验已读出的块（驱动内部调用）
+ * @param  Status: 读取的状态，失败时不校验
+ * @param  pData: 读出的数据
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 读入CRC表的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef CRC不一致时返回HAL_ERROR
+ */
+HAL_StatusTypeDef SD_Crc_Verify(HAL_StatusTypeDef Status, const uint8_t *pData, uint32_t BlockAdd,
+                                uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 按已写入卡的数据记下一段块的CRC（驱动内部调用，供SD_WriteBlocksV()等不经SD_WriteBlocks()的写入使用）
+ * @param  pData: 写入的数据
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 读写CRC表的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Crc_Record(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 把被擦除或丢弃的块改为未记录（驱动内部调用）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 读写CRC表的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Crc_Forget(uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+#endif /* SD_CRC_ENABLE */
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_CRC_H__ */
@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    sd_discard.h
+  * @brief   SD卡丢弃（TRIM）区间记录与批量后台擦除
+  * @author  STMicroelectronics
+  * @date    2025-11-06
+  * @version 1.0
+  * @note    在sd.h中定义SD_DISCARD_ENABLE为1后可用。SD_Discard()只把不再需要的块区间记入按地址排序的区间表，
+  *          相邻、重叠的区间合并；空闲时SD_Discard_Idle()取区间内按擦除单元对齐的最大一段发一条擦除命令，
+  *          卡在后台擦除。之后写入已擦除的块不必先擦除，顺序写入更快
+  * @note    驱动的所有写入路径（SD_WriteBlocks()、SD_WriteBlocksDirect()、IDMA异步/双缓冲写入）和SD_EraseBlocks()
+  *          都会先从区间表中去掉被写入的块，丢弃之后又写入的数据不会被擦除
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_DISCARD_H__
+#define __SD_DISCARD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Discard_Config 丢弃配置
+ * @{
+ */
+#ifndef SD_DISCARD_MAX_EXTENTS
+#define SD_DISCARD_MAX_EXTENTS   32U   /*!< 区间表容量；满时SD_Discard()先擦除最大的区间腾出位置 */
+#endif
+
+#ifndef SD_DISCARD_ALIGN_BLOCKS
+#define SD_DISCARD_ALIGN_BLOCKS  0U    /*!< 空闲擦除的对齐单元（块）；0取卡的AU大小，AU未知时为8192（4MB） */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_DISCARD_MAX_EXTENTS < 2U)
+  #error "SD_DISCARD_MAX_EXTENTS must be at least 2"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 丢弃统计
+ */
+typedef struct {
+    uint32_t Discards;       /*!< SD_Discard()调用次数 */
+    uint64_t DiscardBlocks;  /*!< 丢弃的块数（重叠部分重复计） */
+    uint32_t Merges;         /*!< 与已有区间合并的次数 */
+    uint32_t Erases;         /*!< 发出的擦除命令数 */
+    uint64_t ErasedBlocks;   /*!< 擦除的块数 */
+    uint32_t Forced;         /*!< 区间表满或SD_Discard_Flush()时不按对齐擦除的次数 */
+    uint64_t Rewritten;      /*!< 擦除前又被写入（或被SD_EraseBlocks()直接擦除）、从区间表中去掉的块数 */
+    uint64_t Dropped;        /*!< 区间表满、拆分或擦除失败放回时放弃记录的块数（这些块不会被擦除） */
+    uint32_t Extents;        /*!< 当前区间数 */
+    uint64_t PendingBlocks;  /*!< 当前待擦除的块数 */
+} SD_DiscardStatsTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 丢弃块区间：记录下来，之后批量擦除
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 区间表满、需要立即擦除时的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 参数错误返回HAL_ERROR
+ * @note 块缓存、写合并队列和预取缓冲中这些块的数据立即作废；擦除前读取得到旧数据或0，内容不确定
+ */
+HAL_StatusTypeDef SD_Discard(uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 空闲时调用：擦除一段对齐的待擦除区间
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval uint8_t 1: 发出了擦除命令；0: 卡忙或没有满一个对齐单元的区间
+ * @note 只在卡处于传输状态时发命令，不等待之前的编程或擦除结束；擦除命令发出后立即返回
+ */
+uint8_t SD_Discard_Idle(uint32_t Timeout);
+
+/**
+ * @brief 立即擦除全部待擦除区间（不按对齐）
+ * @param  Timeout: 每条擦除命令的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 在开始大量顺序写入（如录像、日志）之前调用
+ */
+HAL_StatusTypeDef SD_Discard_Flush(uint32_t Timeout);
+
+/**
+ * @brief 从区间表中去掉将被写入或已擦除的块（驱动内部调用）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @note 可在中断中调用
+ */
+void SD_Discard_Forget(uint32_t BlockAdd, uint32_t NumberOfBlocks);
+
+/**
+ * @brief 读取丢弃统计
+ * @param  pStats: 统计结构体指针
+ */
+void SD_Discard_GetStats(SD_DiscardStatsTypeDef *pStats);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_DISCARD_H__ */
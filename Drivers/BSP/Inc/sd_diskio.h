@@ -0,0 +1,121 @@
+/**
+  ******************************************************************************
+  * @file    sd_diskio.h
+  * @brief   FatFs底层接口（diskio）
+  * @author  STMicroelectronics
+  * @date    2025-11-05
+  * @version 1.0
+  * @note    在sd.h中定义SD_DISKIO_ENABLE为1后可用，工程中须有FatFs（ff.h、diskio.h）。
+  *          多扇区请求原样交给SD_ReadBlocks()/SD_WriteBlocks()，只发一条CMD18/CMD25；缓冲区满足IDMA要求时不复制，
+  *          FatFs窗口缓冲区等未对齐的缓冲区由驱动的跳板缓冲区中转，这里不再经512字节缓冲区逐扇区复制
+  * @note    CTRL_SYNC写回块缓存/写合并队列并等待卡编程完成，CTRL_TRIM擦除对应块（使能SD_DISCARD_ENABLE时记入丢弃区间表、
+  *          空闲时批量擦除），GET_BLOCK_SIZE报告AU大小
+  * @note    使能SD_SCHED_ENABLE时所有访问经调度器提交，与其他任务的请求一起排序
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_DISKIO_H__
+#define __SD_DISKIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+#include "ff.h"
+#include "diskio.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_DiskIo_Config diskio配置
+ * @{
+ */
+#ifndef SD_DISKIO_PDRV
+#define SD_DISKIO_PDRV      0U               /*!< SD卡对应的FatFs物理驱动器号 */
+#endif
+
+#ifndef SD_DISKIO_GLUE
+#define SD_DISKIO_GLUE      1U               /*!< 1: 本模块定义disk_xxx()；0: 只提供SD_DiskIo_xxx()，由工程自己的diskio.c按驱动器号分发 */
+#endif
+
+#ifndef SD_DISKIO_TIMEOUT
+#define SD_DISKIO_TIMEOUT   SD_TIMEOUT_LONG  /*!< 每次读写、擦除、刷新的超时时间（毫秒） */
+#endif
+
+#ifndef SD_DISKIO_PRIORITY
+#define SD_DISKIO_PRIORITY  1U               /*!< 使能SD_SCHED_ENABLE时请求的优先级（SD_SCHED_PRIO_NORMAL） */
+#endif
+/**
+ * @}
+ */
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 初始化（disk_initialize）
+ * @param  pdrv: 物理驱动器号
+ * @retval DSTATUS 驱动器状态
+ * @note 第一次调用时执行SD_Init()，之后只返回状态；应用已调用过SD_Init()时再调用一次也没有问题
+ */
+DSTATUS SD_DiskIo_Initialize(BYTE pdrv);
+
+/**
+ * @brief 驱动器状态（disk_status）
+ * @param  pdrv: 物理驱动器号
+ * @retval DSTATUS 未初始化时为STA_NOINIT
+ */
+DSTATUS SD_DiskIo_Status(BYTE pdrv);
+
+/**
+ * @brief 读扇区（disk_read）
+ * @param  pdrv: 物理驱动器号
+ * @param  buff: 数据缓冲区
+ * @param  sector: 起始扇区
+ * @param  count: 扇区数
+ * @retval DRESULT 超出卡容量返回RES_PARERR
+ */
+DRESULT SD_DiskIo_Read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count);
+
+/**
+ * @brief 写扇区（disk_write）
+ * @param  pdrv: 物理驱动器号
+ * @param  buff: 数据缓冲区
+ * @param  sector: 起始扇区
+ * @param  count: 扇区数
+ * @retval DRESULT 超出卡容量返回RES_PARERR
+ * @note 使能块缓存或写合并队列时返回后数据可能还在驱动中，FatFs在f_sync()/f_close()时发CTRL_SYNC
+ */
+DRESULT SD_DiskIo_Write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count);
+
+/**
+ * @brief 控制命令（disk_ioctl）
+ * @param  pdrv: 物理驱动器号
+ * @param  cmd: CTRL_SYNC / GET_SECTOR_COUNT / GET_SECTOR_SIZE / GET_BLOCK_SIZE / CTRL_TRIM
+ * @param  buff: 命令参数
+ * @retval DRESULT 不支持的命令返回RES_PARERR
+ * @note GET_BLOCK_SIZE返回AU块数（f_mkfs()按它对齐数据区），AU未知时返回1
+ */
+DRESULT SD_DiskIo_Ioctl(BYTE pdrv, BYTE cmd, void *buff);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_DISKIO_H__ */
@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file    sd_iovec.h
+  * @brief   SD卡分散/聚集（iovec）读写
+  * @author  STMicroelectronics
+  * @date    2025-11-03
+  * @version 1.0
+  * @note    把若干个(指针, 长度)段当作一段连续数据写入/读出连续的块区间，只发一次CMD25/CMD18：
+  *          IDMA双缓冲模式下每传完一个分片，在中断中把IDMABASE0/IDMABASE1改指向下一个分片，
+  *          段边界都落在块边界上时不复制数据；跨块边界或对齐不满足的块经两个单块暂存槽中转
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_IOVEC_H__
+#define __SD_IOVEC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_IoVec_Config 分散/聚集配置
+ * @{
+ */
+#ifndef SD_IOVEC_MAX_CHUNK_BLOCKS
+#define SD_IOVEC_MAX_CHUNK_BLOCKS  15U  /*!< 分片块数上限：IDMABSIZE.IDMABNDT为8位、以32字节计，一个缓冲区最多8160字节 */
+#endif
+/**
+ * @}
+ */
+
+#if ((SD_IOVEC_MAX_CHUNK_BLOCKS == 0U) || (SD_IOVEC_MAX_CHUNK_BLOCKS > 15U))
+  #error "SD_IOVEC_MAX_CHUNK_BLOCKS must be 1..15"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 数据段
+ */
+typedef struct {
+    uint8_t  *pBuf;          /*!< 段起始地址，Length为0时可为NULL */
+    uint32_t  Length;        /*!< 段字节数 */
+} SD_IoVecTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 把各段依次拼接后写入连续的块区间（直接写卡，不经过块缓存和写合并队列）
+ * @param  pVec: 段数组
+ * @param  VecCount: 段数
+ * @param  BlockAdd: 起始块地址
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态；总长度不是512的整数倍或超过SD_DOUBLEBUF_MAX_BLOCKS块时返回HAL_ERROR
+ * @note 每段长度都是512的整数倍、32字节对齐（D-Cache行，双缓冲接口的要求）且IDMA可访问时零复制：分片大小取各段块数的最大公约数
+ *       （不超过SD_IOVEC_MAX_CHUNK_BLOCKS）；否则按单块分片，不能直接传输的块在中断中拼入暂存槽
+ * @note 只有一个非空段、分片不足两个或SD_USE_IDMA为0时，按段拆成多次SD_WriteBlocksDirect()
+ * @note 中断响应必须快于一个分片的传输时间（50MHz 4线下每块约20us），否则IDMA会重复发送旧的分片
+ * @note 区间内的缓存行、写合并队列中的块与预取的数据直接作废，CRC层使能时按写入的数据更新CRC表
+ */
+HAL_StatusTypeDef SD_WriteBlocksV(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd, uint32_t Timeout);
+
+/**
+ * @brief 读取连续的块区间，依次分散到各段（直接读卡，不经过块缓存）
+ * @param  pVec: 段数组
+ * @param  VecCount: 段数
+ * @param  BlockAdd: 起始块地址
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态；总长度不是512的整数倍或超过SD_DOUBLEBUF_MAX_BLOCKS块时返回HAL_ERROR
+ * @note 零复制条件同SD_WriteBlocksV()；传输期间不得访问各段
+ * @note 先写回块缓存和写合并队列中未写卡的数据；CRC层使能时读出后校验，不一致返回HAL_ERROR
+ */
+HAL_StatusTypeDef SD_ReadBlocksV(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd, uint32_t Timeout);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_IOVEC_H__ */
@@ -0,0 +1,174 @@
+/**
+  ******************************************************************************
+  * @file    sd_log.h
+  * @brief   SD卡掉电安全的日志结构追加存储
+  * @author  STMicroelectronics
+  * @date    2025-11-07
+  * @version 1.0
+  * @note    在sd.h中定义SD_LOG_ENABLE为1后可用。不经文件系统，直接在一段块区域上追加记录：
+  *          区域按段（默认一个AU）循环使用，第一段存放超级块；记录先攒在批缓冲区中，攒满后整批一次写卡，
+  *          每批开头是带段序号、批位置和CRC32的批头，段内第一批的批头即段头
+  * @note    掉电后SD_Log_Open()恢复写入位置：按段头序号二分查找最新的段（读log2(段数)个块），
+  *          再沿批头链找到段内最后一批（每批读一个块），只校验最后一批的数据CRC，不必读全卡
+  * @note    区域由本模块独占；SD_Log_Sync()返回后此前追加的记录已落盘，之后未同步的记录掉电时丢失
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_LOG_H__
+#define __SD_LOG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Log_Config 日志存储配置
+ * @{
+ */
+#ifndef SD_LOG_SEG_BLOCKS
+#define SD_LOG_SEG_BLOCKS     0U      /*!< 段块数；0取卡的AU大小，AU未知时为8192（4MB） */
+#endif
+
+#ifndef SD_LOG_RU_BLOCKS
+#define SD_LOG_RU_BLOCKS      32U     /*!< 记录单元（RU）块数；批大小为其整数倍，SD_Log_Sync()补齐到RU边界 */
+#endif
+
+#ifndef SD_LOG_PAD_BYTE
+#define SD_LOG_PAD_BYTE       0xFFU   /*!< 批内未用部分的填充字节 */
+#endif
+/**
+ * @}
+ */
+
+#define SD_LOG_HEADER_SIZE    40U     /*!< 批头字节数，批缓冲区的前40字节 */
+#define SD_LOG_RECORD_HEADER  2U      /*!< 每条记录前的长度字段字节数（小端） */
+
+#if (SD_LOG_RU_BLOCKS == 0U)
+  #error "SD_LOG_RU_BLOCKS must be greater than 0"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 读取记录的回调
+ * @param  RecordSeq: 记录序号（从格式化起连续编号）
+ * @param  pData: 记录内容，只在回调期间有效
+ * @param  Length: 记录字节数
+ * @param  pContext: SD_Log_Walk()的pContext参数
+ */
+typedef void (*SD_LogCallbackTypeDef)(uint32_t RecordSeq, const uint8_t *pData, uint32_t Length, void *pContext);
+
+/**
+ * @brief 日志存储对象
+ * @note 段i位于 BaseBlock + i * SegBlocks，区域的第一段（BaseBlock之前）存放超级块
+ */
+typedef struct {
+    uint8_t  *pBuf;          /*!< 批缓冲区（UnitBlocks块） */
+    uint32_t  UnitBlocks;    /*!< 满批块数：RU的整数倍，且整除段 */
+    uint32_t  SegBlocks;     /*!< 段块数 */
+    uint32_t  SegCount;      /*!< 段数（不含超级块所在的段） */
+    uint32_t  BaseBlock;     /*!< 段0的起始块 */
+    uint32_t  LogId;         /*!< 格式化编号，区分上一次格式化留下的段 */
+    uint32_t  Tail;          /*!< 最旧的段 */
+    uint32_t  Seg;           /*!< 当前写入的段 */
+    uint32_t  SegSeq;        /*!< 当前段的序号 */
+    uint32_t  Offset;        /*!< 当前批在段内的块偏移 */
+    uint32_t  BatchBlocks;   /*!< 当前批可用的块数（段尾可能不足一个满批） */
+    uint32_t  Fill;          /*!< 当前批已用的字节数（含批头） */
+    uint32_t  Records;       /*!< 当前批中的记录数 */
+    uint32_t  NextRecord;    /*!< 下一条记录的序号 */
+    uint32_t  Batches;       /*!< 写卡的批数 */
+    uint32_t  PadBlocks;     /*!< SD_Log_Sync()和段尾填充的块数 */
+    uint32_t  RecoverReads;  /*!< 最近一次SD_Log_Open()读取的块数 */
+} SD_LogTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 格式化区域并打开一个空日志
+ * @param  pLog: 日志对象
+ * @param  pBuf: 批缓冲区（32字节对齐，位于IDMA可访问的RAM）
+ * @param  BufBlocks: 缓冲区块数，不少于SD_LOG_RU_BLOCKS
+ * @param  RegionStart: 区域起始块，向上对齐到段
+ * @param  RegionBlocks: 区域块数，对齐后至少放得下超级块段和2个段
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 只改写超级块（格式化编号加1），不擦除区域；旧的段因编号不同而作废
+ */
+HAL_StatusTypeDef SD_Log_Format(SD_LogTypeDef *pLog, uint8_t *pBuf, uint32_t BufBlocks,
+                                uint32_t RegionStart, uint32_t RegionBlocks, uint32_t Timeout);
+
+/**
+ * @brief 打开已格式化的区域，恢复写入位置
+ * @param  pLog: 日志对象
+ * @param  pBuf: 批缓冲区
+ * @param  BufBlocks: 缓冲区块数
+ * @param  RegionStart: 区域起始块（与格式化时相同）
+ * @param  RegionBlocks: 区域块数（与格式化时相同）
+ * @param  Timeout: 每次读卡的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 没有有效的超级块或布局不一致时返回HAL_ERROR
+ * @note 掉电时正在写的批（数据CRC错误）被丢弃，之后从它的位置继续写入
+ */
+HAL_StatusTypeDef SD_Log_Open(SD_LogTypeDef *pLog, uint8_t *pBuf, uint32_t BufBlocks,
+                              uint32_t RegionStart, uint32_t RegionBlocks, uint32_t Timeout);
+
+/**
+ * @brief 追加一条记录，当前批放不下时先把它整批写卡
+ * @param  pLog: 日志对象
+ * @param  pData: 记录内容
+ * @param  Length: 字节数，1 ~ UnitBlocks*512-42
+ * @param  Timeout: 写卡超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 区域写满后覆盖最旧的段
+ */
+HAL_StatusTypeDef SD_Log_Append(SD_LogTypeDef *pLog, const uint8_t *pData, uint32_t Length, uint32_t Timeout);
+
+/**
+ * @brief 把当前批补齐到RU边界后写卡，并等卡编程完成
+ * @param  pLog: 日志对象
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 下一批从下一个RU开始；频繁同步会浪费空间，数据记录仪可按时间或数据量周期调用
+ */
+HAL_StatusTypeDef SD_Log_Sync(SD_LogTypeDef *pLog, uint32_t Timeout);
+
+/**
+ * @brief 从最旧的记录起按顺序读出已写卡的全部记录
+ * @param  pLog: 日志对象
+ * @param  pBuf: 读缓冲区（32字节对齐），不少于UnitBlocks块，不能是日志对象自己的批缓冲区
+ * @param  Callback: 每条记录调用一次
+ * @param  pContext: 传给回调的参数
+ * @param  Timeout: 每次读卡的超时时间（毫秒）
+ * @retval uint32_t 读出的记录数
+ * @note 数据CRC错误的批被跳过；尚在批缓冲区中的记录不读出
+ */
+uint32_t SD_Log_Walk(const SD_LogTypeDef *pLog, uint8_t *pBuf, SD_LogCallbackTypeDef Callback, void *pContext,
+                     uint32_t Timeout);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_LOG_H__ */
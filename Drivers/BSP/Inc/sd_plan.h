@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    sd_plan.h
+  * @brief   SD卡AU对齐写入规划
+  * @author  STMicroelectronics
+  * @date    2025-10-30
+  * @version 1.0
+  * @note    在sd.h中定义SD_PLAN_ENABLE为1后可用；日志等流式数据先攒满一个写入单元（RU的整数倍）再写卡，
+  *          区域起点对齐到AU，每次写卡都从RU边界开始、在RU边界结束，卡不必补齐不完整的RU或整理AU
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_PLAN_H__
+#define __SD_PLAN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Plan_Config AU对齐写入规划配置
+ * @{
+ */
+#ifndef SD_PLAN_RU_BLOCKS
+#define SD_PLAN_RU_BLOCKS     32U     /*!< 记录单元（RU）块数，Speed Class按16KB的整数倍计量 */
+#endif
+
+#ifndef SD_PLAN_PAD_BYTE
+#define SD_PLAN_PAD_BYTE      0xFFU   /*!< SD_Plan_Sync()补齐RU时的填充字节 */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_PLAN_RU_BLOCKS == 0U)
+  #error "SD_PLAN_RU_BLOCKS must be greater than 0"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 写入规划对象
+ * @note 区域 [StartBlock, EndBlock) 由规划器独占
+ */
+typedef struct {
+    uint8_t  *pBuf;          /*!< 单元缓冲区（UnitBlocks块） */
+    uint32_t  UnitBlocks;    /*!< 每次写卡的块数：RU的整数倍，且整除AU */
+    uint32_t  AuBlocks;      /*!< 卡的AU块数，0表示未知（只按RU对齐） */
+    uint32_t  StartBlock;    /*!< 对齐后的区域起始块 */
+    uint32_t  EndBlock;      /*!< 区域结束块（不含） */
+    uint32_t  NextBlock;     /*!< 下一次写卡的块地址，总在RU边界 */
+    uint32_t  Fill;          /*!< 缓冲区中尚未写卡的字节数 */
+    uint32_t  Units;         /*!< 写卡次数 */
+    uint32_t  PadBlocks;     /*!< SD_Plan_Sync()填充的块数 */
+    uint32_t  Accepted;      /*!< 最近一次SD_Plan_Write()接收（写卡或留在缓冲区）的字节数 */
+} SD_PlanTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 在区域内打开一个写入规划
+ * @param  pPlan: 规划对象
+ * @param  pBuf: 单元缓冲区（32字节对齐，位于IDMA可访问的RAM）
+ * @param  BufBlocks: 缓冲区块数，不少于SD_PLAN_RU_BLOCKS
+ * @param  RegionStart: 区域起始块，向上对齐到AU（放不下一个单元时对齐到RU）
+ * @param  RegionBlocks: 区域块数
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 需在SD_Init()之后调用，AU大小取自SD_GetCardInfo()
+ */
+HAL_StatusTypeDef SD_Plan_Open(SD_PlanTypeDef *pPlan, uint8_t *pBuf, uint32_t BufBlocks,
+                               uint32_t RegionStart, uint32_t RegionBlocks);
+
+/**
+ * @brief 追加数据，攒满一个单元即写卡
+ * @param  pPlan: 规划对象
+ * @param  pData: 数据
+ * @param  Length: 字节数，不要求块对齐
+ * @param  Timeout: 每次写卡的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 区域写满时返回HAL_ERROR：前pPlan->Accepted字节已接收（最后一个单元留在缓冲区），
+ *         其余未接收
+ * @note 每次写卡写到下一个单元边界（按区域起点计），SD_Plan_Sync()之后的第一次写卡比单元短
+ */
+HAL_StatusTypeDef SD_Plan_Write(SD_PlanTypeDef *pPlan, const uint8_t *pData, uint32_t Length, uint32_t Timeout);
+
+/**
+ * @brief 把缓冲区中的数据补齐到RU边界后写卡
+ * @param  pPlan: 规划对象
+ * @param  Timeout: 写卡超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 填充SD_PLAN_PAD_BYTE，之后的数据从下一个RU开始；用空间换下一次写卡不必补齐RU。
+ *       补齐后不一定在单元边界，下一次写卡只写到单元边界，单元仍不跨AU
+ */
+HAL_StatusTypeDef SD_Plan_Sync(SD_PlanTypeDef *pPlan, uint32_t Timeout);
+
+/**
+ * @brief 区域中已写卡的块数（含填充）
+ * @param  pPlan: 规划对象
+ * @retval uint32_t 块数
+ */
+uint32_t SD_Plan_GetWrittenBlocks(const SD_PlanTypeDef *pPlan);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_PLAN_H__ */
@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file    sd_prefetch.h
+  * @brief   SD卡顺序读预取（read-ahead）
+  * @author  STMicroelectronics
+  * @date    2025-10-26
+  * @version 1.0
+  * @note    在sd.h中定义SD_PREFETCH_ENABLE为1后，SD_ReadBlocks自动经过本预取器
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_PREFETCH_H__
+#define __SD_PREFETCH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Prefetch_Config 预取配置
+ * @{
+ */
+#ifndef SD_PREFETCH_STREAMS
+#define SD_PREFETCH_STREAMS       2U    /*!< 同时跟踪的顺序读流数 */
+#endif
+
+#ifndef SD_PREFETCH_MAX_BLOCKS
+#define SD_PREFETCH_MAX_BLOCKS    32U   /*!< 每个流的预取缓冲块数（窗口上限）；
+                                             RAM预算 = SD_PREFETCH_STREAMS * SD_PREFETCH_MAX_BLOCKS * 512 */
+#endif
+
+#ifndef SD_PREFETCH_MIN_BLOCKS
+#define SD_PREFETCH_MIN_BLOCKS    4U    /*!< 预取窗口下限（块） */
+#endif
+
+#ifndef SD_PREFETCH_TRIGGER
+#define SD_PREFETCH_TRIGGER       2U    /*!< 连续多少次顺序访问后开始预取 */
+#endif
+
+#ifndef SD_PREFETCH_SECTION
+#define SD_PREFETCH_SECTION             /*!< 预取缓冲所在段，如 __attribute__((section(".RAM_D1")))；
+                                             IDMA不能访问DTCM */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_PREFETCH_STREAMS == 0U) || (SD_PREFETCH_MIN_BLOCKS == 0U) || (SD_PREFETCH_MIN_BLOCKS > SD_PREFETCH_MAX_BLOCKS)
+  #error "SD_PREFETCH: need STREAMS > 0 and 0 < MIN_BLOCKS <= MAX_BLOCKS"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 预取统计
+ */
+typedef struct {
+    uint32_t Hits;          /*!< 从预取缓冲直接返回的块数 */
+    uint32_t Misses;        /*!< 需要读卡的块数 */
+    uint32_t Prefetched;    /*!< 后台预取读入的块数 */
+    uint32_t Wasted;        /*!< 预取后未被使用就丢弃的块数 */
+    uint32_t Waits;         /*!< 请求到达时预取仍在传输、需要等待的次数 */
+    uint32_t Bypasses;      /*!< 不少于SD_PREFETCH_MAX_BLOCKS块、直接读卡的次数 */
+} SD_PrefetchStatsTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 经预取器读取
+ * @param  pData: 数据缓冲区指针（必须4字节对齐）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 检测到顺序访问后，在返回前用IDMA在后台读入下一个窗口，后续的小块读取直接从缓冲区返回；
+ *       窗口全部被用完时加倍，流中断导致预取浪费时减半
+ */
+HAL_StatusTypeDef SD_Prefetch_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 作废与指定区间重叠的预取数据
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @note 不等待：正在传输的预取在完成时被丢弃；可在中断上下文调用
+ */
+void SD_Prefetch_Invalidate(uint32_t BlockAdd, uint32_t NumberOfBlocks);
+
+/**
+ * @brief 等待后台预取传输结束
+ * @param  Timeout: 超时时间（毫秒）
+ * @note 直接访问卡之前调用，保证控制器空闲
+ */
+void SD_Prefetch_Quiesce(uint32_t Timeout);
+
+/**
+ * @brief 读取预取统计
+ * @param  pStats: 统计结构体指针
+ */
+void SD_Prefetch_GetStats(SD_PrefetchStatsTypeDef *pStats);
+
+/**
+ * @brief 清零预取统计
+ */
+void SD_Prefetch_ResetStats(void);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_PREFETCH_H__ */
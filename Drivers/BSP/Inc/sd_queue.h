@@ -0,0 +1,150 @@
+/**
+  ******************************************************************************
+  * @file    sd_queue.h
+  * @brief   SD卡写合并队列
+  * @author  STMicroelectronics
+  * @date    2025-10-27
+  * @version 1.0
+  * @note    在sd.h中定义SD_QUEUE_ENABLE为1后，SD_WriteBlocks的小块写入先进入本队列，
+  *          刷新时按块地址排序，相邻块合并为尽可能长的CMD25
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_QUEUE_H__
+#define __SD_QUEUE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Queue_Config 写合并队列配置
+ * @{
+ */
+#ifndef SD_QUEUE_BLOCKS
+#define SD_QUEUE_BLOCKS         64U   /*!< 暂存区块数（RAM = SD_QUEUE_BLOCKS * 512字节） */
+#endif
+
+#ifndef SD_QUEUE_BYPASS_BLOCKS
+#define SD_QUEUE_BYPASS_BLOCKS  32U   /*!< 不少于该块数的写入直接写卡 */
+#endif
+
+#ifndef SD_QUEUE_DEADLINE_MS
+#define SD_QUEUE_DEADLINE_MS    50U   /*!< 最早一块在队列中停留的最长时间（毫秒），到期后自动刷新 */
+#endif
+
+#ifndef SD_QUEUE_SECTION
+#define SD_QUEUE_SECTION              /*!< 暂存区所在段，如 __attribute__((section(".RAM_D1")))；
+                                           IDMA不能访问DTCM */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_QUEUE_BLOCKS == 0U) || (SD_QUEUE_BLOCKS > 65535U)
+  #error "SD_QUEUE_BLOCKS must be in [1, 65535]"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 写合并队列统计
+ * @note 合并比 = SubmittedWrites / Transfers，平均传输大小 = TransferBlocks / Transfers
+ */
+typedef struct {
+    uint32_t SubmittedWrites;   /*!< 进入队列的写请求数 */
+    uint32_t SubmittedBlocks;   /*!< 进入队列的块数 */
+    uint32_t Overwrites;        /*!< 在队列中被新数据覆盖的块数（未写卡） */
+    uint32_t Transfers;         /*!< 刷新时发出的多块写命令数 */
+    uint32_t TransferBlocks;    /*!< 刷新时写入卡的块数 */
+    uint32_t Bypasses;          /*!< 大块直接写卡次数 */
+    uint32_t FullFlushes;       /*!< 暂存区满触发的刷新次数 */
+    uint32_t DeadlineFlushes;   /*!< 超过SD_QUEUE_DEADLINE_MS触发的刷新次数 */
+    uint32_t SyncFlushes;       /*!< SD_Queue_Sync()/SD_Flush()触发的刷新次数 */
+    uint32_t PendingBlocks;     /*!< 当前队列中的块数 */
+} SD_QueueStatsTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 经写合并队列写入
+ * @param  pData: 数据缓冲区指针（返回后即可复用）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 小块写入复制到暂存区后立即返回；暂存区放不下时先刷新整个队列再入队，刷新失败则本次写入的块都不入队，
+ *       队列中原有未写卡的块保留；最早一块超过期限时入队后刷新，失败时本次写入的块已在队列中
+ */
+HAL_StatusTypeDef SD_Queue_Write(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 读取并叠加队列中尚未写卡的数据
+ * @param  pData: 数据缓冲区指针（必须4字节对齐）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Queue_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 立即刷新队列
+ * @param  Timeout: 每次写入的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态；失败时未写入的块保留在队列中
+ */
+HAL_StatusTypeDef SD_Queue_Sync(uint32_t Timeout);
+
+/**
+ * @brief 期限检查，应用空闲时周期调用
+ * @param  Timeout: 每次写入的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 最早一块停留超过SD_QUEUE_DEADLINE_MS时刷新队列，否则立即返回
+ */
+HAL_StatusTypeDef SD_Queue_Poll(uint32_t Timeout);
+
+/**
+ * @brief 丢弃队列中指定区间的块（不写卡）
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ */
+void SD_Queue_Discard(uint32_t BlockAdd, uint32_t NumberOfBlocks);
+
+/**
+ * @brief 读取队列统计
+ * @param  pStats: 统计结构体指针
+ */
+void SD_Queue_GetStats(SD_QueueStatsTypeDef *pStats);
+
+/**
+ * @brief 清零队列统计（PendingBlocks除外）
+ */
+void SD_Queue_ResetStats(void);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_QUEUE_H__ */
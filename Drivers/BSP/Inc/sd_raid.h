@@ -0,0 +1,192 @@
+/**
+  ******************************************************************************
+  * @file    sd_raid.h
+  * @brief   双卡条带（RAID-0）与镜像（RAID-1）
+  * @author  STMicroelectronics
+  * @date    2025-11-12
+  * @version 1.0
+  * @note    在sd.h中定义SD_RAID_ENABLE为1后可用。把两个实例（如sddev1与SDMMC2上的实例）上相同位置的一段块区域
+  *          当作一个块设备，以与SD_ReadBlocks()/SD_WriteBlocks()相同的方式读写：
+  *          - 条带：虚拟块按ChunkBlocks块的分片轮流放在两张卡上，一次读写跨越的分片拆给两张卡，
+  *            两个实例各自提交IDMA异步请求，同时传输；
+  *          - 镜像：写入时两张卡同时写入整段；读取时按分片拆开，哪张卡先空闲（不在传输、不在编程忙）就交给哪张卡
+  * @note    分片取AU大小或其约数/倍数，区域起点按分片（分片大于AU时按AU）对齐，分片不会跨越AU边界
+  * @note    直接访问卡，不经过sddev1的块缓存、写合并队列与CRC层；成员区域不应再经SD_WriteBlocks()写入
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_RAID_H__
+#define __SD_RAID_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Raid_Config 条带/镜像配置
+ * @{
+ */
+#ifndef SD_RAID_POLL_US
+#define SD_RAID_POLL_US        64U     /*!< 两张卡都在传输或编程忙时，两次查询之间调用SD_WaitYield()的时间（微秒）；
+                                            卡忙时每次查询都要发CMD13，不宜太短 */
+#endif
+/**
+ * @}
+ */
+
+#define SD_RAID_MEMBERS        2U      /*!< 成员卡数 */
+
+/**
+ * @defgroup SD_Raid_Mode 组织方式
+ * @{
+ */
+#define SD_RAID_MODE_STRIPE    0U      /*!< RAID-0：容量与吞吐量为两张卡之和，任一张卡损坏则数据全部不可用 */
+#define SD_RAID_MODE_MIRROR    1U      /*!< RAID-1：两张卡内容相同，容量为一张卡，读取可两张卡分担 */
+/**
+ * @}
+ */
+
+#if (SD_RAID_ENABLE != 0U) && (SD_MAX_DEVICES < SD_RAID_MEMBERS)
+  #error "SD_RAID_ENABLE needs SD_MAX_DEVICES >= 2"
+#endif
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 条带/镜像配置
+ */
+typedef struct {
+    SD_DeviceTypeDef *pDev[SD_RAID_MEMBERS]; /*!< 成员实例，须已用SD_Init()/SD_Dev_Init()初始化，不能相同 */
+    uint32_t Mode;             /*!< SD_RAID_MODE_xxx */
+    uint32_t ChunkBlocks;      /*!< 分片块数；0取卡的AU大小（AU未知时为8192，即4MB） */
+    uint32_t StartBlock;       /*!< 成员区域在每张卡上的起始块 */
+    uint32_t RegionBlocks;     /*!< 成员区域块数；0表示到较小的卡的末尾 */
+} SD_RaidConfigTypeDef;
+
+/**
+ * @brief 条带/镜像统计
+ */
+typedef struct {
+    uint32_t Reads;                        /*!< SD_Raid_ReadBlocks()调用次数 */
+    uint32_t Writes;                       /*!< SD_Raid_WriteBlocks()调用次数 */
+    uint32_t Errors;                       /*!< 返回非HAL_OK的次数 */
+    uint32_t Commands[SD_RAID_MEMBERS];    /*!< 各成员上的读写命令数 */
+    uint64_t Blocks[SD_RAID_MEMBERS];      /*!< 各成员传输的块数 */
+    uint32_t BusyRetries;                  /*!< 提交时成员卡还在编程忙、下一轮再试的次数 */
+    uint32_t Bounced;                      /*!< 缓冲区不满足IDMA要求、逐段同步读写的调用次数 */
+} SD_RaidStatsTypeDef;
+
+/**
+ * @brief 条带/镜像实例
+ * @note 由SD_Raid_Init()填写，调用者只需提供存储
+ */
+typedef struct {
+    SD_DeviceTypeDef    *pDev[SD_RAID_MEMBERS];
+    uint32_t            Mode;
+    uint32_t            ChunkBlocks;
+    uint32_t            StartBlock;
+    uint32_t            MemberBlocks;         /*!< 每张卡上使用的块数（条带时为分片的整数倍） */
+    uint32_t            Blocks;               /*!< 虚拟块设备的容量（块） */
+    uint32_t            NextRead;             /*!< 镜像读取优先尝试的成员，两张卡都空闲时轮流使用 */
+    SD_RequestTypeDef   Req[SD_RAID_MEMBERS]; /*!< 各成员的IDMA请求 */
+    SD_RaidStatsTypeDef Stats;
+} SD_RaidTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+#if (SD_RAID_ENABLE != 0U)
+
+/**
+ * @brief 按配置组建条带或镜像
+ * @param  hraid: 实例存储
+ * @param  pConfig: 配置
+ * @retval HAL_StatusTypeDef 成员无效、区域超出卡容量、分片与AU不对齐或条带区域放不下一个分片时返回HAL_ERROR
+ * @note 不读写卡；镜像的两张卡内容是否一致由调用者保证（新卡先整段写入一次）
+ */
+HAL_StatusTypeDef SD_Raid_Init(SD_RaidTypeDef *hraid, const SD_RaidConfigTypeDef *pConfig);
+
+/**
+ * @brief 虚拟块设备的容量
+ * @param  hraid: 实例
+ * @retval uint32_t 块数
+ */
+uint32_t SD_Raid_GetBlockCount(const SD_RaidTypeDef *hraid);
+
+/**
+ * @brief 写入虚拟块设备
+ * @param  hraid: 实例
+ * @param  pData: 数据缓冲区
+ * @param  BlockAdd: 虚拟起始块
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 整次写入的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态；超时则中止两个成员上的传输
+ * @note 缓冲区4字节对齐且IDMA可访问时两张卡同时传输，否则逐段调用SD_Dev_WriteBlocksDirect()（经跳板缓冲区）
+ * @note 返回时数据已传给卡，卡可能仍在编程；镜像写入失败时两张卡内容可能不一致
+ */
+HAL_StatusTypeDef SD_Raid_WriteBlocks(SD_RaidTypeDef *hraid, const uint8_t *pData, uint32_t BlockAdd,
+                                      uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 读取虚拟块设备
+ * @param  hraid: 实例
+ * @param  pData: 数据缓冲区
+ * @param  BlockAdd: 虚拟起始块
+ * @param  NumberOfBlocks: 块数量
+ * @param  Timeout: 整次读取的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态；超时则中止两个成员上的传输
+ * @note 缓冲区32字节对齐且IDMA可访问时两张卡同时传输，否则逐段调用SD_Dev_ReadBlocksDirect()
+ * @note 镜像时每个分片交给先空闲的卡；刚写入后一张卡先结束编程，读取就先从这张卡开始
+ */
+HAL_StatusTypeDef SD_Raid_ReadBlocks(SD_RaidTypeDef *hraid, uint8_t *pData, uint32_t BlockAdd,
+                                     uint32_t NumberOfBlocks, uint32_t Timeout);
+
+/**
+ * @brief 等待两张卡都结束编程
+ * @param  hraid: 实例
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Raid_WaitReady(SD_RaidTypeDef *hraid, uint32_t Timeout);
+
+/**
+ * @brief 读取统计
+ * @param  hraid: 实例
+ * @param  pStats: 统计结构体指针
+ */
+void SD_Raid_GetStats(const SD_RaidTypeDef *hraid, SD_RaidStatsTypeDef *pStats);
+
+/**
+ * @brief 清零统计
+ * @param  hraid: 实例
+ */
+void SD_Raid_ResetStats(SD_RaidTypeDef *hraid);
+
+#endif /* SD_RAID_ENABLE */
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_RAID_H__ */
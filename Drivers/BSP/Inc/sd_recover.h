@@ -0,0 +1,174 @@
+/**
+  ******************************************************************************
+  * @file    sd_recover.h
+  * @brief   SD卡读写错误的分类与自适应恢复
+  * @author  STMicroelectronics
+  * @date    2025-11-10
+  * @version 1.0
+  * @note    在sd.h中定义SD_RECOVER_ENABLE为1后可用。SD_ReadBlocksDirect()/SD_WriteBlocksDirect()失败时按HAL错误码分类
+  *          （CRC、超时、FIFO上溢/下溢、忙），退避后重试：
+  *          - 连续SD_RECOVER_CRC_LIMIT次CRC或FIFO错误时降一级分频，降到SD_RECOVER_MIN_HZ后改用1线；
+  *          - 超时时卡停在数据状态则发CMD12，卡无响应或再次超时则重新初始化卡；
+  *          - 降级后连续SD_RECOVER_UPSHIFT_RUN次传输无错时逐级恢复（先恢复线宽再恢复时钟），恢复后很快又出错则下次加倍
+  * @note    前门的缓存、队列、预取与CRC层最终都经过这两个函数，一并受保护；异步接口、双缓冲接口与CRC层的流水读取
+  *          不重试，错误直接交给调用者
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_RECOVER_H__
+#define __SD_RECOVER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Recover_Config 错误恢复配置
+ * @{
+ */
+#ifndef SD_RECOVER_RETRIES
+#define SD_RECOVER_RETRIES         4U       /*!< 一次读写最多重试的次数 */
+#endif
+
+#ifndef SD_RECOVER_BACKOFF_US
+#define SD_RECOVER_BACKOFF_US      100U     /*!< 第一次重试前的退避时间（微秒），之后每次加倍；期间调用SD_WaitYield() */
+#endif
+
+#ifndef SD_RECOVER_BACKOFF_MAX_US
+#define SD_RECOVER_BACKOFF_MAX_US  10000U   /*!< 退避时间上限（微秒） */
+#endif
+
+#ifndef SD_RECOVER_CRC_LIMIT
+#define SD_RECOVER_CRC_LIMIT       2U       /*!< 连续多少次CRC/FIFO错误后降级（偶发的一次只重试） */
+#endif
+
+#ifndef SD_RECOVER_MIN_HZ
+#define SD_RECOVER_MIN_HZ          5000000U /*!< 降频下限（Hz），再降一级会低于它时改为从4线降到1线 */
+#endif
+
+#ifndef SD_RECOVER_UPSHIFT_RUN
+#define SD_RECOVER_UPSHIFT_RUN     256U     /*!< 降级后连续多少次无错传输恢复一级；0表示不自动恢复 */
+#endif
+
+#ifndef SD_RECOVER_UPSHIFT_MAX
+#define SD_RECOVER_UPSHIFT_MAX     65536U   /*!< 恢复后马上又出错时所需次数加倍，不超过此值 */
+#endif
+/**
+ * @}
+ */
+
+#if (SD_RECOVER_BACKOFF_MAX_US < SD_RECOVER_BACKOFF_US) || (SD_RECOVER_CRC_LIMIT == 0U) || \
+    (SD_RECOVER_UPSHIFT_MAX < SD_RECOVER_UPSHIFT_RUN)
+  #error "SD_RECOVER: need BACKOFF_MAX_US >= BACKOFF_US, CRC_LIMIT > 0 and UPSHIFT_MAX >= UPSHIFT_RUN"
+#endif
+
+/**
+ * @defgroup SD_Recover_Class 错误类别
+ * @{
+ */
+#define SD_RECOVER_CLASS_CRC       0U  /*!< 命令或数据CRC错误 */
+#define SD_RECOVER_CLASS_TIMEOUT   1U  /*!< 命令响应、数据或软件超时 */
+#define SD_RECOVER_CLASS_FIFO      2U  /*!< FIFO下溢/上溢或IDMA错误 */
+#define SD_RECOVER_CLASS_BUSY      3U  /*!< 控制器或卡忙 */
+#define SD_RECOVER_CLASS_OTHER     4U  /*!< 参数、地址、写保护等重试无用的错误 */
+#define SD_RECOVER_CLASSES         5U
+/**
+ * @}
+ */
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 错误恢复统计
+ */
+typedef struct {
+    uint32_t Errors[SD_RECOVER_CLASSES]; /*!< 各类别的错误次数（每次失败的尝试计一次） */
+    uint32_t Retries;          /*!< 重试次数 */
+    uint32_t Recovered;        /*!< 重试后成功的读写次数 */
+    uint32_t Failed;           /*!< 重试用尽或不可重试而失败的读写次数 */
+    uint32_t Stops;            /*!< 发CMD12使卡回到传输状态的次数 */
+    uint32_t Resets;           /*!< 重新初始化卡的次数 */
+    uint32_t Downshifts;       /*!< 降一级分频的次数 */
+    uint32_t WidthFallbacks;   /*!< 从4线降到1线的次数 */
+    uint32_t Upshifts;         /*!< 无错运行后恢复一级的次数 */
+    uint32_t ClockDiv;         /*!< 当前分频 */
+    uint32_t BusWidth;         /*!< 当前线宽：1或4 */
+    uint32_t UpshiftRun;       /*!< 当前恢复一级所需的无错次数 */
+    uint64_t RecoverCycles;    /*!< 从第一次失败到重试成功的累计CPU周期 */
+    uint32_t MaxRecoverCycles; /*!< 单次恢复的最长CPU周期 */
+} SD_RecoverStatsTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 按状态和HAL错误码给错误分类
+ * @param  Status: 读写返回的状态
+ * @param  ErrorCode: HAL_SD_GetError()
+ * @retval uint32_t SD_RECOVER_CLASS_xxx
+ */
+uint32_t SD_Recover_Classify(HAL_StatusTypeDef Status, uint32_t ErrorCode);
+
+/**
+ * @brief 打开或暂停错误恢复（默认打开）
+ * @param  Enable: 1打开 0暂停
+ * @retval uint8_t 之前的设置，用于恢复
+ * @note 暂停期间失败直接返回；时钟校准等需要看到原始错误的场合使用
+ */
+uint8_t SD_Recover_Enable(uint8_t Enable);
+
+/**
+ * @brief 一次尝试失败后处理（驱动内部调用）
+ * @param  Status: 本次尝试的状态
+ * @param  ErrorCode: HAL_SD_GetError()
+ * @param  Attempt: 已重试的次数，第一次失败为0
+ * @retval HAL_StatusTypeDef HAL_OK: 已做完降级/停止/复位与退避，应重试；其他: 放弃
+ */
+HAL_StatusTypeDef SD_Recover_OnError(HAL_StatusTypeDef Status, uint32_t ErrorCode, uint32_t Attempt);
+
+/**
+ * @brief 一次读写结束后记账（驱动内部调用）
+ * @param  Status: 最终状态
+ * @param  Attempts: 重试次数
+ * @note 成功时累计无错次数，够数后恢复一级
+ */
+void SD_Recover_OnDone(HAL_StatusTypeDef Status, uint32_t Attempts);
+
+/**
+ * @brief 读取错误恢复统计
+ * @param  pStats: 统计结构体指针
+ * @retval HAL_StatusTypeDef HAL_OK: 成功；HAL_ERROR: pStats为空
+ */
+HAL_StatusTypeDef SD_Recover_GetStats(SD_RecoverStatsTypeDef *pStats);
+
+/**
+ * @brief 清零错误恢复统计（不影响当前降级状态）
+ */
+void SD_Recover_ResetStats(void);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_RECOVER_H__ */
@@ -0,0 +1,261 @@
+/**
+  ******************************************************************************
+  * @file    sd_sched.h
+  * @brief   SD卡多任务I/O调度器
+  * @author  STMicroelectronics
+  * @date    2025-11-04
+  * @version 1.0
+  * @note    在sd.h中定义SD_SCHED_ENABLE为1后可用。驱动的每个实例不可重入（同一时间只有一个IDMA请求），
+  *          多个任务同时调用SD_ReadBlocks()等会互相破坏传输；调度器独占卡：各任务只向按优先级分开的
+  *          提交队列放入请求，由一个执行者（SD_Sched_Run()所在的任务，或裸机下的SD_Sched_Poll()）逐个执行
+  * @note    选取顺序：已超过截止时间的请求按截止时间最早优先（防止低优先级饿死）；否则取最高优先级非空队列，
+  *          队列内按块地址单向电梯（C-SCAN）；与更早提交、区间重叠的写/擦除冲突的请求不会越过它；
+  *          没有请求时（SD_DISCARD_ENABLE为1）用空闲时间调用SD_Discard_Idle()
+  * @note    操作系统相关部分（锁、等待/唤醒）为弱定义函数，默认实现只适用于裸机单线程，
+  *          RTOS下须按SD_Sched_OsXxx()的说明重新实现；主机仿真中的pthread实现见Sim/Src/sd_sched_os.c
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_SCHED_H__
+#define __SD_SCHED_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Sched_Priority 请求优先级（数值越小越优先）
+ * @{
+ */
+#define SD_SCHED_PRIO_RT          0U    /*!< 实时：数据记录等有时限的写入 */
+#define SD_SCHED_PRIO_NORMAL      1U    /*!< 普通：文件系统访问 */
+#define SD_SCHED_PRIO_BACKGROUND  2U    /*!< 后台：校验、备份等扫描读取 */
+#define SD_SCHED_PRIO_COUNT       3U
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Sched_Op 请求类型
+ * @{
+ */
+#define SD_SCHED_OP_READ          0U    /*!< SD_ReadBlocks() */
+#define SD_SCHED_OP_WRITE         1U    /*!< SD_WriteBlocks() */
+#define SD_SCHED_OP_ERASE         2U    /*!< SD_EraseBlocks() */
+#define SD_SCHED_OP_FLUSH         3U    /*!< SD_Flush()并等待卡编程完成：等之前提交的请求都执行完才执行，之后提交的请求也不会越过它 */
+#define SD_SCHED_OP_DISCARD       4U    /*!< SD_Discard()（SD_DISCARD_ENABLE为1时） */
+/**
+ * @}
+ */
+
+/**
+ * @defgroup SD_Sched_Config 调度器配置
+ * @{
+ */
+#ifndef SD_SCHED_DEADLINE_RT_MS
+#define SD_SCHED_DEADLINE_RT_MS          20U     /*!< 实时请求默认的截止时间（提交后毫秒数） */
+#endif
+
+#ifndef SD_SCHED_DEADLINE_NORMAL_MS
+#define SD_SCHED_DEADLINE_NORMAL_MS      250U    /*!< 普通请求默认的截止时间 */
+#endif
+
+#ifndef SD_SCHED_DEADLINE_BACKGROUND_MS
+#define SD_SCHED_DEADLINE_BACKGROUND_MS  2000U   /*!< 后台请求默认的截止时间，即最长饿死时间 */
+#endif
+
+#ifndef SD_SCHED_IDLE_MS
+#define SD_SCHED_IDLE_MS                 100U    /*!< SD_Sched_Run()无请求时每次等待的最长时间 */
+#endif
+/**
+ * @}
+ */
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+struct __SD_SchedReqTypeDef;
+
+/**
+ * @brief 请求完成回调（在执行者的上下文中、Done置1之前调用，不持有调度器锁，可以提交新请求）
+ */
+typedef void (*SD_SchedCallbackTypeDef)(struct __SD_SchedReqTypeDef *pReq);
+
+/**
+ * @brief 调度请求
+ * @note 由提交者分配，提交后到Done置1之前不得修改或释放
+ */
+typedef struct __SD_SchedReqTypeDef {
+    uint8_t                   Op;             /*!< SD_SCHED_OP_xxx */
+    uint8_t                   Priority;       /*!< SD_SCHED_PRIO_xxx */
+    uint8_t                  *pData;          /*!< 数据缓冲区，擦除/刷新时不用 */
+    uint32_t                  BlockAdd;       /*!< 起始块地址 */
+    uint32_t                  NumberOfBlocks; /*!< 块数量 */
+    uint32_t                  DeadlineMs;     /*!< 提交后多少毫秒内应开始执行，0取该优先级的默认值 */
+    uint32_t                  Timeout;        /*!< 执行时传给驱动的超时时间（毫秒），0为SD_TIMEOUT_LONG */
+    SD_SchedCallbackTypeDef   Callback;       /*!< 完成回调，可为NULL */
+    void                     *pContext;       /*!< 用户上下文 */
+    volatile uint32_t         Done;           /*!< 0:排队或执行中 1:已完成 */
+    volatile HAL_StatusTypeDef Status;        /*!< 完成状态 */
+    /* 以下由调度器维护 */
+    struct __SD_SchedReqTypeDef *pNext;       /*!< 队列链接 */
+    uint32_t                  Seq;            /*!< 提交序号 */
+    uint32_t                  SubmitTick;     /*!< 提交时的SD_Sched_OsGetTick() */
+    uint32_t                  Deadline;       /*!< 截止时刻（SD_Sched_OsGetTick()） */
+    uint8_t                   Held;           /*!< 1: 曾因冲突被推迟，已计入统计 */
+} SD_SchedReqTypeDef;
+
+/**
+ * @brief 单个优先级的统计
+ */
+typedef struct {
+    uint32_t Submitted;      /*!< 提交的请求数 */
+    uint32_t Completed;      /*!< 完成的请求数 */
+    uint32_t Errors;         /*!< 完成状态非HAL_OK的请求数 */
+    uint32_t Cancelled;      /*!< 等待超时后撤销的请求数 */
+    uint32_t DeadlineMisses; /*!< 开始执行时已超过截止时间的请求数 */
+    uint32_t MaxWaitMs;      /*!< 从提交到开始执行的最长时间（毫秒） */
+    uint64_t WaitMs;         /*!< 从提交到开始执行的累计时间（毫秒） */
+} SD_SchedClassStatsTypeDef;
+
+/**
+ * @brief 调度器统计
+ */
+typedef struct {
+    SD_SchedClassStatsTypeDef Class[SD_SCHED_PRIO_COUNT];
+    uint32_t Pending;        /*!< 当前排队的请求数 */
+    uint32_t MaxPending;     /*!< 排队请求数的最大值 */
+    uint32_t Expedited;      /*!< 因超过截止时间而越过更高优先级或电梯顺序执行的次数 */
+    uint32_t Held;           /*!< 因与更早提交的请求冲突而被推迟过的请求数（每个请求只计一次） */
+} SD_SchedStatsTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 初始化调度器（清空队列和统计）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 在创建执行者和提交任务之前调用一次；SD_Init()仍由应用在此之前完成
+ */
+HAL_StatusTypeDef SD_Sched_Init(void);
+
+/**
+ * @brief 提交请求（任意任务，线程安全）
+ * @param  pReq: 请求，Op、Priority、pData、BlockAdd、NumberOfBlocks等由调用者填写
+ * @retval HAL_StatusTypeDef 参数非法或调度器已停止返回HAL_ERROR
+ * @note 立即返回；完成时调用Callback并唤醒SD_Sched_Wait()
+ */
+HAL_StatusTypeDef SD_Sched_Submit(SD_SchedReqTypeDef *pReq);
+
+/**
+ * @brief 等待请求完成（任意任务，线程安全）
+ * @param  pReq: 已提交的请求
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 请求的完成状态；超时仍在排队则撤销并返回HAL_TIMEOUT
+ * @note 请求已开始执行时继续等到它结束（驱动自身有超时）；没有执行者任务时由调用者自己执行队列中的请求
+ */
+HAL_StatusTypeDef SD_Sched_Wait(SD_SchedReqTypeDef *pReq, uint32_t Timeout);
+
+/**
+ * @brief 同步读取：提交并等待
+ * @param  pData: 数据缓冲区
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Priority: SD_SCHED_PRIO_xxx
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Sched_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint8_t Priority,
+                                uint32_t Timeout);
+
+/**
+ * @brief 同步写入：提交并等待
+ * @param  pData: 数据缓冲区
+ * @param  BlockAdd: 起始块地址
+ * @param  NumberOfBlocks: 块数量
+ * @param  Priority: SD_SCHED_PRIO_xxx
+ * @param  Timeout: 超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ */
+HAL_StatusTypeDef SD_Sched_Write(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint8_t Priority,
+                                 uint32_t Timeout);
+
+/**
+ * @brief 执行一个请求（裸机主循环或各任务轮流调用）
+ * @retval uint8_t 1: 执行了一个请求（或空闲时发出了一条丢弃区间的擦除命令）；0: 没有可执行的请求，或另一个任务正在执行
+ */
+uint8_t SD_Sched_Poll(void);
+
+/**
+ * @brief 执行者主循环，在专用任务中调用
+ * @note 没有请求时在SD_Sched_OsWait()中阻塞；SD_Sched_Stop()后执行完已提交的请求再返回
+ */
+void SD_Sched_Run(void);
+
+/**
+ * @brief 停止接受新请求，并让SD_Sched_Run()在队列取空后返回
+ */
+void SD_Sched_Stop(void);
+
+/**
+ * @brief 读取调度器统计
+ * @param  pStats: 统计结构体指针
+ */
+void SD_Sched_GetStats(SD_SchedStatsTypeDef *pStats);
+
+/**
+ * @brief 加锁（弱定义）
+ * @note 保护提交队列，持锁时间只有链表操作；默认关中断（不可嵌套），RTOS下换成互斥量
+ */
+void SD_Sched_OsLock(void);
+
+/**
+ * @brief 解锁（弱定义）
+ */
+void SD_Sched_OsUnlock(void);
+
+/**
+ * @brief 阻塞等待SD_Sched_OsNotify()（弱定义）
+ * @param  Timeout: 最长等待时间（毫秒）
+ * @note 调用时持有锁，等待期间释放、返回前重新获得（条件变量语义），允许虚假唤醒；
+ *       默认实现只是短暂开锁后返回（忙等）
+ */
+void SD_Sched_OsWait(uint32_t Timeout);
+
+/**
+ * @brief 当前时刻（毫秒，弱定义）
+ * @retval uint32_t 默认为HAL_GetTick()；RTOS下可换成系统节拍，须能在任意任务中调用
+ */
+uint32_t SD_Sched_OsGetTick(void);
+
+/**
+ * @brief 唤醒所有在SD_Sched_OsWait()中等待的任务（弱定义）
+ * @note 持有锁时调用；有新请求、请求完成或停止时调用
+ */
+void SD_Sched_OsNotify(void);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_SCHED_H__ */
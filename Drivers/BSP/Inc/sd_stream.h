@@ -0,0 +1,111 @@
+/**
+  ******************************************************************************
+  * @file    sd_stream.h
+  * @brief   SD卡双缓冲流式写入（数据记录用）
+  * @author  STMicroelectronics
+  * @date    2025-10-22
+  * @version 1.0
+  * @note    基于SDMMC IDMA双缓冲模式：应用填充一半的同时另一半在总线上传输，
+  *          整个会话只发一次CMD25，缓冲区切换时不停止多块写入
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_STREAM_H__
+#define __SD_STREAM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 流式写入对象
+ * @note 会话区间 [StartBlock, StartBlock + TotalBlocks) 由写入器独占；
+ *       应用未及时提交下一半时IDMA已开始发送旧数据，此时写入器立即发CMD12结束会话（记为欠载），
+ *       已提交的数据不受影响，但已写入区域之后最多一个半缓冲的块内容不确定
+ */
+typedef struct {
+    uint8_t           *pBuf[2];         /*!< 两个半缓冲区 */
+    uint32_t           HalfBlocks;      /*!< 每个半缓冲区的块数 */
+    uint32_t           StartBlock;      /*!< 会话起始块地址 */
+    uint32_t           TotalHalves;     /*!< 会话总半缓冲数 */
+    uint32_t           Committed;       /*!< 应用已提交的半缓冲数 */
+    volatile uint32_t  Written;         /*!< IDMA已取空的半缓冲数 */
+    volatile uint8_t   Filled[2];       /*!< 半缓冲已填好、等待传输 */
+    volatile uint8_t   Running;         /*!< 多块写入进行中 */
+    volatile uint8_t   Closing;         /*!< 应用已请求结束会话 */
+    uint32_t           Underruns;       /*!< 欠载次数（应用提交过慢导致会话提前结束） */
+    SD_RequestTypeDef  Req;             /*!< 内部IDMA请求 */
+} SD_StreamTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 打开一个流式写入会话
+ * @param  pStream: 流对象
+ * @param  pBuf0: 半缓冲区0（HalfBlocks块，32字节对齐，位于IDMA可访问的RAM）
+ * @param  pBuf1: 半缓冲区1（同上）
+ * @param  HalfBlocks: 每个半缓冲区的块数
+ * @param  StartBlock: 会话起始块地址
+ * @param  TotalBlocks: 会话总块数（HalfBlocks的整数倍，不超过SD_DOUBLEBUF_MAX_BLOCKS）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 两个半缓冲都提交后才启动传输
+ */
+HAL_StatusTypeDef SD_Stream_Open(SD_StreamTypeDef *pStream, uint8_t *pBuf0, uint8_t *pBuf1,
+                                 uint32_t HalfBlocks, uint32_t StartBlock, uint32_t TotalBlocks);
+
+/**
+ * @brief 获取可以填充的半缓冲区
+ * @param  pStream: 流对象
+ * @retval uint8_t* 空闲半缓冲区；两半都在使用或会话已结束时返回NULL
+ */
+uint8_t *SD_Stream_GetBuffer(SD_StreamTypeDef *pStream);
+
+/**
+ * @brief 提交已填好的半缓冲区
+ * @param  pStream: 流对象
+ * @retval HAL_StatusTypeDef 会话已结束或启动失败时返回错误
+ */
+HAL_StatusTypeDef SD_Stream_Commit(SD_StreamTypeDef *pStream);
+
+/**
+ * @brief 结束会话
+ * @param  pStream: 流对象
+ * @param  Timeout: 等待已提交数据写完的超时时间（毫秒）
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 未写满TotalBlocks时在最后一个已提交半缓冲传完后发CMD12；
+ *       只提交了一半尚未启动时以普通多块写入补写
+ */
+HAL_StatusTypeDef SD_Stream_Close(SD_StreamTypeDef *pStream, uint32_t Timeout);
+
+/**
+ * @brief 已写入卡的块数
+ * @param  pStream: 流对象
+ * @retval uint32_t 块数，欠载后可从StartBlock + 该值处重新打开会话
+ */
+uint32_t SD_Stream_GetWrittenBlocks(const SD_StreamTypeDef *pStream);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_STREAM_H__ */
@@ -0,0 +1,147 @@
+/**
+  ******************************************************************************
+  * @file    sd_trace.h
+  * @brief   SD卡二进制事件跟踪
+  * @author  STMicroelectronics
+  * @date    2025-11-01
+  * @version 1.0
+  * @note    在sd.h中定义SD_TRACE_ENABLE为1后可用；驱动把命令、IDMA起止、忙等待起止和错误位
+  *          以16字节定长事件写入环形缓冲区（满后覆盖最旧的事件），记录一次只需几十个周期，不改变被观察的时序
+  * @note    SD_Trace_Dump()导出二进制映像，主机端用Drivers/BSP/Tools/sd_trace.py转换为时间线或Chrome trace JSON
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_TRACE_H__
+#define __SD_TRACE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* USER CODE BEGIN Private defines */
+
+/**
+ * @defgroup SD_Trace_Config 事件跟踪配置
+ * @{
+ */
+#ifndef SD_TRACE_DEPTH
+#define SD_TRACE_DEPTH        256U    /*!< 环形缓冲区事件数（2的幂），RAM = 16 * SD_TRACE_DEPTH字节 */
+#endif
+/**
+ * @}
+ */
+
+#if ((SD_TRACE_DEPTH == 0U) || ((SD_TRACE_DEPTH & (SD_TRACE_DEPTH - 1U)) != 0U))
+  #error "SD_TRACE_DEPTH must be a power of 2"
+#endif
+
+/**
+ * @defgroup SD_Trace_Event 事件类型
+ * @{
+ */
+#define SD_TRACE_EV_CMD         1U    /*!< 发出命令（查询模式读写、擦除、CMD23）：Cmd、BlockAdd、Count；Arg为1表示ACMD */
+#define SD_TRACE_EV_IDMA_START  2U    /*!< 启动IDMA传输：Cmd为17/18/24/25，BlockAdd、Count；双缓冲传输时Arg为每个缓冲区的块数 */
+#define SD_TRACE_EV_IDMA_DONE   3U    /*!< IDMA传输结束（中断上下文）：Arg为HAL_StatusTypeDef */
+#define SD_TRACE_EV_BUSY_START  4U    /*!< 卡不在传输状态，开始等待就绪（第一次查询即就绪时不记录） */
+#define SD_TRACE_EV_BUSY_END    5U    /*!< 等待就绪结束：Count为CMD13查询次数，Arg为HAL_StatusTypeDef */
+#define SD_TRACE_EV_ERROR       6U    /*!< 传输出错：Cmd为出错的命令，Arg为HAL_SD_GetError()的错误位 */
+#define SD_TRACE_EV_MARK        7U    /*!< 用户标记（SD_Trace_Mark()）：Cmd为标记号，Arg为用户数据 */
+/**
+ * @}
+ */
+
+#define SD_TRACE_MAGIC          0x52544453U   /*!< 导出映像头部标识："SDTR"（小端） */
+#define SD_TRACE_VERSION        1U
+
+/* USER CODE END Private defines */
+
+/* USER CODE BEGIN Exported types */
+
+/**
+ * @brief 跟踪事件（16字节）
+ */
+typedef struct {
+    uint32_t Cycles;         /*!< DWT->CYCCNT，32位回绕（480MHz下约8.9秒） */
+    uint8_t  Type;           /*!< SD_TRACE_EV_xxx */
+    uint8_t  Cmd;            /*!< 命令号，0表示无 */
+    uint16_t Count;          /*!< 块数（超过65535记为65535）或查询次数 */
+    uint32_t BlockAdd;       /*!< 块地址 */
+    uint32_t Arg;            /*!< 状态、错误位或用户数据 */
+} SD_TraceEventTypeDef;
+
+/**
+ * @brief 导出映像头部，之后紧跟Count个事件（从旧到新）
+ */
+typedef struct {
+    uint32_t Magic;          /*!< SD_TRACE_MAGIC */
+    uint16_t Version;        /*!< SD_TRACE_VERSION */
+    uint16_t EventSize;      /*!< sizeof(SD_TraceEventTypeDef) */
+    uint32_t Count;          /*!< 导出的事件数 */
+    uint32_t Lost;           /*!< 被覆盖而丢失的事件数 */
+    uint32_t CyclesPerUs;    /*!< 每微秒的周期数 */
+} SD_TraceHeaderTypeDef;
+
+/* USER CODE END Exported types */
+
+/* USER CODE BEGIN Exported functions */
+
+/**
+ * @brief 清空缓冲区并开始记录
+ * @note 启动DWT周期计数器；可在SD_Init()之前调用，以记录初始化过程
+ */
+void SD_Trace_Start(void);
+
+/**
+ * @brief 停止记录，缓冲区内容保留到下一次SD_Trace_Start()
+ * @note 出错后立即调用可以保住出错前的历史，避免被后续事件覆盖
+ */
+void SD_Trace_Stop(void);
+
+/**
+ * @brief 记录一个事件（驱动内部调用）
+ * @param  Type: SD_TRACE_EV_xxx
+ * @param  Cmd: 命令号
+ * @param  BlockAdd: 块地址
+ * @param  Count: 块数或查询次数
+ * @param  Arg: 状态、错误位或用户数据
+ * @note 可在线程和中断中调用：用LDREX/STREX领取槽位，不关中断、不加锁
+ */
+void SD_Trace_Record(uint8_t Type, uint8_t Cmd, uint32_t BlockAdd, uint32_t Count, uint32_t Arg);
+
+/**
+ * @brief 记录用户标记，把应用层的阶段（如"开始写文件"）对到时间线上
+ * @param  Id: 标记号（0~255）
+ * @param  Arg: 用户数据
+ */
+void SD_Trace_Mark(uint8_t Id, uint32_t Arg);
+
+/**
+ * @brief 导出缓冲区
+ * @param  pBuf: 输出缓冲区，依次为SD_TraceHeaderTypeDef和事件
+ * @param  Size: 输出缓冲区字节数，放不下时只导出最新的事件
+ * @retval uint32_t 写入的字节数；Size小于头部时返回0
+ * @note 导出期间暂停记录；输出可直接写入文件或经串口发送，由Drivers/BSP/Tools/sd_trace.py解析
+ */
+uint32_t SD_Trace_Dump(uint8_t *pBuf, uint32_t Size);
+
+/* USER CODE END Exported functions */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_TRACE_H__ */
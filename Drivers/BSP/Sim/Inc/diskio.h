@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file    diskio.h
+  * @brief   主机仿真工程的diskio.h - FatFs底层接口声明（取值与FatFs R0.15一致）
+  * @author  STMicroelectronics
+  * @date    2025-11-05
+  * @version 1.0
+  * @note    目标板工程使用FatFs中间件自带的diskio.h，不要加入此文件
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DISKIO_H__
+#define __DISKIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "ff.h"
+
+typedef BYTE DSTATUS;
+
+typedef enum {
+    RES_OK = 0,     /* 0: Successful */
+    RES_ERROR,      /* 1: R/W Error */
+    RES_WRPRT,      /* 2: Write Protected */
+    RES_NOTRDY,     /* 3: Not Ready */
+    RES_PARERR      /* 4: Invalid Parameter */
+} DRESULT;
+
+DSTATUS disk_initialize(BYTE pdrv);
+DSTATUS disk_status(BYTE pdrv);
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count);
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count);
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff);
+
+/* Disk Status Bits (DSTATUS) */
+#define STA_NOINIT      0x01
+#define STA_NODISK      0x02
+#define STA_PROTECT     0x04
+
+/* Generic command (Used by FatFs) */
+#define CTRL_SYNC           0
+#define GET_SECTOR_COUNT    1
+#define GET_SECTOR_SIZE     2
+#define GET_BLOCK_SIZE      3
+#define CTRL_TRIM           4
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DISKIO_H__ */
@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file    ff.h
+  * @brief   主机仿真工程的ff.h - 只提供sd_diskio.c用到的FatFs类型与配置（取值与FatFs R0.15一致）
+  * @author  STMicroelectronics
+  * @date    2025-11-05
+  * @version 1.0
+  * @note    目标板工程使用FatFs中间件自带的ff.h/ffconf.h，不要加入此文件
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FF_H__
+#define __FF_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* ffconf.h中与diskio有关的配置 */
+#define FF_FS_READONLY  0
+#define FF_FS_NORTC     0
+#define FF_USE_TRIM     1
+#define FF_MIN_SS       512
+#define FF_MAX_SS       512
+#define FF_LBA64        0
+
+typedef unsigned int    UINT;
+typedef unsigned char   BYTE;
+typedef uint16_t        WORD;
+typedef uint32_t        DWORD;
+typedef uint64_t        QWORD;
+
+#if FF_LBA64
+typedef QWORD LBA_t;
+#else
+typedef DWORD LBA_t;
+#endif
+
+DWORD get_fattime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FF_H__ */
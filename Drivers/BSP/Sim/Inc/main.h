@@ -0,0 +1,36 @@
+/**
+  ******************************************************************************
+  * @file    main.h
+  * @brief   主机仿真工程的main.h - 替代CubeMX生成的同名头文件
+  * @author  STMicroelectronics
+  * @date    2025-10-20
+  * @version 1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32h7xx_hal.h"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
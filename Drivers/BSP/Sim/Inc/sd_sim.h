@@ -0,0 +1,195 @@
+/**
+  ******************************************************************************
+  * @file    sd_sim.h
+  * @brief   主机端SDMMC/SD卡仿真器配置接口
+  * @author  STMicroelectronics
+  * @date    2025-10-20
+  * @version 1.0
+  * @note    卡数据保存在内存映射的镜像文件中，时间为虚拟时间，结果可复现
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_SIM_H__
+#define __SD_SIM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+#define SIM_SD_SLOTS              2U  /*!< 卡槽数：0接SDMMC1（hsd1），1接SDMMC2（hsd2） */
+
+/**
+ * @brief 仿真卡配置（时间模型参数）
+ * @note KernelClockHz、PollCostNs、OtherIrqPeriodNs、CrcBlockNs是全局参数，只取卡槽0的配置
+ */
+typedef struct {
+    const char *ImagePath;      /*!< 卡镜像文件路径，不存在时自动创建 */
+    uint64_t    CapacityBytes;  /*!< 卡容量（字节），0表示沿用镜像文件大小 */
+    uint32_t    KernelClockHz;  /*!< SDMMC内核时钟，SDMMC_CK = Kernel / (2*CLKDIV)，CLKDIV=0时直通 */
+    uint32_t    BusWidth;       /*!< 数据线宽度：1或4 */
+    uint32_t    CmdOverheadNs;  /*!< 每条命令的固定开销（驱动+卡响应延迟，纳秒） */
+    uint32_t    ReadAccessNs;   /*!< 读命令到第一个数据块的访问延迟（纳秒） */
+    uint32_t    ProgBusyNs;     /*!< 每次写命令结束后的编程忙时间（纳秒） */
+    uint32_t    ProgBlockNs;    /*!< 每块额外的编程忙时间（纳秒） */
+    uint32_t    EraseBusyNs;    /*!< 每次擦除命令的忙时间（纳秒） */
+    uint32_t    PollCostNs;     /*!< 每次HAL_GetTick()调用消耗的CPU时间（纳秒），防止空循环卡死 */
+    uint32_t    OtherIrqPeriodNs; /*!< 周期性“其他中断”的周期（纳秒），0表示关闭，用于测量中断延迟 */
+    uint32_t    Cmd23Support;   /*!< SCR.CMD_SUPPORT中是否声明支持CMD23（0/1） */
+    uint32_t    PreEraseBlockNs; /*!< ACMD23预擦除提示覆盖的块的编程忙时间（纳秒），代替ProgBlockNs */
+    uint32_t    ErasedBlockNs;   /*!< 写入已擦除（擦除后未写过）的块的编程忙时间（纳秒），优先于以上两项 */
+    uint32_t    HighSpeedSupport; /*!< CMD6功能组1是否支持High Speed（0/1） */
+    uint32_t    BoardMaxClockHz; /*!< 板级走线能稳定工作的最高SDMMC_CK，超过时数据CRC错误；0表示不限制 */
+    uint32_t    AuBlocks;       /*!< 分配单元（AU）块数，经SD Status报告；0表示关闭写入位置模型 */
+    uint32_t    RuBlocks;       /*!< 卡内部编程单元（RU）块数，写入不连续且不在RU边界时要补齐 */
+    uint32_t    RuMergeNs;      /*!< 每补齐一个不完整RU的额外编程忙（纳秒） */
+    uint32_t    AuMergeNs;      /*!< 在未打开的AU中间开始写入时整理该AU的额外编程忙（纳秒） */
+    uint32_t    CrcBlockNs;     /*!< 软件CRC32计算512字节消耗的CPU时间（纳秒），经SD_CRC_COST计入 */
+    uint32_t    CardInitNs;     /*!< HAL_SD_InitCard()重新识别卡的时间（纳秒），不含命令本身 */
+    uint32_t    Sdsc;           /*!< 1: 报告为SDSC（CSD 1.0），CSD的读写时间取下面三项；0: SDHC/SDXC（CSD 2.0） */
+    uint32_t    CsdTaac;        /*!< SDSC的CSD.TAAC编码 */
+    uint32_t    CsdNsac;        /*!< SDSC的CSD.NSAC（100个时钟为单位） */
+    uint32_t    CsdR2wFactor;   /*!< SDSC的CSD.R2W_FACTOR */
+} SIM_SD_ConfigTypeDef;
+
+/**
+ * @defgroup SIM_SD_Faults 可注入的故障（SIM_SD_InjectFault()）
+ * @{
+ */
+#define SIM_SD_FAULT_CRC          0U  /*!< 之后Count次数据命令CRC错误 */
+#define SIM_SD_FAULT_FIFO         1U  /*!< 之后Count次数据命令读RX_OVERRUN/写TX_UNDERRUN */
+#define SIM_SD_FAULT_DATA_TIMEOUT 2U  /*!< 之后Count次数据命令数据超时，卡停在收发状态直到CMD12 */
+#define SIM_SD_FAULT_HANG         3U  /*!< Count非0时卡不再响应任何命令，直到HAL_SD_InitCard() */
+#define SIM_SD_FAULT_DAT123       4U  /*!< Count非0时DAT1~3接触不良：4线数据传输都CRC错误，1线正常 */
+#define SIM_SD_FAULT_STALL        5U  /*!< 之后Count次数据命令（双缓冲除外）卡中途停止收发且不报错：HAL的DTIMER为最大值，
+                                           DATAEND与数据超时都不会到来，卡停在收发状态直到CMD12 */
+#define SIM_SD_FAULT_BUSY         6U  /*!< 之后Count次写入结束后卡一直编程忙（DAT0保持低），直到HAL_SD_InitCard() */
+#define SIM_SD_FAULTS             7U
+/**
+ * @}
+ */
+
+/**
+ * @brief 仿真器统计
+ */
+typedef struct {
+    uint32_t Commands;          /*!< 发出的命令总数（含CMD13） */
+    uint32_t StatusPolls;       /*!< CMD13次数 */
+    uint32_t ReadCmds;          /*!< 读命令次数 */
+    uint32_t WriteCmds;         /*!< 写命令次数 */
+    uint32_t EraseCmds;         /*!< 擦除命令次数 */
+    uint32_t PreDefinedWrites;  /*!< CMD23预定义块数的写命令次数（无CMD12） */
+    uint32_t PreErasedWrites;   /*!< 带ACMD23预擦除提示的写命令次数 */
+    uint64_t ErasedBlocksWritten; /*!< 写入时已被擦除（不必先擦除）的块数 */
+    uint32_t CrcErrors;         /*!< 时钟超出卡或板级上限导致的数据CRC错误次数 */
+    uint32_t RuMerges;          /*!< 不完整RU的补齐次数 */
+    uint32_t AuMerges;          /*!< 在未打开的AU中间开始写入的次数 */
+    uint32_t CacheOpErrors;     /*!< 未按缓存行对齐的D-Cache维护操作次数 */
+    uint32_t InjectedFaults;    /*!< 因注入的故障而失败的数据命令次数 */
+    uint32_t CardResets;        /*!< HAL_SD_InitCard()次数 */
+    uint64_t BlocksRead;        /*!< 读出块数 */
+    uint64_t BlocksWritten;     /*!< 写入块数 */
+    uint64_t BusBusyNs;         /*!< 总线占用时间（纳秒） */
+    uint64_t IrqOffNs;          /*!< 中断关闭累计时间（纳秒） */
+    uint64_t IrqOffMaxNs;       /*!< 单次中断关闭最长时间（纳秒） */
+    uint32_t OtherIrqCount;     /*!< “其他中断”响应次数 */
+    uint32_t OtherIrqMissed;    /*!< 关中断期间重复触发而丢失的次数 */
+    uint64_t OtherIrqLatencySumNs; /*!< “其他中断”响应延迟累计（纳秒） */
+    uint64_t OtherIrqLatencyMaxNs; /*!< “其他中断”最大响应延迟（纳秒） */
+} SIM_SD_StatsTypeDef;
+
+/**
+ * @brief 填充默认配置（12.8MHz直通、4线、典型Class10卡延迟）
+ * @param  pConfig: 配置结构体指针
+ */
+void SIM_SD_GetDefaultConfig(SIM_SD_ConfigTypeDef *pConfig);
+
+/**
+ * @brief 打开镜像并初始化卡槽0的仿真卡，虚拟时间清零
+ * @param  pConfig: 配置结构体指针
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 调用后还需调用MX_SDMMC1_SD_Init()使hsd1进入就绪状态；其他卡槽全部关闭
+ */
+HAL_StatusTypeDef SIM_SD_Init(const SIM_SD_ConfigTypeDef *pConfig);
+
+/**
+ * @brief 打开镜像并初始化指定卡槽的仿真卡（不影响虚拟时间与其他卡槽）
+ * @param  Slot: 卡槽号，0~SIM_SD_SLOTS-1
+ * @param  pConfig: 配置结构体指针，全局参数忽略
+ * @retval HAL_StatusTypeDef 返回操作状态
+ * @note 卡槽1调用后还需调用MX_SDMMC2_SD_Init()使hsd2进入就绪状态；未初始化的卡槽上HAL_SD_Init()失败
+ */
+HAL_StatusTypeDef SIM_SD_InitSlot(uint32_t Slot, const SIM_SD_ConfigTypeDef *pConfig);
+
+/**
+ * @brief 同步镜像并释放所有卡槽的仿真卡
+ */
+void SIM_SD_DeInit(void);
+
+/**
+ * @brief 获取当前虚拟时间
+ * @retval uint64_t 虚拟时间（纳秒）
+ */
+uint64_t SIM_SD_GetTimeNs(void);
+
+/**
+ * @brief 推进虚拟时间（模拟CPU计算耗时）
+ * @param  ns: 推进的纳秒数
+ */
+void SIM_SD_AdvanceNs(uint64_t ns);
+
+/**
+ * @brief 按CrcBlockNs推进软件CRC计算的CPU时间（sd_crc.c的SD_CRC_COST）
+ * @param  Bytes: 计算的字节数
+ */
+void SIM_SD_CrcCost(uint32_t Bytes);
+
+/**
+ * @brief 给卡槽0注入故障
+ * @param  Fault: SIM_SD_FAULT_xxx
+ * @param  Count: 次数或开关（见各故障说明），0清除
+ */
+void SIM_SD_InjectFault(uint32_t Fault, uint32_t Count);
+
+/**
+ * @brief 读取卡槽0的仿真器统计（含中断关闭、“其他中断”与D-Cache检查等全局统计）
+ * @param  pStats: 统计结构体指针
+ */
+void SIM_SD_GetStats(SIM_SD_StatsTypeDef *pStats);
+
+/**
+ * @brief 读取指定卡槽的仿真器统计
+ * @param  Slot: 卡槽号
+ * @param  pStats: 统计结构体指针
+ */
+void SIM_SD_GetSlotStats(uint32_t Slot, SIM_SD_StatsTypeDef *pStats);
+
+/**
+ * @brief 清零所有卡槽的仿真器统计
+ */
+void SIM_SD_ResetStats(void);
+
+/**
+ * @brief 获取SDMMC1当前的SDMMC_CK频率
+ * @retval uint32_t 总线时钟（Hz），由CLKCR.CLKDIV计算
+ */
+uint32_t SIM_SD_GetBusClockHz(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_SIM_H__ */
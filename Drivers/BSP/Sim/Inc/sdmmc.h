@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file    sdmmc.h
+  * @brief   主机仿真工程的sdmmc.h - 替代CubeMX生成的同名头文件
+  * @author  STMicroelectronics
+  * @date    2025-10-20
+  * @version 1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SDMMC_H__
+#define __SDMMC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+extern SD_HandleTypeDef hsd1;
+extern SD_HandleTypeDef hsd2;
+
+void MX_SDMMC1_SD_Init(void);
+void MX_SDMMC2_SD_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SDMMC_H__ */
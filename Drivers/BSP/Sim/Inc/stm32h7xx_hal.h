@@ -0,0 +1,461 @@
+/**
+  ******************************************************************************
+  * @file    stm32h7xx_hal.h
+  * @brief   主机端HAL仿真头文件 - 仅提供sd.c所需的HAL_SD子集
+  * @author  STMicroelectronics
+  * @date    2025-10-20
+  * @version 1.0
+  * @note    类型、常量与STM32H7 HAL保持同名同值，使sd.c无需修改即可在Linux编译
+  * @note    仅用于主机仿真/基准测试，禁止加入目标板工程
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32H7xx_HAL_H
+#define __STM32H7xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief HAL状态定义（与stm32h7xx_hal_def.h一致）
+ */
+typedef enum
+{
+  HAL_OK       = 0x00U,
+  HAL_ERROR    = 0x01U,
+  HAL_BUSY     = 0x02U,
+  HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+/**
+ * @brief SDMMC寄存器组（仿真版本，仅保存软件可见的寄存器值）
+ */
+typedef struct
+{
+  volatile uint32_t POWER;
+  volatile uint32_t CLKCR;
+  volatile uint32_t ARG;
+  volatile uint32_t CMD;
+  volatile uint32_t RESPCMD;
+  volatile uint32_t RESP1;
+  volatile uint32_t RESP2;
+  volatile uint32_t RESP3;
+  volatile uint32_t RESP4;
+  volatile uint32_t DTIMER;
+  volatile uint32_t DLEN;
+  volatile uint32_t DCTRL;
+  volatile uint32_t DCNT;
+  volatile uint32_t STA;
+  volatile uint32_t ICR;
+  volatile uint32_t MASK;
+  volatile uint32_t ACKTIME;
+  volatile uint32_t IDMACTRL;
+  volatile uint32_t IDMABSIZE;
+  volatile uint32_t IDMABASE0;
+  volatile uint32_t IDMABASE1;
+  volatile uint32_t FIFO;
+} SDMMC_TypeDef;
+
+/**
+ * @brief SDMMC初始化参数
+ */
+typedef struct
+{
+  uint32_t ClockEdge;
+  uint32_t ClockPowerSave;
+  uint32_t BusWide;
+  uint32_t HardwareFlowControl;
+  uint32_t ClockDiv;
+} SD_InitTypeDef;
+
+/**
+ * @brief SD句柄状态
+ */
+typedef enum
+{
+  HAL_SD_STATE_RESET       = 0x00000000U,
+  HAL_SD_STATE_READY       = 0x00000001U,
+  HAL_SD_STATE_TIMEOUT     = 0x00000002U,
+  HAL_SD_STATE_BUSY        = 0x00000003U,
+  HAL_SD_STATE_PROGRAMMING = 0x00000004U,
+  HAL_SD_STATE_RECEIVING   = 0x00000005U,
+  HAL_SD_STATE_TRANSFER    = 0x00000006U,
+  HAL_SD_STATE_ERROR       = 0x0000000FU
+} HAL_SD_StateTypeDef;
+
+/**
+ * @brief SD卡状态（CMD13 CURRENT_STATE）
+ */
+typedef uint32_t HAL_SD_CardStateTypeDef;
+
+#define HAL_SD_CARD_READY          0x00000001U
+#define HAL_SD_CARD_IDENTIFICATION 0x00000002U
+#define HAL_SD_CARD_STANDBY        0x00000003U
+#define HAL_SD_CARD_TRANSFER       0x00000004U
+#define HAL_SD_CARD_SENDING        0x00000005U
+#define HAL_SD_CARD_RECEIVING      0x00000006U
+#define HAL_SD_CARD_PROGRAMMING    0x00000007U
+#define HAL_SD_CARD_DISCONNECTED   0x00000008U
+#define HAL_SD_CARD_ERROR          0x000000FFU
+
+/**
+ * @brief IDMA双缓冲模式的缓冲区号
+ */
+typedef enum
+{
+  SD_DMA_BUFFER0 = 0x00U,
+  SD_DMA_BUFFER1 = 0x01U
+} HAL_SDEx_DMABuffer_MemoryTypeDef;
+
+/**
+ * @brief SD卡信息
+ */
+typedef struct
+{
+  uint32_t CardType;
+  uint32_t CardVersion;
+  uint32_t Class;
+  uint32_t RelCardAdd;
+  uint32_t BlockNbr;
+  uint32_t BlockSize;
+  uint32_t LogBlockNbr;
+  uint32_t LogBlockSize;
+  uint32_t CardSpeed;
+} HAL_SD_CardInfoTypeDef;
+
+/**
+ * @brief SD Status（ACMD13）解析结果，字段为规范中的原始编码
+ */
+typedef struct
+{
+  volatile uint8_t  DataBusWidth;
+  volatile uint8_t  SecuredMode;
+  volatile uint16_t CardType;
+  volatile uint32_t ProtectedAreaSize;
+  volatile uint8_t  SpeedClass;
+  volatile uint8_t  PerformanceMove;
+  volatile uint8_t  AllocationUnitSize;
+  volatile uint16_t EraseSize;
+  volatile uint8_t  EraseTimeout;
+  volatile uint8_t  EraseOffset;
+  volatile uint8_t  UhsSpeedGrade;
+  volatile uint8_t  UhsAllocationUnitSize;
+  volatile uint8_t  VideoSpeedClass;
+} HAL_SD_CardStatusTypeDef;
+
+/**
+ * @brief CSD寄存器解析结果，字段为规范中的原始编码
+ */
+typedef struct
+{
+  volatile uint8_t  CSDStruct;
+  volatile uint8_t  SysSpecVersion;
+  volatile uint8_t  Reserved1;
+  volatile uint8_t  TAAC;
+  volatile uint8_t  NSAC;
+  volatile uint8_t  MaxBusClkFrec;
+  volatile uint16_t CardComdClasses;
+  volatile uint8_t  RdBlockLen;
+  volatile uint8_t  PartBlockRead;
+  volatile uint8_t  WrBlockMisalign;
+  volatile uint8_t  RdBlockMisalign;
+  volatile uint8_t  DSRImpl;
+  volatile uint8_t  Reserved2;
+  volatile uint32_t DeviceSize;
+  volatile uint8_t  MaxRdCurrentVDDMin;
+  volatile uint8_t  MaxRdCurrentVDDMax;
+  volatile uint8_t  MaxWrCurrentVDDMin;
+  volatile uint8_t  MaxWrCurrentVDDMax;
+  volatile uint8_t  DeviceSizeMul;
+  volatile uint8_t  EraseGrSize;
+  volatile uint8_t  EraseGrMul;
+  volatile uint8_t  WrProtectGrSize;
+  volatile uint8_t  WrProtectGrEnable;
+  volatile uint8_t  ManDeflECC;
+  volatile uint8_t  WrSpeedFact;
+  volatile uint8_t  MaxWrBlockLen;
+  volatile uint8_t  WriteBlockPaPartial;
+  volatile uint8_t  Reserved3;
+  volatile uint8_t  ContentProtectAppli;
+  volatile uint8_t  FileFormatGroup;
+  volatile uint8_t  CopyFlag;
+  volatile uint8_t  PermWrProtect;
+  volatile uint8_t  TempWrProtect;
+  volatile uint8_t  FileFormat;
+  volatile uint8_t  ECC;
+  volatile uint8_t  CSD_CRC;
+  volatile uint8_t  Reserved4;
+} HAL_SD_CardCSDTypeDef;
+
+/**
+ * @brief SD句柄
+ */
+typedef struct
+{
+  SDMMC_TypeDef                *Instance;
+  SD_InitTypeDef               Init;
+  const uint8_t                *pTxBuffPtr;
+  uint32_t                     TxXferSize;
+  uint8_t                      *pRxBuffPtr;
+  uint32_t                     RxXferSize;
+  volatile uint32_t            Context;
+  volatile HAL_SD_StateTypeDef State;
+  volatile uint32_t            ErrorCode;
+  HAL_SD_CardInfoTypeDef       SdCard;
+  uint32_t                     CSD[4];
+  uint32_t                     CID[4];
+} SD_HandleTypeDef;
+
+/**
+ * @brief SDMMC命令参数（与stm32h7xx_ll_sdmmc.h一致）
+ */
+typedef struct
+{
+  uint32_t Argument;
+  uint32_t CmdIndex;
+  uint32_t Response;
+  uint32_t WaitForInterrupt;
+  uint32_t CPSM;
+} SDMMC_CmdInitTypeDef;
+
+/**
+ * @brief SDMMC数据通道参数（与stm32h7xx_ll_sdmmc.h一致）
+ */
+typedef struct
+{
+  uint32_t DataTimeOut;
+  uint32_t DataLength;
+  uint32_t DataBlockSize;
+  uint32_t TransferDir;
+  uint32_t TransferMode;
+  uint32_t DPSM;
+} SDMMC_DataInitTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+
+#define CARD_SDSC                  0x00000000U
+#define CARD_SDHC_SDXC             0x00000001U
+#define CARD_SECURED               0x00000003U
+
+#define CARD_V1_X                  0x00000000U
+#define CARD_V2_X                  0x00000001U
+
+#define SD_CONTEXT_NONE                  0x00000000U
+#define SD_CONTEXT_READ_SINGLE_BLOCK     0x00000001U
+#define SD_CONTEXT_READ_MULTIPLE_BLOCK   0x00000002U
+#define SD_CONTEXT_WRITE_SINGLE_BLOCK    0x00000010U
+#define SD_CONTEXT_WRITE_MULTIPLE_BLOCK  0x00000020U
+#define SD_CONTEXT_IT                    0x00000008U
+#define SD_CONTEXT_DMA                   0x00000080U
+
+#define SDMMC_BUS_WIDE_1B          0x00000000U
+#define SDMMC_BUS_WIDE_4B          0x00004000U
+#define SDMMC_BUS_WIDE_8B          0x00008000U
+
+#define SDMMC_CLOCK_EDGE_RISING              0x00000000U
+#define SDMMC_CLOCK_POWER_SAVE_DISABLE       0x00000000U
+#define SDMMC_HARDWARE_FLOW_CONTROL_DISABLE  0x00000000U
+#define SDMMC_HARDWARE_FLOW_CONTROL_ENABLE   0x00020000U
+
+#define SDMMC_CLKCR_CLKDIV         0x000003FFU
+#define SDMMC_CLKCR_WIDBUS         0x0000C000U
+
+#define SDMMC_RESPONSE_NO          0x00000000U
+#define SDMMC_RESPONSE_SHORT       0x00000100U
+#define SDMMC_WAIT_NO              0x00000000U
+#define SDMMC_CPSM_ENABLE          0x00001000U
+#define SDMMC_CMDTIMEOUT           5000U
+
+#define SDMMC_DATATIMEOUT          0xFFFFFFFFU
+#define SDMMC_DATABLOCK_SIZE_8B    0x00000030U
+#define SDMMC_DATABLOCK_SIZE_64B   0x00000060U
+#define SDMMC_TRANSFER_DIR_TO_SDMMC 0x00000002U
+#define SDMMC_TRANSFER_MODE_BLOCK  0x00000000U
+#define SDMMC_DPSM_ENABLE          0x00000001U
+
+#define SDMMC_FLAG_DCRCFAIL        0x00000002U
+#define SDMMC_FLAG_DTIMEOUT        0x00000008U
+#define SDMMC_FLAG_RXOVERR         0x00000020U
+#define SDMMC_FLAG_DATAEND         0x00000100U
+#define SDMMC_FLAG_DBCKEND         0x00000400U
+#define SDMMC_FLAG_RXFIFOE         0x00080000U
+#define SDMMC_FLAG_BUSYD0          0x00100000U
+#define SDMMC_FLAG_BUSYD0END       0x00200000U
+#define SDMMC_STATIC_DATA_FLAGS    0x18000FAAU
+
+#define SDMMC_ERROR_NONE           0x00000000U
+#define SDMMC_ERROR_DATA_CRC_FAIL  0x00000002U
+#define SDMMC_ERROR_DATA_TIMEOUT   0x00000008U
+#define SDMMC_ERROR_RX_OVERRUN     0x00000020U
+#define SDMMC_ERROR_TIMEOUT        0x80000000U
+#define SDMMC_ERROR_ILLEGAL_CMD    0x00002000U
+
+#define SDMMC_CMD_SET_BLOCKLEN     16U
+#define SDMMC_CMD_SET_BLOCK_COUNT  23U
+#define SDMMC_CMD_APP_CMD          55U
+#define SDMMC_CMD_SD_APP_SEND_SCR  51U
+#define SDMMC_CMD_HS_SWITCH        6U
+
+#define SDMMC_FLAG_RXFIFOHF        0x00008000U
+
+#define RCC_PERIPHCLK_SDMMC        0x00010000U
+
+extern SDMMC_TypeDef SIM_SDMMC1_Regs;
+extern SDMMC_TypeDef SIM_SDMMC2_Regs;
+#define SDMMC1                     (&SIM_SDMMC1_Regs)
+#define SDMMC2                     (&SIM_SDMMC2_Regs)
+
+/**
+ * @defgroup SD_Error_Bits HAL_SD_GetError()返回的错误位
+ * @{
+ */
+#define HAL_SD_ERROR_NONE                   0x00000000U
+#define HAL_SD_ERROR_CMD_CRC_FAIL           0x00000001U
+#define HAL_SD_ERROR_DATA_CRC_FAIL          0x00000002U
+#define HAL_SD_ERROR_CMD_RSP_TIMEOUT        0x00000004U
+#define HAL_SD_ERROR_DATA_TIMEOUT           0x00000008U
+#define HAL_SD_ERROR_TX_UNDERRUN            0x00000010U
+#define HAL_SD_ERROR_RX_OVERRUN             0x00000020U
+#define HAL_SD_ERROR_ADDR_MISALIGNED        0x00000040U
+#define HAL_SD_ERROR_BLOCK_LEN_ERR          0x00000080U
+#define HAL_SD_ERROR_WRITE_PROT_VIOLATION   0x00000400U
+#define HAL_SD_ERROR_ILLEGAL_CMD            0x00002000U
+#define HAL_SD_ERROR_ADDR_OUT_OF_RANGE      0x02000000U
+#define HAL_SD_ERROR_PARAM                  0x08000000U
+#define HAL_SD_ERROR_UNSUPPORTED_FEATURE    0x10000000U
+#define HAL_SD_ERROR_BUSY                   0x20000000U
+#define HAL_SD_ERROR_DMA                    0x40000000U
+#define HAL_SD_ERROR_TIMEOUT                0x80000000U
+/**
+ * @}
+ */
+
+/* Exported macro ------------------------------------------------------------*/
+
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) \
+        ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+#define READ_REG(REG)         ((REG))
+#define __weak                __attribute__((weak))
+#define ALIGN_32BYTES(buf)    buf __attribute__ ((aligned (32)))
+
+/**
+ * @brief Cortex-M7 DWT/CoreDebug（仅周期计数器相关寄存器）
+ * @note 每次经DWT宏访问时按虚拟时间推进CYCCNT，频率为SystemCoreClock
+ */
+typedef struct
+{
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+  volatile uint32_t LAR;
+} DWT_Type;
+
+typedef struct
+{
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24U)
+
+extern uint32_t SystemCoreClock;
+extern CoreDebug_Type SIM_CoreDebug;
+DWT_Type *SIM_DWT(void);
+
+#define DWT                   (SIM_DWT())
+#define __CLZ(x)              (((x) == 0U) ? 32U : (uint32_t)__builtin_clz(x))
+#define CoreDebug             (&SIM_CoreDebug)
+
+/* 软件CRC计算不占虚拟时间，经此钩子按仿真配置计入（见sd_crc.h） */
+void SIM_SD_CrcCost(uint32_t Bytes);
+#define SD_CRC_COST(Bytes)    SIM_SD_CrcCost(Bytes)
+
+/* 仿真中STA由仿真器维护，写ICR不会清除，因此直接清STA */
+#define __SDMMC_GET_FLAG(__INSTANCE__, __FLAG__)   (((__INSTANCE__)->STA & (__FLAG__)) != 0U)
+#define __SDMMC_CLEAR_FLAG(__INSTANCE__, __FLAG__) ((__INSTANCE__)->STA &= ~(__FLAG__))
+
+/* Exported functions --------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+#define __DCACHE_PRESENT      1U
+void SCB_CleanDCache_by_Addr(uint32_t *addr, int32_t dsize);
+void SCB_InvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize);
+void SCB_CleanInvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize);
+uint32_t __LDREXW(volatile uint32_t *addr);
+uint32_t __STREXW(uint32_t value, volatile uint32_t *addr);
+uint32_t HAL_RCCEx_GetPeriphCLKFreq(uint64_t PeriphClk);
+void __set_PRIMASK(uint32_t priMask);
+
+HAL_StatusTypeDef HAL_SD_Init(SD_HandleTypeDef *hsd);
+HAL_StatusTypeDef HAL_SD_InitCard(SD_HandleTypeDef *hsd);
+HAL_StatusTypeDef HAL_SD_ConfigWideBusOperation(SD_HandleTypeDef *hsd, uint32_t WideMode);
+HAL_StatusTypeDef HAL_SD_ReadBlocks(SD_HandleTypeDef *hsd, uint8_t *pData, uint32_t BlockAdd,
+                                    uint32_t NumberOfBlocks, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SD_WriteBlocks(SD_HandleTypeDef *hsd, const uint8_t *pData, uint32_t BlockAdd,
+                                     uint32_t NumberOfBlocks, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SD_EraseBlocks(SD_HandleTypeDef *hsd, uint32_t BlockStartAdd, uint32_t BlockEndAdd);
+HAL_StatusTypeDef HAL_SD_ReadBlocks_DMA(SD_HandleTypeDef *hsd, uint8_t *pData, uint32_t BlockAdd,
+                                        uint32_t NumberOfBlocks);
+HAL_StatusTypeDef HAL_SD_WriteBlocks_DMA(SD_HandleTypeDef *hsd, const uint8_t *pData, uint32_t BlockAdd,
+                                         uint32_t NumberOfBlocks);
+HAL_StatusTypeDef HAL_SD_Abort(SD_HandleTypeDef *hsd);
+void HAL_SD_IRQHandler(SD_HandleTypeDef *hsd);
+void HAL_SD_TxCpltCallback(SD_HandleTypeDef *hsd);
+void HAL_SD_RxCpltCallback(SD_HandleTypeDef *hsd);
+void HAL_SD_ErrorCallback(SD_HandleTypeDef *hsd);
+HAL_StatusTypeDef HAL_SDEx_ConfigDMAMultiBuffer(SD_HandleTypeDef *hsd, uint32_t *pDataBuffer0,
+                                                uint32_t *pDataBuffer1, uint32_t BufferSize);
+HAL_StatusTypeDef HAL_SDEx_WriteBlocksDMAMultiBuffer(SD_HandleTypeDef *hsd, uint32_t BlockAdd,
+                                                     uint32_t NumberOfBlocks);
+HAL_StatusTypeDef HAL_SDEx_ReadBlocksDMAMultiBuffer(SD_HandleTypeDef *hsd, uint32_t BlockAdd,
+                                                    uint32_t NumberOfBlocks);
+HAL_StatusTypeDef HAL_SDEx_ChangeDMABuffer(SD_HandleTypeDef *hsd, HAL_SDEx_DMABuffer_MemoryTypeDef Buffer,
+                                           uint32_t *pDataBuffer);
+void HAL_SDEx_Write_DMADoubleBuf0CpltCallback(SD_HandleTypeDef *hsd);
+void HAL_SDEx_Write_DMADoubleBuf1CpltCallback(SD_HandleTypeDef *hsd);
+void HAL_SDEx_Read_DMADoubleBuf0CpltCallback(SD_HandleTypeDef *hsd);
+void HAL_SDEx_Read_DMADoubleBuf1CpltCallback(SD_HandleTypeDef *hsd);
+HAL_SD_CardStateTypeDef HAL_SD_GetCardState(SD_HandleTypeDef *hsd);
+HAL_StatusTypeDef HAL_SD_GetCardInfo(SD_HandleTypeDef *hsd, HAL_SD_CardInfoTypeDef *pCardInfo);
+HAL_StatusTypeDef HAL_SD_GetCardStatus(SD_HandleTypeDef *hsd, HAL_SD_CardStatusTypeDef *pStatus);
+HAL_StatusTypeDef HAL_SD_GetCardCSD(SD_HandleTypeDef *hsd, HAL_SD_CardCSDTypeDef *pCSD);
+uint32_t HAL_SD_GetError(const SD_HandleTypeDef *hsd);
+HAL_SD_StateTypeDef HAL_SD_GetState(const SD_HandleTypeDef *hsd);
+
+/* stm32h7xx_ll_sdmmc.h子集 */
+HAL_StatusTypeDef SDMMC_SendCommand(SDMMC_TypeDef *SDMMCx, const SDMMC_CmdInitTypeDef *Command);
+uint32_t SDMMC_GetCmdResp1(SDMMC_TypeDef *SDMMCx, uint8_t SD_CMD, uint32_t Timeout);
+uint32_t SDMMC_CmdBlockLength(SDMMC_TypeDef *SDMMCx, uint32_t BlockSize);
+uint32_t SDMMC_CmdAppCommand(SDMMC_TypeDef *SDMMCx, uint32_t Argument);
+uint32_t SDMMC_CmdSendSCR(SDMMC_TypeDef *SDMMCx);
+uint32_t SDMMC_CmdSwitch(SDMMC_TypeDef *SDMMCx, uint32_t Argument);
+HAL_StatusTypeDef SDMMC_ConfigData(SDMMC_TypeDef *SDMMCx, const SDMMC_DataInitTypeDef *Data);
+uint32_t SDMMC_ReadFIFO(const SDMMC_TypeDef *SDMMCx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32H7xx_HAL_H */
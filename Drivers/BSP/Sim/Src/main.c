@@ -0,0 +1,3058 @@
+/**
+  ******************************************************************************
+  * @file    main.c
+  * @brief   主机仿真入口 - 在Linux上运行sd.c并输出虚拟时间下的性能数据
+  * @author  STMicroelectronics
+  * @date    2025-10-20
+  * @version 1.0
+  * @note    用法: sd_sim [-i 镜像] [-j 第二张卡的镜像] [-m 容量MB] [-k 内核时钟Hz] [-d CLKDIV] [-w 线宽]
+  *                      [-c 命令开销ns] [-a 读访问延迟ns] [-b 编程忙ns] [-p 每块编程ns]
+  *                      [-q 其他中断周期ns] [-t 事件跟踪输出文件] ...
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "sdmmc.h"
+#include "sd.h"
+#include "sd_stream.h"
+#include "sd_iovec.h"
+#if (SD_CACHE_ENABLE != 0U)
+#include "sd_cache.h"
+#endif
+#if (SD_PREFETCH_ENABLE != 0U)
+#include "sd_prefetch.h"
+#endif
+#if (SD_QUEUE_ENABLE != 0U)
+#include "sd_queue.h"
+#endif
+#if (SD_CALIB_ENABLE != 0U)
+#include "sd_calib.h"
+#endif
+#if (SD_PLAN_ENABLE != 0U)
+#include "sd_plan.h"
+#endif
+#if (SD_BENCH_ENABLE != 0U)
+#include "sd_bench.h"
+#endif
+#if (SD_TRACE_ENABLE != 0U)
+#include "sd_trace.h"
+#endif
+#if (SD_SCHED_ENABLE != 0U)
+#include "sd_sched.h"
+#include <pthread.h>
+#endif
+#if (SD_DISKIO_ENABLE != 0U)
+#include "sd_diskio.h"
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+#include "sd_discard.h"
+#endif
+#if (SD_LOG_ENABLE != 0U)
+#include "sd_log.h"
+#endif
+#if (SD_CRC_ENABLE != 0U)
+#include "sd_crc.h"
+#endif
+#if (SD_RECOVER_ENABLE != 0U)
+#include "sd_recover.h"
+#endif
+#if (SD_RAID_ENABLE != 0U)
+#include "sd_raid.h"
+#endif
+#include "sd_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BENCH_HALF_BLOCKS   64U                 /* 每个半缓冲块数 */
+#define BENCH_TOTAL_BLOCKS  (BENCH_HALF_BLOCKS * 64U)
+#define BENCH_BLOCK_START   0x10000U            /* 测试区起始块（32MB处） */
+#define BENCH_READ_BLOCKS   4U                  /* 顺序读测试每次调用的块数 */
+#define BENCH_READ_CPU_NS   50000U              /* 顺序读测试中应用处理每次数据的CPU时间 */
+#define BENCH_SMALL_WRITES  512U                /* 小块写测试：2块数据写入次数 */
+#define BENCH_SMALL_START   (BENCH_BLOCK_START + BENCH_TOTAL_BLOCKS)  /* 小块写数据区 */
+#define BENCH_FAT_BLOCK     (BENCH_SMALL_START - 1U)                  /* 模拟FAT表扇区 */
+#define BENCH_CALIB_BLOCK   (BENCH_BLOCK_START - 64U)                 /* 时钟校准暂存区 */
+#define BENCH_PLAN_START    0x14000U            /* 日志写测试区（40MB处，4MB AU边界） */
+#define BENCH_PLAN_SPAN     8192U               /* 每个会话的区域块数 */
+#define BENCH_PLAN_SESSIONS 4U                  /* 会话数 */
+#define BENCH_PLAN_RECORDS  256U                /* 每个会话的记录数 */
+#define BENCH_PLAN_RECORD   1000U               /* 每条记录的字节数 */
+#define BENCH_PLAN_SKEW     777U                /* 未对齐时会话起点的偏移（块） */
+#define BENCH_PLAN_UNIT     32U                 /* 每次写卡的块数（16KB） */
+#define BENCH_PLAN_CHUNK    4096U               /* 单元对齐测试每次追加的字节数 */
+#define BENCH_META_BLOCK    (BENCH_PLAN_START - 1U)                   /* 模拟目录项扇区 */
+#define BENCH_SUITE_START   0x18000U            /* 测试套件区（48MB处） */
+#define BENCH_SUITE_BLOCKS  16384U              /* 测试套件区块数（8MB） */
+#define BENCH_SUITE_OPS     64U                 /* 测试套件每项传输次数 */
+#define BENCH_ALIGN_START   0x1C000U            /* 缓冲区对齐测试区（56MB处） */
+#define BENCH_ALIGN_BLOCKS  20U                 /* 每次传输块数（大于跳板缓冲区，跨段） */
+#define BENCH_ALIGN_GUARD   0x5AU               /* 缓冲区前后的哨兵字节 */
+#define BENCH_IOVEC_START   0x1C800U            /* 分散/聚集测试区 */
+#define BENCH_IOVEC_HEADER  100U                /* 未对齐场景的头部字节数 */
+#define BENCH_IOVEC_COHERENT 2U                 /* 与块缓存/写合并队列一致性测试的块数 */
+#define BENCH_SCHED_START   0x1D000U            /* 调度器测试：实时记录区 */
+#define BENCH_SCHED_LOG_BLOCKS  8U              /* 实时记录每次写入块数 */
+#define BENCH_SCHED_LOG_WRITES  128U            /* 实时记录写入次数 */
+#define BENCH_SCHED_RW_START  (BENCH_SCHED_START + (BENCH_SCHED_LOG_BLOCKS * BENCH_SCHED_LOG_WRITES))
+#define BENCH_SCHED_RW_SPAN   256U              /* 每个普通线程的区域块数 */
+#define BENCH_SCHED_RW_BLOCKS 4U                /* 普通线程每次写后读的块数 */
+#define BENCH_SCHED_RW_ROUNDS 64U               /* 普通线程轮数 */
+#define BENCH_SCHED_BG_BLOCKS 16U               /* 后台线程每次读取块数 */
+#define BENCH_SCHED_BG_READS  64U               /* 后台线程读取次数 */
+#define BENCH_SCHED_TIMEOUT   5000U             /* 等待请求完成的超时（毫秒） */
+#define BENCH_DISKIO_START  0x1D800U            /* diskio测试：两个模拟卷 */
+#define BENCH_DISKIO_SPAN   0x1100U             /* 每个模拟卷的扇区数 */
+#define BENCH_DISKIO_FAT    0U                  /* 卷内FAT扇区偏移 */
+#define BENCH_DISKIO_DIR    32U                 /* 卷内目录扇区偏移 */
+#define BENCH_DISKIO_DATA   64U                 /* 卷内数据区偏移 */
+#define BENCH_DISKIO_CLUSTER 64U                /* 簇大小（扇区，32KB） */
+#define BENCH_DISKIO_FILE_KB 2048U              /* 文件大小 */
+#define BENCH_DISKIO_CHUNK  4096U               /* 每次f_write()/f_read()的字节数 */
+#define BENCH_DISKIO_SYNC_KB 256U               /* 每写入多少KB调用一次f_sync() */
+#define BENCH_DISCARD_START 0x8000U             /* 丢弃测试区（16MB处，4MB AU边界） */
+#define BENCH_DISCARD_BLOCKS 8192U              /* 丢弃测试区块数（一个AU） */
+#define BENCH_DISCARD_PIECE 256U                /* 每次丢弃的块数（模拟逐个释放簇） */
+#define BENCH_LOG_START     0xA000U             /* 日志存储区（20MB处，3个AU：超级块+2段） */
+#define BENCH_LOG_END       0x10000U
+#define BENCH_LOG_BIG_START 0x20000U            /* 卡大于64MB时使用64MB之后的全部空间 */
+#define BENCH_LOG_RECORD    100U                /* 每条记录的字节数 */
+#define BENCH_LOG_RECORDS   120000U             /* 追加的记录数（约12MB，小区域时绕回覆盖） */
+#define BENCH_LOG_SYNC      10000U              /* 每多少条记录同步一次 */
+#define BENCH_CRC_START     0x4000U             /* CRC校验测试区（8MB处） */
+#define BENCH_CRC_BLOCKS    2048U               /* 受保护的块数（1MB），CRC表紧随其后 */
+#define BENCH_CRC_BAD       (BENCH_CRC_START + 100U)  /* 模拟位翻转的块 */
+#define BENCH_CRC_IOVEC_BLOCKS 4U               /* 分散/聚集写入受保护区的块数 */
+#define BENCH_RECOVER_START 0x6000U             /* 错误恢复测试区（12MB处） */
+#define BENCH_TIMEOUT_START 0x6800U             /* 超时测试区 */
+#define BENCH_QUEUE_START   0x7000U             /* 写合并队列刷新失败测试区 */
+#define BENCH_DUAL_START    0x2000U             /* 双卡测试区（4MB处，两张卡相同） */
+#define BENCH_DUAL_BLOCKS   4096U               /* 每张卡读写的块数（2MB） */
+#define BENCH_RAID_BLOCKS   4096U               /* 条带/镜像测试读写的虚拟块数（2MB），成员区域即双卡测试区 */
+#define BENCH_RAID_REQ      512U                /* 条带/镜像测试每次调用的块数（256KB） */
+#define BENCH_RAID_MIRROR_CHUNK 64U             /* 镜像读取的分片块数 */
+
+static uint8_t bench_buf[2][BENCH_HALF_BLOCKS * 512U] __attribute__((aligned(32)));
+
+#if (SD_TRACE_ENABLE != 0U)
+static uint8_t trace_dump[sizeof(SD_TraceHeaderTypeDef) + (SD_TRACE_DEPTH * sizeof(SD_TraceEventTypeDef))];
+
+/**
+  * @brief  检查导出的事件中卡忙开始/结束成对出现（最早的事件被覆盖时开头可以是结束）
+  */
+static int trace_check_busy(uint32_t Size)
+{
+  const SD_TraceHeaderTypeDef *hdr = (const SD_TraceHeaderTypeDef *)trace_dump;
+  const SD_TraceEventTypeDef *ev = (const SD_TraceEventTypeDef *)&trace_dump[sizeof(*hdr)];
+  uint8_t open = (hdr->Lost != 0U) ? 2U : 0U;  /* 2: 还不知道开头是否在卡忙中 */
+  uint32_t i;
+
+  for (i = 0U; (i < hdr->Count) && ((sizeof(*hdr) + ((i + 1U) * sizeof(*ev))) <= Size); i++)
+  {
+    if (ev[i].Type == SD_TRACE_EV_BUSY_START)
+    {
+      if (open == 1U)
+      {
+        break;
+      }
+      open = 1U;
+    }
+    else if (ev[i].Type == SD_TRACE_EV_BUSY_END)
+    {
+      if (open == 0U)
+      {
+        break;
+      }
+      open = 0U;
+    }
+    else
+    {
+    }
+  }
+  if (i < hdr->Count)
+  {
+    printf("[FAIL] 事件跟踪第%lu个事件的卡忙开始/结束不配对\n", (unsigned long)i);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+  * @brief  把事件跟踪导出到文件，由Drivers/BSP/Tools/sd_trace.py解析
+  */
+static int trace_save(const char *path)
+{
+  uint32_t n = SD_Trace_Dump(trace_dump, sizeof(trace_dump));
+  FILE *f;
+
+  if (trace_check_busy(n) != 0)
+  {
+    return 1;
+  }
+  f = fopen(path, "wb");
+
+  if ((f == NULL) || (fwrite(trace_dump, 1U, n, f) != n))
+  {
+    perror(path);
+    if (f != NULL)
+    {
+      (void)fclose(f);
+    }
+    return 1;
+  }
+  (void)fclose(f);
+  printf("[SIM] 事件跟踪: %lu字节 -> %s\r\n", (unsigned long)n, path);
+  return 0;
+}
+#endif
+
+static uint8_t bench_dtcm[BENCH_ALIGN_BLOCKS * 512U] __attribute__((aligned(32)));  /* 模拟放在DTCM的缓冲区 */
+
+/**
+  * @brief  仿真中主机地址都可由“IDMA”访问；bench_dtcm按DTCM处理，用于走跳板缓冲区
+  */
+uint8_t SD_IsDmaReachable(const void *pData, uint32_t Length)
+{
+  const uint8_t *p = (const uint8_t *)pData;
+
+  return ((p + Length <= bench_dtcm) || (p >= &bench_dtcm[sizeof(bench_dtcm)])) ? 1U : 0U;
+}
+
+/**
+  * @brief  等待卡就绪时让出CPU：模拟RTOS把这段时间交给其他任务，到时返回
+  */
+void SD_WaitYield(uint32_t Us)
+{
+  SIM_SD_AdvanceNs((uint64_t)Us * 1000U);
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+          "usage: %s [-i image] [-j image2] [-m size_mb] [-k kernel_hz] [-d clkdiv] [-w 1|4]\n"
+          "          [-c cmd_ns] [-a access_ns] [-b busy_ns] [-p block_busy_ns] [-q irq_period_ns]\n"
+          "          [-e preerased_block_ns] [-z erased_block_ns] [-s cmd23_support 0|1] [-g high_speed 0|1]\n"
+          "          [-x board_max_hz] [-u au_kb] [-r ru_merge_ns] [-n au_merge_ns] [-y crc_block_ns] [-t trace_file]\n"
+          "          [-v (SDSC card, CSD v1.0)]\n", prog);
+}
+
+/**
+  * @brief  打印一次测量结果
+  */
+static void bench_report(const char *name, uint32_t blocks, uint64_t ns)
+{
+  double mbps = ((double)blocks * 512.0) / ((double)ns / 1e9) / (1024.0 * 1024.0);
+  double bus = (double)SIM_SD_GetBusClockHz() *
+               (((hsd1.Instance->CLKCR & SDMMC_CLKCR_WIDBUS) == SDMMC_BUS_WIDE_4B) ? 4.0 : 1.0) / 8.0 *
+               (512.0 / (512.0 + 4.5)) / (1024.0 * 1024.0);
+
+  printf("[SIM] %-24s %6lu块 %9.3f ms  %6.2f MB/s (总线上限的 %.1f%%)\r\n", name, (unsigned long)blocks,
+         (double)ns / 1e6, mbps, mbps * 100.0 / bus);
+}
+
+#if (SD_CALIB_ENABLE != 0U)
+static SD_CalibResultTypeDef bench_calib_saved;   /* 模拟内部Flash中保存的校准结果 */
+static uint8_t bench_calib_valid;
+
+HAL_StatusTypeDef SD_Calib_SaveHook(const SD_CalibResultTypeDef *pResult)
+{
+  bench_calib_saved = *pResult;
+  bench_calib_valid = 1U;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef SD_Calib_LoadHook(SD_CalibResultTypeDef *pResult)
+{
+  if (bench_calib_valid == 0U)
+  {
+    return HAL_ERROR;
+  }
+  *pResult = bench_calib_saved;
+  return HAL_OK;
+}
+
+/**
+  * @brief  时钟校准：找出最高稳定时钟，再模拟下次上电从保存的结果恢复
+  */
+static int bench_calib(void)
+{
+  SD_CalibResultTypeDef result;
+  SIM_SD_StatsTypeDef st;
+  uint64_t t0 = SIM_SD_GetTimeNs();
+
+  SIM_SD_ResetStats();
+  if (SD_Calibrate(BENCH_CALIB_BLOCK, &result) != HAL_OK)
+  {
+    return 1;
+  }
+  SIM_SD_GetStats(&st);
+  printf("[SIM] 时钟校准: 试%lu级, 最高稳定 %lu Hz, 选用 %lu Hz, CRC错误 %lu次, 耗时 %.3f ms\r\n",
+         (unsigned long)result.StepsTried, (unsigned long)result.MaxStableHz, (unsigned long)result.ClockHz,
+         (unsigned long)st.CrcErrors, (double)(SIM_SD_GetTimeNs() - t0) / 1e6);
+
+  /* 下次上电：SD_Init后直接套用保存的结果 */
+  if ((SD_SetClockDiv(SD_CLOCKDIV_DEFAULT) != HAL_OK) || (SD_Calib_Restore() != HAL_OK) ||
+      (SD_GetClockDiv() != result.ClockDiv))
+  {
+    return 1;
+  }
+  printf("[SIM] 校准结果恢复: SDMMC_CK = %lu Hz\r\n", (unsigned long)SIM_SD_GetBusClockHz());
+
+  return 0;
+}
+#endif
+
+static volatile HAL_StatusTypeDef bench_change_status;  /* 双缓冲回调中换成不可访问缓冲区的结果 */
+
+/**
+  * @brief  双缓冲读取的缓冲区回调：试图换成“DTCM”中的缓冲区
+  */
+static void bench_change_cplt(SD_RequestTypeDef *pReq, uint32_t BufferIndex)
+{
+  (void)pReq;
+  if (bench_change_status == HAL_BUSY)
+  {
+    bench_change_status = SD_ChangeDoubleBuffer(BufferIndex, bench_dtcm);
+  }
+}
+
+/**
+  * @brief  连续写入对比：逐次SD_WriteBlocks vs 双缓冲流式写入
+  */
+static int bench_stream(void)
+{
+  SD_RequestTypeDef req = {0};
+  SD_StreamTypeDef stream;
+  uint64_t t0;
+  uint32_t i;
+  uint8_t *p;
+
+  /* 1. 每半缓冲一次SD_WriteBlocks：CMD25 + CMD12 + 编程忙等待 */
+  t0 = SIM_SD_GetTimeNs();
+  for (i = 0U; i < (BENCH_TOTAL_BLOCKS / BENCH_HALF_BLOCKS); i++)
+  {
+    memset(bench_buf[0], (int)i, sizeof(bench_buf[0]));
+    if (SD_WriteBlocks(bench_buf[0], BENCH_BLOCK_START + (i * BENCH_HALF_BLOCKS), BENCH_HALF_BLOCKS,
+                       SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+  }
+  (void)SD_WaitReady(SD_TIMEOUT_LONG);
+  bench_report("SD_WriteBlocks x64", BENCH_TOTAL_BLOCKS, SIM_SD_GetTimeNs() - t0);
+
+  /* 2. 双缓冲流式写入：一次CMD25，边填边传；缓冲区未按缓存行对齐或IDMA不可访问时拒绝 */
+  if ((SD_Stream_Open(&stream, &bench_buf[0][4], bench_buf[1], BENCH_HALF_BLOCKS,
+                      BENCH_BLOCK_START, BENCH_TOTAL_BLOCKS) != HAL_ERROR) ||
+      (SD_Stream_Open(&stream, bench_buf[0], bench_dtcm, 1U, BENCH_BLOCK_START, BENCH_TOTAL_BLOCKS) != HAL_ERROR) ||
+      (SD_WriteBlocksDoubleBufferAsync(bench_buf[0], &bench_buf[1][4], BENCH_HALF_BLOCKS, BENCH_BLOCK_START,
+                                       BENCH_TOTAL_BLOCKS, &stream.Req) != HAL_ERROR))
+  {
+    printf("[FAIL] 双缓冲写入未拒绝未对齐或IDMA不可访问的缓冲区\n");
+    return 1;
+  }
+  t0 = SIM_SD_GetTimeNs();
+  if (SD_Stream_Open(&stream, bench_buf[0], bench_buf[1], BENCH_HALF_BLOCKS,
+                     BENCH_BLOCK_START, BENCH_TOTAL_BLOCKS) != HAL_OK)
+  {
+    return 1;
+  }
+  i = 0U;
+  while (i < (BENCH_TOTAL_BLOCKS / BENCH_HALF_BLOCKS))
+  {
+    p = SD_Stream_GetBuffer(&stream);
+    if (p == NULL)
+    {
+      (void)HAL_GetTick();  /* 模拟应用在等待期间做别的事 */
+      continue;
+    }
+    memset(p, (int)i, BENCH_HALF_BLOCKS * 512U);
+    if (SD_Stream_Commit(&stream) != HAL_OK)
+    {
+      return 1;
+    }
+    i++;
+  }
+  if (SD_Stream_Close(&stream, SD_TIMEOUT_LONG) != HAL_OK)
+  {
+    return 1;
+  }
+  (void)SD_WaitReady(SD_TIMEOUT_LONG);
+  bench_report("SD_Stream (双缓冲)", SD_Stream_GetWrittenBlocks(&stream), SIM_SD_GetTimeNs() - t0);
+  if (stream.Underruns != 0U)
+  {
+    return 1;
+  }
+
+  /* 3. 双缓冲读取中途换成IDMA不可访问的缓冲区：拒绝，传输照常完成 */
+  bench_change_status = HAL_BUSY;
+  req.BufferCallback = bench_change_cplt;
+  if ((SD_ReadBlocksDoubleBufferAsync(bench_buf[0], bench_buf[1], BENCH_HALF_BLOCKS, BENCH_BLOCK_START,
+                                      4U * BENCH_HALF_BLOCKS, &req) != HAL_OK) ||
+      (SD_WaitRequest(&req, SD_TIMEOUT_LONG) != HAL_OK) || (bench_change_status != HAL_ERROR) ||
+      (bench_buf[1][0] != 3U))
+  {
+    printf("[FAIL] 双缓冲读取未拒绝IDMA不可访问的新缓冲区\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+#if (SD_TRACE_ENABLE != 0U)
+/**
+  * @brief  事件跟踪：写入后的等待、立即超时与只等1毫秒的等待都不留下不配对的卡忙事件
+  * @note   重新开始记录，只在未用-t导出整个运行的跟踪时调用
+  */
+static int bench_trace(void)
+{
+  uint32_t n;
+  int ret = 0;
+
+  memset(bench_buf[0], 0x3C, BENCH_HALF_BLOCKS * 512U);
+  SD_Trace_Start();
+  if ((SD_WriteBlocksDirect(bench_buf[0], BENCH_BLOCK_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_WaitReady(0U) == HAL_OK) || (SD_WaitReady(1U) == HAL_ERROR) || (SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    ret = 1;
+  }
+  SD_Trace_Stop();
+  n = SD_Trace_Dump(trace_dump, sizeof(trace_dump));
+  if ((ret != 0) || (trace_check_busy(n) != 0))
+  {
+    return 1;
+  }
+
+  return 0;
+}
+#endif
+
+#if (SD_STATS_ENABLE != 0U)
+/**
+  * @brief  长时间连续写入期间等待卡就绪的开销：CMD13次数与可让给其他任务的CPU时间
+  */
+static int bench_wait(void)
+{
+  SD_StatsTypeDef before;
+  SD_StatsTypeDef after;
+  SIM_SD_StatsTypeDef sim_before;
+  SIM_SD_StatsTypeDef sim_after;
+  uint64_t t0;
+  double wait_ms;
+  double yield_ms;
+  uint32_t i;
+
+  SD_GetStats(&before);
+  SIM_SD_GetStats(&sim_before);
+  t0 = SIM_SD_GetTimeNs();
+  for (i = 0U; i < (BENCH_TOTAL_BLOCKS / BENCH_HALF_BLOCKS); i++)
+  {
+    memset(bench_buf[0], (int)i, sizeof(bench_buf[0]));  /* 与bench_stream()相同，供顺序读测试校验 */
+    if (SD_WriteBlocks(bench_buf[0], BENCH_BLOCK_START + (i * BENCH_HALF_BLOCKS), BENCH_HALF_BLOCKS,
+                       SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+  }
+  if ((SD_Flush(SD_TIMEOUT_LONG) != HAL_OK) || (SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    return 1;
+  }
+  bench_report("长写入 SD_WriteBlocks x64", BENCH_TOTAL_BLOCKS, SIM_SD_GetTimeNs() - t0);
+  SD_GetStats(&after);
+  SIM_SD_GetStats(&sim_after);
+
+  wait_ms = (double)(after.WaitReady.Cycles - before.WaitReady.Cycles) / (double)after.CyclesPerUs / 1e3;
+  yield_ms = (double)(after.WaitYieldCycles - before.WaitYieldCycles) / (double)after.CyclesPerUs / 1e3;
+  printf("[SIM] 等待就绪 %.3f ms: CMD13 %lu次（仿真计 %lu次）, DAT0忙结束 %lu次, 让出CPU %.3f ms (%.1f%%)\r\n",
+         wait_ms, (unsigned long)(after.WaitPolls - before.WaitPolls),
+         (unsigned long)(sim_after.StatusPolls - sim_before.StatusPolls),
+         (unsigned long)(after.WaitBusyEnds - before.WaitBusyEnds), yield_ms,
+         (wait_ms > 0.0) ? (yield_ms * 100.0 / wait_ms) : 0.0);
+
+  return 0;
+}
+#endif
+
+/**
+  * @brief  顺序小块读取对比：直接读卡 vs SD_ReadBlocks（启用预取时经过预取器）
+  */
+static int bench_seqread(void)
+{
+  uint64_t t0;
+  uint32_t i;
+  uint32_t pass;
+
+  for (pass = 0U; pass < 2U; pass++)
+  {
+    t0 = SIM_SD_GetTimeNs();
+    for (i = 0U; i < BENCH_TOTAL_BLOCKS; i += BENCH_READ_BLOCKS)
+    {
+      HAL_StatusTypeDef status = (pass == 0U) ?
+          SD_ReadBlocksDirect(bench_buf[0], BENCH_BLOCK_START + i, BENCH_READ_BLOCKS, SD_TIMEOUT_LONG) :
+          SD_ReadBlocks(bench_buf[0], BENCH_BLOCK_START + i, BENCH_READ_BLOCKS, SD_TIMEOUT_LONG);
+      if ((status != HAL_OK) || (bench_buf[0][0] != (uint8_t)(i / BENCH_HALF_BLOCKS)))
+      {
+        return 1;
+      }
+      SIM_SD_AdvanceNs(BENCH_READ_CPU_NS);  /* 应用处理数据 */
+    }
+    bench_report((pass == 0U) ? "顺序读 Direct x4块" : "顺序读 SD_ReadBlocks x4块", BENCH_TOTAL_BLOCKS,
+                 SIM_SD_GetTimeNs() - t0);
+  }
+
+#if (SD_PREFETCH_ENABLE != 0U)
+  {
+    SD_PrefetchStatsTypeDef ps;
+
+    SD_Prefetch_GetStats(&ps);
+    printf("[SIM] 预取: 命中 %lu, 未命中 %lu, 预读 %lu, 浪费 %lu, 等待 %lu, 绕过 %lu\r\n",
+           (unsigned long)ps.Hits, (unsigned long)ps.Misses, (unsigned long)ps.Prefetched,
+           (unsigned long)ps.Wasted, (unsigned long)ps.Waits, (unsigned long)ps.Bypasses);
+  }
+#endif
+
+  return 0;
+}
+
+#if (SD_QUEUE_ENABLE != 0U) && (SD_RECOVER_ENABLE == 0U)
+/**
+  * @brief  写合并队列放不下时刷新失败：本次写入的块不入队，原有的块保留，恢复后刷新写卡
+  */
+static int bench_queue_fail(void)
+{
+  SD_QueueStatsTypeDef qs;
+  uint32_t fill = SD_QUEUE_BLOCKS - 1U;
+  uint32_t target = BENCH_QUEUE_START + SD_QUEUE_BLOCKS;
+  uint32_t i;
+
+  memset(bench_buf[1], 0x11, 1024U);
+  if ((SD_Queue_Sync(SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_WriteBlocksDirect(bench_buf[1], target, 2U, SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    return 1;
+  }
+
+  /* 1. 填到只剩一个空槽 */
+  for (i = 0U; i < fill; i++)
+  {
+    memset(bench_buf[0], (int)(uint8_t)(0xA0U + i), 512U);
+    if (SD_Queue_Write(bench_buf[0], BENCH_QUEUE_START + i, 1U, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+  }
+
+  /* 2. 两块放不下，先刷新，刷新失败 */
+  memset(bench_buf[0], 0x22, 1024U);
+  SIM_SD_InjectFault(SIM_SD_FAULT_CRC, 1U);
+  if (SD_Queue_Write(bench_buf[0], target, 2U, SD_TIMEOUT_LONG) == HAL_OK)
+  {
+    printf("[FAIL] 写合并队列刷新失败未返回错误\n");
+    return 1;
+  }
+  SD_Queue_GetStats(&qs);
+  if (qs.PendingBlocks != fill)
+  {
+    printf("[FAIL] 写合并队列刷新失败后排队 %lu块（应为 %lu块）\n", (unsigned long)qs.PendingBlocks,
+           (unsigned long)fill);
+    return 1;
+  }
+
+  /* 3. 恢复后刷新：原有的块写卡，失败的那次写入未写卡 */
+  if ((SD_Queue_Sync(SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocksDirect(bench_buf[0], BENCH_QUEUE_START, fill, SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    return 1;
+  }
+  for (i = 0U; i < fill; i++)
+  {
+    if (bench_buf[0][i * 512U] != (uint8_t)(0xA0U + i))
+    {
+      return 1;
+    }
+  }
+  if ((SD_ReadBlocksDirect(bench_buf[0], target, 2U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (memcmp(bench_buf[0], bench_buf[1], 1024U) != 0))
+  {
+    printf("[FAIL] 写合并队列刷新失败的写入仍写到了卡上\n");
+    return 1;
+  }
+
+  return 0;
+}
+#endif
+
+/**
+  * @brief  文件系统式小块写入对比：逐次直接写卡 vs SD_WriteBlocks + SD_Flush（启用写合并队列时合并）
+  * @note   每次写2块相邻数据，每4次改写一次同一个FAT扇区
+  */
+static int bench_smallwrite(void)
+{
+  uint64_t t0;
+  uint32_t i;
+  uint32_t k;
+  uint32_t blk;
+  uint32_t pass;
+  uint8_t fat = 0U;
+  HAL_StatusTypeDef status;
+
+  for (pass = 0U; pass < 2U; pass++)
+  {
+    t0 = SIM_SD_GetTimeNs();
+    for (i = 0U; i < BENCH_SMALL_WRITES; i++)
+    {
+      blk = BENCH_SMALL_START + (i * 2U);
+      memset(bench_buf[0], (int)(uint8_t)(blk + pass), 512U);
+      memset(&bench_buf[0][512], (int)(uint8_t)(blk + 1U + pass), 512U);
+      status = (pass == 0U) ? SD_WriteBlocksDirect(bench_buf[0], blk, 2U, SD_TIMEOUT_LONG) :
+                              SD_WriteBlocks(bench_buf[0], blk, 2U, SD_TIMEOUT_LONG);
+      if ((status == HAL_OK) && ((i % 4U) == 3U))
+      {
+        fat = (uint8_t)(i + pass);
+        memset(bench_buf[1], (int)fat, 512U);
+        status = (pass == 0U) ? SD_WriteBlocksDirect(bench_buf[1], BENCH_FAT_BLOCK, 1U, SD_TIMEOUT_LONG) :
+                                SD_WriteBlocks(bench_buf[1], BENCH_FAT_BLOCK, 1U, SD_TIMEOUT_LONG);
+      }
+      if (status != HAL_OK)
+      {
+        return 1;
+      }
+      SIM_SD_AdvanceNs(20000U);  /* 应用准备下一次数据 */
+    }
+    if ((SD_Flush(SD_TIMEOUT_LONG) != HAL_OK) || (SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK))
+    {
+      return 1;
+    }
+    bench_report((pass == 0U) ? "小块写 Direct x2块" : "小块写 SD_WriteBlocks x2块",
+                 BENCH_SMALL_WRITES * 2U + (BENCH_SMALL_WRITES / 4U), SIM_SD_GetTimeNs() - t0);
+
+    /* 校验卡上内容 */
+    for (i = 0U; i < (BENCH_SMALL_WRITES * 2U); i += BENCH_HALF_BLOCKS)
+    {
+      if (SD_ReadBlocksDirect(bench_buf[0], BENCH_SMALL_START + i, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK)
+      {
+        return 1;
+      }
+      for (k = 0U; k < BENCH_HALF_BLOCKS; k++)
+      {
+        if (bench_buf[0][k * 512U] != (uint8_t)(BENCH_SMALL_START + i + k + pass))
+        {
+          return 1;
+        }
+      }
+    }
+    if ((SD_ReadBlocksDirect(bench_buf[1], BENCH_FAT_BLOCK, 1U, SD_TIMEOUT_LONG) != HAL_OK) ||
+        (bench_buf[1][0] != fat))
+    {
+      return 1;
+    }
+  }
+
+#if (SD_QUEUE_ENABLE != 0U)
+  {
+    SD_QueueStatsTypeDef qs;
+
+    SD_Queue_GetStats(&qs);
+    if (qs.Transfers != 0U)
+    {
+      printf("[SIM] 写合并: 请求 %lu, 写命令 %lu (合并比 %.1f), 平均 %.1f块/次, 覆盖 %lu块, "
+             "刷新 满%lu/期限%lu/同步%lu\r\n",
+             (unsigned long)qs.SubmittedWrites, (unsigned long)qs.Transfers,
+             (double)qs.SubmittedWrites / (double)qs.Transfers,
+             (double)qs.TransferBlocks / (double)qs.Transfers, (unsigned long)qs.Overwrites,
+             (unsigned long)qs.FullFlushes, (unsigned long)qs.DeadlineFlushes, (unsigned long)qs.SyncFlushes);
+    }
+  }
+#endif
+#if (SD_QUEUE_ENABLE != 0U) && (SD_RECOVER_ENABLE == 0U)
+  return bench_queue_fail();
+#else
+  return 0;
+#endif
+}
+
+/**
+  * @brief  缓冲区对齐：按各种偏移写入、读回并校验，检查缓冲区外的字节未被改动
+  */
+static int bench_align(void)
+{
+  static const uint32_t offsets[] = {0U, 4U, 8U, 1U, 2U};
+  static uint8_t area[(BENCH_ALIGN_BLOCKS * 512U) + 64U] __attribute__((aligned(32)));
+  uint8_t *wr = &bench_buf[0][0];
+  uint8_t *p;
+  uint32_t k;
+  uint32_t i;
+  uint32_t len = BENCH_ALIGN_BLOCKS * 512U;
+
+  for (k = 0U; k <= (sizeof(offsets) / sizeof(offsets[0])); k++)
+  {
+    /* 最后一轮为“DTCM”中的缓冲区 */
+    p = (k < (sizeof(offsets) / sizeof(offsets[0]))) ? &area[offsets[k]] : bench_dtcm;
+    for (i = 0U; i < len; i++)
+    {
+      wr[i] = (uint8_t)((i * 7U) + (k * 13U) + (i >> 9));
+    }
+
+    /* 从该缓冲区写入 */
+    memset(area, BENCH_ALIGN_GUARD, sizeof(area));
+    memcpy(p, wr, len);
+    if (SD_WriteBlocksDirect(p, BENCH_ALIGN_START, BENCH_ALIGN_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+
+    /* 读回到同一位置 */
+    memset(area, BENCH_ALIGN_GUARD, sizeof(area));
+    memset(bench_dtcm, 0, sizeof(bench_dtcm));
+    if ((SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK) ||
+        (SD_ReadBlocksDirect(p, BENCH_ALIGN_START, BENCH_ALIGN_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+        (memcmp(p, wr, len) != 0))
+    {
+      printf("[FAIL] 偏移 %lu 读回数据不符\n", (unsigned long)((p == bench_dtcm) ? 0U : offsets[k]));
+      return 1;
+    }
+    for (i = 0U; (p != bench_dtcm) && (i < sizeof(area)); i++)
+    {
+      if (((i < offsets[k]) || (i >= (offsets[k] + len))) && (area[i] != BENCH_ALIGN_GUARD))
+      {
+        printf("[FAIL] 偏移 %lu 缓冲区外第%lu字节被改写\n", (unsigned long)offsets[k], (unsigned long)i);
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+  * @brief  分散/聚集：一次写入头部+数据两段，读回到另一组段并逐字节比较
+  * @param  name: 场景名
+  * @param  pWr: 写入的段数组
+  * @param  pRd: 读回的段数组（与pWr各段长度相同）
+  * @param  Count: 段数
+  */
+static int bench_iovec_case(const char *name, const SD_IoVecTypeDef *pWr, const SD_IoVecTypeDef *pRd, uint32_t Count)
+{
+  SIM_SD_StatsTypeDef s0;
+  SIM_SD_StatsTypeDef s1;
+  uint64_t t0;
+  uint32_t blocks = 0U;
+  uint32_t i;
+
+  for (i = 0U; i < Count; i++)
+  {
+    blocks += pWr[i].Length;
+    if (pRd[i].Length != 0U)
+    {
+      memset(pRd[i].pBuf, 0, pRd[i].Length);
+    }
+  }
+  blocks /= 512U;
+
+  SIM_SD_GetStats(&s0);
+  t0 = SIM_SD_GetTimeNs();
+  if ((SD_WriteBlocksV(pWr, Count, BENCH_IOVEC_START, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocksV(pRd, Count, BENCH_IOVEC_START, SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    printf("[FAIL] %s: 传输失败\n", name);
+    return 1;
+  }
+  SIM_SD_GetStats(&s1);
+  bench_report(name, blocks * 2U, SIM_SD_GetTimeNs() - t0);
+
+  for (i = 0U; i < Count; i++)
+  {
+    if ((pWr[i].Length != 0U) && (memcmp(pWr[i].pBuf, pRd[i].pBuf, pWr[i].Length) != 0))
+    {
+      printf("[FAIL] %s: 第%lu段读回数据不符\n", name, (unsigned long)i);
+      return 1;
+    }
+  }
+
+#if (SD_USE_IDMA != 0U)
+  /* 各一条CMD25、CMD18 */
+  if (((s1.WriteCmds - s0.WriteCmds) != 1U) || ((s1.ReadCmds - s0.ReadCmds) != 1U))
+  {
+    printf("[FAIL] %s: 写命令%lu条、读命令%lu条，应各为1条\n", name,
+           (unsigned long)(s1.WriteCmds - s0.WriteCmds), (unsigned long)(s1.ReadCmds - s0.ReadCmds));
+    return 1;
+  }
+#endif
+
+  return 0;
+}
+
+/**
+  * @brief  分散/聚集读写与块缓存、写合并队列一致：SD_WriteBlocksV()改写已缓存的块后SD_ReadBlocks()读到新数据，
+  *         SD_ReadBlocksV()读到还在缓存或队列中的数据
+  * @param  pRd: 读回缓冲区（32字节对齐，至少BENCH_IOVEC_COHERENT块）
+  */
+static int bench_iovec_coherent(uint8_t *pRd)
+{
+  static const uint8_t fill[3] = {0x11U, 0x22U, 0x33U};
+  uint32_t blk = BENCH_IOVEC_START + 32U;
+  uint32_t len = BENCH_IOVEC_COHERENT * 512U;
+  SD_IoVecTypeDef wv[2];
+  SD_IoVecTypeDef rv[2];
+  uint32_t i;
+
+  wv[0].pBuf = &bench_buf[1][0];
+  wv[0].Length = 512U;
+  wv[1].pBuf = &bench_buf[1][512U];
+  wv[1].Length = len - 512U;
+  rv[0].pBuf = pRd;
+  rv[0].Length = 512U;
+  rv[1].pBuf = &pRd[512U];
+  rv[1].Length = len - 512U;
+
+  /* 1. 写入并读入块缓存 */
+  memset(bench_buf[1], fill[0], len);
+  if ((SD_WriteBlocks(bench_buf[1], blk, BENCH_IOVEC_COHERENT, SD_TIMEOUT_DEFAULT) != HAL_OK) ||
+      (SD_Flush(SD_TIMEOUT_DEFAULT) != HAL_OK) ||
+      (SD_ReadBlocks(pRd, blk, BENCH_IOVEC_COHERENT, SD_TIMEOUT_DEFAULT) != HAL_OK))
+  {
+    return 1;
+  }
+
+  /* 2. 分散/聚集写入后，经前门读到新数据 */
+  memset(bench_buf[1], fill[1], len);
+  memset(pRd, 0, len);
+  if ((SD_WriteBlocksV(wv, 2U, blk, SD_TIMEOUT_DEFAULT) != HAL_OK) || (SD_Flush(SD_TIMEOUT_DEFAULT) != HAL_OK) ||
+      (SD_ReadBlocks(pRd, blk, BENCH_IOVEC_COHERENT, SD_TIMEOUT_DEFAULT) != HAL_OK))
+  {
+    printf("[FAIL] 分散/聚集写入后前门读取失败\n");
+    return 1;
+  }
+  for (i = 0U; i < len; i++)
+  {
+    if (pRd[i] != fill[1])
+    {
+      printf("[FAIL] 分散/聚集写入后前门读到旧数据: 字节%lu = 0x%02X\n", (unsigned long)i, pRd[i]);
+      return 1;
+    }
+  }
+
+  /* 3. 前门写入尚未刷新时，分散/聚集读取读到新数据 */
+  memset(bench_buf[1], fill[2], len);
+  memset(pRd, 0, len);
+  if ((SD_WriteBlocks(bench_buf[1], blk, BENCH_IOVEC_COHERENT, SD_TIMEOUT_DEFAULT) != HAL_OK) ||
+      (SD_ReadBlocksV(rv, 2U, blk, SD_TIMEOUT_DEFAULT) != HAL_OK))
+  {
+    printf("[FAIL] 前门写入后分散/聚集读取失败\n");
+    return 1;
+  }
+  for (i = 0U; i < len; i++)
+  {
+    if (pRd[i] != fill[2])
+    {
+      printf("[FAIL] 前门写入后分散/聚集读到旧数据: 字节%lu = 0x%02X\n", (unsigned long)i, pRd[i]);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+  * @brief  分散/聚集读写：段边界在块边界上（零复制）和不在块边界上（暂存）两种情况
+  */
+static int bench_iovec(void)
+{
+  static uint8_t rd[(BENCH_HALF_BLOCKS * 512U) + 64U] __attribute__((aligned(32)));
+  uint8_t *wr = &bench_buf[0][0];
+  SD_IoVecTypeDef wv[3];
+  SD_IoVecTypeDef rv[3];
+  uint32_t len = 16U * 512U;
+  uint32_t i;
+
+  for (i = 0U; i < len; i++)
+  {
+    wr[i] = (uint8_t)((i * 13U) + (i >> 9) + 5U);
+  }
+
+  /* 1块头部 + 15块数据，分别放在两个缓冲区中 */
+  wv[0].pBuf = &bench_buf[1][0];
+  wv[0].Length = 512U;
+  memcpy(wv[0].pBuf, "HDR0", 4U);
+  wv[1].pBuf = &wr[512U];
+  wv[1].Length = 15U * 512U;
+  rv[0].pBuf = &rd[15U * 512U];
+  rv[0].Length = 512U;
+  rv[1].pBuf = &rd[0];
+  rv[1].Length = 15U * 512U;
+  if (bench_iovec_case("SD_xxxBlocksV (块对齐)", wv, rv, 2U) != 0)
+  {
+    return 1;
+  }
+
+  /* 100字节头部 + 空段 + 未对齐的数据，合计16块；读回到奇数地址 */
+  wv[0].Length = BENCH_IOVEC_HEADER;
+  wv[1].pBuf = NULL;
+  wv[1].Length = 0U;
+  wv[2].pBuf = &wr[1];
+  wv[2].Length = len - BENCH_IOVEC_HEADER;
+  rv[0].pBuf = &rd[(BENCH_HALF_BLOCKS * 512U) - 128U];
+  rv[0].Length = BENCH_IOVEC_HEADER;
+  rv[1].pBuf = NULL;
+  rv[1].Length = 0U;
+  rv[2].pBuf = &rd[3];
+  rv[2].Length = len - BENCH_IOVEC_HEADER;
+  if (bench_iovec_case("SD_xxxBlocksV (暂存)", wv, rv, 3U) != 0)
+  {
+    return 1;
+  }
+
+  return bench_iovec_coherent(rd);
+}
+
+#if (SD_SCHED_ENABLE != 0U)
+/**
+  * @brief  调度器测试中各线程的数据块内容：块号和轮次
+  */
+static void bench_sched_fill(uint8_t *p, uint32_t Blocks, uint32_t BlockAdd, uint32_t Round)
+{
+  uint32_t i;
+
+  for (i = 0U; i < (Blocks * 512U); i++)
+  {
+    p[i] = (uint8_t)((BlockAdd + (i >> 9)) * 31U + Round + i);
+  }
+}
+
+static volatile uint32_t bench_sched_callbacks;  /* 实时写入的完成回调次数（只在执行者线程中修改） */
+static volatile uint32_t bench_sched_errors;
+
+static void bench_sched_done(SD_SchedReqTypeDef *pReq)
+{
+  (void)pReq;
+  bench_sched_callbacks++;
+}
+
+/**
+  * @brief  实时记录线程：顺序追加写入，异步提交、回调计数
+  */
+static void *bench_sched_logger(void *arg)
+{
+  static uint8_t buf[2][BENCH_SCHED_LOG_BLOCKS * 512U] __attribute__((aligned(32)));
+  SD_SchedReqTypeDef req[2];
+  uint32_t i;
+
+  (void)arg;
+  memset(req, 0, sizeof(req));
+  for (i = 0U; i < BENCH_SCHED_LOG_WRITES; i++)
+  {
+    SD_SchedReqTypeDef *r = &req[i & 1U];
+    uint32_t blk = BENCH_SCHED_START + (i * BENCH_SCHED_LOG_BLOCKS);
+
+    /* 两个请求交替使用：提交下一个之前等上上个完成 */
+    if ((i >= 2U) && (SD_Sched_Wait(r, BENCH_SCHED_TIMEOUT) != HAL_OK))
+    {
+      bench_sched_errors++;
+    }
+    bench_sched_fill(buf[i & 1U], BENCH_SCHED_LOG_BLOCKS, blk, 0U);
+    r->Op = SD_SCHED_OP_WRITE;
+    r->Priority = SD_SCHED_PRIO_RT;
+    r->pData = buf[i & 1U];
+    r->BlockAdd = blk;
+    r->NumberOfBlocks = BENCH_SCHED_LOG_BLOCKS;
+    r->Callback = bench_sched_done;
+    if (SD_Sched_Submit(r) != HAL_OK)
+    {
+      bench_sched_errors++;
+    }
+    usleep(200U);
+  }
+  for (i = 0U; i < 2U; i++)
+  {
+    if (SD_Sched_Wait(&req[i], BENCH_SCHED_TIMEOUT) != HAL_OK)
+    {
+      bench_sched_errors++;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  * @brief  普通线程：写入后不等完成立即提交同一区间的读取，读回的必须是刚写入的数据
+  */
+static void *bench_sched_normal(void *arg)
+{
+  static uint8_t buf[2][2][BENCH_SCHED_RW_BLOCKS * 512U] __attribute__((aligned(32)));
+  uint32_t id = (uint32_t)(uintptr_t)arg;
+  uint8_t *wr = buf[id][0];
+  uint8_t *rd = buf[id][1];
+  SD_SchedReqTypeDef w;
+  SD_SchedReqTypeDef r;
+  uint32_t i;
+
+  for (i = 0U; i < BENCH_SCHED_RW_ROUNDS; i++)
+  {
+    uint32_t blk = BENCH_SCHED_RW_START + (id * BENCH_SCHED_RW_SPAN) + ((i * 5U) % (BENCH_SCHED_RW_SPAN - BENCH_SCHED_RW_BLOCKS));
+
+    bench_sched_fill(wr, BENCH_SCHED_RW_BLOCKS, blk, i + 1U);
+    memset(rd, 0, BENCH_SCHED_RW_BLOCKS * 512U);
+    memset(&w, 0, sizeof(w));
+    w.Op = SD_SCHED_OP_WRITE;
+    w.Priority = SD_SCHED_PRIO_NORMAL;
+    w.pData = wr;
+    w.BlockAdd = blk;
+    w.NumberOfBlocks = BENCH_SCHED_RW_BLOCKS;
+    r = w;
+    r.Op = SD_SCHED_OP_READ;
+    r.pData = rd;
+    if ((SD_Sched_Submit(&w) != HAL_OK) || (SD_Sched_Submit(&r) != HAL_OK) ||
+        (SD_Sched_Wait(&r, BENCH_SCHED_TIMEOUT) != HAL_OK) || (SD_Sched_Wait(&w, BENCH_SCHED_TIMEOUT) != HAL_OK) ||
+        (memcmp(wr, rd, BENCH_SCHED_RW_BLOCKS * 512U) != 0))
+    {
+      printf("[FAIL] 调度器: 线程%lu 第%lu轮 写后读不一致\r\n", (unsigned long)id, (unsigned long)i);
+      bench_sched_errors++;
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  * @brief  后台线程：同步扫描读取记录区
+  */
+static void *bench_sched_background(void *arg)
+{
+  static uint8_t buf[BENCH_SCHED_BG_BLOCKS * 512U] __attribute__((aligned(32)));
+  uint32_t i;
+
+  (void)arg;
+  for (i = 0U; i < BENCH_SCHED_BG_READS; i++)
+  {
+    if (SD_Sched_Read(buf, BENCH_SCHED_START + (i * BENCH_SCHED_BG_BLOCKS), BENCH_SCHED_BG_BLOCKS,
+                      SD_SCHED_PRIO_BACKGROUND, BENCH_SCHED_TIMEOUT) != HAL_OK)
+    {
+      bench_sched_errors++;
+    }
+  }
+
+  return NULL;
+}
+
+static void *bench_sched_worker(void *arg)
+{
+  (void)arg;
+  SD_Sched_Run();
+  return NULL;
+}
+
+/**
+  * @brief  冲突推迟统计：同一个请求在多轮选择中都被挡住，只计一次
+  * @note   没有执行者线程，由SD_Sched_Poll()逐个执行；使用两个普通线程区域之后的空闲块
+  */
+static int bench_sched_held(void)
+{
+  const uint32_t base = BENCH_SCHED_RW_START + (2U * BENCH_SCHED_RW_SPAN);
+  SD_SchedReqTypeDef req[4];
+  SD_SchedStatsTypeDef ss;
+  uint32_t i;
+
+  (void)SD_Sched_Init();
+  memset(req, 0, sizeof(req));
+  /* 先执行一次把电梯位置放到base之后，再排队：两个后台写入（低地址的先执行），一个与高地址写入重叠的实时读取 */
+  req[0] = (SD_SchedReqTypeDef){ .Op = SD_SCHED_OP_READ, .Priority = SD_SCHED_PRIO_BACKGROUND,
+                                 .pData = bench_buf[0], .BlockAdd = base, .NumberOfBlocks = 8U };
+  req[1] = (SD_SchedReqTypeDef){ .Op = SD_SCHED_OP_WRITE, .Priority = SD_SCHED_PRIO_BACKGROUND,
+                                 .pData = bench_buf[0], .BlockAdd = base + 64U, .NumberOfBlocks = 8U };
+  req[2] = (SD_SchedReqTypeDef){ .Op = SD_SCHED_OP_WRITE, .Priority = SD_SCHED_PRIO_BACKGROUND,
+                                 .pData = bench_buf[0], .BlockAdd = base + 16U, .NumberOfBlocks = 8U };
+  req[3] = (SD_SchedReqTypeDef){ .Op = SD_SCHED_OP_READ, .Priority = SD_SCHED_PRIO_RT,
+                                 .pData = bench_buf[1], .BlockAdd = base + 64U, .NumberOfBlocks = 8U };
+  if ((SD_Sched_Submit(&req[0]) != HAL_OK) || (SD_Sched_Poll() == 0U))
+  {
+    printf("[FAIL] 调度器: 冲突推迟测试准备失败\r\n");
+    return 1;
+  }
+  for (i = 1U; i < 4U; i++)
+  {
+    if (SD_Sched_Submit(&req[i]) != HAL_OK)
+    {
+      printf("[FAIL] 调度器: 冲突推迟测试提交失败\r\n");
+      return 1;
+    }
+  }
+  for (i = 1U; i < 4U; i++)
+  {
+    (void)SD_Sched_Poll();
+  }
+
+  SD_Sched_GetStats(&ss);
+  if ((req[1].Status != HAL_OK) || (req[2].Status != HAL_OK) || (req[3].Status != HAL_OK) || (ss.Held != 1U))
+  {
+    printf("[FAIL] 调度器: 实时读取两轮被挡住，冲突推迟应计1个请求，实际 %lu\r\n", (unsigned long)ss.Held);
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+  * @brief  多线程调度测试：执行者线程独占卡，实时、普通、后台线程并发提交
+  */
+static int bench_sched(void)
+{
+  static const char *const names[SD_SCHED_PRIO_COUNT] = { "实时", "普通", "后台" };
+  pthread_t worker;
+  pthread_t th[4];
+  SD_SchedStatsTypeDef ss;
+  uint64_t t0 = SIM_SD_GetTimeNs();
+  uint32_t i;
+  int ret = 0;
+
+  bench_sched_callbacks = 0U;
+  bench_sched_errors = 0U;
+  (void)SD_Sched_Init();
+  if ((pthread_create(&worker, NULL, bench_sched_worker, NULL) != 0) ||
+      (pthread_create(&th[0], NULL, bench_sched_logger, NULL) != 0) ||
+      (pthread_create(&th[1], NULL, bench_sched_normal, (void *)0) != 0) ||
+      (pthread_create(&th[2], NULL, bench_sched_normal, (void *)1) != 0) ||
+      (pthread_create(&th[3], NULL, bench_sched_background, NULL) != 0))
+  {
+    perror("pthread_create");
+    exit(1);
+  }
+  for (i = 0U; i < 4U; i++)
+  {
+    (void)pthread_join(th[i], NULL);
+  }
+  SD_Sched_Stop();
+  (void)pthread_join(worker, NULL);
+
+  /* 实时记录区逐块校验 */
+  for (i = 0U; (i < BENCH_SCHED_LOG_WRITES) && (ret == 0); i++)
+  {
+    uint32_t blk = BENCH_SCHED_START + (i * BENCH_SCHED_LOG_BLOCKS);
+
+    bench_sched_fill(bench_buf[0], BENCH_SCHED_LOG_BLOCKS, blk, 0U);
+    if ((SD_ReadBlocks(bench_buf[1], blk, BENCH_SCHED_LOG_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+        (memcmp(bench_buf[0], bench_buf[1], BENCH_SCHED_LOG_BLOCKS * 512U) != 0))
+    {
+      printf("[FAIL] 调度器: 实时记录第%lu次写入校验失败\r\n", (unsigned long)i);
+      ret = 1;
+    }
+  }
+
+  SD_Sched_GetStats(&ss);
+  printf("[SIM] 调度器: %.3f ms, 最多排队 %lu, 超时提前 %lu次, 冲突推迟 %lu个请求\r\n",
+         (double)(SIM_SD_GetTimeNs() - t0) / 1e6, (unsigned long)ss.MaxPending,
+         (unsigned long)ss.Expedited, (unsigned long)ss.Held);
+  for (i = 0U; i < SD_SCHED_PRIO_COUNT; i++)
+  {
+    const SD_SchedClassStatsTypeDef *c = &ss.Class[i];
+
+    printf("[SIM]   %s: 完成 %lu/%lu, 错误 %lu, 撤销 %lu, 超过截止 %lu, 平均等待 %.2f ms, 最长 %lu ms\r\n",
+           names[i], (unsigned long)c->Completed, (unsigned long)c->Submitted, (unsigned long)c->Errors,
+           (unsigned long)c->Cancelled, (unsigned long)c->DeadlineMisses,
+           (c->Completed != 0U) ? ((double)c->WaitMs / (double)c->Completed) : 0.0, (unsigned long)c->MaxWaitMs);
+    if ((c->Completed != c->Submitted) || (c->Errors != 0U))
+    {
+      ret = 1;
+    }
+  }
+  if ((bench_sched_errors != 0U) || (bench_sched_callbacks != BENCH_SCHED_LOG_WRITES))
+  {
+    printf("[FAIL] 调度器: 错误 %lu, 回调 %lu/%u\r\n", (unsigned long)bench_sched_errors,
+           (unsigned long)bench_sched_callbacks, BENCH_SCHED_LOG_WRITES);
+    ret = 1;
+  }
+  if (bench_sched_held() != 0)
+  {
+    ret = 1;
+  }
+
+  return ret;
+}
+#endif
+
+#if (SD_DISKIO_ENABLE != 0U)
+/**
+  * @brief  diskio实现：SD_DiskIo_xxx()或常见的逐扇区复制写法
+  */
+typedef struct {
+    const char *Name;
+    DRESULT (*Read)(BYTE *buff, LBA_t sector, UINT count);
+    DRESULT (*Write)(const BYTE *buff, LBA_t sector, UINT count);
+    DRESULT (*Sync)(void);
+} BenchGlueTypeDef;
+
+static uint8_t bench_glue_scratch[512] __attribute__((aligned(32)));
+
+static DRESULT bench_naive_read(BYTE *buff, LBA_t sector, UINT count)
+{
+  UINT i;
+
+  for (i = 0U; i < count; i++)
+  {
+    if (SD_ReadBlocksDirect(bench_glue_scratch, sector + i, 1U, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return RES_ERROR;
+    }
+    memcpy(&buff[i * 512U], bench_glue_scratch, 512U);
+  }
+  return RES_OK;
+}
+
+static DRESULT bench_naive_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+  UINT i;
+
+  for (i = 0U; i < count; i++)
+  {
+    memcpy(bench_glue_scratch, &buff[i * 512U], 512U);
+    if (SD_WriteBlocksDirect(bench_glue_scratch, sector + i, 1U, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return RES_ERROR;
+    }
+  }
+  return RES_OK;
+}
+
+static DRESULT bench_naive_sync(void)
+{
+  return RES_OK;
+}
+
+static DRESULT bench_diskio_read(BYTE *buff, LBA_t sector, UINT count)
+{
+  return disk_read(SD_DISKIO_PDRV, buff, sector, count);
+}
+
+static DRESULT bench_diskio_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+  return disk_write(SD_DISKIO_PDRV, buff, sector, count);
+}
+
+static DRESULT bench_diskio_sync(void)
+{
+  return disk_ioctl(SD_DISKIO_PDRV, CTRL_SYNC, NULL);
+}
+
+/* 模拟FATFS结构体：窗口缓冲区在结构体中只有4字节对齐 */
+static struct {
+    DWORD Sector;
+    BYTE  Win[512];
+} __attribute__((aligned(32))) bench_fs;
+static uint8_t bench_fs_dirty;
+
+/**
+  * @brief  模拟FatFs的move_window()：窗口切换到Sector，原窗口有改动时先写回
+  */
+static DRESULT bench_fs_window(const BenchGlueTypeDef *pGlue, DWORD Sector)
+{
+  DRESULT res = RES_OK;
+
+  if (bench_fs.Sector != Sector)
+  {
+    if (bench_fs_dirty != 0U)
+    {
+      res = pGlue->Write(bench_fs.Win, bench_fs.Sector, 1U);
+      bench_fs_dirty = 0U;
+    }
+    if (res == RES_OK)
+    {
+      res = pGlue->Read(bench_fs.Win, Sector, 1U);
+      bench_fs.Sector = Sector;
+    }
+  }
+  return res;
+}
+
+/**
+  * @brief  模拟f_sync()：写回FAT窗口，改写目录项，CTRL_SYNC
+  */
+static DRESULT bench_fs_sync(const BenchGlueTypeDef *pGlue, DWORD Base, uint32_t Size)
+{
+  DRESULT res = bench_fs_window(pGlue, Base + BENCH_DISKIO_DIR);
+
+  if (res == RES_OK)
+  {
+    memcpy(&bench_fs.Win[32], &Size, sizeof(Size));
+    res = pGlue->Write(bench_fs.Win, bench_fs.Sector, 1U);
+    bench_fs_dirty = 0U;
+  }
+  return (res == RES_OK) ? pGlue->Sync() : res;
+}
+
+/**
+  * @brief  按FatFs访问卡的方式写入并读回一个文件：整扇区的f_write()/f_read()直接多扇区传输，
+  *         每个簇分配时经窗口改写FAT扇区，定期f_sync()
+  * @param  pGlue: diskio实现
+  * @param  Base: 模拟卷的起始扇区（FAT、目录、数据区依次排列）
+  */
+static int bench_diskio_file(const BenchGlueTypeDef *pGlue, DWORD Base)
+{
+  uint8_t *buf = bench_buf[0];
+  uint32_t chunk = BENCH_DISKIO_CHUNK / 512U;
+  uint32_t total = (BENCH_DISKIO_FILE_KB * 1024U) / 512U;
+  SIM_SD_StatsTypeDef s0;
+  SIM_SD_StatsTypeDef s1;
+  char name[64];
+  uint64_t t0;
+  uint32_t s;
+  uint32_t i;
+  DRESULT res = RES_OK;
+
+  bench_fs.Sector = 0xFFFFFFFFU;
+  bench_fs_dirty = 0U;
+  SIM_SD_GetStats(&s0);
+  t0 = SIM_SD_GetTimeNs();
+  for (s = 0U; (s < total) && (res == RES_OK); s += chunk)
+  {
+    if ((s % BENCH_DISKIO_CLUSTER) == 0U)
+    {
+      uint32_t clst = s / BENCH_DISKIO_CLUSTER;
+
+      /* 分配簇：FAT32每扇区128项 */
+      res = bench_fs_window(pGlue, Base + BENCH_DISKIO_FAT + (clst / 128U));
+      bench_fs.Win[(clst % 128U) * 4U] = (BYTE)(clst + 1U);
+      bench_fs_dirty = 1U;
+    }
+    for (i = 0U; i < (chunk * 512U); i++)
+    {
+      buf[i] = (uint8_t)(((s * 512U) + i) * 7U + (i >> 9) + Base);
+    }
+    if (res == RES_OK)
+    {
+      res = pGlue->Write(buf, Base + BENCH_DISKIO_DATA + s, chunk);
+    }
+    if ((res == RES_OK) && ((((s + chunk) * 512U) % (BENCH_DISKIO_SYNC_KB * 1024U)) == 0U))
+    {
+      res = bench_fs_sync(pGlue, Base, (s + chunk) * 512U);
+    }
+  }
+  if (res != RES_OK)
+  {
+    printf("[FAIL] %s: 写入失败 %d\n", pGlue->Name, (int)res);
+    return 1;
+  }
+  SIM_SD_GetStats(&s1);
+  snprintf(name, sizeof(name), "%s 文件写入", pGlue->Name);
+  bench_report(name, total, SIM_SD_GetTimeNs() - t0);
+  printf("  写命令 %lu 次\n", (unsigned long)(s1.WriteCmds - s0.WriteCmds));
+
+  SIM_SD_GetStats(&s0);
+  t0 = SIM_SD_GetTimeNs();
+  for (s = 0U; s < total; s += chunk)
+  {
+    if (((s % BENCH_DISKIO_CLUSTER) == 0U) &&
+        (bench_fs_window(pGlue, Base + BENCH_DISKIO_FAT + ((s / BENCH_DISKIO_CLUSTER) / 128U)) != RES_OK))
+    {
+      res = RES_ERROR;
+      break;
+    }
+    if (pGlue->Read(buf, Base + BENCH_DISKIO_DATA + s, chunk) != RES_OK)
+    {
+      res = RES_ERROR;
+      break;
+    }
+    for (i = 0U; i < (chunk * 512U); i++)
+    {
+      if (buf[i] != (uint8_t)(((s * 512U) + i) * 7U + (i >> 9) + Base))
+      {
+        printf("[FAIL] %s: 扇区%lu读回数据不符\n", pGlue->Name, (unsigned long)(s + (i / 512U)));
+        return 1;
+      }
+    }
+  }
+  if (res != RES_OK)
+  {
+    printf("[FAIL] %s: 读取失败\n", pGlue->Name);
+    return 1;
+  }
+  SIM_SD_GetStats(&s1);
+  snprintf(name, sizeof(name), "%s 文件读取", pGlue->Name);
+  bench_report(name, total, SIM_SD_GetTimeNs() - t0);
+  printf("  读命令 %lu 次\n", (unsigned long)(s1.ReadCmds - s0.ReadCmds));
+
+  return 0;
+}
+
+/**
+  * @brief  文件级吞吐：逐扇区复制的常见写法与SD_DiskIo对比，最后删除文件（CTRL_TRIM）
+  */
+static int bench_diskio(void)
+{
+  static const BenchGlueTypeDef naive = { "逐扇区diskio", bench_naive_read, bench_naive_write, bench_naive_sync };
+  static const BenchGlueTypeDef diskio = { "SD_DiskIo", bench_diskio_read, bench_diskio_write, bench_diskio_sync };
+  LBA_t range[2];
+  LBA_t count = 0U;
+  DWORD au = 0U;
+  WORD ss = 0U;
+
+#if (SD_SCHED_ENABLE != 0U)
+  /* 调度器测试结束时已停止；这里没有执行者线程，由SD_Sched_Wait()自己执行请求 */
+  (void)SD_Sched_Init();
+#endif
+  if ((disk_initialize(SD_DISKIO_PDRV) & STA_NOINIT) != 0U)
+  {
+    printf("[FAIL] disk_initialize失败\n");
+    return 1;
+  }
+  if ((disk_ioctl(SD_DISKIO_PDRV, GET_SECTOR_COUNT, &count) != RES_OK) ||
+      (disk_ioctl(SD_DISKIO_PDRV, GET_SECTOR_SIZE, &ss) != RES_OK) ||
+      (disk_ioctl(SD_DISKIO_PDRV, GET_BLOCK_SIZE, &au) != RES_OK) || (ss != 512U) ||
+      (disk_read(SD_DISKIO_PDRV, bench_buf[0], count - 1U, 2U) != RES_PARERR))
+  {
+    printf("[FAIL] disk_ioctl查询失败\n");
+    return 1;
+  }
+  printf("[SIM] diskio: %lu扇区, 擦除块(AU) %lu扇区\n", (unsigned long)count, (unsigned long)au);
+
+  if ((bench_diskio_file(&naive, BENCH_DISKIO_START) != 0) ||
+      (bench_diskio_file(&diskio, BENCH_DISKIO_START + BENCH_DISKIO_SPAN) != 0))
+  {
+    return 1;
+  }
+
+  /* f_unlink()释放簇时的CTRL_TRIM */
+  range[0] = BENCH_DISKIO_START + BENCH_DISKIO_SPAN + BENCH_DISKIO_DATA;
+  range[1] = range[0] + ((BENCH_DISKIO_FILE_KB * 1024U) / 512U) - 1U;
+  if (disk_ioctl(SD_DISKIO_PDRV, CTRL_TRIM, range) != RES_OK)
+  {
+    printf("[FAIL] CTRL_TRIM失败\n");
+    return 1;
+  }
+
+  return 0;
+}
+#endif
+
+#if (SD_PLAN_ENABLE != 0U)
+/**
+  * @brief  生成第Session个会话的第Record条记录
+  */
+static void bench_plan_record(uint8_t *p, uint32_t Session, uint32_t Record)
+{
+  uint32_t i;
+
+  for (i = 0U; i < BENCH_PLAN_RECORD; i++)
+  {
+    p[i] = (uint8_t)((Session * 131U) + (Record * 7U) + i);
+  }
+}
+
+/**
+  * @brief  校验卡上一个会话的内容
+  */
+static int bench_plan_verify(uint32_t Session, uint32_t StartBlock)
+{
+  uint32_t total = BENCH_PLAN_RECORDS * BENCH_PLAN_RECORD;
+  uint32_t off = 0U;
+  uint32_t n;
+  uint32_t i;
+
+  while (off < total)
+  {
+    n = ((total - off) + 511U) / 512U;
+    if (n > BENCH_HALF_BLOCKS)
+    {
+      n = BENCH_HALF_BLOCKS;
+    }
+    if (SD_ReadBlocksDirect(bench_buf[1], StartBlock + (off / 512U), n, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+    for (i = 0U; (i < (n * 512U)) && (off < total); i++, off++)
+    {
+      if (bench_buf[1][i] != (uint8_t)((Session * 131U) + ((off / BENCH_PLAN_RECORD) * 7U) + (off % BENCH_PLAN_RECORD)))
+      {
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+  * @brief  单元大于RU时，SD_Plan_Sync()之后的写卡仍按单元边界进行、不跨AU；区域写满时报告接收的字节数
+  */
+static int bench_plan_au(void)
+{
+  SD_PlanTypeDef plan;
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t au;
+  uint32_t prev;
+  uint32_t total = 0U;
+  uint32_t calls = 0U;
+
+  memset(bench_buf[1], 0x5A, BENCH_PLAN_CHUNK);
+  if ((SD_Plan_Open(&plan, bench_buf[0], BENCH_HALF_BLOCKS, BENCH_PLAN_START, 2U * BENCH_PLAN_SPAN) != HAL_OK) ||
+      (plan.AuBlocks == 0U) || (plan.UnitBlocks <= SD_PLAN_RU_BLOCKS))
+  {
+    printf("[SIM] 跳过单元对齐测试: AU %lu块\r\n", (unsigned long)plan.AuBlocks);
+    return 0;
+  }
+  au = plan.AuBlocks;
+
+  /* 不足一个RU的数据补齐后，NextBlock只在RU边界；之后连续写满一个AU以上 */
+  if ((SD_Plan_Write(&plan, bench_buf[1], BENCH_PLAN_RECORD, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_Plan_Sync(&plan, SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    return 1;
+  }
+  while ((status == HAL_OK) && ((plan.NextBlock - plan.StartBlock) < (au + plan.UnitBlocks)))
+  {
+    prev = plan.NextBlock;
+    status = SD_Plan_Write(&plan, bench_buf[1], BENCH_PLAN_CHUNK, SD_TIMEOUT_LONG);
+    if ((plan.NextBlock != prev) && ((prev / au) != ((plan.NextBlock - 1U) / au)))
+    {
+      printf("[FAIL] 写入规划跨AU: %lu..%lu\n", (unsigned long)prev, (unsigned long)(plan.NextBlock - 1U));
+      return 1;
+    }
+  }
+  if ((status != HAL_OK) || (((plan.NextBlock - plan.StartBlock) % plan.UnitBlocks) != 0U))
+  {
+    printf("[FAIL] 补齐后写卡未回到单元边界: %lu\n", (unsigned long)plan.NextBlock);
+    return 1;
+  }
+
+  /* 只有一个单元的区域：一个单元写卡，一个单元留在缓冲区，其余不接收 */
+  if (SD_Plan_Open(&plan, bench_buf[0], BENCH_HALF_BLOCKS, BENCH_PLAN_START, BENCH_HALF_BLOCKS) != HAL_OK)
+  {
+    return 1;
+  }
+  do
+  {
+    status = SD_Plan_Write(&plan, bench_buf[1], BENCH_PLAN_CHUNK, SD_TIMEOUT_LONG);
+    total += plan.Accepted;
+    calls++;
+  } while ((status == HAL_OK) && (calls < 64U));
+  status = SD_Plan_Write(&plan, bench_buf[1], BENCH_PLAN_CHUNK, SD_TIMEOUT_LONG);
+  if ((status != HAL_ERROR) || (plan.Accepted != 0U) || (total != (2U * plan.UnitBlocks * 512U)))
+  {
+    printf("[FAIL] 区域写满时接收 %lu字节，应为 %lu\n", (unsigned long)total,
+           (unsigned long)(2U * plan.UnitBlocks * 512U));
+    return 1;
+  }
+  printf("[SIM] 写入规划: 单元 %lu块，补齐后跨过AU边界无跨AU写卡；区域写满时接收 %lu字节\r\n",
+         (unsigned long)plan.UnitBlocks, (unsigned long)total);
+
+  return 0;
+}
+
+/**
+  * @brief  日志写入：任意起点逐16KB写卡 对比 SD_Plan按AU/RU对齐；每次写卡后改写一次目录项
+  */
+static int bench_plan(void)
+{
+  static uint8_t rec[BENCH_PLAN_RECORD];
+  SIM_SD_StatsTypeDef st0;
+  SIM_SD_StatsTypeDef st1;
+  SD_PlanTypeDef plan;
+  HAL_StatusTypeDef status;
+  uint64_t t0;
+  uint32_t pass;
+  uint32_t s;
+  uint32_t r;
+  uint32_t blk;
+  uint32_t fill;
+  uint32_t units;
+  uint32_t pad = 0U;
+  uint32_t start[BENCH_PLAN_SESSIONS];
+
+  for (pass = 0U; pass < 2U; pass++)
+  {
+    SIM_SD_GetStats(&st0);
+    t0 = SIM_SD_GetTimeNs();
+    pad = 0U;
+    for (s = 0U; s < BENCH_PLAN_SESSIONS; s++)
+    {
+      blk = BENCH_PLAN_START + (s * BENCH_PLAN_SPAN) + (BENCH_PLAN_SKEW * (s + 1U));
+      fill = 0U;
+      if (pass != 0U)
+      {
+        if (SD_Plan_Open(&plan, bench_buf[0], BENCH_PLAN_UNIT, blk, BENCH_PLAN_SPAN) != HAL_OK)
+        {
+          return 1;
+        }
+        blk = plan.StartBlock;
+      }
+      start[s] = blk;
+
+      for (r = 0U; r <= BENCH_PLAN_RECORDS; r++)
+      {
+        status = HAL_OK;
+        if (pass == 0U)
+        {
+          units = 0U;
+          if (r < BENCH_PLAN_RECORDS)
+          {
+            bench_plan_record(rec, s, r);
+            memcpy(&bench_buf[0][fill], rec, BENCH_PLAN_RECORD);
+            fill += BENCH_PLAN_RECORD;
+            if (fill >= (BENCH_PLAN_UNIT * 512U))
+            {
+              status = SD_WriteBlocks(bench_buf[0], blk, BENCH_PLAN_UNIT, SD_TIMEOUT_LONG);
+              blk += BENCH_PLAN_UNIT;
+              fill -= BENCH_PLAN_UNIT * 512U;
+              memmove(bench_buf[0], &bench_buf[0][BENCH_PLAN_UNIT * 512U], fill);
+              units = 1U;
+            }
+          }
+          else if (fill != 0U)
+          {
+            status = SD_WriteBlocks(bench_buf[0], blk, (fill + 511U) / 512U, SD_TIMEOUT_LONG);
+            units = 1U;
+          }
+        }
+        else
+        {
+          units = plan.Units;
+          if (r < BENCH_PLAN_RECORDS)
+          {
+            bench_plan_record(rec, s, r);
+            status = SD_Plan_Write(&plan, rec, BENCH_PLAN_RECORD, SD_TIMEOUT_LONG);
+          }
+          else
+          {
+            status = SD_Plan_Sync(&plan, SD_TIMEOUT_LONG);
+            pad += plan.PadBlocks;
+          }
+          units = plan.Units - units;
+        }
+
+        if ((status == HAL_OK) && (units != 0U))
+        {
+          memset(bench_buf[1], (int)(uint8_t)(s + r), 512U);
+          status = SD_WriteBlocksDirect(bench_buf[1], BENCH_META_BLOCK, 1U, SD_TIMEOUT_LONG);
+        }
+        if (status != HAL_OK)
+        {
+          return 1;
+        }
+        SIM_SD_AdvanceNs(20000U);  /* 应用产生下一条记录 */
+      }
+    }
+    if ((SD_Flush(SD_TIMEOUT_LONG) != HAL_OK) || (SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK))
+    {
+      return 1;
+    }
+    SIM_SD_GetStats(&st1);
+    bench_report((pass == 0U) ? "日志写 任意起点" : "日志写 SD_Plan对齐",
+                 (BENCH_PLAN_SESSIONS * BENCH_PLAN_RECORDS * BENCH_PLAN_RECORD) / 512U, SIM_SD_GetTimeNs() - t0);
+    printf("[SIM]   RU补齐 %lu次, AU整理 %lu次, 填充 %lu块\r\n", (unsigned long)(st1.RuMerges - st0.RuMerges),
+           (unsigned long)(st1.AuMerges - st0.AuMerges), (unsigned long)pad);
+
+    for (s = 0U; s < BENCH_PLAN_SESSIONS; s++)
+    {
+      if (bench_plan_verify(s, start[s]) != 0)
+      {
+        return 1;
+      }
+    }
+  }
+
+  return bench_plan_au();
+}
+#endif
+
+#if (SD_STATS_ENABLE != 0U)
+/**
+  * @brief  打印一类操作的运行统计：次数、数据量、平均/最大延迟与延迟直方图
+  */
+static void stats_report(const char *name, const SD_OpStatsTypeDef *pOp, uint32_t CyclesPerUs)
+{
+  uint32_t lo = 32U;
+  uint32_t hi = 0U;
+  uint32_t i;
+
+  if (pOp->Ops == 0U)
+  {
+    return;
+  }
+  printf("[SD] %s: %lu次 (失败 %lu), %.3f MB, 平均 %.1f us, 最大 %.1f us\r\n", name,
+         (unsigned long)pOp->Ops, (unsigned long)pOp->Errors, (double)pOp->Bytes / 1e6,
+         (double)pOp->Cycles / (double)CyclesPerUs / (double)pOp->Ops,
+         (double)pOp->MaxCycles / (double)CyclesPerUs);
+  for (i = 0U; i < 32U; i++)
+  {
+    if (pOp->Hist[i] != 0U)
+    {
+      lo = (i < lo) ? i : lo;
+      hi = i;
+    }
+  }
+  printf("[SD]   直方图(us):");
+  for (i = lo; i <= hi; i++)
+  {
+    printf(" <%.3g:%lu", (double)(2ULL << i) / (double)CyclesPerUs, (unsigned long)pOp->Hist[i]);
+  }
+  printf("\r\n");
+}
+#endif
+
+#if (SD_DISCARD_ENABLE != 0U)
+/**
+  * @brief  顺序写满丢弃测试区，每64块一次SD_WriteBlocks
+  * @retval uint64_t 耗时（纳秒），失败返回0
+  */
+static uint64_t bench_discard_fill(uint8_t Pass)
+{
+  uint64_t t0 = SIM_SD_GetTimeNs();
+  uint32_t i;
+
+  for (i = 0U; i < BENCH_DISCARD_BLOCKS; i += BENCH_HALF_BLOCKS)
+  {
+    memset(bench_buf[0], (int)(i + Pass), sizeof(bench_buf[0]));
+    if (SD_WriteBlocks(bench_buf[0], BENCH_DISCARD_START + i, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 0U;
+    }
+  }
+  if ((SD_Flush(SD_TIMEOUT_LONG) != HAL_OK) || (SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    return 0U;
+  }
+
+  return SIM_SD_GetTimeNs() - t0;
+}
+
+/**
+  * @brief  丢弃与后台擦除：覆盖写 vs 丢弃、空闲擦除后再写；丢弃后又写入的数据不被擦除
+  */
+static int bench_discard(void)
+{
+  SD_DiscardStatsTypeDef ds;
+  SIM_SD_StatsTypeDef s0;
+  SIM_SD_StatsTypeDef s1;
+  uint64_t ns;
+  uint32_t erases = 0U;
+  uint32_t i;
+
+  /* 1. 覆盖已有数据：卡内部先擦后写 */
+  if ((bench_discard_fill(0U) == 0U) || ((ns = bench_discard_fill(1U)) == 0U))
+  {
+    printf("[FAIL] 丢弃测试区写入失败\n");
+    return 1;
+  }
+  bench_report("覆盖写", BENCH_DISCARD_BLOCKS, ns);
+
+  /* 2. 文件删除：先丢弃奇数段再丢弃偶数段，区间表中合并为一段 */
+  for (i = 0U; i < (2U * BENCH_DISCARD_BLOCKS); i += 2U * BENCH_DISCARD_PIECE)
+  {
+    if (SD_Discard(BENCH_DISCARD_START + (i % BENCH_DISCARD_BLOCKS) + ((i < BENCH_DISCARD_BLOCKS) ? BENCH_DISCARD_PIECE : 0U),
+                   BENCH_DISCARD_PIECE, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      printf("[FAIL] SD_Discard失败\n");
+      return 1;
+    }
+  }
+
+  /* 3. 空闲时整段擦除，卡在后台完成 */
+  while (SD_Discard_Idle(SD_TIMEOUT_LONG) != 0U)
+  {
+    erases++;
+    (void)SD_WaitReady(SD_TIMEOUT_LONG);
+  }
+
+  SIM_SD_GetStats(&s0);
+  if ((erases == 0U) || ((ns = bench_discard_fill(2U)) == 0U))
+  {
+    printf("[FAIL] 空闲擦除未执行或写入失败\n");
+    return 1;
+  }
+  SIM_SD_GetStats(&s1);
+  bench_report("丢弃+空闲擦除后写", BENCH_DISCARD_BLOCKS, ns);
+  printf("[SIM] 空闲擦除 %lu次, 写入已擦除块 %llu块\n", (unsigned long)erases,
+         (unsigned long long)(s1.ErasedBlocksWritten - s0.ErasedBlocksWritten));
+
+  /* 4. 丢弃之后又写入的块不能被擦掉 */
+  memset(bench_buf[0], 0xA5, 4U * 512U);
+  if ((SD_Discard(BENCH_DISCARD_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_WriteBlocks(bench_buf[0], BENCH_DISCARD_START + 8U, 4U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_Discard_Flush(SD_TIMEOUT_LONG) != HAL_OK) || (SD_Flush(SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocks(bench_buf[1], BENCH_DISCARD_START + 7U, 6U, SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    printf("[FAIL] 丢弃后写入测试失败\n");
+    return 1;
+  }
+  for (i = 0U; i < (6U * 512U); i++)
+  {
+    if (bench_buf[1][i] != (((i / 512U) - 1U < 4U) ? 0xA5U : 0U))
+    {
+      printf("[FAIL] 丢弃后写入的数据被擦除: 块%lu\n", (unsigned long)(BENCH_DISCARD_START + 7U + (i / 512U)));
+      return 1;
+    }
+  }
+
+  /* 5. 擦除失败：区间留在表中，卡恢复后重试 */
+  if ((SD_Discard(BENCH_DISCARD_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_WriteBlocksDirect(bench_buf[0], BENCH_DISCARD_START + (2U * BENCH_HALF_BLOCKS), 1U, SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    printf("[FAIL] 擦除失败测试准备失败\n");
+    return 1;
+  }
+  SIM_SD_InjectFault(SIM_SD_FAULT_BUSY, 1U);
+  if ((SD_WriteBlocksDirect(bench_buf[0], BENCH_DISCARD_START + (2U * BENCH_HALF_BLOCKS), 1U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_Discard_Flush(SD_TIMEOUT_DEFAULT) == HAL_OK))
+  {
+    printf("[FAIL] 卡一直忙时丢弃区间擦除未返回错误\n");
+    return 1;
+  }
+  SD_Discard_GetStats(&ds);
+  if ((ds.Extents != 1U) || (ds.PendingBlocks != BENCH_HALF_BLOCKS))
+  {
+    printf("[FAIL] 擦除失败后区间未保留: %lu段 %llu块\n", (unsigned long)ds.Extents,
+           (unsigned long long)ds.PendingBlocks);
+    return 1;
+  }
+  if ((SD_ResetCard() != HAL_OK) || (SD_Discard_Flush(SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocks(bench_buf[1], BENCH_DISCARD_START, 1U, SD_TIMEOUT_LONG) != HAL_OK) || (bench_buf[1][0] != 0U))
+  {
+    printf("[FAIL] 卡恢复后重试擦除失败\n");
+    return 1;
+  }
+
+  SD_Discard_GetStats(&ds);
+  printf("[SIM] 丢弃: %lu次 (合并 %lu), 擦除 %lu次 %llu块 (强制 %lu), 重写 %llu块, 放弃 %llu块, 待擦除 %lu段 %llu块\n",
+         (unsigned long)ds.Discards, (unsigned long)ds.Merges, (unsigned long)ds.Erases,
+         (unsigned long long)ds.ErasedBlocks, (unsigned long)ds.Forced, (unsigned long long)ds.Rewritten,
+         (unsigned long long)ds.Dropped, (unsigned long)ds.Extents, (unsigned long long)ds.PendingBlocks);
+
+  return 0;
+}
+#endif
+
+#if (SD_LOG_ENABLE != 0U)
+static SD_LogTypeDef bench_log_obj;
+
+/**
+  * @brief  生成第Seq条记录：前4字节为序号
+  */
+static void bench_log_record(uint8_t *p, uint32_t Seq)
+{
+  uint32_t i;
+
+  (void)memcpy(p, &Seq, sizeof(Seq));
+  for (i = sizeof(Seq); i < BENCH_LOG_RECORD; i++)
+  {
+    p[i] = (uint8_t)(Seq + i);
+  }
+}
+
+/**
+  * @brief  读回校验：记录序号连续、内容正确
+  */
+static void bench_log_check(uint32_t RecordSeq, const uint8_t *pData, uint32_t Length, void *pContext)
+{
+  uint32_t *st = (uint32_t *)pContext;   /* [0]期望的下一个序号 [1]第一条的序号 [2]错误数 [3]已读条数 */
+  uint8_t rec[BENCH_LOG_RECORD];
+
+  bench_log_record(rec, RecordSeq);
+  if (st[3] == 0U)
+  {
+    st[1] = RecordSeq;
+  }
+  else if (RecordSeq != st[0])
+  {
+    st[2]++;
+  }
+  if ((Length != BENCH_LOG_RECORD) || (memcmp(rec, pData, BENCH_LOG_RECORD) != 0))
+  {
+    st[2]++;
+  }
+  st[0] = RecordSeq + 1U;
+  st[3]++;
+}
+
+/**
+  * @brief  日志存储：追加吞吐、模拟掉电（最后一批写了一半）后的恢复时间与读回校验
+  */
+static int bench_log(void)
+{
+  SD_CardInfoTypeDef info;
+  uint8_t rec[BENCH_LOG_RECORD];
+  uint32_t st[4];
+  uint32_t start;
+  uint32_t blocks;
+  uint32_t durable;
+  uint32_t torn;
+  uint32_t batches;
+  uint64_t t0;
+  uint64_t ns;
+  uint32_t i;
+
+  if (SD_GetCardInfo(&info) != HAL_OK)
+  {
+    return 1;
+  }
+  start = (info.LogBlockNbr > BENCH_LOG_BIG_START) ? BENCH_LOG_BIG_START : BENCH_LOG_START;
+  blocks = ((info.LogBlockNbr > BENCH_LOG_BIG_START) ? info.LogBlockNbr : BENCH_LOG_END) - start;
+  if (SD_Log_Format(&bench_log_obj, bench_buf[0], BENCH_HALF_BLOCKS, start, blocks, SD_TIMEOUT_LONG) != HAL_OK)
+  {
+    printf("[FAIL] SD_Log_Format失败\n");
+    return 1;
+  }
+
+  /* 1. 追加：定期同步 */
+  t0 = SIM_SD_GetTimeNs();
+  for (i = 0U; i < BENCH_LOG_RECORDS; i++)
+  {
+    bench_log_record(rec, i);
+    if ((SD_Log_Append(&bench_log_obj, rec, BENCH_LOG_RECORD, SD_TIMEOUT_LONG) != HAL_OK) ||
+        ((((i + 1U) % BENCH_LOG_SYNC) == 0U) && (SD_Log_Sync(&bench_log_obj, SD_TIMEOUT_LONG) != HAL_OK)))
+    {
+      printf("[FAIL] SD_Log_Append失败: 记录%lu\n", (unsigned long)i);
+      return 1;
+    }
+  }
+  ns = SIM_SD_GetTimeNs() - t0;
+  printf("[SIM] 日志追加: %lu条x%u字节 %.3f ms, %.2f MB/s, %lu批, 填充 %lu块, 段 %lu x %lu块\n",
+         (unsigned long)BENCH_LOG_RECORDS, BENCH_LOG_RECORD, (double)ns / 1e6,
+         ((double)BENCH_LOG_RECORDS * BENCH_LOG_RECORD) / ((double)ns / 1e9) / (1024.0 * 1024.0),
+         (unsigned long)bench_log_obj.Batches, (unsigned long)bench_log_obj.PadBlocks,
+         (unsigned long)bench_log_obj.SegCount, (unsigned long)bench_log_obj.SegBlocks);
+
+  /* 2. 掉电：已同步的记录之后又写出一批，这一批只写了一半；批缓冲区中的记录丢失 */
+  durable = bench_log_obj.NextRecord;
+  torn = bench_log_obj.BaseBlock + (bench_log_obj.Seg * bench_log_obj.SegBlocks) + bench_log_obj.Offset + 1U;
+  batches = bench_log_obj.Batches;
+  for (i = durable; bench_log_obj.Batches == batches; i++)
+  {
+    bench_log_record(rec, i);
+    if (SD_Log_Append(&bench_log_obj, rec, BENCH_LOG_RECORD, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+  }
+  memset(bench_buf[1], 0, 512U);
+  if ((SD_WriteBlocks(bench_buf[1], torn, 1U, SD_TIMEOUT_LONG) != HAL_OK) || (SD_Flush(SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    return 1;
+  }
+
+  /* 3. 重新上电：恢复写入位置 */
+  t0 = SIM_SD_GetTimeNs();
+  if (SD_Log_Open(&bench_log_obj, bench_buf[0], BENCH_HALF_BLOCKS, start, blocks, SD_TIMEOUT_LONG) != HAL_OK)
+  {
+    printf("[FAIL] SD_Log_Open失败\n");
+    return 1;
+  }
+  ns = SIM_SD_GetTimeNs() - t0;
+  printf("[SIM] 日志恢复: %.3f ms, 读 %lu块 (卡 %lu MB, %lu段)\n", (double)ns / 1e6,
+         (unsigned long)bench_log_obj.RecoverReads, (unsigned long)(info.LogBlockNbr / 2048U),
+         (unsigned long)bench_log_obj.SegCount);
+  if (bench_log_obj.NextRecord != durable)
+  {
+    printf("[FAIL] 恢复后下一条记录 %lu, 应为 %lu\n", (unsigned long)bench_log_obj.NextRecord,
+           (unsigned long)durable);
+    return 1;
+  }
+
+  /* 4. 恢复后继续追加，再次打开，从最旧的记录读回 */
+  for (i = durable; i < (durable + BENCH_LOG_SYNC); i++)
+  {
+    bench_log_record(rec, i);
+    if (SD_Log_Append(&bench_log_obj, rec, BENCH_LOG_RECORD, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+  }
+  if ((SD_Log_Sync(&bench_log_obj, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_Log_Open(&bench_log_obj, bench_buf[0], BENCH_HALF_BLOCKS, start, blocks, SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    return 1;
+  }
+  memset(st, 0, sizeof(st));
+  t0 = SIM_SD_GetTimeNs();
+  (void)SD_Log_Walk(&bench_log_obj, bench_buf[1], bench_log_check, st, SD_TIMEOUT_LONG);
+  ns = SIM_SD_GetTimeNs() - t0;
+  printf("[SIM] 日志读回: 记录%lu ~ %lu, %.3f ms\n", (unsigned long)st[1], (unsigned long)(st[0] - 1U),
+         (double)ns / 1e6);
+  if ((st[2] != 0U) || (st[3] == 0U) || (st[0] != (durable + BENCH_LOG_SYNC)) ||
+      (st[3] != (st[0] - st[1])))
+  {
+    printf("[FAIL] 日志读回校验失败: 错误 %lu\n", (unsigned long)st[2]);
+    return 1;
+  }
+
+  return 0;
+}
+#endif
+
+#if (SD_CRC_ENABLE != 0U)
+/**
+  * @brief  顺序写或读完CRC测试区，每64块一次SD_WriteBlocks/SD_ReadBlocks
+  * @param  IsRead: 1读 0写
+  * @param  Pass: 写入内容的编号，读出时按它比对
+  * @retval uint64_t 耗时（纳秒），失败返回0
+  */
+static uint64_t bench_crc_pass(uint8_t IsRead, uint8_t Pass)
+{
+  uint64_t t0 = SIM_SD_GetTimeNs();
+  uint32_t i;
+  uint32_t k;
+
+  for (i = 0U; i < BENCH_CRC_BLOCKS; i += BENCH_HALF_BLOCKS)
+  {
+    if (IsRead == 0U)
+    {
+      for (k = 0U; k < sizeof(bench_buf[0]); k++)
+      {
+        bench_buf[0][k] = (uint8_t)((i * 7U) + k + Pass);
+      }
+      if (SD_WriteBlocks(bench_buf[0], BENCH_CRC_START + i, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK)
+      {
+        return 0U;
+      }
+    }
+    else
+    {
+      if (SD_ReadBlocks(bench_buf[1], BENCH_CRC_START + i, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK)
+      {
+        return 0U;
+      }
+      for (k = 0U; k < sizeof(bench_buf[1]); k++)
+      {
+        if (bench_buf[1][k] != (uint8_t)((i * 7U) + k + Pass))
+        {
+          printf("[FAIL] CRC测试区读回数据错误: 块%lu\n", (unsigned long)(BENCH_CRC_START + i + (k / 512U)));
+          return 0U;
+        }
+      }
+    }
+  }
+  if ((IsRead == 0U) && ((SD_Flush(SD_TIMEOUT_LONG) != HAL_OK) || (SD_WaitReady(SD_TIMEOUT_LONG) != HAL_OK)))
+  {
+    return 0U;
+  }
+
+  return SIM_SD_GetTimeNs() - t0;
+}
+
+/**
+  * @brief  逐块CRC校验：无校验 / 先传输后计算 / 与IDMA重叠的吞吐量，重新挂载，位翻转检出，擦除后不误报
+  */
+static int bench_crc(void)
+{
+  static const char *const name[3][2] = {
+    {"写入（无CRC）", "读取（无CRC）"},
+    {"写入（CRC，串行）", "读取（CRC，串行）"},
+    {"写入（CRC，与IDMA重叠）", "读取（CRC，与IDMA重叠）"}
+  };
+  const uint32_t meta = BENCH_CRC_START + BENCH_CRC_BLOCKS;
+  SD_CrcStatsTypeDef cs;
+  SD_IoVecTypeDef wv[2];
+  SD_IoVecTypeDef rv;
+  uint64_t ns;
+  uint32_t m;
+  uint8_t d;
+
+  /* 1. 吞吐量：m=0不挂载，m=1关闭重叠，m=2打开重叠 */
+  for (m = 0U; m < 3U; m++)
+  {
+    if ((m == 1U) && (SD_Crc_Attach(BENCH_CRC_START, BENCH_CRC_BLOCKS, meta, 1U, SD_TIMEOUT_LONG) != HAL_OK))
+    {
+      printf("[FAIL] SD_Crc_Attach失败\n");
+      return 1;
+    }
+    SD_Crc_SetPipeline((m == 2U) ? 1U : 0U);
+    for (d = 0U; d < 2U; d++)
+    {
+      if ((ns = bench_crc_pass(d, (uint8_t)m)) == 0U)
+      {
+        printf("[FAIL] %s失败\n", name[m][d]);
+        return 1;
+      }
+      bench_report(name[m][d], BENCH_CRC_BLOCKS, ns);
+    }
+  }
+
+  /* 2. 重新挂载沿用卡上的CRC表 */
+  if ((SD_Crc_Detach(SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_Crc_Attach(BENCH_CRC_START, BENCH_CRC_BLOCKS, meta, 0U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (bench_crc_pass(1U, 2U) == 0U))
+  {
+    printf("[FAIL] 重新挂载后校验失败\n");
+    return 1;
+  }
+
+  /* 3. 绕过前门改写一个字节（模拟介质位翻转），读取应报错并指出该块 */
+  if (SD_ReadBlocksDirect(bench_buf[0], BENCH_CRC_BAD, 1U, SD_TIMEOUT_LONG) != HAL_OK)
+  {
+    return 1;
+  }
+  bench_buf[0][123] ^= 0x10U;
+  printf("[SIM] 模拟块%lu位翻转，下面应报告该块CRC校验失败\n", (unsigned long)BENCH_CRC_BAD);
+  if ((SD_WriteBlocksDirect(bench_buf[0], BENCH_CRC_BAD, 1U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocks(bench_buf[1], BENCH_CRC_START + 64U, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_ERROR))
+  {
+    printf("[FAIL] 位翻转未被检出\n");
+    return 1;
+  }
+  SD_Crc_GetStats(&cs);
+  if ((cs.Mismatches != 1U) || (cs.LastBadBlock != BENCH_CRC_BAD))
+  {
+    printf("[FAIL] CRC不一致统计错误: %lu块, 最近 %lu\n", (unsigned long)cs.Mismatches,
+           (unsigned long)cs.LastBadBlock);
+    return 1;
+  }
+
+  /* 4. 擦除后的块改为未记录，不误报；经前门重写后恢复校验 */
+  if ((SD_EraseBlocks(BENCH_CRC_START + 64U, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocks(bench_buf[1], BENCH_CRC_START + 64U, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (bench_crc_pass(0U, 3U) == 0U) || (bench_crc_pass(1U, 3U) == 0U))
+  {
+    printf("[FAIL] 擦除后校验失败\n");
+    return 1;
+  }
+
+  /* 5. 分散/聚集写入（头部+未对齐数据）同样记下CRC，前门读取和分散/聚集读取都校验通过 */
+  for (m = 0U; m < (BENCH_CRC_IOVEC_BLOCKS * 512U); m++)
+  {
+    bench_buf[0][m] = (uint8_t)((m * 7U) + 3U);
+  }
+  wv[0].pBuf = &bench_buf[0][0];
+  wv[0].Length = BENCH_IOVEC_HEADER;
+  wv[1].pBuf = &bench_buf[0][BENCH_IOVEC_HEADER + 1U];
+  wv[1].Length = (BENCH_CRC_IOVEC_BLOCKS * 512U) - BENCH_IOVEC_HEADER;
+  rv.pBuf = &bench_buf[1][1];
+  rv.Length = BENCH_CRC_IOVEC_BLOCKS * 512U;
+  if ((SD_WriteBlocksV(wv, 2U, BENCH_CRC_START + 64U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocks(bench_buf[1], BENCH_CRC_START + 64U, BENCH_CRC_IOVEC_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_ReadBlocksV(&rv, 1U, BENCH_CRC_START + 64U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (memcmp(&bench_buf[1][1 + BENCH_IOVEC_HEADER], wv[1].pBuf, wv[1].Length) != 0) ||
+      (SD_Crc_Detach(SD_TIMEOUT_LONG) != HAL_OK))
+  {
+    printf("[FAIL] 分散/聚集写入后校验失败\n");
+    return 1;
+  }
+
+  SD_Crc_GetStats(&cs);
+  printf("[SIM] CRC: 计算 %llu块, 校验 %llu块, 未记录 %llu块, 不一致 %lu块 (块%lu), 与IDMA重叠 %llu块, "
+         "表读 %lu次 写 %lu次\n",
+         (unsigned long long)cs.BlocksHashed, (unsigned long long)cs.BlocksVerified,
+         (unsigned long long)cs.Unrecorded, (unsigned long)cs.Mismatches, (unsigned long)cs.LastBadBlock,
+         (unsigned long long)cs.Overlapped, (unsigned long)cs.MetaReads, (unsigned long)cs.MetaWrites);
+
+  return 0;
+}
+#endif
+
+#if (SD_RECOVER_ENABLE != 0U)
+/**
+  * @brief  写入或读回校验错误恢复测试区的64块
+  * @param  IsRead: 1读 0写
+  * @param  Pass: 内容编号
+  * @param  pNs: 输出，耗时（纳秒）
+  * @retval int 0成功
+  */
+static int bench_recover_op(uint8_t IsRead, uint8_t Pass, uint64_t *pNs)
+{
+  uint64_t t0 = SIM_SD_GetTimeNs();
+  uint32_t k;
+
+  if (IsRead == 0U)
+  {
+    for (k = 0U; k < sizeof(bench_buf[0]); k++)
+    {
+      bench_buf[0][k] = (uint8_t)((k * 13U) + Pass);
+    }
+    if ((SD_WriteBlocksDirect(bench_buf[0], BENCH_RECOVER_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_DEFAULT) != HAL_OK) ||
+        (SD_WaitReady(SD_TIMEOUT_DEFAULT) != HAL_OK))
+    {
+      return 1;
+    }
+  }
+  else
+  {
+    if (SD_ReadBlocksDirect(bench_buf[1], BENCH_RECOVER_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_DEFAULT) != HAL_OK)
+    {
+      return 1;
+    }
+    for (k = 0U; k < sizeof(bench_buf[1]); k++)
+    {
+      if (bench_buf[1][k] != (uint8_t)((k * 13U) + Pass))
+      {
+        printf("[FAIL] 错误恢复测试区读回数据错误: 字节%lu\n", (unsigned long)k);
+        return 1;
+      }
+    }
+  }
+  *pNs = SIM_SD_GetTimeNs() - t0;
+
+  return 0;
+}
+
+/**
+  * @brief  注入各类故障，测量恢复耗时；DAT1~3故障触发降频和降为1线，排除后无错运行恢复原配置
+  */
+static int bench_recover(void)
+{
+  static const struct {
+    const char *Name;
+    uint32_t    Fault;
+    uint8_t     IsRead;
+  } scene[] = {
+    {"CRC错误（读）",       SIM_SD_FAULT_CRC,          1U},
+    {"FIFO下溢（写）",      SIM_SD_FAULT_FIFO,         0U},
+    {"数据超时（读）",      SIM_SD_FAULT_DATA_TIMEOUT, 1U},
+    {"卡无响应（写）",      SIM_SD_FAULT_HANG,         0U},
+  };
+  SD_RecoverStatsTypeDef rs;
+  SIM_SD_StatsTypeDef ss;
+  uint32_t div0 = SD_GetClockDiv();
+  uint64_t clean[2];
+  uint64_t ns;
+  uint32_t i;
+  uint8_t pass = 0U;
+
+  SD_Recover_ResetStats();
+  if (SD_Recover_GetStats(NULL) != HAL_ERROR)
+  {
+    printf("[FAIL] SD_Recover_GetStats未检查空指针\n");
+    return 1;
+  }
+  if ((bench_recover_op(0U, pass, &clean[0]) != 0) || (bench_recover_op(1U, pass, &clean[1]) != 0))
+  {
+    return 1;
+  }
+
+  /* 1. 单次故障：重试一次即恢复 */
+  for (i = 0U; i < (sizeof(scene) / sizeof(scene[0])); i++)
+  {
+    if (scene[i].IsRead == 0U)
+    {
+      pass++;
+    }
+    SIM_SD_InjectFault(scene[i].Fault, 1U);
+    if (bench_recover_op(scene[i].IsRead, pass, &ns) != 0)
+    {
+      printf("[FAIL] %s未恢复\n", scene[i].Name);
+      return 1;
+    }
+    printf("[SIM] 恢复 %-16s %9.3f ms（无错 %.3f ms）\r\n", scene[i].Name, (double)ns / 1e6,
+           (double)clean[scene[i].IsRead] / 1e6);
+  }
+
+  /* 2. DAT1~3接触不良：连续CRC错误，先降频，降到下限后改用1线 */
+  SIM_SD_InjectFault(SIM_SD_FAULT_DAT123, 1U);
+  if (bench_recover_op(1U, pass, &ns) != 0)
+  {
+    printf("[FAIL] DAT1~3故障未恢复\n");
+    return 1;
+  }
+  (void)SD_Recover_GetStats(&rs);
+  printf("[SIM] 恢复 %-16s %9.3f ms, 降频 %lu次, 降为1线 %lu次 -> %lu Hz %lu线\r\n", "DAT1~3故障（读）",
+         (double)ns / 1e6, (unsigned long)rs.Downshifts, (unsigned long)rs.WidthFallbacks,
+         (unsigned long)SD_ClockDivToHz(rs.ClockDiv), (unsigned long)rs.BusWidth);
+  if ((rs.BusWidth != 1U) || (bench_recover_op(1U, pass, &ns) != 0))
+  {
+    return 1;
+  }
+  bench_report("1线降级后读取", BENCH_HALF_BLOCKS, ns);
+
+  /* 3. 故障排除后无错运行，逐级恢复到原来的4线与分频 */
+  SIM_SD_InjectFault(SIM_SD_FAULT_DAT123, 0U);
+  for (i = 0U; i < (4U * (SD_RECOVER_UPSHIFT_RUN + 1U)); i++)
+  {
+    if (SD_ReadBlocksDirect(bench_buf[1], BENCH_RECOVER_START + (i % BENCH_HALF_BLOCKS), 1U,
+                            SD_TIMEOUT_DEFAULT) != HAL_OK)
+    {
+      return 1;
+    }
+    if ((SD_GetClockDiv() == div0) && (SD_GetBusWidth() == SDMMC_BUS_WIDE_4B))
+    {
+      break;
+    }
+  }
+  (void)SD_Recover_GetStats(&rs);
+  printf("[SIM] 无错读取 %lu次后恢复 %lu级 -> %lu Hz %lu线\r\n", (unsigned long)(i + 1U),
+         (unsigned long)rs.Upshifts, (unsigned long)SD_ClockDivToHz(rs.ClockDiv), (unsigned long)rs.BusWidth);
+  if ((rs.ClockDiv != div0) || (rs.BusWidth != 4U) || (bench_recover_op(1U, pass, &ns) != 0))
+  {
+    printf("[FAIL] 未恢复原配置\n");
+    return 1;
+  }
+
+  SIM_SD_GetStats(&ss);
+  printf("[SIM] 错误恢复: CRC %lu, 超时 %lu, FIFO %lu, 忙 %lu, 其他 %lu; 重试 %lu, 恢复 %lu, 失败 %lu, "
+         "CMD12 %lu, 重新初始化 %lu（仿真计 %lu）, 平均恢复 %.3f ms, 最长 %.3f ms\r\n",
+         (unsigned long)rs.Errors[SD_RECOVER_CLASS_CRC], (unsigned long)rs.Errors[SD_RECOVER_CLASS_TIMEOUT],
+         (unsigned long)rs.Errors[SD_RECOVER_CLASS_FIFO], (unsigned long)rs.Errors[SD_RECOVER_CLASS_BUSY],
+         (unsigned long)rs.Errors[SD_RECOVER_CLASS_OTHER], (unsigned long)rs.Retries,
+         (unsigned long)rs.Recovered, (unsigned long)rs.Failed, (unsigned long)rs.Stops,
+         (unsigned long)rs.Resets, (unsigned long)ss.CardResets,
+         (rs.Recovered != 0U) ? ((double)rs.RecoverCycles / (double)rs.Recovered / (SystemCoreClock / 1e3)) : 0.0,
+         (double)rs.MaxRecoverCycles / (SystemCoreClock / 1e3));
+
+  return (rs.Failed == 0U) ? 0 : 1;
+}
+#endif
+
+/**
+  * @brief  卡中途停止收发或编程忙不结束：调用者给SD_TIMEOUT_LONG，驱动按卡寄存器计算的超时返回
+  */
+static int bench_timeout(void)
+{
+  static const struct {
+    const char *Name;
+    uint32_t    Fault;
+    uint8_t     IsRead;
+  } scene[] = {
+    {"读取中途卡死",   SIM_SD_FAULT_STALL, 1U},
+    {"写入中途卡死",   SIM_SD_FAULT_STALL, 0U},
+    {"编程忙不结束",   SIM_SD_FAULT_BUSY,  0U},
+  };
+  static SD_RequestTypeDef req;
+  HAL_StatusTypeDef status;
+  uint32_t limit;
+  uint64_t t0;
+  uint64_t ns;
+  uint32_t i;
+
+  printf("[SIM] 计算的超时: 读1块 %lu ms, 读%lu块 %lu ms, 写1块 %lu ms, 写%lu块 %lu ms, 擦除%lu块 %lu ms\r\n",
+         (unsigned long)SD_GetTimeout(SD_OP_READ, 1U), (unsigned long)BENCH_HALF_BLOCKS,
+         (unsigned long)SD_GetTimeout(SD_OP_READ, BENCH_HALF_BLOCKS),
+         (unsigned long)SD_GetTimeout(SD_OP_WRITE, 1U), (unsigned long)BENCH_HALF_BLOCKS,
+         (unsigned long)SD_GetTimeout(SD_OP_WRITE, BENCH_HALF_BLOCKS), 8192UL,
+         (unsigned long)SD_GetTimeout(SD_OP_ERASE, 8192U));
+
+  memset(bench_buf[0], 0x3C, sizeof(bench_buf[0]));
+  if ((SD_WriteBlocksDirect(bench_buf[0], BENCH_TIMEOUT_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_DEFAULT) != HAL_OK) ||
+      (SD_WaitReady(SD_TIMEOUT_DEFAULT) != HAL_OK))
+  {
+    return 1;
+  }
+
+  for (i = 0U; i < (sizeof(scene) / sizeof(scene[0])); i++)
+  {
+    memset(&req, 0, sizeof(req));
+    SIM_SD_InjectFault(scene[i].Fault, 1U);
+    if (scene[i].Fault == SIM_SD_FAULT_BUSY)
+    {
+      /* 数据正常传给卡，之后的等待就绪按写入的超时返回 */
+      if (SD_WriteBlocksDirect(bench_buf[0], BENCH_TIMEOUT_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK)
+      {
+        return 1;
+      }
+      limit = SD_GetTimeout(SD_OP_WRITE, BENCH_HALF_BLOCKS);
+      t0 = SIM_SD_GetTimeNs();
+      status = SD_WaitReady(SD_TIMEOUT_LONG);
+    }
+    else if (scene[i].IsRead != 0U)
+    {
+      limit = SD_GetTimeout(SD_OP_READ, BENCH_HALF_BLOCKS);
+      t0 = SIM_SD_GetTimeNs();
+      status = SD_ReadBlocksAsync(bench_buf[1], BENCH_TIMEOUT_START, BENCH_HALF_BLOCKS, &req);
+      if (status == HAL_OK)
+      {
+        status = SD_WaitRequest(&req, SD_TIMEOUT_LONG);
+      }
+    }
+    else
+    {
+      limit = SD_GetTimeout(SD_OP_WRITE, BENCH_HALF_BLOCKS);
+      t0 = SIM_SD_GetTimeNs();
+      status = SD_WriteBlocksAsync(bench_buf[0], BENCH_TIMEOUT_START, BENCH_HALF_BLOCKS, &req);
+      if (status == HAL_OK)
+      {
+        status = SD_WaitRequest(&req, SD_TIMEOUT_LONG);
+      }
+    }
+    ns = SIM_SD_GetTimeNs() - t0;
+#if (SD_TIMEOUT_DERIVED == 0U)
+    limit = SD_TIMEOUT_LONG;
+#endif
+    printf("[SIM] 超时 %-16s %9.3f ms（计算的超时 %lu ms，调用者给 %lu ms）\r\n", scene[i].Name,
+           (double)ns / 1e6, (unsigned long)limit, (unsigned long)SD_TIMEOUT_LONG);
+    if ((status != HAL_TIMEOUT) || (ns > ((uint64_t)(limit + 1U) * 1000000ULL)))
+    {
+      printf("[FAIL] %s: 返回 %d\n", scene[i].Name, (int)status);
+      return 1;
+    }
+
+    /* 卡死的卡只能重新初始化；之后照常读写 */
+    if ((SD_ResetCard() != HAL_OK) ||
+        (SD_ReadBlocksDirect(bench_buf[1], BENCH_TIMEOUT_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_DEFAULT) != HAL_OK) ||
+        (bench_buf[1][0] != 0x3CU) || (bench_buf[1][sizeof(bench_buf[1]) - 1U] != 0x3CU))
+    {
+      printf("[FAIL] %s后未恢复\n", scene[i].Name);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static SD_DeviceTypeDef sddev2;  /* 第二个实例：SDMMC2（hsd2）上的卡 */
+
+/**
+  * @brief  双卡测试的数据：每张卡、每个64块分片不同
+  */
+static uint8_t bench_dual_byte(const SD_DeviceTypeDef *pDev, uint32_t Chunk)
+{
+  return (uint8_t)((Chunk * 7U) + ((pDev == &sddev1) ? 1U : 0x56U));
+}
+
+/**
+  * @brief  在Count个实例上同时顺序写入或读取BENCH_DUAL_BLOCKS块：每个实例一个64块的异步请求，
+  *         完成后立即提交下一个；所有实例都在传输或卡忙时让出CPU
+  * @param  pDev: 实例数组，实例k使用bench_buf[k]
+  * @param  Count: 实例个数（1或2）
+  * @param  IsRead: 1读（并校验） 0写
+  * @param  pNs: 输出耗时（写入包括最后的编程忙）
+  * @retval int 0成功
+  */
+static int bench_dual_pass(SD_DeviceTypeDef * const *pDev, uint32_t Count, uint8_t IsRead, uint64_t *pNs)
+{
+  SD_RequestTypeDef req[2];
+  uint32_t chunk[2] = {0U, 0U};
+  uint8_t busy[2] = {0U, 0U};
+  uint32_t chunks = BENCH_DUAL_BLOCKS / BENCH_HALF_BLOCKS;
+  uint32_t done = 0U;
+  uint32_t tickstart = HAL_GetTick();
+  uint64_t t0 = SIM_SD_GetTimeNs();
+  HAL_StatusTypeDef status;
+  uint8_t progress;
+  uint32_t k;
+  uint32_t i;
+
+  memset(req, 0, sizeof(req));
+  while (done < Count)
+  {
+    progress = 0U;
+    for (k = 0U; k < Count; k++)
+    {
+      if (busy[k] != 0U)
+      {
+        status = SD_PollRequest(&req[k]);
+        if (status == HAL_BUSY)
+        {
+          continue;
+        }
+        if (status != HAL_OK)
+        {
+          printf("[FAIL] 双卡测试: 实例%lu 分片%lu 传输失败\n", (unsigned long)k, (unsigned long)chunk[k]);
+          return 1;
+        }
+        busy[k] = 0U;
+        progress = 1U;
+        if (IsRead != 0U)
+        {
+          for (i = 0U; i < sizeof(bench_buf[k]); i++)
+          {
+            if (bench_buf[k][i] != bench_dual_byte(pDev[k], chunk[k]))
+            {
+              printf("[FAIL] 双卡测试: 实例%lu 分片%lu 读回数据错误\n", (unsigned long)k, (unsigned long)chunk[k]);
+              return 1;
+            }
+          }
+        }
+        chunk[k]++;
+        if (chunk[k] == chunks)
+        {
+          done++;
+        }
+      }
+      else if (chunk[k] < chunks)
+      {
+        if (IsRead == 0U)
+        {
+          memset(bench_buf[k], bench_dual_byte(pDev[k], chunk[k]), sizeof(bench_buf[k]));
+          status = SD_Dev_WriteBlocksAsync(pDev[k], bench_buf[k], BENCH_DUAL_START + (chunk[k] * BENCH_HALF_BLOCKS),
+                                           BENCH_HALF_BLOCKS, &req[k]);
+        }
+        else
+        {
+          status = SD_Dev_ReadBlocksAsync(pDev[k], bench_buf[k], BENCH_DUAL_START + (chunk[k] * BENCH_HALF_BLOCKS),
+                                          BENCH_HALF_BLOCKS, &req[k]);
+        }
+        if (status == HAL_OK)
+        {
+          busy[k] = 1U;
+          progress = 1U;
+        }
+        else if (status != HAL_BUSY)
+        {
+          return 1;  /* HAL_BUSY：卡还在编程，下一轮再试 */
+        }
+      }
+      else
+      {
+        /* 本实例已完成 */
+      }
+    }
+    if ((HAL_GetTick() - tickstart) >= SD_TIMEOUT_LONG)
+    {
+      printf("[FAIL] 双卡测试超时\n");
+      return 1;
+    }
+    if (progress == 0U)
+    {
+      SD_WaitYield(64U);  /* 卡编程忙时每次重试都要发CMD13，间隔不宜太短 */
+    }
+  }
+
+  if (IsRead == 0U)
+  {
+    for (k = 0U; k < Count; k++)
+    {
+      if (SD_Dev_WaitReady(pDev[k], SD_TIMEOUT_LONG) != HAL_OK)
+      {
+        return 1;
+      }
+    }
+  }
+  *pNs = SIM_SD_GetTimeNs() - t0;
+
+  return 0;
+}
+
+/**
+  * @brief  两个实例各自接一张卡：先分别单独读写，再同时读写，比较合计吞吐量
+  */
+static int bench_dual(void)
+{
+  SD_DeviceTypeDef * const devs[2] = {&sddev1, &sddev2};
+  SIM_SD_StatsTypeDef s0;
+  SIM_SD_StatsTypeDef s1;
+  uint64_t ns[2][3];
+  uint32_t op;
+
+  if (SD_Dev_Init(&sddev2, &hsd2) != HAL_OK)
+  {
+    printf("[FAIL] SDMMC2上的卡初始化失败\n");
+    return 1;
+  }
+
+  for (op = 0U; op < 2U; op++)
+  {
+    if ((bench_dual_pass(&devs[0], 1U, (uint8_t)op, &ns[op][0]) != 0) ||
+        (bench_dual_pass(&devs[1], 1U, (uint8_t)op, &ns[op][1]) != 0) ||
+        (bench_dual_pass(devs, 2U, (uint8_t)op, &ns[op][2]) != 0))
+    {
+      return 1;
+    }
+  }
+
+  bench_report("写 SDMMC1", BENCH_DUAL_BLOCKS, ns[0][0]);
+  bench_report("写 SDMMC2", BENCH_DUAL_BLOCKS, ns[0][1]);
+  bench_report("写 双卡同时（合计）", 2U * BENCH_DUAL_BLOCKS, ns[0][2]);
+  bench_report("读 SDMMC1", BENCH_DUAL_BLOCKS, ns[1][0]);
+  bench_report("读 SDMMC2", BENCH_DUAL_BLOCKS, ns[1][1]);
+  bench_report("读 双卡同时（合计）", 2U * BENCH_DUAL_BLOCKS, ns[1][2]);
+  SIM_SD_GetSlotStats(0U, &s0);
+  SIM_SD_GetSlotStats(1U, &s1);
+  printf("[SIM] 双卡: 写入合计为单卡的 %.2f 倍, 读取 %.2f 倍; 命令数 SDMMC1 %lu, SDMMC2 %lu\r\n",
+         (double)ns[0][0] * 2.0 / (double)ns[0][2], (double)ns[1][0] * 2.0 / (double)ns[1][2],
+         (unsigned long)s0.Commands, (unsigned long)s1.Commands);
+
+#if (SD_STATS_ENABLE != 0U)
+  /* 每个实例各自统计：SDMMC2上的直接读取只计入sddev2 */
+  {
+    SD_StatsTypeDef st1;
+    SD_StatsTypeDef st2;
+
+    SD_Dev_ResetStats(&sddev1);
+    SD_Dev_ResetStats(&sddev2);
+    if (SD_Dev_ReadBlocksDirect(&sddev2, bench_buf[0], BENCH_DUAL_START, BENCH_HALF_BLOCKS, SD_TIMEOUT_LONG) != HAL_OK)
+    {
+      return 1;
+    }
+    SD_Dev_GetStats(&sddev1, &st1);
+    SD_Dev_GetStats(&sddev2, &st2);
+    if ((st2.Read.Ops != 1U) || (st2.Read.Bytes != (BENCH_HALF_BLOCKS * 512U)) || (st1.Read.Ops != 0U))
+    {
+      printf("[FAIL] 实例统计错误: SDMMC2读 %lu次 %llu字节, SDMMC1读 %lu次\n", (unsigned long)st2.Read.Ops,
+             (unsigned long long)st2.Read.Bytes, (unsigned long)st1.Read.Ops);
+      return 1;
+    }
+  }
+#endif
+
+  return 0;
+}
+
+#if (SD_RAID_ENABLE != 0U)
+static uint8_t bench_raid_buf[(BENCH_RAID_REQ * 512U) + 32U] __attribute__((aligned(32)));  /* 多出的32字节用于未对齐测试 */
+
+/**
+  * @brief  条带/镜像测试的数据：每个虚拟块、每一轮不同
+  */
+static void bench_raid_fill(uint8_t *p, uint32_t Block, uint32_t Blocks, uint32_t Pass)
+{
+  uint32_t i;
+
+  for (i = 0U; i < Blocks; i++)
+  {
+    memset(&p[i * 512U], (int)(uint8_t)(((Block + i) * 13U) + (Pass * 101U) + 1U), 512U);
+  }
+}
+
+/**
+  * @brief  检查读出的数据
+  * @retval int 0一致
+  */
+static int bench_raid_check(const uint8_t *p, uint32_t Block, uint32_t Blocks, uint32_t Pass)
+{
+  uint8_t expect;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0U; i < Blocks; i++)
+  {
+    expect = (uint8_t)(((Block + i) * 13U) + (Pass * 101U) + 1U);
+    for (j = 0U; j < 512U; j++)
+    {
+      if (p[(i * 512U) + j] != expect)
+      {
+        printf("[FAIL] 条带/镜像测试: 虚拟块%lu读回数据错误\n", (unsigned long)(Block + i));
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+  * @brief  以BENCH_RAID_REQ块为单位顺序写入并读回BENCH_RAID_BLOCKS块
+  * @param  hraid: 实例，NULL表示只用sddev1单卡（对照）
+  * @param  Pass: 数据轮次
+  * @param  pNs: 输出写入（包括最后的编程忙）与读取的耗时
+  * @retval int 0成功
+  */
+static int bench_raid_pass(SD_RaidTypeDef *hraid, uint32_t Pass, uint64_t *pNs)
+{
+  uint64_t t0;
+  uint32_t b;
+  HAL_StatusTypeDef status;
+
+  t0 = SIM_SD_GetTimeNs();
+  for (b = 0U; b < BENCH_RAID_BLOCKS; b += BENCH_RAID_REQ)
+  {
+    bench_raid_fill(bench_raid_buf, b, BENCH_RAID_REQ, Pass);
+    status = (hraid != NULL) ?
+             SD_Raid_WriteBlocks(hraid, bench_raid_buf, b, BENCH_RAID_REQ, SD_TIMEOUT_LONG) :
+             SD_Dev_WriteBlocksDirect(&sddev1, bench_raid_buf, BENCH_DUAL_START + b, BENCH_RAID_REQ, SD_TIMEOUT_LONG);
+    if (status != HAL_OK)
+    {
+      return 1;
+    }
+  }
+  status = (hraid != NULL) ? SD_Raid_WaitReady(hraid, SD_TIMEOUT_LONG) : SD_Dev_WaitReady(&sddev1, SD_TIMEOUT_LONG);
+  if (status != HAL_OK)
+  {
+    return 1;
+  }
+  pNs[0] = SIM_SD_GetTimeNs() - t0;
+
+  t0 = SIM_SD_GetTimeNs();
+  for (b = 0U; b < BENCH_RAID_BLOCKS; b += BENCH_RAID_REQ)
+  {
+    status = (hraid != NULL) ?
+             SD_Raid_ReadBlocks(hraid, bench_raid_buf, b, BENCH_RAID_REQ, SD_TIMEOUT_LONG) :
+             SD_Dev_ReadBlocksDirect(&sddev1, bench_raid_buf, BENCH_DUAL_START + b, BENCH_RAID_REQ, SD_TIMEOUT_LONG);
+    if ((status != HAL_OK) || (bench_raid_check(bench_raid_buf, b, BENCH_RAID_REQ, Pass) != 0))
+    {
+      return 1;
+    }
+  }
+  pNs[1] = SIM_SD_GetTimeNs() - t0;
+
+  return 0;
+}
+
+/**
+  * @brief  两张卡组成条带，扫描分片大小比较吞吐量；再测试镜像与未对齐缓冲区
+  * @note   在bench_dual()之后运行（sddev2已初始化）
+  */
+static int bench_raid(void)
+{
+  static const uint32_t chunks[] = {8U, 32U, 64U, 128U, 256U, 512U};
+  SD_RaidTypeDef raid;
+  SD_RaidConfigTypeDef rc;
+  SD_RaidStatsTypeDef rs;
+  char name[48];
+  uint64_t ns[2];
+  uint64_t base[2];
+  uint32_t pass = 0U;
+  uint32_t i;
+  uint8_t *odd = &bench_raid_buf[8];
+
+  if (bench_raid_pass(NULL, pass++, base) != 0)
+  {
+    printf("[FAIL] 条带/镜像测试: 单卡对照失败\n");
+    return 1;
+  }
+  bench_report("写 单卡对照", BENCH_RAID_BLOCKS, base[0]);
+  bench_report("读 单卡对照", BENCH_RAID_BLOCKS, base[1]);
+
+  rc.pDev[0] = &sddev1;
+  rc.pDev[1] = &sddev2;
+  rc.Mode = SD_RAID_MODE_STRIPE;
+  rc.StartBlock = BENCH_DUAL_START;
+  rc.RegionBlocks = BENCH_DUAL_BLOCKS;
+  for (i = 0U; i < (sizeof(chunks) / sizeof(chunks[0])); i++)
+  {
+    rc.ChunkBlocks = chunks[i];
+    if ((SD_Raid_Init(&raid, &rc) != HAL_OK) || (bench_raid_pass(&raid, pass++, ns) != 0))
+    {
+      printf("[FAIL] 条带测试失败: 分片%lu块\n", (unsigned long)chunks[i]);
+      return 1;
+    }
+    SD_Raid_GetStats(&raid, &rs);
+    printf("[SIM] 条带 分片%4lu块: 写 %6.2f MB/s (%.2f倍), 读 %6.2f MB/s (%.2f倍), 命令 %lu/%lu, 编程忙重试 %lu\r\n",
+           (unsigned long)chunks[i],
+           (double)BENCH_RAID_BLOCKS * 512.0 / ((double)ns[0] / 1e9) / (1024.0 * 1024.0),
+           (double)base[0] / (double)ns[0],
+           (double)BENCH_RAID_BLOCKS * 512.0 / ((double)ns[1] / 1e9) / (1024.0 * 1024.0),
+           (double)base[1] / (double)ns[1],
+           (unsigned long)rs.Commands[0], (unsigned long)rs.Commands[1], (unsigned long)rs.BusyRetries);
+  }
+
+  /* 未对齐的缓冲区、跨分片的奇数起点：逐段同步读写 */
+  bench_raid_fill(odd, 100U, 77U, pass);
+  if ((SD_Raid_WriteBlocks(&raid, odd, 100U, 77U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (SD_Raid_ReadBlocks(&raid, odd, 100U, 77U, SD_TIMEOUT_LONG) != HAL_OK) ||
+      (bench_raid_check(odd, 100U, 77U, pass) != 0))
+  {
+    printf("[FAIL] 条带测试: 未对齐缓冲区读写失败\n");
+    return 1;
+  }
+  pass++;
+
+  rc.Mode = SD_RAID_MODE_MIRROR;
+  rc.ChunkBlocks = BENCH_RAID_MIRROR_CHUNK;
+  if ((SD_Raid_Init(&raid, &rc) != HAL_OK) || (bench_raid_pass(&raid, pass, ns) != 0))
+  {
+    printf("[FAIL] 镜像测试失败\n");
+    return 1;
+  }
+  SD_Raid_GetStats(&raid, &rs);
+  (void)snprintf(name, sizeof(name), "写 镜像");
+  bench_report(name, BENCH_RAID_BLOCKS, ns[0]);
+  (void)snprintf(name, sizeof(name), "读 镜像（分片%lu块）", (unsigned long)BENCH_RAID_MIRROR_CHUNK);
+  bench_report(name, BENCH_RAID_BLOCKS, ns[1]);
+  printf("[SIM] 镜像: 写入为单卡的 %.2f 倍, 读取 %.2f 倍; 读取分到两张卡 %llu/%llu块\r\n",
+         (double)base[0] / (double)ns[0], (double)base[1] / (double)ns[1],
+         (unsigned long long)(rs.Blocks[0] - BENCH_RAID_BLOCKS), (unsigned long long)(rs.Blocks[1] - BENCH_RAID_BLOCKS));
+
+  /* 两张卡内容相同：直接从第二张卡读回 */
+  if ((SD_Dev_ReadBlocksDirect(&sddev2, bench_raid_buf, BENCH_DUAL_START + BENCH_RAID_REQ, BENCH_RAID_REQ,
+                               SD_TIMEOUT_LONG) != HAL_OK) ||
+      (bench_raid_check(bench_raid_buf, BENCH_RAID_REQ, BENCH_RAID_REQ, pass) != 0))
+  {
+    printf("[FAIL] 镜像测试: 第二张卡内容不一致\n");
+    return 1;
+  }
+
+  return 0;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+  SIM_SD_ConfigTypeDef cfg;
+  SIM_SD_ConfigTypeDef cfg2;
+  SIM_SD_StatsTypeDef stats;
+  static char image2[256];
+  const char *trace_path = NULL;
+  uint32_t clkdiv = 0U;
+  int opt;
+  int ret = 0;
+
+  SIM_SD_GetDefaultConfig(&cfg);
+
+  while ((opt = getopt(argc, argv, "i:j:m:k:d:w:c:a:b:p:q:e:z:s:g:x:u:r:n:y:t:vh")) != -1)
+  {
+    switch (opt)
+    {
+      case 'i': cfg.ImagePath = optarg; break;
+      case 'j': (void)snprintf(image2, sizeof(image2), "%s", optarg); break;
+      case 'm': cfg.CapacityBytes = strtoull(optarg, NULL, 0) * 1024ULL * 1024ULL; break;
+      case 'k': cfg.KernelClockHz = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'd': clkdiv = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'w': cfg.BusWidth = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'c': cfg.CmdOverheadNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'a': cfg.ReadAccessNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'b': cfg.ProgBusyNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'p': cfg.ProgBlockNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'q': cfg.OtherIrqPeriodNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'e': cfg.PreEraseBlockNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'z': cfg.ErasedBlockNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 's': cfg.Cmd23Support = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'g': cfg.HighSpeedSupport = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'x': cfg.BoardMaxClockHz = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'u': cfg.AuBlocks = (uint32_t)strtoul(optarg, NULL, 0) * 2U; break;
+      case 'r': cfg.RuMergeNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'n': cfg.AuMergeNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'y': cfg.CrcBlockNs = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 't': trace_path = optarg; break;
+      case 'v': cfg.Sdsc = 1U; break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+
+  if (SIM_SD_Init(&cfg) != HAL_OK)
+  {
+    return 1;
+  }
+
+  /* 第二张卡：参数与第一张相同，默认镜像为“第一张的镜像.2” */
+  if (image2[0] == '\0')
+  {
+    (void)snprintf(image2, sizeof(image2), "%s.2", cfg.ImagePath);
+  }
+  cfg2 = cfg;
+  cfg2.ImagePath = image2;
+  if (SIM_SD_InitSlot(1U, &cfg2) != HAL_OK)
+  {
+    return 1;
+  }
+
+  if (trace_path != NULL)
+  {
+#if (SD_TRACE_ENABLE != 0U)
+    SD_Trace_Start();
+#else
+    fprintf(stderr, "-t: 需要以-DSD_TRACE_ENABLE=1编译\n");
+    trace_path = NULL;
+#endif
+  }
+
+  MX_SDMMC1_SD_Init();
+  MODIFY_REG(hsd1.Instance->CLKCR, SDMMC_CLKCR_CLKDIV, clkdiv);
+  MX_SDMMC2_SD_Init();
+  MODIFY_REG(hsd2.Instance->CLKCR, SDMMC_CLKCR_CLKDIV, clkdiv);
+  printf("[SIM] SDMMC_CK = %lu Hz, %lu线\r\n", (unsigned long)SIM_SD_GetBusClockHz(),
+         ((hsd1.Instance->CLKCR & SDMMC_CLKCR_WIDBUS) == SDMMC_BUS_WIDE_4B) ? 4UL : 1UL);
+
+  if (SD_Init() == HAL_OK)
+  {
+    printf("[PASS] SD_Init passed!\n");
+#if (SD_CALIB_ENABLE != 0U)
+    if (bench_calib() != 0)
+    {
+      printf("[FAIL] 时钟校准失败\n");
+      ret = 1;
+    }
+#endif
+#ifdef DEBUG
+    if (SD_MeasureTest() != HAL_OK)
+    {
+      ret = 1;
+    }
+#endif
+    if (bench_stream() != 0)
+    {
+      printf("[FAIL] 流式写入测试失败\n");
+      ret = 1;
+    }
+#if (SD_TRACE_ENABLE != 0U)
+    if ((trace_path == NULL) && (bench_trace() != 0))
+    {
+      printf("[FAIL] 事件跟踪测试失败\n");
+      ret = 1;
+    }
+#endif
+#if (SD_STATS_ENABLE != 0U)
+    if (bench_wait() != 0)
+    {
+      printf("[FAIL] 等待就绪测试失败\n");
+      ret = 1;
+    }
+#endif
+    if (bench_seqread() != 0)
+    {
+      printf("[FAIL] 顺序读测试失败\n");
+      ret = 1;
+    }
+    if (bench_smallwrite() != 0)
+    {
+      printf("[FAIL] 小块写测试失败\n");
+      ret = 1;
+    }
+    if (bench_align() != 0)
+    {
+      printf("[FAIL] 缓冲区对齐测试失败\n");
+      ret = 1;
+    }
+    if (bench_iovec() != 0)
+    {
+      printf("[FAIL] 分散/聚集测试失败\n");
+      ret = 1;
+    }
+#if (SD_SCHED_ENABLE != 0U)
+    if (bench_sched() != 0)
+    {
+      printf("[FAIL] 调度器测试失败\n");
+      ret = 1;
+    }
+#endif
+#if (SD_DISKIO_ENABLE != 0U)
+    if (bench_diskio() != 0)
+    {
+      printf("[FAIL] diskio测试失败\n");
+      ret = 1;
+    }
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+    if (bench_discard() != 0)
+    {
+      printf("[FAIL] 丢弃测试失败\n");
+      ret = 1;
+    }
+#endif
+#if (SD_LOG_ENABLE != 0U)
+    if (bench_log() != 0)
+    {
+      printf("[FAIL] 日志存储测试失败\n");
+      ret = 1;
+    }
+#endif
+#if (SD_CRC_ENABLE != 0U)
+    if (bench_crc() != 0)
+    {
+      printf("[FAIL] CRC校验测试失败\n");
+      ret = 1;
+    }
+#endif
+#if (SD_RECOVER_ENABLE != 0U)
+    if (bench_recover() != 0)
+    {
+      printf("[FAIL] 错误恢复测试失败\n");
+      ret = 1;
+    }
+#endif
+    if (bench_timeout() != 0)
+    {
+      printf("[FAIL] 超时测试失败\n");
+      ret = 1;
+    }
+#if (SD_BENCH_ENABLE != 0U)
+    {
+      SD_BenchConfigTypeDef bc;
+
+      bc.StartBlock = BENCH_SUITE_START;
+      bc.AreaBlocks = BENCH_SUITE_BLOCKS;
+      bc.pBuf = &bench_buf[0][0];
+      bc.MaxBlocks = sizeof(bench_buf) / 512U;
+      bc.Ops = BENCH_SUITE_OPS;
+      bc.Seed = 1U;
+      if (SD_Bench_Run(&bc) != HAL_OK)
+      {
+        printf("[FAIL] 测试套件失败\n");
+        ret = 1;
+      }
+    }
+#endif
+#if (SD_PLAN_ENABLE != 0U)
+    if (bench_plan() != 0)
+    {
+      printf("[FAIL] 日志写测试失败\n");
+      ret = 1;
+    }
+#endif
+    if (bench_dual() != 0)
+    {
+      printf("[FAIL] 双卡测试失败\n");
+      ret = 1;
+    }
+#if (SD_RAID_ENABLE != 0U)
+    else if (bench_raid() != 0)
+    {
+      printf("[FAIL] 条带/镜像测试失败\n");
+      ret = 1;
+    }
+    else
+    {
+      /* 条带/镜像测试已通过 */
+    }
+#endif
+  }
+  else
+  {
+    printf("[FAIL] SD_Init failed!\n");
+    ret = 1;
+  }
+
+#if (SD_CACHE_ENABLE != 0U)
+  {
+    SD_CacheStatsTypeDef cs;
+
+    (void)SD_Flush(SD_TIMEOUT_LONG);
+    SD_Cache_GetStats(&cs);
+    printf("[SIM] 块缓存: 命中 %lu, 未命中 %lu, 替换 %lu, 写回 %lu, 绕过 %lu\r\n",
+           (unsigned long)cs.Hits, (unsigned long)cs.Misses, (unsigned long)cs.Evictions,
+           (unsigned long)cs.WriteBacks, (unsigned long)cs.Bypasses);
+  }
+#endif
+
+#if (SD_STATS_ENABLE != 0U)
+  {
+    SD_StatsTypeDef ds;
+
+    SD_GetStats(&ds);
+    stats_report("读", &ds.Read, ds.CyclesPerUs);
+    stats_report("写", &ds.Write, ds.CyclesPerUs);
+    stats_report("擦除", &ds.Erase, ds.CyclesPerUs);
+    stats_report("等待就绪", &ds.WaitReady, ds.CyclesPerUs);
+    printf("[SD] 等待就绪轮询 %lu次, DAT0忙结束 %lu次, 让出CPU %.3f ms, IDMA等待 %.3f ms\r\n",
+           (unsigned long)ds.WaitPolls, (unsigned long)ds.WaitBusyEnds,
+           (double)ds.WaitYieldCycles / (double)ds.CyclesPerUs / 1e3,
+           (double)ds.RequestWaitCycles / (double)ds.CyclesPerUs / 1e3);
+    printf("[SD] IDMA缓冲区: 直接 %lu次, 首尾经跳板 %lu次, 全部经跳板 %lu次 (%lu块)\r\n",
+           (unsigned long)ds.DmaZeroCopy, (unsigned long)ds.DmaSplit, (unsigned long)ds.DmaBounced,
+           (unsigned long)ds.BounceBlocks);
+  }
+#endif
+
+  SIM_SD_GetStats(&stats);
+  printf("[SIM] 虚拟时间: %.3f ms, 命令: %lu (CMD13: %lu), 读: %llu块, 写: %llu块\r\n",
+         (double)SIM_SD_GetTimeNs() / 1e6, (unsigned long)stats.Commands,
+         (unsigned long)stats.StatusPolls, (unsigned long long)stats.BlocksRead,
+         (unsigned long long)stats.BlocksWritten);
+  printf("[SIM] 总线占用: %.3f ms, 关中断累计: %.3f ms (最长 %.3f ms)\r\n",
+         (double)stats.BusBusyNs / 1e6, (double)stats.IrqOffNs / 1e6, (double)stats.IrqOffMaxNs / 1e6);
+  printf("[SIM] 写入位置: RU补齐 %lu次, AU整理 %lu次\r\n", (unsigned long)stats.RuMerges, (unsigned long)stats.AuMerges);
+  if (stats.CacheOpErrors != 0U)
+  {
+    printf("[SIM] [FAIL] 未对齐的D-Cache维护: %lu 次\r\n", (unsigned long)stats.CacheOpErrors);
+    ret = 1;
+  }
+  if (stats.CrcErrors != 0U)
+  {
+    printf("[SIM] 数据CRC错误: %lu 次\r\n", (unsigned long)stats.CrcErrors);
+  }
+  if (stats.OtherIrqCount != 0U)
+  {
+    printf("[SIM] 其他中断: %lu 次, 平均延迟 %.3f us, 最大延迟 %.3f us, 丢失 %lu 次\r\n",
+           (unsigned long)stats.OtherIrqCount,
+           (double)stats.OtherIrqLatencySumNs / 1e3 / (double)stats.OtherIrqCount,
+           (double)stats.OtherIrqLatencyMaxNs / 1e3, (unsigned long)stats.OtherIrqMissed);
+  }
+
+#if (SD_TRACE_ENABLE != 0U)
+  if ((trace_path != NULL) && (trace_save(trace_path) != 0))
+  {
+    ret = 1;
+  }
+#endif
+
+  SIM_SD_DeInit();
+  return ret;
+}
@@ -0,0 +1,98 @@
+/**
+  ******************************************************************************
+  * @file    sd_sched_os.c
+  * @brief   主机仿真工程的调度器操作系统接口 - 用pthread互斥量和条件变量实现SD_Sched_OsXxx()
+  * @author  STMicroelectronics
+  * @date    2025-11-04
+  * @version 1.0
+  * @note    时刻取仿真卡的虚拟时间，不调用HAL_GetTick()：后者会推进虚拟时间并进入虚拟中断，
+  *          只能由执行请求的线程调用。等待超时同样按虚拟时间计：等待者不推进虚拟时间，
+  *          以短的真实时间片查看虚拟时间是否到期，虚拟时间只在执行请求时前进
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_sched.h"
+
+#if (SD_SCHED_ENABLE != 0U)
+
+#include "sd_sim.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#define SIM_SCHED_SLICE_NS  1000000L  /* 虚拟时间未到期时每次真实等待的时长 */
+
+static pthread_mutex_t sim_sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sim_sched_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t sim_sched_notify;  /* SD_Sched_OsNotify()的次数，等待者据此区分唤醒与时间片到期 */
+
+/**
+  * @brief  加锁
+  */
+void SD_Sched_OsLock(void)
+{
+  (void)pthread_mutex_lock(&sim_sched_mutex);
+}
+
+/**
+  * @brief  解锁
+  */
+void SD_Sched_OsUnlock(void)
+{
+  (void)pthread_mutex_unlock(&sim_sched_mutex);
+}
+
+/**
+  * @brief  释放锁等待唤醒，返回前重新加锁
+  * @param  Timeout: 最长等待时间（虚拟时间，毫秒）
+  * @note   被唤醒或虚拟时间过了Timeout时返回；没有线程执行请求时虚拟时间不动，只能等唤醒
+  */
+void SD_Sched_OsWait(uint32_t Timeout)
+{
+  uint64_t deadline = SIM_SD_GetTimeNs() + ((uint64_t)Timeout * 1000000U);
+  uint32_t seq = sim_sched_notify;
+  struct timespec ts;
+
+  while ((sim_sched_notify == seq) && (SIM_SD_GetTimeNs() < deadline))
+  {
+    (void)clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += SIM_SCHED_SLICE_NS;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+    (void)pthread_cond_timedwait(&sim_sched_cond, &sim_sched_mutex, &ts);
+  }
+}
+
+/**
+  * @brief  唤醒所有等待者（调用者持有锁）
+  */
+void SD_Sched_OsNotify(void)
+{
+  sim_sched_notify++;
+  (void)pthread_cond_broadcast(&sim_sched_cond);
+}
+
+/**
+  * @brief  当前时刻
+  * @retval uint32_t 仿真卡的虚拟时间（毫秒）
+  */
+uint32_t SD_Sched_OsGetTick(void)
+{
+  return (uint32_t)(SIM_SD_GetTimeNs() / 1000000U);
+}
+
+#endif /* SD_SCHED_ENABLE */
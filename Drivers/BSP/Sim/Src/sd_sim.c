@@ -0,0 +1,1865 @@
+/**
+  ******************************************************************************
+  * @file    sd_sim.c
+  * @brief   主机端SDMMC/SD卡仿真器 - 实现sd.c使用的HAL_SD子集
+  * @author  STMicroelectronics
+  * @date    2025-10-20
+  * @version 1.0
+  * @note    卡内容保存在mmap映射的镜像文件中
+  * @note    时间模型为虚拟时间：命令、数据传输、编程忙均按配置推进时钟，
+  *          HAL_GetTick()返回虚拟毫秒数，因此SD_MeasureTest的结果可复现
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_sim.h"
+#include "sdmmc.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define SIM_BLOCK_SIZE        512U
+#define SIM_CMD_CLOCKS        112U   /* 48位命令 + NCR + 48位响应 + NCC */
+#define SIM_CRC_CLOCKS        18U    /* 起始位 + CRC16 + 结束位 */
+#define SIM_NS_PER_MS         1000000ULL
+#define SIM_SCR_HI            0x02358000U   /* SD_SPEC=2, SD_SECURITY=3, BUS_WIDTHS=1|4, SD_SPEC3=1 */
+#define SIM_SCR_CMD23         0x00000002U   /* CMD_SUPPORT bit 33 */
+#define SIM_DS_MAX_HZ         25000000U     /* Default Speed上限 */
+#define SIM_HS_MAX_HZ         50000000U     /* High Speed上限 */
+#define SIM_OPEN_AUS          2U            /* 卡能同时保持打开（可继续顺序写入）的AU数 */
+#define SIM_SPEED_CLASS_10    4U            /* SD Status.SPEED_CLASS编码：Class 10 */
+#define SIM_UHS_GRADE_1       1U            /* SD Status.UHS_SPEED_GRADE：U1 */
+#define SIM_INIT_CLOCK_HZ     400000U       /* 卡识别阶段的SDMMC_CK */
+#define SIM_INIT_CMDS         7U            /* 重新初始化的命令数：CMD0/8/55/41/2/3/7（ACMD41的重复计入CardInitNs） */
+#define SIM_DTIMEOUT_NS       1000000ULL    /* 注入的数据超时在正常结束时间之后多久报出（DTIMER） */
+#define SIM_STUCK_BUSY_NS     3600000000000ULL  /* 注入的编程忙卡死：1小时，只有CMD0能结束 */
+
+/* Private variables ---------------------------------------------------------*/
+SDMMC_TypeDef SIM_SDMMC1_Regs;      /* SDMMC1寄存器组（仿真） */
+SDMMC_TypeDef SIM_SDMMC2_Regs;      /* SDMMC2寄存器组（仿真） */
+uint32_t SystemCoreClock = 480000000U;  /* CPU时钟，DWT->CYCCNT按此频率计数 */
+CoreDebug_Type SIM_CoreDebug;
+static DWT_Type sim_dwt;
+
+/* 每个卡槽一张卡；内核时钟、查询开销、“其他中断”与CRC计算开销等全局参数取卡槽0的配置，相应统计也记在卡槽0 */
+typedef struct {
+    SIM_SD_ConfigTypeDef cfg;
+    SIM_SD_StatsTypeDef  stats;
+    SDMMC_TypeDef       *regs;           /* 所接的SDMMC寄存器组 */
+    int                  fd;
+    uint8_t             *image;
+    uint8_t             *erased;         /* 每块1位：擦除后尚未写入 */
+    uint64_t             block_nbr;
+    uint64_t             busy_until_ns;  /* 卡编程忙结束时间 */
+    uint8_t              busy_d0;        /* CMD13响应时DAT0忙（STA.BUSYD0），忙结束时置位BUSYD0END */
+    uint8_t              high_speed;     /* CMD6已切换到High Speed */
+    uint32_t             rng;            /* 边缘时钟下CRC错误的伪随机序列 */
+    struct {                             /* 注入的故障 */
+        uint32_t          count[SIM_SD_FAULTS]; /* 剩余次数；HANG/DAT123为开关 */
+        uint32_t          stuck;         /* 数据超时后卡停留的状态（SENDING/RECEIVING），CMD12清除 */
+        uint8_t           busy_stuck;    /* 编程忙卡死，CMD0清除 */
+    } fault;
+    struct {                             /* 写入位置模型 */
+        uint64_t          next;          /* 上一次写入之后的块地址 */
+        uint64_t          open[SIM_OPEN_AUS]; /* 打开的AU，下标0最近使用 */
+    } place;
+    struct {                             /* 进行中的IDMA传输 */
+        SD_HandleTypeDef *hsd;
+        uint8_t          *pData;
+        uint32_t          BlockAdd;
+        uint32_t          NumberOfBlocks;
+        uint64_t          done_ns;
+        uint8_t           active;
+        uint8_t           is_write;
+        uint8_t           irq_pending;   /* 完成时中断被关闭，待开中断后进入 */
+        uint8_t           multi;         /* IDMA双缓冲模式 */
+        uint8_t          *buf[2];        /* IDMABASE0/IDMABASE1 */
+        uint32_t          half_blocks;   /* IDMABSIZE对应的块数 */
+        uint32_t          halves_done;
+        uint32_t          halves_total;
+        uint8_t           pre_erased;    /* 本次写入有ACMD23预擦除提示 */
+        uint32_t          error;         /* 本次传输结束时报出的错误（时钟过高或注入的故障） */
+    } dma;
+    struct {                             /* 命令通道（LL接口） */
+        uint32_t          err;           /* 最近一条命令的R1错误 */
+        uint8_t           app;           /* 上一条是CMD55 */
+        uint32_t          acmd23;        /* ACMD23预擦除块数，下一条写命令后清零 */
+        uint32_t          cmd23;         /* CMD23预定义块数，下一条数据命令后清零 */
+        uint32_t          fifo[16];      /* ACMD51/CMD6返回的数据 */
+        uint32_t          fifo_n;        /* FIFO中剩余字数 */
+        uint32_t          fifo_len;      /* 本次数据的总字数 */
+    } cmd;
+} SIM_CardTypeDef;
+
+static SIM_CardTypeDef sim_card[SIM_SD_SLOTS] = {
+    { .regs = &SIM_SDMMC1_Regs, .fd = -1 },
+    { .regs = &SIM_SDMMC2_Regs, .fd = -1 },
+};
+
+static struct {
+    uint64_t             now_ns;         /* 虚拟时间 */
+    uint64_t             irq_off_ns;     /* 本次关中断开始时间 */
+    uint8_t              irq_disabled;
+    uint64_t             dwt_cycles;     /* 上次访问DWT时的虚拟周期数 */
+    struct {                             /* 周期性的“其他中断”，用于测量中断延迟 */
+        uint64_t          next_ns;
+        uint64_t          raised_ns;
+        uint8_t           pending;
+    } tick;
+} sim;
+
+static void SIM_Advance(uint64_t ns);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  寄存器组对应的卡槽
+  */
+static SIM_CardTypeDef *SIM_Card(const SDMMC_TypeDef *SDMMCx)
+{
+    return (SDMMCx == &SIM_SDMMC2_Regs) ? &sim_card[1] : &sim_card[0];
+}
+
+/**
+  * @brief  卡槽的SDMMC_CK频率（SDMMC1/2共用内核时钟）
+  */
+static uint32_t SIM_BusClockHz(const SIM_CardTypeDef *c)
+{
+    uint32_t kernel = sim_card[0].cfg.KernelClockHz;
+    uint32_t div = c->regs->CLKCR & SDMMC_CLKCR_CLKDIV;
+
+    return (div == 0U) ? kernel : (kernel / (2U * div));
+}
+
+/**
+  * @brief  当前总线宽度（由CLKCR.WIDBUS决定）
+  */
+static uint32_t SIM_BusWidth(const SD_HandleTypeDef *hsd)
+{
+    return ((hsd->Instance->CLKCR & SDMMC_CLKCR_WIDBUS) == SDMMC_BUS_WIDE_4B) ? 4U : 1U;
+}
+
+/**
+  * @brief  将总线时钟数换算为纳秒
+  */
+static uint64_t SIM_ClocksToNs(const SIM_CardTypeDef *c, uint64_t clocks)
+{
+    return (clocks * 1000000000ULL) / SIM_BusClockHz(c);
+}
+
+/**
+  * @brief  发送一条命令并接收响应
+  */
+static void SIM_Command(SIM_CardTypeDef *c)
+{
+    uint64_t t = SIM_ClocksToNs(c, SIM_CMD_CLOCKS);
+
+    c->stats.BusBusyNs += t;
+    c->stats.Commands++;
+    SIM_Advance(t + c->cfg.CmdOverheadNs);
+}
+
+/**
+  * @brief  n个数据块在总线上的传输时间
+  */
+static uint64_t SIM_DataNs(const SD_HandleTypeDef *hsd, uint32_t n)
+{
+    uint32_t width = SIM_BusWidth(hsd);
+    uint64_t clocks = (((uint64_t)SIM_BLOCK_SIZE * 8U / width) + SIM_CRC_CLOCKS) * n;
+
+    return SIM_ClocksToNs(SIM_Card(hsd->Instance), clocks);
+}
+
+/**
+  * @brief  传输n个数据块（CPU同步等待）
+  */
+static void SIM_DataBlocks(const SD_HandleTypeDef *hsd, uint32_t n)
+{
+    uint64_t t = SIM_DataNs(hsd, n);
+
+    SIM_Card(hsd->Instance)->stats.BusBusyNs += t;
+    SIM_Advance(t);
+}
+
+/**
+  * @brief  当前时钟下数据线是否可靠
+  * @retval uint8_t 0: 超过卡当前模式或板级上限，本次数据CRC错误
+  */
+static uint8_t SIM_DataLinkOk(SIM_CardTypeDef *c)
+{
+    uint32_t hz = SIM_BusClockHz(c);
+    uint32_t band;
+    uint8_t ok = 1U;
+
+    if (hz > ((c->high_speed != 0U) ? SIM_HS_MAX_HZ : SIM_DS_MAX_HZ))
+    {
+        ok = 0U;
+    }
+    else if ((c->cfg.BoardMaxClockHz != 0U) && (hz > c->cfg.BoardMaxClockHz))
+    {
+        /* 超出板级上限20%以内为边缘区：出错概率随超出量线性增加 */
+        band = c->cfg.BoardMaxClockHz / 5U;
+        c->rng = (c->rng * 1664525U) + 1013904223U;
+        if ((hz - c->cfg.BoardMaxClockHz) >= band)
+        {
+            ok = 0U;
+        }
+        else if (((uint64_t)(c->rng >> 8) * band >> 24) < (hz - c->cfg.BoardMaxClockHz))
+        {
+            ok = 0U;
+        }
+        else
+        {
+            /* 本次侥幸通过 */
+        }
+    }
+    else
+    {
+        /* 时钟在上限之内 */
+    }
+
+    if (ok == 0U)
+    {
+        c->stats.CrcErrors++;
+    }
+
+    return ok;
+}
+
+/**
+  * @brief  取本次数据命令要注入的故障
+  * @param  is_write: 1写 0读
+  * @retval uint32_t 要报出的HAL错误码，0表示正常
+  */
+static uint32_t SIM_TakeFault(const SD_HandleTypeDef *hsd, uint8_t is_write)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    uint32_t err = 0U;
+
+    if (c->fault.count[SIM_SD_FAULT_CRC] != 0U)
+    {
+        c->fault.count[SIM_SD_FAULT_CRC]--;
+        err = HAL_SD_ERROR_DATA_CRC_FAIL;
+    }
+    else if (c->fault.count[SIM_SD_FAULT_FIFO] != 0U)
+    {
+        c->fault.count[SIM_SD_FAULT_FIFO]--;
+        err = (is_write != 0U) ? HAL_SD_ERROR_TX_UNDERRUN : HAL_SD_ERROR_RX_OVERRUN;
+    }
+    else if (c->fault.count[SIM_SD_FAULT_DATA_TIMEOUT] != 0U)
+    {
+        c->fault.count[SIM_SD_FAULT_DATA_TIMEOUT]--;
+        err = HAL_SD_ERROR_DATA_TIMEOUT;
+        c->fault.stuck = (is_write != 0U) ? HAL_SD_CARD_RECEIVING : HAL_SD_CARD_SENDING;
+    }
+    else if ((c->fault.count[SIM_SD_FAULT_DAT123] != 0U) && (SIM_BusWidth(hsd) == 4U))
+    {
+        err = HAL_SD_ERROR_DATA_CRC_FAIL;
+    }
+    else
+    {
+        /* 没有注入故障 */
+    }
+
+    if (err != 0U)
+    {
+        c->stats.InjectedFaults++;
+    }
+
+    return err;
+}
+
+/**
+  * @brief  本次数据命令是否中途卡死（SIM_SD_FAULT_STALL）
+  */
+static uint8_t SIM_TakeStall(SIM_CardTypeDef *c)
+{
+    if (c->fault.count[SIM_SD_FAULT_STALL] == 0U)
+    {
+        return 0U;
+    }
+
+    c->fault.count[SIM_SD_FAULT_STALL]--;
+    c->stats.InjectedFaults++;
+    return 1U;
+}
+
+/**
+  * @brief  消耗CMD23/ACMD23设置，计算本次写命令是否需要CMD12以及编程忙时间
+  * @param  n: 写入块数
+  * @param  pre_erased: 输出，本次写入是否有预擦除提示
+  * @retval uint8_t 1: CMD23已预定义块数，不发CMD12
+  */
+static uint8_t SIM_TakeWriteHints(SIM_CardTypeDef *c, uint32_t n, uint8_t *pre_erased)
+{
+    uint8_t predefined = ((c->cmd.cmd23 != 0U) && (c->cmd.cmd23 == n)) ? 1U : 0U;
+
+    *pre_erased = ((c->cmd.acmd23 != 0U) && (c->cmd.acmd23 >= n)) ? 1U : 0U;
+    c->stats.PreDefinedWrites += predefined;
+    c->stats.PreErasedWrites += *pre_erased;
+    c->cmd.cmd23 = 0U;
+    c->cmd.acmd23 = 0U;
+
+    return predefined;
+}
+
+/**
+  * @brief  清除块的已擦除标记
+  * @retval uint32_t 其中原来已擦除的块数
+  */
+static uint32_t SIM_MarkWritten(SIM_CardTypeDef *c, uint32_t BlockAdd, uint32_t n)
+{
+    uint32_t erased = 0U;
+    uint64_t b;
+
+    for (b = BlockAdd; b < ((uint64_t)BlockAdd + n); b++)
+    {
+        if ((c->erased[b >> 3] & (1U << (b & 7U))) != 0U)
+        {
+            c->erased[b >> 3] &= (uint8_t)~(1U << (b & 7U));
+            erased++;
+        }
+    }
+    c->stats.ErasedBlocksWritten += erased;
+
+    return erased;
+}
+
+/**
+  * @brief  写命令结束后的编程忙时间
+  * @note   已擦除的块按ErasedBlockNs计，其余块有ACMD23预擦除提示时按PreEraseBlockNs计；写入后清除已擦除标记
+  */
+static uint64_t SIM_ProgNs(SIM_CardTypeDef *c, uint32_t BlockAdd, uint32_t n, uint8_t pre_erased)
+{
+    uint32_t erased = SIM_MarkWritten(c, BlockAdd, n);
+
+    if (c->fault.count[SIM_SD_FAULT_BUSY] != 0U)
+    {
+        c->fault.count[SIM_SD_FAULT_BUSY]--;
+        c->fault.busy_stuck = 1U;
+        c->stats.InjectedFaults++;
+        return SIM_STUCK_BUSY_NS;
+    }
+
+    return c->cfg.ProgBusyNs + ((uint64_t)c->cfg.ErasedBlockNs * erased) +
+           ((uint64_t)((pre_erased != 0U) ? c->cfg.PreEraseBlockNs : c->cfg.ProgBlockNs) * (n - erased));
+}
+
+/**
+  * @brief  写入位置带来的额外编程忙
+  * @param  BlockAdd: 起始块地址
+  * @param  n: 块数
+  * @note   接着上一次写入的顺序写不付代价；否则上一次停在RU中间、本次从RU中间开始各补齐一个RU，
+  *         在最近没有写过的AU中间开始还要整理该AU
+  */
+static uint64_t SIM_PlacementNs(SIM_CardTypeDef *c, uint32_t BlockAdd, uint32_t n)
+{
+    uint64_t ns = 0U;
+    uint64_t au;
+    uint32_t i;
+
+    if ((c->cfg.AuBlocks == 0U) || (c->cfg.RuBlocks == 0U))
+    {
+        return 0U;
+    }
+
+    if (BlockAdd != c->place.next)
+    {
+        if ((c->place.next % c->cfg.RuBlocks) != 0U)
+        {
+            ns += c->cfg.RuMergeNs;
+            c->stats.RuMerges++;
+        }
+        if ((BlockAdd % c->cfg.RuBlocks) != 0U)
+        {
+            ns += c->cfg.RuMergeNs;
+            c->stats.RuMerges++;
+        }
+        au = BlockAdd / c->cfg.AuBlocks;
+        for (i = 0U; (i < SIM_OPEN_AUS) && (c->place.open[i] != au); i++)
+        {
+        }
+        if ((i == SIM_OPEN_AUS) && ((BlockAdd % c->cfg.AuBlocks) != 0U))
+        {
+            ns += c->cfg.AuMergeNs;
+            c->stats.AuMerges++;
+        }
+    }
+
+    /* 结束所在的AU移到最近使用 */
+    c->place.next = (uint64_t)BlockAdd + n;
+    au = (c->place.next - 1U) / c->cfg.AuBlocks;
+    for (i = 0U; (i < (SIM_OPEN_AUS - 1U)) && (c->place.open[i] != au); i++)
+    {
+    }
+    for (; i > 0U; i--)
+    {
+        c->place.open[i] = c->place.open[i - 1U];
+    }
+    c->place.open[0] = au;
+
+    return ns;
+}
+
+/**
+  * @brief  进入一次“其他中断”，记录从触发到响应的延迟
+  */
+static void SIM_TickIrq(uint64_t raised_ns)
+{
+    SIM_CardTypeDef *c = &sim_card[0];
+    uint64_t latency = sim.now_ns - raised_ns;
+
+    c->stats.OtherIrqCount++;
+    c->stats.OtherIrqLatencySumNs += latency;
+    if (latency > c->stats.OtherIrqLatencyMaxNs)
+    {
+        c->stats.OtherIrqLatencyMaxNs = latency;
+    }
+}
+
+/**
+  * @brief  IDMA事件：双缓冲模式下为一个缓冲区传完，否则为整个传输结束（DATAEND）
+  */
+static void SIM_DmaEvent(SIM_CardTypeDef *c)
+{
+    SD_HandleTypeDef *hsd = c->dma.hsd;
+    uint32_t h;
+    uint64_t off;
+
+    c->dma.irq_pending = 0U;
+    if (c->dma.active == 0U)
+    {
+        return;
+    }
+
+    if (c->dma.error != 0U)
+    {
+        /* 写：卡返回CRC状态错误，不编程；读：数据作废 */
+        c->dma.active = 0U;
+        c->dma.multi = 0U;
+        hsd->ErrorCode |= c->dma.error;
+        c->dma.error = 0U;
+        HAL_SD_IRQHandler(hsd);
+        return;
+    }
+
+    if ((c->dma.multi != 0U) && (c->dma.halves_done < c->dma.halves_total))
+    {
+        h = c->dma.halves_done;
+        off = ((uint64_t)c->dma.BlockAdd + ((uint64_t)h * c->dma.half_blocks)) * SIM_BLOCK_SIZE;
+        if (c->dma.is_write != 0U)
+        {
+            memcpy(&c->image[off], c->dma.buf[h & 1U], (size_t)c->dma.half_blocks * SIM_BLOCK_SIZE);
+            c->stats.BlocksWritten += c->dma.half_blocks;
+        }
+        else
+        {
+            memcpy(c->dma.buf[h & 1U], &c->image[off], (size_t)c->dma.half_blocks * SIM_BLOCK_SIZE);
+            c->stats.BlocksRead += c->dma.half_blocks;
+        }
+        c->dma.halves_done++;
+
+        if (c->dma.halves_done < c->dma.halves_total)
+        {
+            c->dma.done_ns += SIM_DataNs(hsd, c->dma.half_blocks);
+        }
+        else
+        {
+            /* 最后一个缓冲区：CMD12后DATAEND */
+            c->dma.done_ns += SIM_ClocksToNs(c, SIM_CMD_CLOCKS) + c->cfg.CmdOverheadNs;
+            c->stats.Commands++;
+        }
+
+        if (c->dma.is_write == 0U)
+        {
+            if ((h & 1U) == 0U)
+            {
+                HAL_SDEx_Read_DMADoubleBuf0CpltCallback(hsd);
+            }
+            else
+            {
+                HAL_SDEx_Read_DMADoubleBuf1CpltCallback(hsd);
+            }
+        }
+        else if ((h & 1U) == 0U)
+        {
+            HAL_SDEx_Write_DMADoubleBuf0CpltCallback(hsd);
+        }
+        else
+        {
+            HAL_SDEx_Write_DMADoubleBuf1CpltCallback(hsd);
+        }
+        return;
+    }
+
+    c->dma.active = 0U;
+    if (c->dma.is_write != 0U)
+    {
+        c->busy_until_ns = sim.now_ns + SIM_ProgNs(c, c->dma.BlockAdd, c->dma.NumberOfBlocks, c->dma.pre_erased) +
+                            SIM_PlacementNs(c, c->dma.BlockAdd, c->dma.NumberOfBlocks);
+        c->stats.WriteCmds++;
+        if (c->dma.multi == 0U)
+        {
+            c->stats.BlocksWritten += c->dma.NumberOfBlocks;
+        }
+    }
+    else
+    {
+        if (c->dma.multi == 0U)
+        {
+            memcpy(c->dma.pData, &c->image[(uint64_t)c->dma.BlockAdd * SIM_BLOCK_SIZE],
+                   (size_t)c->dma.NumberOfBlocks * SIM_BLOCK_SIZE);
+            c->stats.BlocksRead += c->dma.NumberOfBlocks;
+        }
+        c->stats.ReadCmds++;
+    }
+    c->dma.multi = 0U;
+
+    HAL_SD_IRQHandler(hsd);
+}
+
+/**
+  * @brief  推进虚拟时间，并按时间顺序处理期间发生的中断事件
+  * @note   中断被关闭时事件挂起，直到__enable_irq()再进入
+  */
+static void SIM_Advance(uint64_t ns)
+{
+    const SIM_SD_ConfigTypeDef *cfg = &sim_card[0].cfg;
+    uint64_t target = sim.now_ns + ns;
+    uint64_t next;
+    SIM_CardTypeDef *c;
+    SIM_CardTypeDef *busy;
+    SIM_CardTypeDef *dma;
+    uint32_t i;
+
+    for (;;)
+    {
+        /* 同一时刻的事件按DAT0释放、“其他中断”、IDMA的顺序处理，卡槽之间按编号 */
+        next = UINT64_MAX;
+        busy = NULL;
+        dma = NULL;
+        for (i = 0U; i < SIM_SD_SLOTS; i++)
+        {
+            c = &sim_card[i];
+            if ((c->dma.active != 0U) && (c->dma.irq_pending == 0U) && (c->dma.done_ns < next))
+            {
+                next = c->dma.done_ns;
+            }
+            if ((c->busy_d0 != 0U) && (c->busy_until_ns < next))
+            {
+                next = c->busy_until_ns;
+            }
+        }
+        if ((cfg->OtherIrqPeriodNs != 0U) && (sim.tick.next_ns < next))
+        {
+            next = sim.tick.next_ns;
+        }
+        if (next > target)
+        {
+            break;
+        }
+        for (i = SIM_SD_SLOTS; i > 0U; i--)
+        {
+            c = &sim_card[i - 1U];
+            if ((c->busy_d0 != 0U) && (c->busy_until_ns == next))
+            {
+                busy = c;
+            }
+            if ((c->dma.active != 0U) && (c->dma.irq_pending == 0U) && (c->dma.done_ns == next))
+            {
+                dma = c;
+            }
+        }
+
+        if (next > sim.now_ns)
+        {
+            __atomic_store_n(&sim.now_ns, next, __ATOMIC_RELAXED);
+        }
+
+        if (busy != NULL)
+        {
+            /* DAT0释放：BUSYD0复位，BUSYD0END置位（仿真不产生中断，驱动查询标志） */
+            busy->busy_d0 = 0U;
+            busy->regs->STA = (busy->regs->STA & ~SDMMC_FLAG_BUSYD0) | SDMMC_FLAG_BUSYD0END;
+        }
+        else if ((cfg->OtherIrqPeriodNs != 0U) && (sim.tick.next_ns == next))
+        {
+            sim.tick.next_ns += cfg->OtherIrqPeriodNs;
+            if (sim.irq_disabled == 0U)
+            {
+                SIM_TickIrq(next);
+            }
+            else if (sim.tick.pending == 0U)
+            {
+                sim.tick.pending = 1U;
+                sim.tick.raised_ns = next;
+            }
+            else
+            {
+                /* 同一中断多次触发只能响应一次，丢失的记为延迟一个周期以上 */
+                sim_card[0].stats.OtherIrqMissed++;
+            }
+        }
+        else
+        {
+            if (sim.irq_disabled == 0U)
+            {
+                SIM_DmaEvent(dma);
+            }
+            else
+            {
+                dma->dma.irq_pending = 1U;
+            }
+        }
+    }
+
+    if (sim.now_ns < target)
+    {
+        __atomic_store_n(&sim.now_ns, target, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+  * @brief  数据命令的公共检查
+  */
+static HAL_StatusTypeDef SIM_CheckXfer(SD_HandleTypeDef *hsd, const void *pData,
+                                       uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+
+    if ((pData == NULL) || (NumberOfBlocks == 0U))
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_PARAM;
+        return HAL_ERROR;
+    }
+
+    if (hsd->State != HAL_SD_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+
+    if (((uint64_t)BlockAdd + NumberOfBlocks) > c->block_nbr)
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_ADDR_OUT_OF_RANGE;
+        return HAL_ERROR;
+    }
+
+    /* 卡无响应 */
+    if (c->fault.count[SIM_SD_FAULT_HANG] != 0U)
+    {
+        SIM_Command(c);
+        hsd->ErrorCode |= HAL_SD_ERROR_CMD_RSP_TIMEOUT;
+        return HAL_ERROR;
+    }
+
+    /* 卡停在数据状态，只接受CMD12 */
+    if (c->fault.stuck != 0U)
+    {
+        SIM_Command(c);
+        hsd->ErrorCode |= HAL_SD_ERROR_ILLEGAL_CMD;
+        return HAL_ERROR;
+    }
+
+    /* 卡仍在编程时发出数据命令属于非法命令（CMD13未确认TRANSFER状态） */
+    if (sim.now_ns < c->busy_until_ns)
+    {
+        SIM_Command(c);
+        hsd->ErrorCode |= HAL_SD_ERROR_ILLEGAL_CMD;
+        return HAL_ERROR;
+    }
+
+    hsd->ErrorCode = HAL_SD_ERROR_NONE;
+    return HAL_OK;
+}
+
+/**
+  * @brief  检查传输是否超出HAL超时时间
+  */
+static HAL_StatusTypeDef SIM_CheckTimeout(SD_HandleTypeDef *hsd, uint64_t start_ns, uint32_t Timeout)
+{
+    if ((sim.now_ns - start_ns) >= ((uint64_t)Timeout * SIM_NS_PER_MS))
+    {
+        SIM_Advance((start_ns + ((uint64_t)Timeout * SIM_NS_PER_MS)) - sim.now_ns);
+        hsd->ErrorCode |= HAL_SD_ERROR_TIMEOUT;
+        return HAL_TIMEOUT;
+    }
+
+    return HAL_OK;
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+void SIM_SD_GetDefaultConfig(SIM_SD_ConfigTypeDef *pConfig)
+{
+    pConfig->ImagePath     = "sdcard.img";
+    pConfig->CapacityBytes = 64ULL * 1024ULL * 1024ULL;
+    pConfig->KernelClockHz = 12800000U;
+    pConfig->BusWidth      = 4U;
+    pConfig->CmdOverheadNs = 2000U;
+    pConfig->ReadAccessNs  = 100000U;
+    pConfig->ProgBusyNs    = 1000000U;
+    pConfig->ProgBlockNs   = 20000U;
+    pConfig->EraseBusyNs   = 5000000U;
+    pConfig->PollCostNs    = 100U;
+    pConfig->OtherIrqPeriodNs = 100000U;
+    pConfig->Cmd23Support  = 1U;
+    pConfig->PreEraseBlockNs = 8000U;
+    pConfig->ErasedBlockNs = 2000U;
+    pConfig->HighSpeedSupport = 1U;
+    pConfig->BoardMaxClockHz = 0U;
+    pConfig->AuBlocks      = 8192U;     /* 4MB */
+    pConfig->RuBlocks      = 32U;       /* 16KB */
+    pConfig->RuMergeNs     = 700000U;
+    pConfig->AuMergeNs     = 20000000U;
+    pConfig->CrcBlockNs    = 2000U;     /* 480MHz M7上4路查表约2周期/字节 */
+    pConfig->CardInitNs    = 20000000U; /* 已上电的卡重新识别，ACMD41很快完成 */
+    pConfig->Sdsc          = 0U;
+    pConfig->CsdTaac       = 0x2DU;     /* 2.0 × 100us */
+    pConfig->CsdNsac       = 1U;        /* 100个时钟 */
+    pConfig->CsdR2wFactor  = 2U;        /* 写入为读取的4倍 */
+}
+
+/**
+  * @brief  关闭卡槽的镜像
+  */
+static void SIM_CloseCard(SIM_CardTypeDef *c)
+{
+    if (c->image != NULL)
+    {
+        (void)msync(c->image, c->block_nbr * SIM_BLOCK_SIZE, MS_SYNC);
+        (void)munmap(c->image, c->block_nbr * SIM_BLOCK_SIZE);
+        c->image = NULL;
+    }
+    free(c->erased);
+    c->erased = NULL;
+
+    if (c->fd >= 0)
+    {
+        (void)close(c->fd);
+        c->fd = -1;
+    }
+}
+
+HAL_StatusTypeDef SIM_SD_Init(const SIM_SD_ConfigTypeDef *pConfig)
+{
+    SIM_SD_DeInit();
+    sim.now_ns = 0U;
+    sim.dwt_cycles = 0U;
+    memset(&sim.tick, 0, sizeof(sim.tick));
+    sim.tick.next_ns = pConfig->OtherIrqPeriodNs;
+
+    return SIM_SD_InitSlot(0U, pConfig);
+}
+
+HAL_StatusTypeDef SIM_SD_InitSlot(uint32_t Slot, const SIM_SD_ConfigTypeDef *pConfig)
+{
+    SIM_CardTypeDef *c;
+    struct stat st;
+    uint64_t size;
+
+    if (Slot >= SIM_SD_SLOTS)
+    {
+        return HAL_ERROR;
+    }
+    c = &sim_card[Slot];
+
+    SIM_CloseCard(c);
+    c->cfg = *pConfig;
+
+    c->fd = open(pConfig->ImagePath, O_RDWR | O_CREAT, 0644);
+    if (c->fd < 0)
+    {
+        perror("[SIM] open");
+        return HAL_ERROR;
+    }
+
+    if (fstat(c->fd, &st) != 0)
+    {
+        perror("[SIM] fstat");
+        return HAL_ERROR;
+    }
+
+    size = (pConfig->CapacityBytes != 0U) ? pConfig->CapacityBytes : (uint64_t)st.st_size;
+    size -= size % SIM_BLOCK_SIZE;
+    if (size == 0U)
+    {
+        fprintf(stderr, "[SIM] 镜像容量为0\n");
+        return HAL_ERROR;
+    }
+
+    if (((uint64_t)st.st_size != size) && (ftruncate(c->fd, (off_t)size) != 0))
+    {
+        perror("[SIM] ftruncate");
+        return HAL_ERROR;
+    }
+
+    c->image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, c->fd, 0);
+    if (c->image == MAP_FAILED)
+    {
+        c->image = NULL;
+        perror("[SIM] mmap");
+        return HAL_ERROR;
+    }
+
+    c->block_nbr = size / SIM_BLOCK_SIZE;
+    c->erased = calloc((size_t)((c->block_nbr + 7U) / 8U), 1U);  /* 镜像原有内容按已写入处理 */
+    if (c->erased == NULL)
+    {
+        perror("[SIM] calloc");
+        return HAL_ERROR;
+    }
+    c->busy_until_ns = 0U;
+    c->busy_d0 = 0U;
+    memset(&c->dma, 0, sizeof(c->dma));
+    memset(&c->cmd, 0, sizeof(c->cmd));
+    c->rng = 1U;
+    memset(&c->fault, 0, sizeof(c->fault));
+    memset(c->place.open, 0xFF, sizeof(c->place.open));
+    c->place.next = 0U;
+    memset(&c->stats, 0, sizeof(c->stats));
+
+    return HAL_OK;
+}
+
+void SIM_SD_DeInit(void)
+{
+    uint32_t i;
+
+    for (i = 0U; i < SIM_SD_SLOTS; i++)
+    {
+        SIM_CloseCard(&sim_card[i]);
+    }
+}
+
+/* 调度器测试中其他线程也会读取虚拟时间，写入和这里的读取都是原子的 */
+uint64_t SIM_SD_GetTimeNs(void)
+{
+    return __atomic_load_n(&sim.now_ns, __ATOMIC_RELAXED);
+}
+
+void SIM_SD_AdvanceNs(uint64_t ns)
+{
+    SIM_Advance(ns);
+}
+
+void SIM_SD_CrcCost(uint32_t Bytes)
+{
+    SIM_Advance(((uint64_t)sim_card[0].cfg.CrcBlockNs * Bytes) / SIM_BLOCK_SIZE);
+}
+
+void SIM_SD_InjectFault(uint32_t Fault, uint32_t Count)
+{
+    if (Fault < SIM_SD_FAULTS)
+    {
+        sim_card[0].fault.count[Fault] = Count;
+    }
+}
+
+void SIM_SD_GetStats(SIM_SD_StatsTypeDef *pStats)
+{
+    *pStats = sim_card[0].stats;
+}
+
+void SIM_SD_GetSlotStats(uint32_t Slot, SIM_SD_StatsTypeDef *pStats)
+{
+    if (Slot < SIM_SD_SLOTS)
+    {
+        *pStats = sim_card[Slot].stats;
+    }
+}
+
+void SIM_SD_ResetStats(void)
+{
+    uint32_t i;
+
+    for (i = 0U; i < SIM_SD_SLOTS; i++)
+    {
+        memset(&sim_card[i].stats, 0, sizeof(sim_card[i].stats));
+    }
+}
+
+uint32_t SIM_SD_GetBusClockHz(void)
+{
+    return SIM_BusClockHz(&sim_card[0]);
+}
+
+/* HAL仿真 -------------------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void)
+{
+    SIM_Advance(sim_card[0].cfg.PollCostNs);
+    return (uint32_t)(sim.now_ns / SIM_NS_PER_MS);
+}
+
+DWT_Type *SIM_DWT(void)
+{
+    uint64_t cycles = (sim.now_ns * (SystemCoreClock / 1000000U)) / 1000U;  /* 避免乘积溢出 */
+
+    if (((SIM_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) != 0U) &&
+        ((sim_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U))
+    {
+        sim_dwt.CYCCNT += (uint32_t)(cycles - sim.dwt_cycles);
+    }
+    sim.dwt_cycles = cycles;
+
+    return &sim_dwt;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    SIM_Advance((uint64_t)Delay * SIM_NS_PER_MS);
+}
+
+void __disable_irq(void)
+{
+    if (sim.irq_disabled == 0U)
+    {
+        sim.irq_disabled = 1U;
+        sim.irq_off_ns = sim.now_ns;
+    }
+}
+
+uint32_t HAL_RCCEx_GetPeriphCLKFreq(uint64_t PeriphClk)
+{
+    (void)PeriphClk;
+    return sim_card[0].cfg.KernelClockHz;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return sim.irq_disabled;
+}
+
+/* 仿真中没有D-Cache，维护操作只检查参数：地址须按32字节行对齐 */
+static void SIM_CheckCacheOp(const char *op, const uint32_t *addr, int32_t dsize)
+{
+    if (((((uintptr_t)addr) & 31U) != 0U) || (dsize <= 0) || ((dsize & 31) != 0))
+    {
+        fprintf(stderr, "[SIM] %s: 未按缓存行对齐 %p + %ld\n", op, (const void *)addr, (long)dsize);
+        sim_card[0].stats.CacheOpErrors++;
+    }
+}
+
+void SCB_CleanDCache_by_Addr(uint32_t *addr, int32_t dsize)
+{
+    SIM_CheckCacheOp("SCB_CleanDCache_by_Addr", addr, dsize);
+}
+
+void SCB_InvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize)
+{
+    SIM_CheckCacheOp("SCB_InvalidateDCache_by_Addr", addr, dsize);
+}
+
+void SCB_CleanInvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize)
+{
+    SIM_CheckCacheOp("SCB_CleanInvalidateDCache_by_Addr", addr, dsize);
+}
+
+/* 仿真的中断只在HAL调用之间进入，独占访问总是成功 */
+uint32_t __LDREXW(volatile uint32_t *addr)
+{
+    return *addr;
+}
+
+uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+    *addr = value;
+    return 0U;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    if (priMask != 0U)
+    {
+        __disable_irq();
+    }
+    else
+    {
+        __enable_irq();
+    }
+}
+
+void __enable_irq(void)
+{
+    SIM_CardTypeDef *c = &sim_card[0];
+    uint64_t off;
+    uint32_t i;
+
+    if (sim.irq_disabled != 0U)
+    {
+        sim.irq_disabled = 0U;
+        off = sim.now_ns - sim.irq_off_ns;
+        c->stats.IrqOffNs += off;
+        if (off > c->stats.IrqOffMaxNs)
+        {
+            c->stats.IrqOffMaxNs = off;
+        }
+
+        /* 关中断期间挂起的中断依次进入 */
+        if (sim.tick.pending != 0U)
+        {
+            sim.tick.pending = 0U;
+            SIM_TickIrq(sim.tick.raised_ns);
+        }
+        for (i = 0U; i < SIM_SD_SLOTS; i++)
+        {
+            if (sim_card[i].dma.irq_pending != 0U)
+            {
+                SIM_DmaEvent(&sim_card[i]);
+            }
+        }
+    }
+}
+
+HAL_StatusTypeDef HAL_SD_Init(SD_HandleTypeDef *hsd)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    uint32_t width = hsd->Init.BusWide;
+
+    if (c->image == NULL)
+    {
+        hsd->ErrorCode = HAL_SD_ERROR_CMD_RSP_TIMEOUT;
+        hsd->State = HAL_SD_STATE_ERROR;
+        return HAL_ERROR;
+    }
+
+    /* 板级只连了DAT0时强制1线 */
+    if (c->cfg.BusWidth == 1U)
+    {
+        width = SDMMC_BUS_WIDE_1B;
+    }
+    hsd->Instance->CLKCR = (hsd->Init.ClockDiv & SDMMC_CLKCR_CLKDIV) | width;
+
+    hsd->SdCard.CardType     = (c->cfg.Sdsc != 0U) ? CARD_SDSC : CARD_SDHC_SDXC;
+    hsd->SdCard.CardVersion  = CARD_V2_X;
+    hsd->SdCard.Class        = 0x5B5U;
+    hsd->SdCard.RelCardAdd   = 0x1234U;
+    hsd->SdCard.BlockNbr     = (uint32_t)c->block_nbr;
+    hsd->SdCard.BlockSize    = SIM_BLOCK_SIZE;
+    hsd->SdCard.LogBlockNbr  = (uint32_t)c->block_nbr;
+    hsd->SdCard.LogBlockSize = SIM_BLOCK_SIZE;
+    hsd->SdCard.CardSpeed    = 0U;
+    c->high_speed = 0U;
+
+    hsd->ErrorCode = HAL_SD_ERROR_NONE;
+    hsd->State = HAL_SD_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_InitCard(SD_HandleTypeDef *hsd)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    uint32_t i;
+
+    if (c->image == NULL)
+    {
+        hsd->ErrorCode = HAL_SD_ERROR_CMD_RSP_TIMEOUT;
+        return HAL_ERROR;
+    }
+
+    /* CMD0使卡回到空闲状态：进行中的传输、卡停留的数据状态、无响应都被清除，已编程的数据保留 */
+    c->dma.active = 0U;
+    c->dma.irq_pending = 0U;
+    c->dma.multi = 0U;
+    c->fault.count[SIM_SD_FAULT_HANG] = 0U;
+    c->fault.stuck = 0U;
+    if (c->fault.busy_stuck != 0U)
+    {
+        c->busy_until_ns = sim.now_ns;
+        c->busy_d0 = 0U;
+        c->fault.busy_stuck = 0U;
+    }
+    c->cmd.cmd23 = 0U;
+    c->cmd.acmd23 = 0U;
+    c->high_speed = 0U;
+
+    /* 识别在400kHz、1线下进行，结束后为hsd->Init的分频、1线 */
+    hsd->Instance->CLKCR = ((sim_card[0].cfg.KernelClockHz + (2U * SIM_INIT_CLOCK_HZ) - 1U) / (2U * SIM_INIT_CLOCK_HZ)) |
+                           SDMMC_BUS_WIDE_1B;
+    for (i = 0U; i < SIM_INIT_CMDS; i++)
+    {
+        SIM_Command(c);
+    }
+    SIM_Advance(c->cfg.CardInitNs);
+    hsd->Instance->CLKCR = (hsd->Init.ClockDiv & SDMMC_CLKCR_CLKDIV) | SDMMC_BUS_WIDE_1B;
+    c->stats.CardResets++;
+
+    hsd->ErrorCode = HAL_SD_ERROR_NONE;
+    hsd->Context = SD_CONTEXT_NONE;
+    hsd->State = HAL_SD_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_ConfigWideBusOperation(SD_HandleTypeDef *hsd, uint32_t WideMode)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    if (hsd->State != HAL_SD_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+
+    if (c->fault.count[SIM_SD_FAULT_HANG] != 0U)
+    {
+        SIM_Command(c);
+        hsd->ErrorCode |= HAL_SD_ERROR_CMD_RSP_TIMEOUT;
+        return HAL_ERROR;
+    }
+
+    SIM_Command(c);                          /* CMD55 */
+    SIM_Command(c);                          /* ACMD6 */
+
+    /* 板级只连了DAT0时强制1线 */
+    if (c->cfg.BusWidth == 1U)
+    {
+        WideMode = SDMMC_BUS_WIDE_1B;
+    }
+    hsd->Instance->CLKCR = (hsd->Init.ClockDiv & SDMMC_CLKCR_CLKDIV) | WideMode;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_ReadBlocks(SD_HandleTypeDef *hsd, uint8_t *pData, uint32_t BlockAdd,
+                                    uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    uint64_t start_ns = sim.now_ns;
+    HAL_StatusTypeDef status;
+    uint32_t err;
+
+    status = SIM_CheckXfer(hsd, pData, BlockAdd, NumberOfBlocks);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    SIM_Command(c);                          /* CMD17/CMD18 */
+    c->cmd.cmd23 = 0U;
+    if (SIM_TakeStall(c) != 0U)
+    {
+        /* 卡不再发送数据，HAL等到自己的超时 */
+        c->fault.stuck = HAL_SD_CARD_SENDING;
+        SIM_Advance((uint64_t)Timeout * SIM_NS_PER_MS);
+        hsd->ErrorCode |= HAL_SD_ERROR_TIMEOUT;
+        return HAL_TIMEOUT;
+    }
+    SIM_Advance(c->cfg.ReadAccessNs);
+    SIM_DataBlocks(hsd, NumberOfBlocks);
+    if (NumberOfBlocks > 1U)
+    {
+        SIM_Command(c);                      /* CMD12 */
+    }
+
+    status = SIM_CheckTimeout(hsd, start_ns, Timeout);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    if (SIM_DataLinkOk(c) == 0U)
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_DATA_CRC_FAIL;
+        return HAL_ERROR;
+    }
+
+    err = SIM_TakeFault(hsd, 0U);
+    if (err != 0U)
+    {
+        SIM_Advance((err == HAL_SD_ERROR_DATA_TIMEOUT) ? SIM_DTIMEOUT_NS : 0U);
+        hsd->ErrorCode |= err;
+        return HAL_ERROR;
+    }
+
+    memcpy(pData, &c->image[(uint64_t)BlockAdd * SIM_BLOCK_SIZE], (size_t)NumberOfBlocks * SIM_BLOCK_SIZE);
+    c->stats.ReadCmds++;
+    c->stats.BlocksRead += NumberOfBlocks;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_WriteBlocks(SD_HandleTypeDef *hsd, const uint8_t *pData, uint32_t BlockAdd,
+                                     uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    uint64_t start_ns = sim.now_ns;
+    HAL_StatusTypeDef status;
+    uint32_t err;
+    uint8_t predefined;
+    uint8_t pre_erased;
+
+    status = SIM_CheckXfer(hsd, pData, BlockAdd, NumberOfBlocks);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    SIM_Command(c);                          /* CMD24/CMD25 */
+    predefined = SIM_TakeWriteHints(c, NumberOfBlocks, &pre_erased);
+    if (SIM_TakeStall(c) != 0U)
+    {
+        /* 卡不再接收数据，HAL等到自己的超时 */
+        c->fault.stuck = HAL_SD_CARD_RECEIVING;
+        SIM_Advance((uint64_t)Timeout * SIM_NS_PER_MS);
+        hsd->ErrorCode |= HAL_SD_ERROR_TIMEOUT;
+        return HAL_TIMEOUT;
+    }
+    SIM_DataBlocks(hsd, NumberOfBlocks);
+    if ((NumberOfBlocks > 1U) && (predefined == 0U))
+    {
+        SIM_Command(c);                      /* CMD12 */
+    }
+
+    status = SIM_CheckTimeout(hsd, start_ns, Timeout);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    if (SIM_DataLinkOk(c) == 0U)
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_DATA_CRC_FAIL;
+        return HAL_ERROR;
+    }
+
+    err = SIM_TakeFault(hsd, 1U);
+    if (err != 0U)
+    {
+        SIM_Advance((err == HAL_SD_ERROR_DATA_TIMEOUT) ? SIM_DTIMEOUT_NS : 0U);
+        hsd->ErrorCode |= err;
+        return HAL_ERROR;
+    }
+
+    memcpy(&c->image[(uint64_t)BlockAdd * SIM_BLOCK_SIZE], pData, (size_t)NumberOfBlocks * SIM_BLOCK_SIZE);
+    c->busy_until_ns = sim.now_ns + SIM_ProgNs(c, BlockAdd, NumberOfBlocks, pre_erased) + SIM_PlacementNs(c, BlockAdd, NumberOfBlocks);
+    c->stats.WriteCmds++;
+    c->stats.BlocksWritten += NumberOfBlocks;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_EraseBlocks(SD_HandleTypeDef *hsd, uint32_t BlockStartAdd, uint32_t BlockEndAdd)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    uint64_t b;
+
+    if (hsd->State != HAL_SD_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+
+    if ((BlockEndAdd < BlockStartAdd) || ((uint64_t)BlockEndAdd >= c->block_nbr))
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_ADDR_OUT_OF_RANGE;
+        return HAL_ERROR;
+    }
+
+    if (sim.now_ns < c->busy_until_ns)
+    {
+        SIM_Command(c);
+        hsd->ErrorCode |= HAL_SD_ERROR_ILLEGAL_CMD;
+        return HAL_ERROR;
+    }
+
+    SIM_Command(c);                          /* CMD32 */
+    SIM_Command(c);                          /* CMD33 */
+    SIM_Command(c);                          /* CMD38 */
+
+    memset(&c->image[(uint64_t)BlockStartAdd * SIM_BLOCK_SIZE], 0,
+           (size_t)(BlockEndAdd - BlockStartAdd + 1U) * SIM_BLOCK_SIZE);
+    for (b = BlockStartAdd; b <= BlockEndAdd; b++)
+    {
+        c->erased[b >> 3] |= (uint8_t)(1U << (b & 7U));
+    }
+    c->busy_until_ns = sim.now_ns + c->cfg.EraseBusyNs;
+    c->stats.EraseCmds++;
+
+    hsd->ErrorCode = HAL_SD_ERROR_NONE;
+    return HAL_OK;
+}
+
+/**
+  * @brief  启动IDMA传输的公共部分：发出命令后返回，完成时间由SIM_Advance()处理
+  */
+static HAL_StatusTypeDef SIM_StartDma(SD_HandleTypeDef *hsd, uint8_t *pData, uint32_t BlockAdd,
+                                      uint32_t NumberOfBlocks, uint8_t is_write)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    HAL_StatusTypeDef status;
+    uint8_t predefined;
+    uint8_t stalled;
+    uint64_t t;
+
+    status = SIM_CheckXfer(hsd, pData, BlockAdd, NumberOfBlocks);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    /* IDMABASE低2位为保留位，未对齐的地址会被截断 */
+    if ((((uintptr_t)pData) & 3U) != 0U)
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_ADDR_MISALIGNED;
+        return HAL_ERROR;
+    }
+
+    SIM_Command(c);                          /* CMD17/18/24/25 */
+    if (is_write != 0U)
+    {
+        predefined = SIM_TakeWriteHints(c, NumberOfBlocks, &c->dma.pre_erased);
+    }
+    else
+    {
+        predefined = 0U;
+        c->cmd.cmd23 = 0U;
+        c->dma.pre_erased = 0U;
+    }
+
+    t = SIM_DataNs(hsd, NumberOfBlocks);
+    c->stats.BusBusyNs += t;
+    if (is_write == 0U)
+    {
+        t += c->cfg.ReadAccessNs;
+    }
+    if ((NumberOfBlocks > 1U) && (predefined == 0U))
+    {
+        /* CMD12由中断服务程序在DATAEND后发出 */
+        t += SIM_ClocksToNs(c, SIM_CMD_CLOCKS) + c->cfg.CmdOverheadNs;
+        c->stats.Commands++;
+    }
+
+    c->dma.error = (SIM_DataLinkOk(c) == 0U) ? HAL_SD_ERROR_DATA_CRC_FAIL : SIM_TakeFault(hsd, is_write);
+    if (c->dma.error == HAL_SD_ERROR_DATA_TIMEOUT)
+    {
+        t += SIM_DTIMEOUT_NS;
+    }
+    stalled = ((c->dma.error == 0U) && (SIM_TakeStall(c) != 0U)) ? 1U : 0U;
+    if (stalled != 0U)
+    {
+        /* 传输永不结束，直到HAL_SD_Abort()（CMD12） */
+        t = UINT64_MAX - sim.now_ns;
+    }
+    if ((is_write != 0U) && (c->dma.error == 0U) && (stalled == 0U))
+    {
+        memcpy(&c->image[(uint64_t)BlockAdd * SIM_BLOCK_SIZE], pData, (size_t)NumberOfBlocks * SIM_BLOCK_SIZE);
+    }
+
+    c->dma.hsd = hsd;
+    c->dma.pData = pData;
+    c->dma.BlockAdd = BlockAdd;
+    c->dma.NumberOfBlocks = NumberOfBlocks;
+    c->dma.is_write = is_write;
+    c->dma.irq_pending = 0U;
+    c->dma.multi = 0U;
+    c->dma.done_ns = sim.now_ns + t;
+    c->dma.active = 1U;
+
+    hsd->Context = (is_write != 0U) ? SD_CONTEXT_WRITE_MULTIPLE_BLOCK : SD_CONTEXT_READ_MULTIPLE_BLOCK;
+    hsd->Context |= SD_CONTEXT_DMA;
+    hsd->State = HAL_SD_STATE_BUSY;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_ReadBlocks_DMA(SD_HandleTypeDef *hsd, uint8_t *pData, uint32_t BlockAdd,
+                                        uint32_t NumberOfBlocks)
+{
+    return SIM_StartDma(hsd, pData, BlockAdd, NumberOfBlocks, 0U);
+}
+
+HAL_StatusTypeDef HAL_SD_WriteBlocks_DMA(SD_HandleTypeDef *hsd, const uint8_t *pData, uint32_t BlockAdd,
+                                         uint32_t NumberOfBlocks)
+{
+    return SIM_StartDma(hsd, (uint8_t *)pData, BlockAdd, NumberOfBlocks, 1U);
+}
+
+HAL_StatusTypeDef HAL_SDEx_ConfigDMAMultiBuffer(SD_HandleTypeDef *hsd, uint32_t *pDataBuffer0,
+                                                uint32_t *pDataBuffer1, uint32_t BufferSize)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    if (hsd->State != HAL_SD_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+
+    hsd->Instance->IDMABASE0 = (uint32_t)(uintptr_t)pDataBuffer0;
+    hsd->Instance->IDMABASE1 = (uint32_t)(uintptr_t)pDataBuffer1;
+    hsd->Instance->IDMABSIZE = SIM_BLOCK_SIZE * BufferSize;
+    c->dma.buf[0] = (uint8_t *)pDataBuffer0;
+    c->dma.buf[1] = (uint8_t *)pDataBuffer1;
+    c->dma.half_blocks = BufferSize;
+
+    return HAL_OK;
+}
+
+/**
+  * @brief  启动IDMA双缓冲传输：每个缓冲区传完产生一次事件，最后一个之后CMD12、DATAEND
+  */
+static HAL_StatusTypeDef SIM_StartMultiDma(SD_HandleTypeDef *hsd, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                           uint8_t is_write)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    HAL_StatusTypeDef status;
+    uint64_t t;
+
+    if ((c->dma.half_blocks == 0U) || ((NumberOfBlocks % c->dma.half_blocks) != 0U))
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_PARAM;
+        return HAL_ERROR;
+    }
+
+    status = SIM_CheckXfer(hsd, c->dma.buf[0], BlockAdd, NumberOfBlocks);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    SIM_Command(c);                          /* CMD18/CMD25 */
+    if (is_write != 0U)
+    {
+        (void)SIM_TakeWriteHints(c, NumberOfBlocks, &c->dma.pre_erased);  /* 双缓冲结束时总是发CMD12 */
+    }
+    else
+    {
+        c->cmd.cmd23 = 0U;
+        c->dma.pre_erased = 0U;
+    }
+
+    t = SIM_DataNs(hsd, NumberOfBlocks);
+    c->stats.BusBusyNs += t;
+
+    c->dma.hsd = hsd;
+    c->dma.pData = NULL;
+    c->dma.BlockAdd = BlockAdd;
+    c->dma.NumberOfBlocks = NumberOfBlocks;
+    c->dma.is_write = is_write;
+    c->dma.irq_pending = 0U;
+    c->dma.multi = 1U;
+    c->dma.halves_done = 0U;
+    c->dma.halves_total = NumberOfBlocks / c->dma.half_blocks;
+    c->dma.error = (SIM_DataLinkOk(c) == 0U) ? HAL_SD_ERROR_DATA_CRC_FAIL : SIM_TakeFault(hsd, is_write);
+    c->dma.done_ns = sim.now_ns + SIM_DataNs(hsd, c->dma.half_blocks) +
+                      ((is_write == 0U) ? c->cfg.ReadAccessNs : 0U);
+    c->dma.active = 1U;
+
+    hsd->Context = (is_write != 0U) ? SD_CONTEXT_WRITE_MULTIPLE_BLOCK : SD_CONTEXT_READ_MULTIPLE_BLOCK;
+    hsd->Context |= SD_CONTEXT_DMA;
+    hsd->State = HAL_SD_STATE_BUSY;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SDEx_WriteBlocksDMAMultiBuffer(SD_HandleTypeDef *hsd, uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+    return SIM_StartMultiDma(hsd, BlockAdd, NumberOfBlocks, 1U);
+}
+
+HAL_StatusTypeDef HAL_SDEx_ReadBlocksDMAMultiBuffer(SD_HandleTypeDef *hsd, uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+    return SIM_StartMultiDma(hsd, BlockAdd, NumberOfBlocks, 0U);
+}
+
+HAL_StatusTypeDef HAL_SDEx_ChangeDMABuffer(SD_HandleTypeDef *hsd, HAL_SDEx_DMABuffer_MemoryTypeDef Buffer,
+                                           uint32_t *pDataBuffer)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    if (Buffer == SD_DMA_BUFFER0)
+    {
+        hsd->Instance->IDMABASE0 = (uint32_t)(uintptr_t)pDataBuffer;
+    }
+    else
+    {
+        hsd->Instance->IDMABASE1 = (uint32_t)(uintptr_t)pDataBuffer;
+    }
+    c->dma.buf[Buffer & 1U] = (uint8_t *)pDataBuffer;
+
+    return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_SDEx_Write_DMADoubleBuf0CpltCallback(SD_HandleTypeDef *hsd)
+{
+    (void)hsd;
+}
+
+__attribute__((weak)) void HAL_SDEx_Write_DMADoubleBuf1CpltCallback(SD_HandleTypeDef *hsd)
+{
+    (void)hsd;
+}
+
+__attribute__((weak)) void HAL_SDEx_Read_DMADoubleBuf0CpltCallback(SD_HandleTypeDef *hsd)
+{
+    (void)hsd;
+}
+
+__attribute__((weak)) void HAL_SDEx_Read_DMADoubleBuf1CpltCallback(SD_HandleTypeDef *hsd)
+{
+    (void)hsd;
+}
+
+HAL_StatusTypeDef HAL_SD_Abort(SD_HandleTypeDef *hsd)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    if ((c->dma.active != 0U) && (c->dma.hsd == hsd))
+    {
+        c->dma.active = 0U;
+        c->dma.irq_pending = 0U;
+        c->dma.multi = 0U;
+        SIM_Command(c);                      /* CMD12 */
+        if (c->dma.is_write != 0U)
+        {
+            c->busy_until_ns = sim.now_ns + c->cfg.ProgBusyNs;
+            (void)SIM_MarkWritten(c, c->dma.BlockAdd, c->dma.NumberOfBlocks);
+        }
+        c->dma.pre_erased = 0U;
+    }
+    else if ((c->fault.stuck != 0U) && (c->fault.count[SIM_SD_FAULT_HANG] == 0U))
+    {
+        SIM_Command(c);                      /* CMD12：卡回到传输状态 */
+        c->fault.stuck = 0U;
+    }
+    else
+    {
+        /* 卡已在传输状态 */
+    }
+
+    hsd->Context = SD_CONTEXT_NONE;
+    hsd->State = HAL_SD_STATE_READY;
+    return HAL_OK;
+}
+
+void HAL_SD_IRQHandler(SD_HandleTypeDef *hsd)
+{
+    uint32_t context = hsd->Context;
+
+    hsd->Context = SD_CONTEXT_NONE;
+    hsd->State = HAL_SD_STATE_READY;
+
+    if (hsd->ErrorCode != HAL_SD_ERROR_NONE)
+    {
+        HAL_SD_ErrorCallback(hsd);
+    }
+    else if ((context & (SD_CONTEXT_WRITE_SINGLE_BLOCK | SD_CONTEXT_WRITE_MULTIPLE_BLOCK)) != 0U)
+    {
+        HAL_SD_TxCpltCallback(hsd);
+    }
+    else
+    {
+        HAL_SD_RxCpltCallback(hsd);
+    }
+}
+
+__attribute__((weak)) void HAL_SD_TxCpltCallback(SD_HandleTypeDef *hsd)
+{
+    (void)hsd;
+}
+
+__attribute__((weak)) void HAL_SD_RxCpltCallback(SD_HandleTypeDef *hsd)
+{
+    (void)hsd;
+}
+
+__attribute__((weak)) void HAL_SD_ErrorCallback(SD_HandleTypeDef *hsd)
+{
+    (void)hsd;
+}
+
+HAL_SD_CardStateTypeDef HAL_SD_GetCardState(SD_HandleTypeDef *hsd)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    if (c->image == NULL)
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_CMD_RSP_TIMEOUT;
+        return HAL_SD_CARD_DISCONNECTED;
+    }
+
+    SIM_Command(c);                          /* CMD13 */
+    c->stats.StatusPolls++;
+
+    if (c->fault.count[SIM_SD_FAULT_HANG] != 0U)
+    {
+        hsd->ErrorCode |= HAL_SD_ERROR_CMD_RSP_TIMEOUT;
+        return HAL_SD_CARD_DISCONNECTED;
+    }
+    if (c->fault.stuck != 0U)
+    {
+        return (HAL_SD_CardStateTypeDef)c->fault.stuck;
+    }
+
+    /* 响应结束时采样DAT0；BUSYD0END随命令响应标志一起清除 */
+    c->regs->STA &= ~(SDMMC_FLAG_BUSYD0 | SDMMC_FLAG_BUSYD0END);
+    c->busy_d0 = ((c->dma.active == 0U) && (sim.now_ns < c->busy_until_ns)) ? 1U : 0U;
+    if (c->busy_d0 != 0U)
+    {
+        c->regs->STA |= SDMMC_FLAG_BUSYD0;
+    }
+
+    if (c->dma.active != 0U)
+    {
+        return (c->dma.is_write != 0U) ? HAL_SD_CARD_RECEIVING : HAL_SD_CARD_SENDING;
+    }
+
+    return (sim.now_ns < c->busy_until_ns) ? HAL_SD_CARD_PROGRAMMING : HAL_SD_CARD_TRANSFER;
+}
+
+HAL_StatusTypeDef HAL_SD_GetCardInfo(SD_HandleTypeDef *hsd, HAL_SD_CardInfoTypeDef *pCardInfo)
+{
+    *pCardInfo = hsd->SdCard;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_GetCardStatus(SD_HandleTypeDef *hsd, HAL_SD_CardStatusTypeDef *pStatus)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+    static const uint32_t au_blocks[16] = {
+        0U, 32U, 64U, 128U, 256U, 512U, 1024U, 2048U, 4096U, 8192U, 16384U, 24576U, 32768U, 49152U, 65536U, 131072U
+    };
+    uint8_t code;
+
+    if (hsd->State != HAL_SD_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+
+    SIM_Command(c);                          /* CMD55 */
+    SIM_Command(c);                          /* ACMD13 */
+    SIM_Advance(SIM_ClocksToNs(c, (64U * 8U) / SIM_BusWidth(hsd)) + c->cfg.ReadAccessNs);
+
+    for (code = 15U; (code > 0U) && (au_blocks[code] != c->cfg.AuBlocks); code--)
+    {
+    }
+
+    memset(pStatus, 0, sizeof(*pStatus));
+    pStatus->DataBusWidth          = (SIM_BusWidth(hsd) == 4U) ? 2U : 0U;
+    pStatus->SpeedClass            = SIM_SPEED_CLASS_10;
+    pStatus->PerformanceMove       = 0U;
+    pStatus->AllocationUnitSize    = code;
+    pStatus->EraseSize             = 1U;
+    pStatus->EraseTimeout          = 1U;
+    pStatus->EraseOffset           = 2U;
+    pStatus->UhsSpeedGrade         = SIM_UHS_GRADE_1;
+    pStatus->UhsAllocationUnitSize = code;
+    pStatus->VideoSpeedClass       = 0U;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SD_GetCardCSD(SD_HandleTypeDef *hsd, HAL_SD_CardCSDTypeDef *pCSD)
+{
+    SIM_CardTypeDef *c = SIM_Card(hsd->Instance);
+
+    /* 与HAL一样解析识别时读到的CSD，不发命令；CSD 2.0的TAAC/NSAC/R2W_FACTOR为规范规定的固定值 */
+    memset(pCSD, 0, sizeof(*pCSD));
+    pCSD->CSDStruct       = (c->cfg.Sdsc != 0U) ? 0U : 1U;
+    pCSD->TAAC            = (c->cfg.Sdsc != 0U) ? (uint8_t)c->cfg.CsdTaac : 0x0EU;
+    pCSD->NSAC            = (c->cfg.Sdsc != 0U) ? (uint8_t)c->cfg.CsdNsac : 0U;
+    pCSD->MaxBusClkFrec   = 0x32U;
+    pCSD->CardComdClasses = 0x5B5U;
+    pCSD->RdBlockLen      = 9U;
+    pCSD->DeviceSizeMul   = 7U;
+    pCSD->DeviceSize      = (c->cfg.Sdsc != 0U) ? (uint32_t)((c->block_nbr / 512U) - 1U) :
+                                                   (uint32_t)((c->block_nbr / 1024U) - 1U);
+    pCSD->EraseGrSize     = 1U;
+    pCSD->EraseGrMul      = 0x7FU;
+    pCSD->WrSpeedFact     = (c->cfg.Sdsc != 0U) ? (uint8_t)c->cfg.CsdR2wFactor : 2U;
+    pCSD->MaxWrBlockLen   = 9U;
+
+    return HAL_OK;
+}
+
+uint32_t HAL_SD_GetError(const SD_HandleTypeDef *hsd)
+{
+    return hsd->ErrorCode;
+}
+
+HAL_SD_StateTypeDef HAL_SD_GetState(const SD_HandleTypeDef *hsd)
+{
+    return hsd->State;
+}
+
+/* LL_SDMMC仿真 ---------------------------------------------------------------*/
+
+HAL_StatusTypeDef SDMMC_SendCommand(SDMMC_TypeDef *SDMMCx, const SDMMC_CmdInitTypeDef *Command)
+{
+    SIM_CardTypeDef *c = SIM_Card(SDMMCx);
+    uint8_t app = c->cmd.app;
+
+    SDMMCx->ARG = Command->Argument;
+    SDMMCx->CMD = Command->CmdIndex | Command->Response | Command->WaitForInterrupt | Command->CPSM;
+    SIM_Command(c);
+
+    c->cmd.app = 0U;
+    c->cmd.err = SDMMC_ERROR_NONE;
+    if (Command->CmdIndex == SDMMC_CMD_SET_BLOCK_COUNT)
+    {
+        if (app != 0U)
+        {
+            c->cmd.acmd23 = Command->Argument & 0x007FFFFFU;   /* ACMD23 SET_WR_BLK_ERASE_COUNT */
+        }
+        else if (c->cfg.Cmd23Support != 0U)
+        {
+            c->cmd.cmd23 = Command->Argument & 0x0000FFFFU;    /* CMD23 SET_BLOCK_COUNT */
+        }
+        else
+        {
+            c->cmd.err = SDMMC_ERROR_ILLEGAL_CMD;
+        }
+    }
+    else if (Command->CmdIndex == SDMMC_CMD_APP_CMD)
+    {
+        c->cmd.app = 1U;
+    }
+    else
+    {
+        /* 其他命令不影响预定义状态 */
+    }
+
+    return HAL_OK;
+}
+
+uint32_t SDMMC_GetCmdResp1(SDMMC_TypeDef *SDMMCx, uint8_t SD_CMD, uint32_t Timeout)
+{
+    SIM_CardTypeDef *c = SIM_Card(SDMMCx);
+    (void)SDMMCx;
+    (void)Timeout;
+    SDMMCx->RESPCMD = SD_CMD;
+    return c->cmd.err;
+}
+
+uint32_t SDMMC_CmdBlockLength(SDMMC_TypeDef *SDMMCx, uint32_t BlockSize)
+{
+    SDMMC_CmdInitTypeDef cmd = { BlockSize, SDMMC_CMD_SET_BLOCKLEN, SDMMC_RESPONSE_SHORT, SDMMC_WAIT_NO,
+                                 SDMMC_CPSM_ENABLE };
+
+    (void)SDMMC_SendCommand(SDMMCx, &cmd);
+    return SDMMC_GetCmdResp1(SDMMCx, SDMMC_CMD_SET_BLOCKLEN, SDMMC_CMDTIMEOUT);
+}
+
+uint32_t SDMMC_CmdAppCommand(SDMMC_TypeDef *SDMMCx, uint32_t Argument)
+{
+    SDMMC_CmdInitTypeDef cmd = { Argument, SDMMC_CMD_APP_CMD, SDMMC_RESPONSE_SHORT, SDMMC_WAIT_NO,
+                                 SDMMC_CPSM_ENABLE };
+
+    (void)SDMMC_SendCommand(SDMMCx, &cmd);
+    return SDMMC_GetCmdResp1(SDMMCx, SDMMC_CMD_APP_CMD, SDMMC_CMDTIMEOUT);
+}
+
+/**
+  * @brief  32位字节序反转：数据线上先传高字节，FIFO按小端装入
+  */
+static uint32_t SIM_Bswap(uint32_t v)
+{
+    return ((v & 0xFFU) << 24) | ((v & 0xFF00U) << 8) | ((v >> 8) & 0xFF00U) | (v >> 24);
+}
+
+uint32_t SDMMC_CmdSendSCR(SDMMC_TypeDef *SDMMCx)
+{
+    SIM_CardTypeDef *c = SIM_Card(SDMMCx);
+    SDMMC_CmdInitTypeDef cmd = { 0U, SDMMC_CMD_SD_APP_SEND_SCR, SDMMC_RESPONSE_SHORT, SDMMC_WAIT_NO,
+                                 SDMMC_CPSM_ENABLE };
+    uint8_t app = c->cmd.app;
+
+    (void)SDMMC_SendCommand(SDMMCx, &cmd);
+    if ((app == 0U) || (SDMMCx->DLEN != 8U))
+    {
+        SDMMCx->STA |= SDMMC_FLAG_DTIMEOUT;
+        return SDMMC_ERROR_ILLEGAL_CMD;
+    }
+
+    c->cmd.fifo[0] = SIM_Bswap(SIM_SCR_HI | ((c->cfg.Cmd23Support != 0U) ? SIM_SCR_CMD23 : 0U));
+    c->cmd.fifo[1] = 0U;
+    c->cmd.fifo_n = 2U;
+    c->cmd.fifo_len = 2U;
+    SIM_Advance(SIM_ClocksToNs(c, (64U / (((SDMMCx->CLKCR & SDMMC_CLKCR_WIDBUS) == SDMMC_BUS_WIDE_4B) ? 4U : 1U)) +
+                               SIM_CRC_CLOCKS));
+    SDMMCx->STA = (SDMMCx->STA & ~SDMMC_FLAG_RXFIFOE) | SDMMC_FLAG_DATAEND | SDMMC_FLAG_DBCKEND;
+
+    return SDMMC_ERROR_NONE;
+}
+
+uint32_t SDMMC_CmdSwitch(SDMMC_TypeDef *SDMMCx, uint32_t Argument)
+{
+    SIM_CardTypeDef *c = SIM_Card(SDMMCx);
+    SDMMC_CmdInitTypeDef cmd = { Argument, SDMMC_CMD_HS_SWITCH, SDMMC_RESPONSE_SHORT, SDMMC_WAIT_NO,
+                                 SDMMC_CPSM_ENABLE };
+    uint8_t status[64];
+    uint32_t fn = Argument & 0x0FU;
+    uint32_t i;
+    uint8_t ok;
+
+    (void)SDMMC_SendCommand(SDMMCx, &cmd);
+    if (SDMMCx->DLEN != 64U)
+    {
+        SDMMCx->STA |= SDMMC_FLAG_DTIMEOUT;
+        return SDMMC_ERROR_ILLEGAL_CMD;
+    }
+
+    /* 功能组1：0=Default，1=High Speed；其他组保持0xF（不改变） */
+    ok = ((fn == 0U) || ((fn == 1U) && (c->cfg.HighSpeedSupport != 0U))) ? 1U : 0U;
+    memset(status, 0, sizeof(status));
+    status[1]  = 100U;                                              /* 最大电流100mA */
+    status[13] = (c->cfg.HighSpeedSupport != 0U) ? 0x03U : 0x01U; /* 功能组1支持的功能 */
+    status[12] = 0x80U;
+    status[16] = (uint8_t)((fn == 0xFU) ? (c->high_speed != 0U ? 1U : 0U) : ((ok != 0U) ? fn : 0xFU));
+    status[17] = 0x01U;                                             /* 数据结构版本 */
+    if (((Argument & 0x80000000U) != 0U) && (ok != 0U))
+    {
+        c->high_speed = (fn == 1U) ? 1U : 0U;
+    }
+
+    for (i = 0U; i < 16U; i++)
+    {
+        memcpy(&c->cmd.fifo[i], &status[i * 4U], 4U);             /* FIFO按小端装入 */
+    }
+    c->cmd.fifo_n = 16U;
+    c->cmd.fifo_len = 16U;
+    SIM_Advance(SIM_ClocksToNs(c, (512U / (((SDMMCx->CLKCR & SDMMC_CLKCR_WIDBUS) == SDMMC_BUS_WIDE_4B) ? 4U : 1U)) +
+                               SIM_CRC_CLOCKS));
+    SDMMCx->STA = (SDMMCx->STA & ~SDMMC_FLAG_RXFIFOE) | SDMMC_FLAG_DATAEND | SDMMC_FLAG_DBCKEND;
+
+    return SDMMC_ERROR_NONE;
+}
+
+HAL_StatusTypeDef SDMMC_ConfigData(SDMMC_TypeDef *SDMMCx, const SDMMC_DataInitTypeDef *Data)
+{
+    SIM_CardTypeDef *c = SIM_Card(SDMMCx);
+    SDMMCx->DTIMER = Data->DataTimeOut;
+    SDMMCx->DLEN = Data->DataLength;
+    SDMMCx->DCTRL = Data->DataBlockSize | Data->TransferDir | Data->TransferMode | Data->DPSM;
+    SDMMCx->STA = (SDMMCx->STA & ~SDMMC_STATIC_DATA_FLAGS) | SDMMC_FLAG_RXFIFOE;
+    c->cmd.fifo_n = 0U;
+
+    return HAL_OK;
+}
+
+uint32_t SDMMC_ReadFIFO(const SDMMC_TypeDef *SDMMCx)
+{
+    SIM_CardTypeDef *c = SIM_Card(SDMMCx);
+    uint32_t v = 0U;
+
+    (void)SDMMCx;
+    if (c->cmd.fifo_n != 0U)
+    {
+        v = c->cmd.fifo[c->cmd.fifo_len - c->cmd.fifo_n];
+        c->cmd.fifo_n--;
+        if (c->cmd.fifo_n == 0U)
+        {
+            c->regs->STA |= SDMMC_FLAG_RXFIFOE;
+        }
+    }
+
+    return v;
+}
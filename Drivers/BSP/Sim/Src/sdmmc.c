@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    sdmmc.c
+  * @brief   主机仿真工程的sdmmc.c - 与CubeMX生成的SDMMC1/SDMMC2初始化保持一致
+  * @author  STMicroelectronics
+  * @date    2025-10-20
+  * @version 1.0
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sdmmc.h"
+
+SD_HandleTypeDef hsd1;
+SD_HandleTypeDef hsd2;
+
+/* SDMMC1 init function */
+void MX_SDMMC1_SD_Init(void)
+{
+  hsd1.Instance = SDMMC1;
+  hsd1.Init.ClockEdge = SDMMC_CLOCK_EDGE_RISING;
+  hsd1.Init.ClockPowerSave = SDMMC_CLOCK_POWER_SAVE_DISABLE;
+  hsd1.Init.BusWide = SDMMC_BUS_WIDE_4B;
+  hsd1.Init.HardwareFlowControl = SDMMC_HARDWARE_FLOW_CONTROL_DISABLE;
+  hsd1.Init.ClockDiv = 0;
+  if (HAL_SD_Init(&hsd1) != HAL_OK)
+  {
+    hsd1.State = HAL_SD_STATE_ERROR;
+  }
+}
+
+/* SDMMC2 init function */
+void MX_SDMMC2_SD_Init(void)
+{
+  hsd2.Instance = SDMMC2;
+  hsd2.Init.ClockEdge = SDMMC_CLOCK_EDGE_RISING;
+  hsd2.Init.ClockPowerSave = SDMMC_CLOCK_POWER_SAVE_DISABLE;
+  hsd2.Init.BusWide = SDMMC_BUS_WIDE_4B;
+  hsd2.Init.HardwareFlowControl = SDMMC_HARDWARE_FLOW_CONTROL_DISABLE;
+  hsd2.Init.ClockDiv = 0;
+  if (HAL_SD_Init(&hsd2) != HAL_OK)
+  {
+    hsd2.State = HAL_SD_STATE_ERROR;
+  }
+}
@@ -26,54 +26,240 @@
 /* USER CODE BEGIN 0 */
 #include <string.h>  /* MISRA-C 要求显式包含 */
 
+#if (SD_CACHE_ENABLE != 0U)
+#include "sd_cache.h"
+#endif
+
+#if (SD_PREFETCH_ENABLE != 0U)
+#include "sd_prefetch.h"
+#endif
+
+#if (SD_QUEUE_ENABLE != 0U)
+#include "sd_queue.h"
+#endif
+
+#if (SD_DISCARD_ENABLE != 0U)
+#include "sd_discard.h"
+#endif
+
+#if (SD_TRACE_ENABLE != 0U)
+#include "sd_trace.h"
+#endif
+
+#if (SD_CRC_ENABLE != 0U)
+#include "sd_crc.h"
+#endif
+
+#if (SD_RECOVER_ENABLE != 0U)
+#include "sd_recover.h"
+#endif
+
 #ifdef DEBUG
 #include <stdio.h>   /* 仅在DEBUG模式下包含 */
 #endif
 
 #ifdef DEBUG
-static void SD_ErrorHandler(const char* operation);  /* 前向声明 */
+static void SD_ErrorHandler(SD_DeviceTypeDef *hdev, const char* operation);  /* 前向声明 */
+#endif
+
+SD_DeviceTypeDef sddev1 = { .hsd = &hsd1 };                /* 默认实例，旧接口都作用于它 */
+static SD_DeviceTypeDef *sd_devices[SD_MAX_DEVICES];       /* 已注册的实例，HAL回调按句柄查找 */
+
+#if (SD_STATS_ENABLE != 0U)
+static void SD_StatsRecord(SD_OpStatsTypeDef *pOp, uint32_t Start, uint32_t Bytes, HAL_StatusTypeDef Status);
+#define SD_STATS_TIC()                           (DWT->CYCCNT)
+#define SD_STATS_TOC(dev, op, t0, bytes, status) SD_StatsRecord(&(dev)->Stats.op, (t0), (bytes), (status))
+#else
+#define SD_STATS_TIC()                           (0U)
+#define SD_STATS_TOC(dev, op, t0, bytes, status) ((void)(t0))
+#endif
+
+#if (SD_TRACE_ENABLE != 0U)
+/* 跟踪缓冲区只有一个，只记录默认实例的事件 */
+#define SD_TRACE(dev, type, cmd, blk, cnt, arg) \
+  do { if ((dev) == &sddev1) { SD_Trace_Record((type), (uint8_t)(cmd), (blk), (cnt), (uint32_t)(arg)); } } while (0)
+#define SD_TRACE_IDMA(dev, cmd, blk, cnt, arg)  do { (dev)->TraceCmd = (uint8_t)(cmd); (dev)->TraceBlk = (blk); \
+                                                     SD_TRACE((dev), SD_TRACE_EV_IDMA_START, (cmd), (blk), (cnt), (arg)); } while (0)
+#else
+#define SD_TRACE(dev, type, cmd, blk, cnt, arg) ((void)0)
+#define SD_TRACE_IDMA(dev, cmd, blk, cnt, arg)  ((void)0)
+#endif
+#define SD_CMD_READ(n)           (((n) == 1U) ? 17U : 18U)   /* READ_SINGLE_BLOCK / READ_MULTIPLE_BLOCK */
+#define SD_CMD_WRITE(n)          (((n) == 1U) ? 24U : 25U)   /* WRITE_BLOCK / WRITE_MULTIPLE_BLOCK */
+
+#define SD_SCR_CMD23_SUPPORT     0x00000002U   /* SCR[33]，位于高32位的bit1 */
+#define SD_ACMD23_MAX_BLOCKS     0x007FFFFFU   /* ACMD23预擦除块数为23位 */
+#define SD_CMD23_MAX_BLOCKS      0x0000FFFFU   /* CMD23块数为16位 */
+
+#if (SD_HIGH_SPEED_ENABLE != 0U)
+/* 只在初始化时使用，各实例共用 */
+ALIGN_32BYTES(static uint8_t sd_speed_ref[SD_SPEED_VERIFY_BLOCKS * 512]);  /* 提速校验：原时钟读出的参考数据 */
+ALIGN_32BYTES(static uint8_t sd_speed_buf[SD_SPEED_VERIFY_BLOCKS * 512]);  /* 提速校验：新时钟读出的数据 */
+#endif
+
+#define SD_SWITCH_CHECK          0x00FFFFF0U   /* CMD6模式0（查询），其余功能组不变 */
+#define SD_SWITCH_SET            0x80FFFFF0U   /* CMD6模式1（切换） */
+#define SD_SWITCH_GROUP1_HS      0x00000001U   /* 功能组1：High Speed / SDR25 */
+#define SD_SDXC_MIN_BLOCKS       0x04000000U   /* 超过32GB（块数）为SDXC，写入编程忙上限更长 */
+#define SD_TIMEOUT_AU_DEFAULT    8192U         /* AU未知时擦除超时按4MB一个AU计 */
+
+static uint32_t SD_ReadSCR(SD_DeviceTypeDef *hdev, uint32_t *pSCR);
+static uint8_t SD_PreDefineWrite(SD_DeviceTypeDef *hdev, uint32_t NumberOfBlocks, uint8_t UseCmd23);
+#if (SD_HIGH_SPEED_ENABLE != 0U)
+static HAL_StatusTypeDef SD_SwitchHighSpeed(SD_DeviceTypeDef *hdev);
+static HAL_StatusTypeDef SD_NegotiateSpeed(SD_DeviceTypeDef *hdev);
+#endif
+static void SD_SpeedFallback(SD_DeviceTypeDef *hdev, uint32_t ErrorCode);
+static uint32_t SD_AuSizeToBlocks(const SD_DeviceTypeDef *hdev);
+static void SD_ReadCsdTimeouts(SD_DeviceTypeDef *hdev);
+static uint32_t SD_LimitTimeout(uint32_t Timeout, uint32_t Derived);
+static void SD_Yield(SD_DeviceTypeDef *hdev, uint32_t Us);
+#if (SD_USE_IDMA != 0U)
+/* 跳板缓冲区由各实例共用，借还时关中断 */
+ALIGN_32BYTES(static uint8_t sd_bounce_pool[SD_BOUNCE_COUNT][SD_BOUNCE_BLOCKS * SD_BLOCK_SIZE]) SD_BOUNCE_SECTION;
+static volatile uint32_t sd_bounce_used;                   /* 位k为1：跳板缓冲区k已借出 */
+static HAL_StatusTypeDef SD_DmaTransfer(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                        uint32_t NumberOfBlocks, uint8_t IsRead, uint32_t Timeout);
 #endif
+static HAL_StatusTypeDef SD_StartRead(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                      uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq);
 
-static uint32_t tickstart;  /* 超时计数器 */
+/* SDMMC1 IDMA经AXI总线矩阵访问存储器，以下区域不可访问 */
+#define SD_DMA_ITCM_END          0x08000000U   /* ITCM及Flash以下的保留区 */
+#define SD_DMA_DTCM_START        0x20000000U
+#define SD_DMA_DTCM_END          0x24000000U   /* AXI SRAM起始 */
+#define SD_DMA_D2D3_START        0x30000000U   /* D2域SRAM1/2/3、D3域SRAM4、备份SRAM */
+#define SD_DMA_D2D3_END          0x40000000U
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief  按HAL句柄查找已注册的实例
+  * @param  hsd: HAL句柄
+  * @retval SD_DeviceTypeDef* 未注册时返回NULL
+  */
+static SD_DeviceTypeDef *SD_FindDevice(const SD_HandleTypeDef *hsd)
+{
+  uint32_t i;
+
+  for (i = 0U; i < SD_MAX_DEVICES; i++)
+  {
+    if ((sd_devices[i] != NULL) && (sd_devices[i]->hsd == hsd))
+    {
+      return sd_devices[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  * @brief  登记实例：同一个实例重复初始化时沿用原表项
+  * @param  hdev: 设备实例
+  * @param  hsd: 已由MX_SDMMCx_SD_Init()初始化的HAL句柄
+  * @retval HAL_StatusTypeDef 句柄已属于其他实例或表已满时返回HAL_ERROR
+  */
+static HAL_StatusTypeDef SD_Register(SD_DeviceTypeDef *hdev, SD_HandleTypeDef *hsd)
+{
+  SD_DeviceTypeDef *owner = SD_FindDevice(hsd);
+  uint32_t i;
+
+  if (owner == hdev)
+  {
+    return HAL_OK;
+  }
+  if (owner != NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  for (i = 0U; i < SD_MAX_DEVICES; i++)
+  {
+    if (sd_devices[i] == hdev)
+    {
+      break;  /* 换了HAL句柄：沿用原表项 */
+    }
+  }
+  if (i == SD_MAX_DEVICES)
+  {
+    for (i = 0U; i < SD_MAX_DEVICES; i++)
+    {
+      if (sd_devices[i] == NULL)
+      {
+        break;
+      }
+    }
+    if (i == SD_MAX_DEVICES)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  hdev->hsd = hsd;
+  hdev->ActiveReq = NULL;
+  hdev->WriteMode = SD_WRITE_MODE_DEFAULT;
+  hdev->BusSpeed = SD_BUS_SPEED_DEFAULT;
+  hdev->CsdTimeouts = 0U;
+  hdev->BusyTimeoutMs = 0U;
+  sd_devices[i] = hdev;
+
+  return HAL_OK;
+}
+
 /**
   * @brief  SD卡初始化
+  * @param  hdev: 设备实例
+  * @param  hsd: 已由MX_SDMMCx_SD_Init()初始化的HAL句柄
   * @retval HAL_StatusTypeDef 返回操作状态
   * @note   等待SD卡就绪并检查卡状态，超时时间1秒
   */
-HAL_StatusTypeDef SD_Init(void)
+HAL_StatusTypeDef SD_Dev_Init(SD_DeviceTypeDef *hdev, SD_HandleTypeDef *hsd)
 {
   HAL_SD_CardStateTypeDef card_state;
   HAL_StatusTypeDef status = HAL_OK;
+  uint32_t tickstart;
   
+  if ((hdev == NULL) || (hsd == NULL) || (SD_Register(hdev, hsd) != HAL_OK))
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 实例登记失败（句柄已被占用或超过SD_MAX_DEVICES）\r\n");
+#endif
+    return HAL_ERROR;
+  }
+
+
+  /* 运行统计与SD_WaitReady()的查询间隔用DWT周期计数器计时 */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
 #ifdef DEBUG
   printf("[SD] SD卡初始化...\r\n");
-  printf("[SD] hsd1.State = %d, hsd1.ErrorCode = 0x%08lX\r\n", hsd1.State, hsd1.ErrorCode);
+  printf("[SD] hsd->State = %d, hsd->ErrorCode = 0x%08lX\r\n", hdev->hsd->State, hdev->hsd->ErrorCode);
 #endif
   
   /* 等待SD卡就绪（1秒超时）*/
   tickstart = HAL_GetTick();
   while ((HAL_GetTick() - tickstart) < SD_TIMEOUT_DEFAULT)
   {
-    if (hsd1.State == HAL_SD_STATE_READY)
+    if (hdev->hsd->State == HAL_SD_STATE_READY)
     {
       break;
     }
+    SD_Yield(hdev, SD_WAIT_POLL_MAX_US);
   }
   
-  if (hsd1.State != HAL_SD_STATE_READY)
+  if (hdev->hsd->State != HAL_SD_STATE_READY)
   {
 #ifdef DEBUG
-    printf("[SD] [FAIL] SD卡未就绪，状态: %d\r\n", hsd1.State);
+    printf("[SD] [FAIL] SD卡未就绪，状态: %d\r\n", hdev->hsd->State);
 #endif
     status = HAL_ERROR;
   }
   else
   {
     /* 检查卡状态 */
-    card_state = HAL_SD_GetCardState(&hsd1);
+    card_state = HAL_SD_GetCardState(hdev->hsd);
     if (card_state != HAL_SD_CARD_TRANSFER)
     {
 #ifdef DEBUG
@@ -82,6 +268,32 @@ HAL_StatusTypeDef SD_Init(void)
       status = HAL_ERROR;
     }
   }
+
+  if (status == HAL_OK)
+  {
+    uint32_t scr[2] = {0U, 0U};
+
+    /* 读SCR确定是否支持CMD23；读不到时按不支持处理，只用ACMD23 */
+    hdev->Cmd23Supported = ((SD_ReadSCR(hdev, scr) == SDMMC_ERROR_NONE) &&
+                          ((scr[1] & SD_SCR_CMD23_SUPPORT) != 0U)) ? 1U : 0U;
+
+    /* 读SD Status取AU大小与速度等级；读不到时AU按未知处理 */
+    hdev->CardStatusValid = (HAL_SD_GetCardStatus(hdev->hsd, &hdev->CardStatus) == HAL_OK) ? 1U : 0U;
+
+    /* SDSC的读写超时按CSD计算 */
+    SD_ReadCsdTimeouts(hdev);
+  }
+
+  hdev->DefaultClkDiv = hdev->hsd->Instance->CLKCR & SDMMC_CLKCR_CLKDIV;
+  hdev->ClockRaised = 0U;
+
+#if (SD_HIGH_SPEED_ENABLE != 0U)
+  if (status == HAL_OK)
+  {
+    /* 协商失败时保持原时钟，不影响初始化结果 */
+    (void)SD_NegotiateSpeed(hdev);
+  }
+#endif
   
 #ifdef DEBUG
   if (status == HAL_OK)
@@ -89,7 +301,7 @@ HAL_StatusTypeDef SD_Init(void)
     SD_CardInfoTypeDef card_info;
     HAL_StatusTypeDef info_status;
     
-    info_status = SD_GetCardInfo(&card_info);
+    info_status = SD_Dev_GetCardInfo(hdev, &card_info);
     if (info_status == HAL_OK)
     {
       uint32_t total_mb = card_info.LogBlockNbr / 2048U;  /* 总MB数 */
@@ -100,6 +312,13 @@ HAL_StatusTypeDef SD_Init(void)
               total_mb, gb_int, gb_decimal);
       printf("[SD] 块大小: %lu, 总块数: %lu\r\n", 
               card_info.LogBlockSize, card_info.LogBlockNbr);
+      printf("[SD] 总线: %s, SDMMC_CK = %lu Hz\r\n",
+              (card_info.BusSpeedMode == SD_BUS_SPEED_HIGH) ? "High Speed" : "Default Speed",
+              card_info.BusClockHz);
+      printf("[SD] AU: %lu KB, Class %lu, U%lu, V%lu\r\n",
+              card_info.AuBlocks / 2U, card_info.SpeedClass, card_info.UhsSpeedGrade, card_info.VideoSpeedClass);
+      printf("[SD] 超时: 读访问 %lu us, 编程忙 %lu us, 擦除 %lu ms/AU + %lu ms\r\n",
+              card_info.ReadAccessUs, card_info.WriteBusyUs, card_info.EraseAuMs, card_info.EraseOffsetMs);
     }
     else
     {
@@ -111,199 +330,2115 @@ HAL_StatusTypeDef SD_Init(void)
   return status;
 }
 
+HAL_StatusTypeDef SD_Init(void)
+{
+  return SD_Dev_Init(&sddev1, &hsd1);
+}
+
+/**
+  * @brief  检查SD卡状态
+  * @param  hdev: 设备实例
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note  如果卡状态为HAL_SD_CARD_DISCONNECTED，返回HAL_TIMEOUT
+  * @note  如果卡状态为HAL_SD_CARD_ERROR，返回HAL_ERROR(DEBUG模式下还会输出诊断信息)
+  * @note  如果卡状态为HAL_SD_CARD_TRANSFER或HAL_SD_CARD_READY，返回HAL_OK
+  * @note  如果卡状态为HAL_SD_CARD_SENDING、HAL_SD_CARD_RECEIVING或HAL_SD_CARD_PROGRAMMING，返回HAL_BUSY
+  */
+HAL_StatusTypeDef SD_Dev_Check(SD_DeviceTypeDef *hdev)
+{
+  HAL_SD_CardStateTypeDef card_state;
+  HAL_StatusTypeDef status = HAL_OK;
+  
+  card_state = HAL_SD_GetCardState(hdev->hsd);
+  
+  switch (card_state)
+  {
+    case HAL_SD_CARD_TRANSFER:
+    case HAL_SD_CARD_READY:
+      status = HAL_OK;
+      break;
+      
+    case HAL_SD_CARD_SENDING:
+    case HAL_SD_CARD_RECEIVING:
+    case HAL_SD_CARD_PROGRAMMING:
+      status = HAL_BUSY;
+      break;
+      
+    case HAL_SD_CARD_DISCONNECTED:
+      status = HAL_TIMEOUT;
+      break;
+      
+    case HAL_SD_CARD_ERROR:
+#ifdef DEBUG
+      printf("[SD] SD卡状态异常: %lu\r\n", (uint32_t)card_state);
+      SD_ErrorHandler(hdev, "检查");
+#endif
+      status = HAL_ERROR;
+      break;
+      
+    default:
+      status = HAL_ERROR;
+      break;
+  }
+
+  return status;
+}
+
+HAL_StatusTypeDef SD_Check(void)
+{
+  return SD_Dev_Check(&sddev1);
+}
+
+/**
+  * @brief  等待SD卡就绪
+  * @param  hdev: 设备实例
+  * @param  Timeout: 超时时间上限（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   等待SD卡进入传输状态，超时取Timeout与最近一次读写、擦除算出的hdev->BusyTimeoutMs中较小的一个
+  * @note   CMD13返回编程状态且DAT0忙（BUSYD0）时不再发命令，等SDMMC检测到DAT0释放（BUSYD0END）后再发一次CMD13确认；
+  *         其他状态下CMD13的间隔从SD_WAIT_POLL_MIN_US起每次加倍，不超过SD_WAIT_POLL_MAX_US。
+  *         两次检查之间调用SD_WaitYield()
+  * @note   卡无响应或不在传输、收发、编程状态时立即返回HAL_ERROR，不等到超时
+  */
+HAL_StatusTypeDef SD_Dev_WaitReady(SD_DeviceTypeDef *hdev, uint32_t Timeout)
+{
+  uint32_t tickstart_local;
+  uint32_t t0 = SD_STATS_TIC();
+  uint32_t polls = 0U;
+  uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+  uint32_t interval_us = SD_WAIT_POLL_MIN_US;
+  uint32_t last_poll = 0U;
+  uint32_t elapsed_us;
+  uint32_t yield_us = 0U;
+  uint8_t busy_d0 = 0U;
+  uint8_t busy_traced = 0U;  /* 已记录BUSY_START，结束时须配对BUSY_END */
+  HAL_SD_CardStateTypeDef card_state = HAL_SD_CARD_TRANSFER;
+  HAL_StatusTypeDef status = HAL_TIMEOUT;
+  
+  Timeout = SD_LimitTimeout(Timeout, hdev->BusyTimeoutMs);
+  tickstart_local = HAL_GetTick();
+  
+  while ((HAL_GetTick() - tickstart_local) < Timeout)
+  {
+    if (busy_d0 != 0U)
+    {
+      /* DAT0释放前不占用总线；标志由下一条命令的响应清除 */
+      if (__SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_BUSYD0END))
+      {
+        busy_d0 = 0U;
+        yield_us = 0U;
+#if (SD_STATS_ENABLE != 0U)
+        hdev->Stats.WaitBusyEnds++;
+#endif
+      }
+      else
+      {
+        yield_us = (SD_WAIT_POLL_MIN_US != 0U) ? SD_WAIT_POLL_MIN_US : 1U;
+      }
+    }
+    else if (polls != 0U)
+    {
+      elapsed_us = (DWT->CYCCNT - last_poll) / cycles_per_us;
+      yield_us = (elapsed_us < interval_us) ? (interval_us - elapsed_us) : 0U;
+      if (yield_us == 0U)
+      {
+        interval_us = ((interval_us * 2U) < SD_WAIT_POLL_MAX_US) ? (interval_us * 2U) : SD_WAIT_POLL_MAX_US;
+      }
+    }
+    else
+    {
+      yield_us = 0U;
+    }
+
+    if (yield_us != 0U)
+    {
+      SD_Yield(hdev, yield_us);
+    }
+    else
+    {
+      polls++;
+      last_poll = DWT->CYCCNT;
+      card_state = HAL_SD_GetCardState(hdev->hsd);
+      if (card_state == HAL_SD_CARD_TRANSFER)
+      {
+        status = HAL_OK;
+        break;
+      }
+      if ((card_state != HAL_SD_CARD_PROGRAMMING) && (card_state != HAL_SD_CARD_RECEIVING) &&
+          (card_state != HAL_SD_CARD_SENDING))
+      {
+        /* 卡无响应或已不在传输模式（如掉电复位），再等也不会就绪 */
+        status = HAL_ERROR;
+        break;
+      }
+      if (busy_traced == 0U)
+      {
+        SD_TRACE(hdev, SD_TRACE_EV_BUSY_START, 13U, 0U, 0U, 0U);
+        busy_traced = 1U;
+      }
+#if (SD_WAIT_BUSY_DETECT != 0U)
+      busy_d0 = ((card_state == HAL_SD_CARD_PROGRAMMING) &&
+                 __SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_BUSYD0)) ? 1U : 0U;
+#endif
+    }
+  }
+  if (busy_traced != 0U)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_BUSY_END, 13U, 0U, polls, status);
+  }
+#if (SD_STATS_ENABLE != 0U)
+  hdev->Stats.WaitPolls += polls;
+#endif
+  SD_STATS_TOC(hdev, WaitReady, t0, 0U, status);
+  
+#ifdef DEBUG
+  if (status == HAL_TIMEOUT)
+  {
+    printf("[SD] [FAIL] 等待SD卡就绪超时 (%lu ms)\r\n", Timeout);
+  }
+  else if (status != HAL_OK)
+  {
+    printf("[SD] [FAIL] 等待SD卡就绪时卡状态异常: %lu\r\n", (uint32_t)card_state);
+  }
+#endif
+  
+  return status;
+}
+
+HAL_StatusTypeDef SD_WaitReady(uint32_t Timeout)
+{
+  return SD_Dev_WaitReady(&sddev1, Timeout);
+}
+
+/**
+  * @brief  等待卡就绪期间让出CPU（弱定义）：默认立即返回
+  * @param  Us: 可以让出的时间（微秒）
+  */
+__weak void SD_WaitYield(uint32_t Us)
+{
+  (void)Us;
+}
+
+/**
+  * @brief  调用SD_WaitYield()并统计其中度过的时间
+  * @param  hdev: 设备实例
+  * @param  Us: 可以让出的时间（微秒）
+  */
+static void SD_Yield(SD_DeviceTypeDef *hdev, uint32_t Us)
+{
+#if (SD_STATS_ENABLE != 0U)
+  uint32_t t0 = DWT->CYCCNT;
+
+  SD_WaitYield(Us);
+  hdev->Stats.WaitYieldCycles += DWT->CYCCNT - t0;
+#else
+  (void)hdev;
+  SD_WaitYield(Us);
+#endif
+}
+
+
+/**
+  * @brief  SD卡多块写入
+  * @param  pData: 数据缓冲区指针（必须4字节对齐）
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   SD_CACHE_ENABLE时经过块缓存（写回），SD_QUEUE_ENABLE时经过写合并队列，否则直接写卡
+  */
+HAL_StatusTypeDef SD_WriteBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+#if (SD_DISCARD_ENABLE != 0U)
+  /* 写入可能留在缓存或队列中，先取消这些块的待擦除记录 */
+  SD_Discard_Forget(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_CRC_ENABLE != 0U)
+  /* 直接写卡时在等待IDMA的循环中计算CRC */
+  SD_Crc_BeginWrite(pData, BlockAdd, NumberOfBlocks, Timeout);
+#endif
+#if (SD_CACHE_ENABLE != 0U)
+  status = SD_Cache_Write(pData, BlockAdd, NumberOfBlocks, Timeout);
+#elif (SD_QUEUE_ENABLE != 0U)
+  status = SD_Queue_Write(pData, BlockAdd, NumberOfBlocks, Timeout);
+#else
+  status = SD_WriteBlocksDirect(pData, BlockAdd, NumberOfBlocks, Timeout);
+#endif
+#if (SD_CRC_ENABLE != 0U)
+  status = SD_Crc_EndWrite(status, Timeout);
+#endif
+
+  return status;
+}
+
+/**
+  * @brief  SD卡多块读取
+  * @param  pData: 数据缓冲区指针（必须4字节对齐）
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   SD_CACHE_ENABLE时优先从块缓存读取（未命中再经过预取器），否则直接读卡
+  */
+HAL_StatusTypeDef SD_ReadBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+#if (SD_CACHE_ENABLE != 0U)
+  status = SD_Cache_Read(pData, BlockAdd, NumberOfBlocks, Timeout);
+#elif (SD_QUEUE_ENABLE != 0U)
+  status = SD_Queue_Read(pData, BlockAdd, NumberOfBlocks, Timeout);
+#elif (SD_PREFETCH_ENABLE != 0U)
+  status = SD_Prefetch_Read(pData, BlockAdd, NumberOfBlocks, Timeout);
+#elif (SD_CRC_ENABLE != 0U)
+  /* 读卡与校验重叠 */
+  status = SD_Crc_ReadDirect(pData, BlockAdd, NumberOfBlocks, Timeout);
+#else
+  status = SD_ReadBlocksDirect(pData, BlockAdd, NumberOfBlocks, Timeout);
+#endif
+#if (SD_CRC_ENABLE != 0U) && ((SD_CACHE_ENABLE != 0U) || (SD_QUEUE_ENABLE != 0U) || (SD_PREFETCH_ENABLE != 0U))
+  status = SD_Crc_Verify(status, pData, BlockAdd, NumberOfBlocks, Timeout);
+#endif
+
+  return status;
+}
+
+/**
+  * @brief  将驱动内部缓存的数据写入卡
+  * @param  Timeout: 每次写入的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   先写回块缓存（脏行进入写合并队列），再刷新写合并队列，最后写回CRC表；都未使能时直接返回HAL_OK
+  */
+HAL_StatusTypeDef SD_Flush(uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+
+#if (SD_CACHE_ENABLE != 0U)
+  status = SD_Cache_Flush(Timeout);
+#endif
+#if (SD_QUEUE_ENABLE != 0U)
+  if (status == HAL_OK)
+  {
+    status = SD_Queue_Sync(Timeout);
+  }
+#endif
+#if (SD_CRC_ENABLE != 0U)
+  if (status == HAL_OK)
+  {
+    status = SD_Crc_Flush(Timeout);
+  }
+#endif
+  (void)Timeout;
+
+  return status;
+}
+
+/**
+  * @brief  SD卡擦除块
+  * @param  hdev: 设备实例
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 等待卡就绪的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   擦除区间内的缓存行和写合并队列中的块直接作废（包括未写回的数据）；这些前门层只作用于默认实例
+  */
+HAL_StatusTypeDef SD_Dev_EraseBlocks(SD_DeviceTypeDef *hdev, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t t0 = SD_STATS_TIC();
+
+  if (NumberOfBlocks == 0U)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: NumberOfBlocks为0\r\n");
+#endif
+    return HAL_ERROR;
+  }
+
+  if (hdev == &sddev1)
+  {
+#if (SD_CACHE_ENABLE != 0U)
+    SD_Cache_Invalidate(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_QUEUE_ENABLE != 0U)
+    SD_Queue_Discard(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_PREFETCH_ENABLE != 0U)
+    SD_Prefetch_Quiesce(Timeout);
+    SD_Prefetch_Invalidate(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+    SD_Discard_Forget(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_CRC_ENABLE != 0U)
+    (void)SD_Crc_Forget(BlockAdd, NumberOfBlocks, Timeout);
+#endif
+  }
+
+  status = SD_Dev_WaitReady(hdev, Timeout);
+  if (status == HAL_OK)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_CMD, 38U, BlockAdd, NumberOfBlocks, 0U);
+    status = HAL_SD_EraseBlocks(hdev->hsd, BlockAdd, BlockAdd + NumberOfBlocks - 1U);
+    if (status == HAL_OK)
+    {
+      /* 之后等待就绪按擦除的AU数计时 */
+      hdev->BusyTimeoutMs = SD_Dev_GetTimeout(hdev, SD_OP_ERASE, NumberOfBlocks);
+    }
+    else
+    {
+      SD_TRACE(hdev, SD_TRACE_EV_ERROR, 38U, BlockAdd, NumberOfBlocks, HAL_SD_GetError(hdev->hsd));
+    }
+#ifdef DEBUG
+    if (status != HAL_OK)
+    {
+      printf("[SD] [FAIL] 擦除失败，状态: %d\r\n", status);
+      SD_ErrorHandler(hdev, "擦除");
+    }
+#endif
+  }
+  SD_STATS_TOC(hdev, Erase, t0, NumberOfBlocks * SD_BLOCK_SIZE, status);
+
+  return status;
+}
+
+HAL_StatusTypeDef SD_EraseBlocks(uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  return SD_Dev_EraseBlocks(&sddev1, BlockAdd, NumberOfBlocks, Timeout);
+}
+
+/**
+  * @brief  等待卡就绪后传输一次
+  * @param  hdev: 设备实例
+  * @param  pData: 数据缓冲区
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 超时时间上限（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   数据传输的超时取Timeout与SD_Dev_GetTimeout()中较小的一个（IDMA由SD_WaitRequest()按请求的TimeoutMs处理）
+  */
+static HAL_StatusTypeDef SD_XferOnce(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint8_t IsRead,
+                                     uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+  /* 等待SD卡就绪 */
+  status = SD_Dev_WaitReady(hdev, Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+#if (SD_USE_IDMA != 0U)
+  /* IDMA传输，等待期间不关中断 */
+  status = SD_DmaTransfer(hdev, pData, BlockAdd, NumberOfBlocks, IsRead, Timeout);
+#else
+  if (IsRead == 0U)
+  {
+    /* 预擦除提示（查询模式的HAL总是发CMD12，不用CMD23） */
+    (void)SD_PreDefineWrite(hdev, NumberOfBlocks, 0U);
+  }
+
+  hdev->BusyTimeoutMs = SD_Dev_GetTimeout(hdev, (IsRead != 0U) ? SD_OP_READ : SD_OP_WRITE, NumberOfBlocks);
+  Timeout = SD_LimitTimeout(Timeout, hdev->BusyTimeoutMs);
+
+  /* 关闭中断，避免FIFO溢出 */
+  SD_TRACE(hdev, SD_TRACE_EV_CMD, (IsRead != 0U) ? SD_CMD_READ(NumberOfBlocks) : SD_CMD_WRITE(NumberOfBlocks),
+           BlockAdd, NumberOfBlocks, 0U);
+  __disable_irq();
+  
+  if (IsRead == 0U)
+  {
+    status = HAL_SD_WriteBlocks(hdev->hsd, pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+  else
+  {
+    status = HAL_SD_ReadBlocks(hdev->hsd, pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+  
+  /* 重新使能中断 */
+  __enable_irq();
+  if (status != HAL_OK)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_ERROR, (IsRead != 0U) ? SD_CMD_READ(NumberOfBlocks) : SD_CMD_WRITE(NumberOfBlocks),
+             BlockAdd, NumberOfBlocks, HAL_SD_GetError(hdev->hsd));
+    SD_SpeedFallback(hdev, HAL_SD_GetError(hdev->hsd));
+  }
+#endif
+
+  return status;
+}
+
+/**
+  * @brief  直接读写：失败时交给错误恢复决定是否重试（错误恢复只作用于默认实例）
+  * @param  hdev: 设备实例
+  * @param  pData: 数据缓冲区
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 每次尝试的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_Xfer(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint8_t IsRead,
+                                 uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+#if (SD_RECOVER_ENABLE != 0U)
+  uint32_t attempt = 0U;
+
+  status = SD_XferOnce(hdev, pData, BlockAdd, NumberOfBlocks, IsRead, Timeout);
+  if (hdev == &sddev1)
+  {
+    while ((status != HAL_OK) && (SD_Recover_OnError(status, HAL_SD_GetError(hdev->hsd), attempt) == HAL_OK))
+    {
+      attempt++;
+      status = SD_XferOnce(hdev, pData, BlockAdd, NumberOfBlocks, IsRead, Timeout);
+    }
+    SD_Recover_OnDone(status, attempt);
+  }
+#else
+  status = SD_XferOnce(hdev, pData, BlockAdd, NumberOfBlocks, IsRead, Timeout);
+#endif
+
+  return status;
+}
+
+/**
+  * @brief  多块写入（直接访问卡）
+  * @param  hdev: 设备实例
+  * @param  pData: 数据缓冲区指针（必须4字节对齐）
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   SD_USE_IDMA时IDMA传输并等待完成，否则查询模式（关中断，避免FIFO溢出）
+  * @note   使能SD_RECOVER_ENABLE时失败后按错误类别恢复并重试，重试用尽才返回错误
+  */
+HAL_StatusTypeDef SD_Dev_WriteBlocksDirect(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                           uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t t0 = SD_STATS_TIC();
+  
+  /* 参数验证 */
+  if (pData == NULL)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: pData为NULL\r\n");
+#endif
+    return HAL_ERROR;
+  }
+  
+  if (NumberOfBlocks == 0U)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: NumberOfBlocks为0\r\n");
+#endif
+    return HAL_ERROR;
+  }
+  
+  if (hdev == &sddev1)
+  {
+#if (SD_PREFETCH_ENABLE != 0U)
+    /* 后台预取占用控制器时先等它结束，并作废被覆盖的预取数据 */
+    SD_Prefetch_Quiesce(Timeout);
+    SD_Prefetch_Invalidate(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+    SD_Discard_Forget(BlockAdd, NumberOfBlocks);
+#endif
+  }
+
+  status = SD_Xfer(hdev, pData, BlockAdd, NumberOfBlocks, 0U, Timeout);
+  SD_STATS_TOC(hdev, Write, t0, NumberOfBlocks * SD_BLOCK_SIZE, status);
+  if (status != HAL_OK)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 多块写入失败，状态: %d\r\n", status);
+    SD_ErrorHandler(hdev, "写入");
+#endif
+  }
+  
+  return status;
+}
+
+HAL_StatusTypeDef SD_WriteBlocksDirect(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  return SD_Dev_WriteBlocksDirect(&sddev1, pData, BlockAdd, NumberOfBlocks, Timeout);
+}
+
+/**
+  * @brief  多块读取（直接访问卡）
+  * @param  hdev: 设备实例
+  * @param  pData: 数据缓冲区指针（必须4字节对齐）
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   SD_USE_IDMA时IDMA传输并等待完成，否则查询模式（关中断，避免FIFO溢出）
+  * @note   使能SD_RECOVER_ENABLE时失败后按错误类别恢复并重试，重试用尽才返回错误
+  */
+HAL_StatusTypeDef SD_Dev_ReadBlocksDirect(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                          uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t t0 = SD_STATS_TIC();
+  
+  /* 参数验证 */
+  if (pData == NULL)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: pData为NULL\r\n");
+#endif
+    return HAL_ERROR;
+  }
+  
+  if (NumberOfBlocks == 0U)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: NumberOfBlocks为0\r\n");
+#endif
+    return HAL_ERROR;
+  }
+  
+#if (SD_PREFETCH_ENABLE != 0U)
+  if (hdev == &sddev1)
+  {
+    SD_Prefetch_Quiesce(Timeout);
+  }
+#endif
+
+  status = SD_Xfer(hdev, pData, BlockAdd, NumberOfBlocks, 1U, Timeout);
+  SD_STATS_TOC(hdev, Read, t0, NumberOfBlocks * SD_BLOCK_SIZE, status);
+  if (status != HAL_OK)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 多块读取失败，状态: %d\r\n", status);
+    SD_ErrorHandler(hdev, "读取");
+#endif
+  }
+  
+  return status;
+}
+
+HAL_StatusTypeDef SD_ReadBlocksDirect(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  return SD_Dev_ReadBlocksDirect(&sddev1, pData, BlockAdd, NumberOfBlocks, Timeout);
+}
+
+/**
+  * @brief  判断缓冲区能否由SDMMC1 IDMA直接访问（弱定义）
+  * @param  pData: 缓冲区
+  * @param  Length: 字节数
+  * @retval uint8_t 1: 可以；0: 不可以
+  */
+__weak uint8_t SD_IsDmaReachable(const void *pData, uint32_t Length)
+{
+  uintptr_t start = (uintptr_t)pData;
+  uintptr_t end = start + Length;
+
+  if ((start < SD_DMA_ITCM_END) ||
+      ((start < SD_DMA_DTCM_END) && (end > SD_DMA_DTCM_START)) ||
+      ((start < SD_DMA_D2D3_END) && (end > SD_DMA_D2D3_START)))
+  {
+    return 0U;
+  }
+
+  return 1U;
+}
+
+/**
+  * @brief  清理（写回）缓冲区所在的D-Cache行
+  * @param  pData: 缓冲区
+  * @param  Length: 字节数
+  */
+void SD_DCacheClean(const void *pData, uint32_t Length)
+{
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+  uintptr_t start = (uintptr_t)pData & ~(uintptr_t)(SD_DCACHE_LINE - 1U);
+  uintptr_t end = ((uintptr_t)pData + Length + (SD_DCACHE_LINE - 1U)) & ~(uintptr_t)(SD_DCACHE_LINE - 1U);
+
+  SCB_CleanDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+#else
+  (void)pData;
+  (void)Length;
+#endif
+}
+
+/**
+  * @brief  作废缓冲区所在的D-Cache行
+  * @param  pData: 缓冲区
+  * @param  Length: 字节数
+  * @param  Clean: 1: 作废前先写回脏行
+  * @note   按缓存行向外取整，调用者须保证首尾行中缓冲区以外的部分不会被CPU同时改写
+  */
+void SD_DCacheInvalidate(const void *pData, uint32_t Length, uint8_t Clean)
+{
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+  uintptr_t start = (uintptr_t)pData & ~(uintptr_t)(SD_DCACHE_LINE - 1U);
+  uintptr_t end = ((uintptr_t)pData + Length + (SD_DCACHE_LINE - 1U)) & ~(uintptr_t)(SD_DCACHE_LINE - 1U);
+
+  if (Clean != 0U)
+  {
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+  }
+  else
+  {
+    SCB_InvalidateDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+  }
+#else
+  (void)pData;
+  (void)Length;
+  (void)Clean;
+#endif
+}
+
+#if (SD_USE_IDMA != 0U)
+/**
+  * @brief  借出一个跳板缓冲区
+  * @retval uint8_t* 缓冲区，全部借出时返回NULL
+  */
+static uint8_t *SD_BounceAlloc(void)
+{
+  uint32_t primask;
+  uint32_t i;
+  uint8_t *buf = NULL;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  for (i = 0U; i < SD_BOUNCE_COUNT; i++)
+  {
+    if ((sd_bounce_used & (1UL << i)) == 0U)
+    {
+      sd_bounce_used |= (1UL << i);
+      buf = sd_bounce_pool[i];
+      break;
+    }
+  }
+  __set_PRIMASK(primask);
+
+  return buf;
+}
+
+/**
+  * @brief  归还跳板缓冲区
+  * @param  pBuf: SD_BounceAlloc()借出的缓冲区
+  */
+static void SD_BounceFree(const uint8_t *pBuf)
+{
+  uint32_t primask;
+  uint32_t i = (uint32_t)((pBuf - &sd_bounce_pool[0][0]) / (SD_BOUNCE_BLOCKS * SD_BLOCK_SIZE));
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  sd_bounce_used &= ~(1UL << i);
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  一次IDMA传输并等待完成（卡须已就绪）
+  * @param  hdev: 设备实例
+  * @param  pData: 4字节对齐且IDMA可访问的缓冲区
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_DmaXfer(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                    uint8_t IsRead, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+  hdev->SyncReq.Callback = NULL;
+  status = (IsRead != 0U) ? SD_StartRead(hdev, pData, BlockAdd, NumberOfBlocks, &hdev->SyncReq) :
+                            SD_Dev_WriteBlocksAsync(hdev, pData, BlockAdd, NumberOfBlocks, &hdev->SyncReq);
+  if (status == HAL_OK)
+  {
+    status = SD_WaitRequest(&hdev->SyncReq, Timeout);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  经跳板缓冲区分段传输（卡须已就绪）
+  * @param  hdev: 设备实例
+  * @param  pData: 调用者缓冲区，任意对齐
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 每段的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_BounceXfer(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                       uint8_t IsRead, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint8_t *bounce;
+  uint32_t n;
+
+  bounce = SD_BounceAlloc();
+  if (bounce == NULL)
+  {
+    return HAL_BUSY;
+  }
+
+#if (SD_STATS_ENABLE != 0U)
+  hdev->Stats.BounceBlocks += NumberOfBlocks;
+#endif
+  while (NumberOfBlocks != 0U)
+  {
+    n = (NumberOfBlocks < SD_BOUNCE_BLOCKS) ? NumberOfBlocks : SD_BOUNCE_BLOCKS;
+    if (IsRead == 0U)
+    {
+      (void)memcpy(bounce, pData, n * SD_BLOCK_SIZE);
+    }
+    status = SD_DmaXfer(hdev, bounce, BlockAdd, n, IsRead, Timeout);
+    if (status != HAL_OK)
+    {
+      break;
+    }
+    if (IsRead != 0U)
+    {
+      (void)memcpy(pData, bounce, n * SD_BLOCK_SIZE);
+    }
+
+    pData += n * SD_BLOCK_SIZE;
+    BlockAdd += n;
+    NumberOfBlocks -= n;
+
+    /* 写入后卡处于编程忙，下一段前等待就绪 */
+    if ((NumberOfBlocks != 0U) && (IsRead == 0U))
+    {
+      status = SD_Dev_WaitReady(hdev, Timeout);
+      if (status != HAL_OK)
+      {
+        break;
+      }
+    }
+  }
+  SD_BounceFree(bounce);
+
+  return status;
+}
+
+/**
+  * @brief  阻塞读写的IDMA传输：按缓冲区地址选择直接传输或经跳板中转（卡须已就绪）
+  * @param  hdev: 设备实例
+  * @param  pData: 调用者缓冲区
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   写入只需清理D-Cache，4字节对齐即可直接传输；读取要作废D-Cache，首尾不在缓存行边界时
+  *         首尾块所在的行可能与相邻变量共用，这两块经跳板读取，中间部分直接读入
+  */
+static HAL_StatusTypeDef SD_DmaTransfer(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                        uint8_t IsRead, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t last = NumberOfBlocks - 1U;
+  uint8_t direct;
+
+  direct = ((((uintptr_t)pData & 3U) == 0U) &&
+            (SD_IsDmaReachable(pData, NumberOfBlocks * SD_BLOCK_SIZE) != 0U)) ? 1U : 0U;
+
+  if ((direct != 0U) && ((IsRead == 0U) || (((uintptr_t)pData & (SD_DCACHE_LINE - 1U)) == 0U)))
+  {
+#if (SD_STATS_ENABLE != 0U)
+    hdev->Stats.DmaZeroCopy++;
+#endif
+    return SD_DmaXfer(hdev, pData, BlockAdd, NumberOfBlocks, IsRead, Timeout);
+  }
+
+  if ((direct == 0U) || (NumberOfBlocks < 3U))
+  {
+#if (SD_STATS_ENABLE != 0U)
+    hdev->Stats.DmaBounced++;
+#endif
+    return SD_BounceXfer(hdev, pData, BlockAdd, NumberOfBlocks, IsRead, Timeout);
+  }
+
+  /* 先读中间部分：其首尾行只含本缓冲区首尾块的数据，随后被跳板数据覆盖 */
+#if (SD_STATS_ENABLE != 0U)
+  hdev->Stats.DmaSplit++;
+#endif
+  status = SD_DmaXfer(hdev, &pData[SD_BLOCK_SIZE], BlockAdd + 1U, NumberOfBlocks - 2U, 1U, Timeout);
+  if (status == HAL_OK)
+  {
+    status = SD_BounceXfer(hdev, pData, BlockAdd, 1U, 1U, Timeout);
+  }
+  if (status == HAL_OK)
+  {
+    status = SD_BounceXfer(hdev, &pData[last * SD_BLOCK_SIZE], BlockAdd + last, 1U, 1U, Timeout);
+  }
+
+  return status;
+}
+#endif /* SD_USE_IDMA */
+
+/**
+  * @brief  启动IDMA传输的公共部分
+  * @param  hdev: 设备实例
+  * @param  pReq: 完成令牌
+  * @param  TimeoutMs: 按块数算出的超时（毫秒），也用作之后等待就绪的超时；0表示不限制
+  * @retval HAL_StatusTypeDef HAL_OK可以启动；HAL_BUSY控制器或卡忙
+  * @note   卡必须已处于传输状态，异步接口不在此处等待
+  */
+static HAL_StatusTypeDef SD_PrepareRequest(SD_DeviceTypeDef *hdev, SD_RequestTypeDef *pReq, uint32_t TimeoutMs)
+{
+  if ((hdev->ActiveReq != NULL) || (HAL_SD_GetState(hdev->hsd) != HAL_SD_STATE_READY))
+  {
+    return HAL_BUSY;
+  }
+
+  if (HAL_SD_GetCardState(hdev->hsd) != HAL_SD_CARD_TRANSFER)
+  {
+    return HAL_BUSY;
+  }
+
+  pReq->Done = 0U;
+  pReq->Status = HAL_BUSY;
+  pReq->ErrorCode = HAL_SD_ERROR_NONE;
+  pReq->pDev = hdev;
+  pReq->TimeoutMs = TimeoutMs;
+  pReq->BufferBlocks = 0U;
+  hdev->BusyTimeoutMs = TimeoutMs;
+  hdev->ActiveReq = pReq;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  结束当前IDMA请求（中断上下文）
+  * @param  hdev: 设备实例
+  * @param  status: 完成状态
+  */
+static void SD_CompleteRequest(SD_DeviceTypeDef *hdev, HAL_StatusTypeDef status)
+{
+  SD_RequestTypeDef *req = hdev->ActiveReq;
+
+  if (req == NULL)
+  {
+    return;
+  }
+
+  /* IDMA写入期间CPU可能推测读取了缓冲区，完成后再作废一次 */
+  if (hdev->DmaRxBuf != NULL)
+  {
+    SD_DCacheInvalidate(hdev->DmaRxBuf, hdev->DmaRxLen, 0U);
+    hdev->DmaRxBuf = NULL;
+  }
+
+  /* 先释放控制器，允许回调中直接提交下一个请求 */
+  hdev->ActiveReq = NULL;
+  req->ErrorCode = HAL_SD_GetError(hdev->hsd);
+  req->Status = status;
+  SD_TRACE(hdev, SD_TRACE_EV_IDMA_DONE, hdev->TraceCmd, hdev->TraceBlk, 0U, status);
+  if (status != HAL_OK)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_ERROR, hdev->TraceCmd, hdev->TraceBlk, 0U, req->ErrorCode);
+    SD_SpeedFallback(hdev, req->ErrorCode);
+  }
+  req->Done = 1U;
+
+  if (req->Callback != NULL)
+  {
+    req->Callback(req);
+  }
+}
+
+/**
+  * @brief  发送R1响应的命令
+  * @param  hdev: 设备实例
+  * @param  CmdIndex: 命令号
+  * @param  Argument: 命令参数
+  * @retval uint32_t SDMMC_ERROR_xxx
+  */
+static uint32_t SD_SendCmdR1(SD_DeviceTypeDef *hdev, uint32_t CmdIndex, uint32_t Argument)
+{
+  SDMMC_CmdInitTypeDef sdmmc_cmdinit;
+
+  sdmmc_cmdinit.Argument         = Argument;
+  sdmmc_cmdinit.CmdIndex         = CmdIndex;
+  sdmmc_cmdinit.Response         = SDMMC_RESPONSE_SHORT;
+  sdmmc_cmdinit.WaitForInterrupt = SDMMC_WAIT_NO;
+  sdmmc_cmdinit.CPSM             = SDMMC_CPSM_ENABLE;
+  (void)SDMMC_SendCommand(hdev->hsd->Instance, &sdmmc_cmdinit);
+
+  return SDMMC_GetCmdResp1(hdev->hsd->Instance, (uint8_t)CmdIndex, SDMMC_CMDTIMEOUT);
+}
+
+/**
+  * @brief  读取数据通道FIFO中的短数据（SCR、CMD6状态等）
+  * @param  hdev: 设备实例
+  * @param  pBuf: 输出缓冲区
+  * @param  Words: 期望的32位字数
+  * @retval uint32_t SDMMC_ERROR_xxx
+  */
+static uint32_t SD_ReadDataFIFO(SD_DeviceTypeDef *hdev, uint32_t *pBuf, uint32_t Words)
+{
+  uint32_t tickstart_fifo = HAL_GetTick();
+  uint32_t timeout = SD_Dev_GetTimeout(hdev, SD_OP_READ, 1U);
+  uint32_t errorstate = SDMMC_ERROR_NONE;
+  uint32_t n = 0U;
+
+  while (!__SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_RXOVERR | SDMMC_FLAG_DCRCFAIL | SDMMC_FLAG_DTIMEOUT |
+                                          SDMMC_FLAG_DATAEND))
+  {
+    if ((n < Words) && (!__SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_RXFIFOE)))
+    {
+      pBuf[n] = SDMMC_ReadFIFO(hdev->hsd->Instance);
+      n++;
+    }
+
+    if ((HAL_GetTick() - tickstart_fifo) >= timeout)
+    {
+      errorstate = SDMMC_ERROR_TIMEOUT;
+      break;
+    }
+  }
+
+  /* DATAEND置位时剩余数据可能仍在FIFO中 */
+  while ((errorstate == SDMMC_ERROR_NONE) && (n < Words) &&
+         (!__SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_RXFIFOE)))
+  {
+    pBuf[n] = SDMMC_ReadFIFO(hdev->hsd->Instance);
+    n++;
+  }
+
+  if (__SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_DTIMEOUT))
+  {
+    errorstate = SDMMC_ERROR_DATA_TIMEOUT;
+  }
+  else if (__SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_DCRCFAIL))
+  {
+    errorstate = SDMMC_ERROR_DATA_CRC_FAIL;
+  }
+  else if (__SDMMC_GET_FLAG(hdev->hsd->Instance, SDMMC_FLAG_RXOVERR))
+  {
+    errorstate = SDMMC_ERROR_RX_OVERRUN;
+  }
+  else
+  {
+    /* 正常结束 */
+  }
+  __SDMMC_CLEAR_FLAG(hdev->hsd->Instance, SDMMC_STATIC_DATA_FLAGS);
+
+  return errorstate;
+}
+
+/**
+  * @brief  读取SCR寄存器（ACMD51）
+  * @param  hdev: 设备实例
+  * @param  pSCR: 输出，pSCR[1]为SCR高32位，pSCR[0]为低32位
+  * @retval uint32_t SDMMC_ERROR_xxx
+  * @note   流程与HAL内部的SD_FindSCR相同，HAL没有导出该函数；结束后块长度恢复为512字节
+  */
+static uint32_t SD_ReadSCR(SD_DeviceTypeDef *hdev, uint32_t *pSCR)
+{
+  SDMMC_DataInitTypeDef config;
+  uint32_t errorstate;
+  uint32_t tempscr[2U] = {0U, 0U};
+
+  errorstate = SDMMC_CmdBlockLength(hdev->hsd->Instance, 8U);
+  if (errorstate == SDMMC_ERROR_NONE)
+  {
+    errorstate = SDMMC_CmdAppCommand(hdev->hsd->Instance, hdev->hsd->SdCard.RelCardAdd << 16U);
+  }
+  if (errorstate == SDMMC_ERROR_NONE)
+  {
+    config.DataTimeOut   = SDMMC_DATATIMEOUT;
+    config.DataLength    = 8U;
+    config.DataBlockSize = SDMMC_DATABLOCK_SIZE_8B;
+    config.TransferDir   = SDMMC_TRANSFER_DIR_TO_SDMMC;
+    config.TransferMode  = SDMMC_TRANSFER_MODE_BLOCK;
+    config.DPSM          = SDMMC_DPSM_ENABLE;
+    (void)SDMMC_ConfigData(hdev->hsd->Instance, &config);
+
+    errorstate = SDMMC_CmdSendSCR(hdev->hsd->Instance);
+  }
+  if (errorstate == SDMMC_ERROR_NONE)
+  {
+    errorstate = SD_ReadDataFIFO(hdev, tempscr, 2U);
+  }
+  if (errorstate == SDMMC_ERROR_NONE)
+  {
+    /* 数据线上先传高字节 */
+    pSCR[0] = ((tempscr[1] & 0x000000FFU) << 24U) | ((tempscr[1] & 0x0000FF00U) << 8U) |
+              ((tempscr[1] & 0x00FF0000U) >> 8U) | ((tempscr[1] & 0xFF000000U) >> 24U);
+    pSCR[1] = ((tempscr[0] & 0x000000FFU) << 24U) | ((tempscr[0] & 0x0000FF00U) << 8U) |
+              ((tempscr[0] & 0x00FF0000U) >> 8U) | ((tempscr[0] & 0xFF000000U) >> 24U);
+  }
+
+  (void)SDMMC_CmdBlockLength(hdev->hsd->Instance, SD_BLOCK_SIZE);
+
+#ifdef DEBUG
+  if (errorstate != SDMMC_ERROR_NONE)
+  {
+    printf("[SD] [WARN] 读取SCR失败: 0x%08lX\r\n", errorstate);
+  }
+#endif
+
+  return errorstate;
+}
+
+#if (SD_HIGH_SPEED_ENABLE != 0U)
+/**
+  * @brief  CMD6 SWITCH_FUNC
+  * @param  hdev: 设备实例
+  * @param  Argument: bit31为0查询、为1切换；bit3:0为功能组1的功能号，其余组填0xF（不改变）
+  * @param  pStatus: 输出，64字节切换状态（按数据线上的字节顺序）
+  * @retval uint32_t SDMMC_ERROR_xxx
+  * @note   流程与HAL内部的SD_HighSpeed相同；结束后块长度恢复为512字节
+  */
+static uint32_t SD_SwitchFunction(SD_DeviceTypeDef *hdev, uint32_t Argument, uint8_t *pStatus)
+{
+  SDMMC_DataInitTypeDef config;
+  uint32_t errorstate;
+  uint32_t status_words[16U];
+
+  errorstate = SDMMC_CmdBlockLength(hdev->hsd->Instance, 64U);
+  if (errorstate == SDMMC_ERROR_NONE)
+  {
+    config.DataTimeOut   = SDMMC_DATATIMEOUT;
+    config.DataLength    = 64U;
+    config.DataBlockSize = SDMMC_DATABLOCK_SIZE_64B;
+    config.TransferDir   = SDMMC_TRANSFER_DIR_TO_SDMMC;
+    config.TransferMode  = SDMMC_TRANSFER_MODE_BLOCK;
+    config.DPSM          = SDMMC_DPSM_ENABLE;
+    (void)SDMMC_ConfigData(hdev->hsd->Instance, &config);
+
+    errorstate = SDMMC_CmdSwitch(hdev->hsd->Instance, Argument);
+  }
+  if (errorstate == SDMMC_ERROR_NONE)
+  {
+    errorstate = SD_ReadDataFIFO(hdev, status_words, 16U);
+  }
+  if (errorstate == SDMMC_ERROR_NONE)
+  {
+    /* FIFO按小端装入，逐字拷贝即恢复线上字节顺序 */
+    (void)memcpy(pStatus, status_words, 64U);
+  }
+
+  (void)SDMMC_CmdBlockLength(hdev->hsd->Instance, SD_BLOCK_SIZE);
+
+  return errorstate;
+}
+
+#endif /* SD_HIGH_SPEED_ENABLE */
+
+/**
+  * @brief  SD Status中AU_SIZE（或UHS_AU_SIZE）对应的块数
+  * @param  hdev: 设备实例
+  * @retval uint32_t AU块数，未读到SD Status或卡未定义AU时为0
+  */
+static uint32_t SD_AuSizeToBlocks(const SD_DeviceTypeDef *hdev)
+{
+  /* AU_SIZE编码：1~9为16KB~4MB（逐级翻倍），A~F为8/12/16/24/32/64MB */
+  static const uint32_t au_blocks[16] = {
+    0U, 32U, 64U, 128U, 256U, 512U, 1024U, 2048U, 4096U, 8192U, 16384U, 24576U, 32768U, 49152U, 65536U, 131072U
+  };
+  uint8_t code;
+
+  if (hdev->CardStatusValid == 0U)
+  {
+    return 0U;
+  }
+
+  code = hdev->CardStatus.AllocationUnitSize;
+  if (code == 0U)
+  {
+    code = hdev->CardStatus.UhsAllocationUnitSize;
+  }
+
+  return au_blocks[code & 0x0FU];
+}
+
+/**
+  * @brief  从CSD取SDSC的读写超时参数
+  * @param  hdev: 设备实例
+  * @note   CSD 2.0（SDHC/SDXC）的TAAC、NSAC、R2W_FACTOR为固定值，规范要求主机改用固定上限
+  */
+static void SD_ReadCsdTimeouts(SD_DeviceTypeDef *hdev)
+{
+  /* TAAC：bit2:0为时间单位1ns~10ms，bit6:3为系数1.0~8.0（下表放大10倍） */
+  static const uint32_t taac_unit_ns[8] = {1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U};
+  static const uint8_t taac_mult[16] = {0U, 10U, 12U, 13U, 15U, 20U, 25U, 30U, 35U, 40U, 45U, 50U, 55U, 60U, 70U, 80U};
+  HAL_SD_CardCSDTypeDef csd;
+
+  hdev->CsdTimeouts = 0U;
+  if ((hdev->hsd->SdCard.CardType == CARD_SDSC) && (HAL_SD_GetCardCSD(hdev->hsd, &csd) == HAL_OK) &&
+      (csd.CSDStruct == 0U))
+  {
+    hdev->TaacNs = (taac_unit_ns[csd.TAAC & 0x07U] * taac_mult[(csd.TAAC >> 3) & 0x0FU]) / 10U;
+    hdev->NsacClocks = (uint32_t)csd.NSAC * 100U;
+    hdev->R2wFactor = csd.WrSpeedFact & 0x07U;
+    hdev->CsdTimeouts = 1U;
+  }
+}
+
+/**
+  * @brief  读访问或写入编程忙的超时
+  * @param  hdev: 设备实例
+  * @param  IsWrite: 1编程忙 0读访问
+  * @retval uint32_t 超时（微秒）
+  * @note   SDSC取典型值的100倍：读为(TAAC + NSAC×100个时钟)×100，写再乘2^R2W_FACTOR；
+  *         都不超过SD_TIMEOUT_READ_MAX_MS/SD_TIMEOUT_WRITE_MAX_MS，SDHC/SDXC直接取上限
+  */
+static uint32_t SD_AccessTimeoutUs(const SD_DeviceTypeDef *hdev, uint8_t IsWrite)
+{
+  uint32_t max_us = SD_TIMEOUT_READ_MAX_MS * 1000U;
+  uint64_t ns;
+
+  if (IsWrite != 0U)
+  {
+    max_us = ((hdev->hsd->SdCard.LogBlockNbr > SD_SDXC_MIN_BLOCKS) ? SD_TIMEOUT_WRITE_SDXC_MS : SD_TIMEOUT_WRITE_MAX_MS) *
+             1000U;
+  }
+  if (hdev->CsdTimeouts == 0U)
+  {
+    return max_us;
+  }
+
+  ns = (uint64_t)hdev->TaacNs +
+       (((uint64_t)hdev->NsacClocks * 1000000000ULL) / SD_ClockDivToHz(SD_Dev_GetClockDiv(hdev)));
+  ns = (ns * 100U) << ((IsWrite != 0U) ? hdev->R2wFactor : 0U);
+
+  return ((ns / 1000U) < max_us) ? (uint32_t)(ns / 1000U) : max_us;
+}
+
+/**
+  * @brief  每个AU的擦除超时
+  * @param  hdev: 设备实例
+  * @retval uint32_t 超时（毫秒）
+  * @note   SD Status的ERASE_TIMEOUT（秒）是擦除ERASE_SIZE个AU的时间；卡未给出时每个AU按写入编程忙超时计
+  */
+static uint32_t SD_EraseAuTimeoutMs(const SD_DeviceTypeDef *hdev)
+{
+  if ((hdev->CardStatusValid != 0U) && (hdev->CardStatus.EraseSize != 0U) && (hdev->CardStatus.EraseTimeout != 0U))
+  {
+    return (((uint32_t)hdev->CardStatus.EraseTimeout * 1000U) + hdev->CardStatus.EraseSize - 1U) /
+           hdev->CardStatus.EraseSize;
+  }
+
+  return (SD_AccessTimeoutUs(hdev, 1U) + 999U) / 1000U;
+}
+
+/**
+  * @brief  当前时钟与线宽下传输若干块占用总线的时间
+  * @param  hdev: 设备实例
+  * @param  NumberOfBlocks: 块数
+  * @retval uint64_t 微秒
+  */
+static uint64_t SD_BusTimeUs(const SD_DeviceTypeDef *hdev, uint32_t NumberOfBlocks)
+{
+  uint32_t width = SD_Dev_GetBusWidth(hdev);
+  uint32_t lines = (width == SDMMC_BUS_WIDE_8B) ? 8U : ((width == SDMMC_BUS_WIDE_4B) ? 4U : 1U);
+  uint32_t khz = SD_ClockDivToHz(SD_Dev_GetClockDiv(hdev)) / 1000U;
+  /* 每块每根数据线：数据位，加CRC16、起始/结束位与写入的CRC状态，按24个时钟计 */
+  uint64_t clocks = (uint64_t)NumberOfBlocks * (((SD_BLOCK_SIZE * 8U) / lines) + 24U);
+
+  return ((clocks * 1000U) + khz - 1U) / khz;
+}
+
+/**
+  * @brief  按卡寄存器与当前总线时钟计算一次操作的超时
+  * @param  hdev: 设备实例
+  * @param  Op: SD_OP_READ/SD_OP_WRITE/SD_OP_ERASE
+  * @param  NumberOfBlocks: 块数
+  * @retval uint32_t 超时（毫秒）
+  */
+uint32_t SD_Dev_GetTimeout(const SD_DeviceTypeDef *hdev, uint32_t Op, uint32_t NumberOfBlocks)
+{
+  uint64_t us;
+  uint64_t ms;
+  uint64_t data_us;
+  uint32_t au;
+
+  if (NumberOfBlocks == 0U)
+  {
+    NumberOfBlocks = 1U;
+  }
+
+  if (Op == SD_OP_ERASE)
+  {
+    au = SD_AuSizeToBlocks(hdev);
+    if (au == 0U)
+    {
+      au = SD_TIMEOUT_AU_DEFAULT;
+    }
+    /* N个连续块最多涉及的AU数（两端可能各有一个不完整的AU） */
+    ms = ((((uint64_t)NumberOfBlocks + au - 2U) / au) + 1U) * SD_EraseAuTimeoutMs(hdev);
+    ms += (hdev->CardStatusValid != 0U) ? ((uint64_t)hdev->CardStatus.EraseOffset * 1000U) : 0U;
+    return (ms < SD_TIMEOUT_ERASE_MAX_MS) ? (uint32_t)ms : SD_TIMEOUT_ERASE_MAX_MS;
+  }
+
+  data_us = SD_BusTimeUs(hdev, NumberOfBlocks) * SD_TIMEOUT_BUS_MARGIN;
+  if (Op == SD_OP_WRITE)
+  {
+    /* 卡接收并编程数据可能比总线慢，按SD_TIMEOUT_WRITE_MIN_KBPS计的时间更长时取它 */
+    us = ((uint64_t)NumberOfBlocks * SD_BLOCK_SIZE * 1000000U) / ((uint64_t)SD_TIMEOUT_WRITE_MIN_KBPS * 1024U);
+    data_us = (us > data_us) ? us : data_us;
+    us = SD_AccessTimeoutUs(hdev, 1U) + data_us;
+  }
+  else
+  {
+    us = SD_AccessTimeoutUs(hdev, 0U) + data_us;
+  }
+  ms = ((us + 999U) / 1000U) + SD_TIMEOUT_SLACK_MS;
+
+  return (ms < 0xFFFFFFFFU) ? (uint32_t)ms : 0xFFFFFFFFU;
+}
+
+uint32_t SD_GetTimeout(uint32_t Op, uint32_t NumberOfBlocks)
+{
+  return SD_Dev_GetTimeout(&sddev1, Op, NumberOfBlocks);
+}
+
+/**
+  * @brief  调用者的超时与计算的超时取较小者
+  * @param  Timeout: 调用者给出的超时（毫秒）
+  * @param  Derived: 计算的超时（毫秒），0表示不限制
+  * @retval uint32_t 实际使用的超时（毫秒）
+  */
+static uint32_t SD_LimitTimeout(uint32_t Timeout, uint32_t Derived)
+{
+#if (SD_TIMEOUT_DERIVED != 0U)
+  return ((Derived != 0U) && (Derived < Timeout)) ? Derived : Timeout;
+#else
+  (void)Derived;
+  return Timeout;
+#endif
+}
+
+/**
+  * @brief  指定分频系数下的SDMMC_CK
+  * @param  ClkDiv: CLKCR.CLKDIV，0为直通
+  * @retval uint32_t 频率（Hz）
+  */
+uint32_t SD_ClockDivToHz(uint32_t ClkDiv)
+{
+  uint32_t kernel = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_SDMMC);
+
+  return (ClkDiv == 0U) ? kernel : (kernel / (2U * ClkDiv));
+}
+
+/**
+  * @brief  不超过MaxHz的最小分频系数
+  * @param  MaxHz: 频率上限（Hz）
+  * @retval uint32_t CLKCR.CLKDIV
+  */
+uint32_t SD_ClockDivForHz(uint32_t MaxHz)
+{
+  uint32_t kernel = HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_SDMMC);
+  uint32_t div;
+
+  if (kernel <= MaxHz)
+  {
+    return 0U;
+  }
+
+  div = (kernel + (2U * MaxHz) - 1U) / (2U * MaxHz);
+  return (div > SDMMC_CLKCR_CLKDIV) ? SDMMC_CLKCR_CLKDIV : div;
+}
+
+/**
+  * @brief  设置SDMMC_CK分频
+  * @param  hdev: 设备实例
+  * @param  ClkDiv: CLKCR.CLKDIV，0为直通；SD_CLOCKDIV_DEFAULT恢复SD_Init时的分频
+  * @retval HAL_StatusTypeDef 传输进行中返回HAL_BUSY
+  */
+HAL_StatusTypeDef SD_Dev_SetClockDiv(SD_DeviceTypeDef *hdev, uint32_t ClkDiv)
+{
+  if (ClkDiv == SD_CLOCKDIV_DEFAULT)
+  {
+    ClkDiv = hdev->DefaultClkDiv;
+  }
+
+  if (ClkDiv > SDMMC_CLKCR_CLKDIV)
+  {
+    return HAL_ERROR;
+  }
+
+  if ((hdev->ActiveReq != NULL) || (HAL_SD_GetState(hdev->hsd) != HAL_SD_STATE_READY))
+  {
+    return HAL_BUSY;
+  }
+
+  MODIFY_REG(hdev->hsd->Instance->CLKCR, SDMMC_CLKCR_CLKDIV, ClkDiv);
+  hdev->ClockRaised = (SD_ClockDivToHz(ClkDiv) > SD_ClockDivToHz(hdev->DefaultClkDiv)) ? 1U : 0U;
+
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef SD_SetClockDiv(uint32_t ClkDiv)
+{
+  return SD_Dev_SetClockDiv(&sddev1, ClkDiv);
+}
+
+/**
+  * @brief  读取当前SDMMC_CK分频
+  * @param  hdev: 设备实例
+  * @retval uint32_t CLKCR.CLKDIV
+  */
+uint32_t SD_Dev_GetClockDiv(const SD_DeviceTypeDef *hdev)
+{
+  return hdev->hsd->Instance->CLKCR & SDMMC_CLKCR_CLKDIV;
+}
+
+uint32_t SD_GetClockDiv(void)
+{
+  return SD_Dev_GetClockDiv(&sddev1);
+}
+
+/**
+  * @brief  设置数据线宽度（ACMD6）
+  * @param  hdev: 设备实例
+  * @param  BusWidth: SDMMC_BUS_WIDE_1B 或 SDMMC_BUS_WIDE_4B
+  * @retval HAL_StatusTypeDef 传输进行中返回HAL_BUSY
+  * @note   HAL按hdev->hsd->Init.ClockDiv重新配置CLKCR，之后恢复调用前的分频
+  */
+HAL_StatusTypeDef SD_Dev_SetBusWidth(SD_DeviceTypeDef *hdev, uint32_t BusWidth)
+{
+  uint32_t div = SD_Dev_GetClockDiv(hdev);
+  HAL_StatusTypeDef status;
+
+  if ((BusWidth != SDMMC_BUS_WIDE_1B) && (BusWidth != SDMMC_BUS_WIDE_4B))
+  {
+    return HAL_ERROR;
+  }
+
+  if ((hdev->ActiveReq != NULL) || (HAL_SD_GetState(hdev->hsd) != HAL_SD_STATE_READY))
+  {
+    return HAL_BUSY;
+  }
+
+  status = HAL_SD_ConfigWideBusOperation(hdev->hsd, BusWidth);
+  MODIFY_REG(hdev->hsd->Instance->CLKCR, SDMMC_CLKCR_CLKDIV, div);
+
+  return status;
+}
+
+HAL_StatusTypeDef SD_SetBusWidth(uint32_t BusWidth)
+{
+  return SD_Dev_SetBusWidth(&sddev1, BusWidth);
+}
+
+/**
+  * @brief  读取当前数据线宽度
+  * @param  hdev: 设备实例
+  * @retval uint32_t SDMMC_BUS_WIDE_1B 或 SDMMC_BUS_WIDE_4B
+  */
+uint32_t SD_Dev_GetBusWidth(const SD_DeviceTypeDef *hdev)
+{
+  return hdev->hsd->Instance->CLKCR & SDMMC_CLKCR_WIDBUS;
+}
+
+uint32_t SD_GetBusWidth(void)
+{
+  return SD_Dev_GetBusWidth(&sddev1);
+}
+
+/**
+  * @brief  重新初始化卡并恢复线宽、High Speed模式与分频
+  * @param  hdev: 设备实例
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   HAL_SD_InitCard()从CMD0开始识别，结束时为1线、hdev->hsd->Init.ClockDiv
+  */
+HAL_StatusTypeDef SD_Dev_ResetCard(SD_DeviceTypeDef *hdev)
+{
+  uint32_t div = SD_Dev_GetClockDiv(hdev);
+  uint32_t width = SD_Dev_GetBusWidth(hdev);
+  HAL_StatusTypeDef status;
+
+  if (hdev->ActiveReq != NULL)
+  {
+    return HAL_BUSY;
+  }
+
+  (void)HAL_SD_Abort(hdev->hsd);
+  status = HAL_SD_InitCard(hdev->hsd);
+  if ((status == HAL_OK) && (width != SDMMC_BUS_WIDE_1B))
+  {
+    status = HAL_SD_ConfigWideBusOperation(hdev->hsd, width);
+  }
+#if (SD_HIGH_SPEED_ENABLE != 0U)
+  if ((status == HAL_OK) && (hdev->BusSpeed == SD_BUS_SPEED_HIGH) && (SD_SwitchHighSpeed(hdev) != HAL_OK))
+  {
+    /* 卡不再接受High Speed：退回Default Speed与SD_Init时的分频 */
+    hdev->BusSpeed = SD_BUS_SPEED_DEFAULT;
+    div = hdev->DefaultClkDiv;
+  }
+#endif
+  if (status == HAL_OK)
+  {
+    MODIFY_REG(hdev->hsd->Instance->CLKCR, SDMMC_CLKCR_CLKDIV, div);
+    hdev->ClockRaised = (SD_ClockDivToHz(div) > SD_ClockDivToHz(hdev->DefaultClkDiv)) ? 1U : 0U;
+  }
+
+#ifdef DEBUG
+  printf("[SD] 重新初始化卡%s\r\n", (status == HAL_OK) ? "完成" : "失败");
+#endif
+
+  return status;
+}
+
+HAL_StatusTypeDef SD_ResetCard(void)
+{
+  return SD_Dev_ResetCard(&sddev1);
+}
+
+#if (SD_HIGH_SPEED_ENABLE != 0U)
+
+/**
+  * @brief  用CMD6把卡切换到High Speed（不改时钟）
+  * @param  hdev: 设备实例
+  * @retval HAL_StatusTypeDef 卡不支持或切换失败返回HAL_ERROR
+  */
+static HAL_StatusTypeDef SD_SwitchHighSpeed(SD_DeviceTypeDef *hdev)
+{
+  uint8_t switch_status[64];
+
+  /* 1. 查询功能组1是否支持High Speed */
+  if ((SD_SwitchFunction(hdev, SD_SWITCH_CHECK | SD_SWITCH_GROUP1_HS, switch_status) != SDMMC_ERROR_NONE) ||
+      ((switch_status[13] & 0x02U) == 0U) || ((switch_status[16] & 0x0FU) != 0x01U))
+  {
+#ifdef DEBUG
+    printf("[SD] 卡不支持High Speed，保持Default Speed\r\n");
+#endif
+    return HAL_ERROR;
+  }
+
+  /* 2. 切换，状态中功能组1的结果为1才算成功 */
+  if ((SD_SwitchFunction(hdev, SD_SWITCH_SET | SD_SWITCH_GROUP1_HS, switch_status) != SDMMC_ERROR_NONE) ||
+      ((switch_status[16] & 0x0FU) != 0x01U))
+  {
+#ifdef DEBUG
+    printf("[SD] [WARN] CMD6切换High Speed失败\r\n");
+#endif
+    return HAL_ERROR;
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  切换到High Speed并提高总线时钟
+  * @param  hdev: 设备实例
+  * @retval HAL_StatusTypeDef HAL_OK已切换（时钟可能因已是上限而不变）；其他为保持Default Speed时钟
+  * @note   提高时钟后重读参考块并比较，出错或不一致时恢复原分频
+  */
+static HAL_StatusTypeDef SD_NegotiateSpeed(SD_DeviceTypeDef *hdev)
+{
+  HAL_StatusTypeDef status;
+  uint32_t div;
+#if (SD_RECOVER_ENABLE != 0U)
+  uint8_t recover;
+#endif
+
+  if (SD_SwitchHighSpeed(hdev) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  hdev->BusSpeed = SD_BUS_SPEED_HIGH;
+
+  div = SD_ClockDivForHz(SD_HIGH_SPEED_MAX_HZ);
+  if (SD_ClockDivToHz(div) <= SD_ClockDivToHz(hdev->DefaultClkDiv))
+  {
+    return HAL_OK;  /* 内核时钟不够，当前时钟已是上限 */
+  }
+
+  /* 3. 原时钟读参考数据，提高时钟后重读比较 */
+  status = SD_Dev_ReadBlocksDirect(hdev, sd_speed_ref, 0U, SD_SPEED_VERIFY_BLOCKS, SD_TIMEOUT_DEFAULT);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  MODIFY_REG(hdev->hsd->Instance->CLKCR, SDMMC_CLKCR_CLKDIV, div);
+  hdev->ClockRaised = 1U;
+
+#if (SD_RECOVER_ENABLE != 0U)
+  /* 校验要看到新时钟下的原始错误，不能被重试或降频掩盖 */
+  recover = SD_Recover_Enable(0U);
+  status = SD_Dev_ReadBlocksDirect(hdev, sd_speed_buf, 0U, SD_SPEED_VERIFY_BLOCKS, SD_TIMEOUT_DEFAULT);
+  (void)SD_Recover_Enable(recover);
+#else
+  status = SD_Dev_ReadBlocksDirect(hdev, sd_speed_buf, 0U, SD_SPEED_VERIFY_BLOCKS, SD_TIMEOUT_DEFAULT);
+#endif
+  if ((status != HAL_OK) || (memcmp(sd_speed_ref, sd_speed_buf, sizeof(sd_speed_buf)) != 0))
+  {
+#ifdef DEBUG
+    printf("[SD] [WARN] %lu Hz校验失败，恢复%lu Hz\r\n", SD_ClockDivToHz(div), SD_ClockDivToHz(hdev->DefaultClkDiv));
+#endif
+    SD_SpeedFallback(hdev, HAL_SD_ERROR_DATA_CRC_FAIL);
+    return HAL_ERROR;
+  }
+
+  return HAL_OK;
+}
+#endif /* SD_HIGH_SPEED_ENABLE */
+
+/**
+  * @brief  提高时钟后出现数据错误时退回原分频
+  * @param  hdev: 设备实例
+  * @param  ErrorCode: HAL_SD_GetError()
+  * @note   卡仍在High Speed模式，该模式在较低时钟下同样有效；可在中断上下文调用（控制器此时空闲）
+  */
+static void SD_SpeedFallback(SD_DeviceTypeDef *hdev, uint32_t ErrorCode)
+{
+  if ((hdev->ClockRaised != 0U) &&
+      ((ErrorCode & (HAL_SD_ERROR_DATA_CRC_FAIL | HAL_SD_ERROR_CMD_CRC_FAIL | HAL_SD_ERROR_DATA_TIMEOUT |
+                     HAL_SD_ERROR_TX_UNDERRUN | HAL_SD_ERROR_RX_OVERRUN)) != 0U))
+  {
+    MODIFY_REG(hdev->hsd->Instance->CLKCR, SDMMC_CLKCR_CLKDIV, hdev->DefaultClkDiv);
+    hdev->ClockRaised = 0U;
+  }
+}
+
+/**
+  * @brief  多块写入前预告块数
+  * @param  hdev: 设备实例
+  * @param  NumberOfBlocks: 块数量
+  * @param  UseCmd23: 1: 允许发CMD23（调用者负责不发CMD12）
+  * @retval uint8_t 1: CMD23已被卡接受，本次写入不能再发CMD12
+  * @note   ACMD23只是预擦除提示，失败不影响写入；CMD23失败时认为卡不支持，之后不再尝试
+  */
+static uint8_t SD_PreDefineWrite(SD_DeviceTypeDef *hdev, uint32_t NumberOfBlocks, uint8_t UseCmd23)
+{
+  if ((hdev->WriteMode != SD_WRITE_MODE_PREDEFINED) || (NumberOfBlocks < 2U))
+  {
+    return 0U;
+  }
+
+  /* ACMD23 SET_WR_BLK_ERASE_COUNT：所有SD卡必须支持 */
+  SD_TRACE(hdev, SD_TRACE_EV_CMD, 23U, 0U, NumberOfBlocks, 1U);
+  if (SDMMC_CmdAppCommand(hdev->hsd->Instance, hdev->hsd->SdCard.RelCardAdd << 16U) == SDMMC_ERROR_NONE)
+  {
+    (void)SD_SendCmdR1(hdev, SDMMC_CMD_SET_BLOCK_COUNT,
+                       (NumberOfBlocks > SD_ACMD23_MAX_BLOCKS) ? SD_ACMD23_MAX_BLOCKS : NumberOfBlocks);
+  }
+
+  if ((UseCmd23 == 0U) || (hdev->Cmd23Supported == 0U) || (NumberOfBlocks > SD_CMD23_MAX_BLOCKS))
+  {
+    return 0U;
+  }
+
+  /* CMD23 SET_BLOCK_COUNT：卡写满N块后自动回到传输状态 */
+  SD_TRACE(hdev, SD_TRACE_EV_CMD, 23U, 0U, NumberOfBlocks, 0U);
+  if (SD_SendCmdR1(hdev, SDMMC_CMD_SET_BLOCK_COUNT, NumberOfBlocks) != SDMMC_ERROR_NONE)
+  {
+#ifdef DEBUG
+    printf("[SD] [WARN] CMD23被拒绝，改用CMD12结束多块写入\r\n");
+#endif
+    hdev->Cmd23Supported = 0U;
+    return 0U;
+  }
+
+  return 1U;
+}
+
+/**
+  * @brief  设置多块写入方式
+  * @param  hdev: 设备实例
+  * @param  Mode: SD_WRITE_MODE_OPEN_ENDED 或 SD_WRITE_MODE_PREDEFINED
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Dev_SetWriteMode(SD_DeviceTypeDef *hdev, uint32_t Mode)
+{
+  if ((Mode != SD_WRITE_MODE_OPEN_ENDED) && (Mode != SD_WRITE_MODE_PREDEFINED))
+  {
+    return HAL_ERROR;
+  }
+
+  hdev->WriteMode = Mode;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef SD_SetWriteMode(uint32_t Mode)
+{
+  return SD_Dev_SetWriteMode(&sddev1, Mode);
+}
+
+/**
+  * @brief  读取当前多块写入方式
+  * @param  hdev: 设备实例
+  * @retval uint32_t SD_WRITE_MODE_xxx
+  */
+uint32_t SD_Dev_GetWriteMode(const SD_DeviceTypeDef *hdev)
+{
+  return hdev->WriteMode;
+}
+
+uint32_t SD_GetWriteMode(void)
+{
+  return SD_Dev_GetWriteMode(&sddev1);
+}
+
+/**
+  * @brief  IDMA多块写入（异步）
+  * @param  hdev: 设备实例
+  * @param  pData: 数据缓冲区指针（必须4字节对齐，完成前不得修改）
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  pReq: 完成令牌
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Dev_WriteBlocksAsync(SD_DeviceTypeDef *hdev, const uint8_t *pData, uint32_t BlockAdd,
+                                          uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq)
+{
+  HAL_StatusTypeDef status;
+  uint8_t predefined;
+  uint32_t primask;
+
+  if ((pData == NULL) || (NumberOfBlocks == 0U) || (pReq == NULL) || (((uintptr_t)pData & 3U) != 0U) ||
+      (SD_IsDmaReachable(pData, NumberOfBlocks * SD_BLOCK_SIZE) == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  status = SD_PrepareRequest(hdev, pReq, SD_Dev_GetTimeout(hdev, SD_OP_WRITE, NumberOfBlocks));
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  if (hdev == &sddev1)
+  {
+#if (SD_PREFETCH_ENABLE != 0U)
+    SD_Prefetch_Invalidate(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+    SD_Discard_Forget(BlockAdd, NumberOfBlocks);
+#endif
+  }
+
+  SD_DCacheClean(pData, NumberOfBlocks * SD_BLOCK_SIZE);
+  predefined = SD_PreDefineWrite(hdev, NumberOfBlocks, 1U);
+
+  /* CMD23之后卡在最后一块后自动结束，HAL不能再发CMD12：启动后立即把上下文改成单块写，
+     DATAEND中断据此跳过CMD12。改写完成前不能进中断 */
+  SD_TRACE_IDMA(hdev, SD_CMD_WRITE(NumberOfBlocks), BlockAdd, NumberOfBlocks, 0U);
+  primask = __get_PRIMASK();
+  __disable_irq();
+  status = HAL_SD_WriteBlocks_DMA(hdev->hsd, pData, BlockAdd, NumberOfBlocks);
+  if ((status == HAL_OK) && (predefined != 0U))
+  {
+    hdev->hsd->Context = (hdev->hsd->Context & ~SD_CONTEXT_WRITE_MULTIPLE_BLOCK) | SD_CONTEXT_WRITE_SINGLE_BLOCK;
+  }
+  __set_PRIMASK(primask);
+
+  if (status != HAL_OK)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_ERROR, hdev->TraceCmd, BlockAdd, NumberOfBlocks, HAL_SD_GetError(hdev->hsd));
+    hdev->ActiveReq = NULL;
+  }
+
+  return status;
+}
+
+HAL_StatusTypeDef SD_WriteBlocksAsync(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                      SD_RequestTypeDef *pReq)
+{
+  return SD_Dev_WriteBlocksAsync(&sddev1, pData, BlockAdd, NumberOfBlocks, pReq);
+}
+
+/**
+  * @brief  IDMA多块读取（异步）
+  * @param  hdev: 设备实例
+  * @param  pData: 数据缓冲区指针（必须4字节对齐）
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  pReq: 完成令牌
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Dev_ReadBlocksAsync(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd,
+                                         uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq)
+{
+  if ((pData == NULL) || (NumberOfBlocks == 0U) || (pReq == NULL) ||
+      (((uintptr_t)pData & (SD_DCACHE_LINE - 1U)) != 0U) ||
+      (SD_IsDmaReachable(pData, NumberOfBlocks * SD_BLOCK_SIZE) == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  return SD_StartRead(hdev, pData, BlockAdd, NumberOfBlocks, pReq);
+}
+
+HAL_StatusTypeDef SD_ReadBlocksAsync(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                     SD_RequestTypeDef *pReq)
+{
+  return SD_Dev_ReadBlocksAsync(&sddev1, pData, BlockAdd, NumberOfBlocks, pReq);
+}
+
+/**
+  * @brief  启动IDMA读取
+  * @param  hdev: 设备实例
+  * @param  pData: 4字节对齐且IDMA可访问的缓冲区
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  pReq: 完成令牌
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   缓冲区按缓存行向外取整作废D-Cache，首尾行须归调用者所有
+  */
+static HAL_StatusTypeDef SD_StartRead(SD_DeviceTypeDef *hdev, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                      SD_RequestTypeDef *pReq)
+{
+  HAL_StatusTypeDef status;
+
+  status = SD_PrepareRequest(hdev, pReq, SD_Dev_GetTimeout(hdev, SD_OP_READ, NumberOfBlocks));
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  SD_TRACE_IDMA(hdev, SD_CMD_READ(NumberOfBlocks), BlockAdd, NumberOfBlocks, 0U);
+  /* 写回并丢弃缓冲区的脏行，避免传输期间被换出覆盖IDMA写入的数据 */
+  SD_DCacheInvalidate(pData, NumberOfBlocks * SD_BLOCK_SIZE, 1U);
+  hdev->DmaRxBuf = pData;
+  hdev->DmaRxLen = NumberOfBlocks * SD_BLOCK_SIZE;
+  status = HAL_SD_ReadBlocks_DMA(hdev->hsd, pData, BlockAdd, NumberOfBlocks);
+  if (status != HAL_OK)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_ERROR, hdev->TraceCmd, BlockAdd, NumberOfBlocks, HAL_SD_GetError(hdev->hsd));
+    hdev->DmaRxBuf = NULL;
+    hdev->ActiveReq = NULL;
+  }
+
+  return status;
+}
+
+/**
+  * @brief  IDMA双缓冲多块写入（异步）
+  * @param  hdev: 设备实例
+  * @param  pBuf0: 缓冲区0
+  * @param  pBuf1: 缓冲区1
+  * @param  BufferBlocks: 每个缓冲区的块数
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 总块数
+  * @param  pReq: 完成令牌
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   缓冲区k取空后在中断中调用pReq->BufferCallback(pReq, k)
+  */
+HAL_StatusTypeDef SD_Dev_WriteBlocksDoubleBufferAsync(SD_DeviceTypeDef *hdev, uint8_t *pBuf0, uint8_t *pBuf1,
+                                                      uint32_t BufferBlocks, uint32_t BlockAdd,
+                                                      uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq)
+{
+  HAL_StatusTypeDef status;
+
+  if ((pBuf0 == NULL) || (pBuf1 == NULL) || (pReq == NULL) || (BufferBlocks == 0U) ||
+      (NumberOfBlocks == 0U) || (NumberOfBlocks > SD_DOUBLEBUF_MAX_BLOCKS) ||
+      ((NumberOfBlocks % BufferBlocks) != 0U) ||
+      (((uintptr_t)pBuf0 & (SD_DCACHE_LINE - 1U)) != 0U) || (((uintptr_t)pBuf1 & (SD_DCACHE_LINE - 1U)) != 0U) ||
+      (SD_IsDmaReachable(pBuf0, BufferBlocks * SD_BLOCK_SIZE) == 0U) ||
+      (SD_IsDmaReachable(pBuf1, BufferBlocks * SD_BLOCK_SIZE) == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 双缓冲传输的时长取决于应用换缓冲区的快慢，不按块数限制 */
+  status = SD_PrepareRequest(hdev, pReq, 0U);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+  pReq->BufferBlocks = BufferBlocks;
+
+  if (hdev == &sddev1)
+  {
+#if (SD_PREFETCH_ENABLE != 0U)
+    SD_Prefetch_Invalidate(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+    SD_Discard_Forget(BlockAdd, NumberOfBlocks);
+#endif
+  }
+
+  /* 双缓冲传输可能被中止，只发预擦除提示，仍由CMD12结束 */
+  (void)SD_PreDefineWrite(hdev, NumberOfBlocks, 0U);
+
+  SD_DCacheClean(pBuf0, BufferBlocks * SD_BLOCK_SIZE);
+  SD_DCacheClean(pBuf1, BufferBlocks * SD_BLOCK_SIZE);
+  SD_TRACE_IDMA(hdev, 25U, BlockAdd, NumberOfBlocks, BufferBlocks);
+  status = HAL_SDEx_ConfigDMAMultiBuffer(hdev->hsd, (uint32_t *)pBuf0, (uint32_t *)pBuf1, BufferBlocks);
+  if (status == HAL_OK)
+  {
+    status = HAL_SDEx_WriteBlocksDMAMultiBuffer(hdev->hsd, BlockAdd, NumberOfBlocks);
+  }
+
+  if (status != HAL_OK)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_ERROR, hdev->TraceCmd, BlockAdd, NumberOfBlocks, HAL_SD_GetError(hdev->hsd));
+    hdev->ActiveReq = NULL;
+  }
+
+  return status;
+}
+
+HAL_StatusTypeDef SD_WriteBlocksDoubleBufferAsync(uint8_t *pBuf0, uint8_t *pBuf1, uint32_t BufferBlocks,
+                                                  uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                                  SD_RequestTypeDef *pReq)
+{
+  return SD_Dev_WriteBlocksDoubleBufferAsync(&sddev1, pBuf0, pBuf1, BufferBlocks, BlockAdd, NumberOfBlocks, pReq);
+}
+
+/**
+  * @brief  IDMA双缓冲多块读取（异步）
+  * @param  hdev: 设备实例
+  * @param  pBuf0: 缓冲区0
+  * @param  pBuf1: 缓冲区1
+  * @param  BufferBlocks: 每个缓冲区的块数
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 总块数
+  * @param  pReq: 完成令牌
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   缓冲区k填满后在中断中调用pReq->BufferCallback(pReq, k)
+  */
+HAL_StatusTypeDef SD_Dev_ReadBlocksDoubleBufferAsync(SD_DeviceTypeDef *hdev, uint8_t *pBuf0, uint8_t *pBuf1,
+                                                     uint32_t BufferBlocks, uint32_t BlockAdd,
+                                                     uint32_t NumberOfBlocks, SD_RequestTypeDef *pReq)
+{
+  HAL_StatusTypeDef status;
+
+  if ((pBuf0 == NULL) || (pBuf1 == NULL) || (pReq == NULL) || (BufferBlocks == 0U) ||
+      (NumberOfBlocks == 0U) || (NumberOfBlocks > SD_DOUBLEBUF_MAX_BLOCKS) ||
+      ((NumberOfBlocks % BufferBlocks) != 0U) ||
+      (((uintptr_t)pBuf0 & (SD_DCACHE_LINE - 1U)) != 0U) || (((uintptr_t)pBuf1 & (SD_DCACHE_LINE - 1U)) != 0U) ||
+      (SD_IsDmaReachable(pBuf0, BufferBlocks * SD_BLOCK_SIZE) == 0U) ||
+      (SD_IsDmaReachable(pBuf1, BufferBlocks * SD_BLOCK_SIZE) == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 双缓冲传输的时长取决于应用换缓冲区的快慢，不按块数限制 */
+  status = SD_PrepareRequest(hdev, pReq, 0U);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+  pReq->BufferBlocks = BufferBlocks;
+
+  SD_DCacheInvalidate(pBuf0, BufferBlocks * SD_BLOCK_SIZE, 1U);
+  SD_DCacheInvalidate(pBuf1, BufferBlocks * SD_BLOCK_SIZE, 1U);
+  SD_TRACE_IDMA(hdev, 18U, BlockAdd, NumberOfBlocks, BufferBlocks);
+  status = HAL_SDEx_ConfigDMAMultiBuffer(hdev->hsd, (uint32_t *)pBuf0, (uint32_t *)pBuf1, BufferBlocks);
+  if (status == HAL_OK)
+  {
+    status = HAL_SDEx_ReadBlocksDMAMultiBuffer(hdev->hsd, BlockAdd, NumberOfBlocks);
+  }
+
+  if (status != HAL_OK)
+  {
+    SD_TRACE(hdev, SD_TRACE_EV_ERROR, hdev->TraceCmd, BlockAdd, NumberOfBlocks, HAL_SD_GetError(hdev->hsd));
+    hdev->ActiveReq = NULL;
+  }
+
+  return status;
+}
+
+HAL_StatusTypeDef SD_ReadBlocksDoubleBufferAsync(uint8_t *pBuf0, uint8_t *pBuf1, uint32_t BufferBlocks,
+                                                 uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                                 SD_RequestTypeDef *pReq)
+{
+  return SD_Dev_ReadBlocksDoubleBufferAsync(&sddev1, pBuf0, pBuf1, BufferBlocks, BlockAdd, NumberOfBlocks, pReq);
+}
+
 /**
-  * @brief  检查SD卡状态
+  * @brief  双缓冲传输中更换缓冲区k的地址
+  * @param  hdev: 设备实例
+  * @param  BufferIndex: 缓冲区号（0或1）
+  * @param  pBuf: 新的缓冲区
   * @retval HAL_StatusTypeDef 返回操作状态
-  * @note  如果卡状态为HAL_SD_CARD_DISCONNECTED，返回HAL_TIMEOUT
-  * @note  如果卡状态为HAL_SD_CARD_ERROR，返回HAL_ERROR(DEBUG模式下还会输出诊断信息)
-  * @note  如果卡状态为HAL_SD_CARD_TRANSFER或HAL_SD_CARD_READY，返回HAL_OK
-  * @note  如果卡状态为HAL_SD_CARD_SENDING、HAL_SD_CARD_RECEIVING或HAL_SD_CARD_PROGRAMMING，返回HAL_BUSY
+  * @note   按启动时的每缓冲区块数检查新缓冲区IDMA可访问：换成DTCM等地址后IDMA会静默访问错误的内存
   */
-HAL_StatusTypeDef SD_Check(void)
+HAL_StatusTypeDef SD_Dev_ChangeDoubleBuffer(SD_DeviceTypeDef *hdev, uint32_t BufferIndex, uint8_t *pBuf)
 {
-  HAL_SD_CardStateTypeDef card_state;
-  HAL_StatusTypeDef status = HAL_OK;
-  
-  card_state = HAL_SD_GetCardState(&hsd1);
-  
-  switch (card_state)
+  SD_RequestTypeDef *req = hdev->ActiveReq;
+
+  if ((req == NULL) || (req->BufferBlocks == 0U) || (BufferIndex > 1U) || (pBuf == NULL) ||
+      (((uintptr_t)pBuf & 3U) != 0U) || (SD_IsDmaReachable(pBuf, req->BufferBlocks * SD_BLOCK_SIZE) == 0U))
   {
-    case HAL_SD_CARD_TRANSFER:
-    case HAL_SD_CARD_READY:
-      status = HAL_OK;
-      break;
-      
-    case HAL_SD_CARD_SENDING:
-    case HAL_SD_CARD_RECEIVING:
-    case HAL_SD_CARD_PROGRAMMING:
-      status = HAL_BUSY;
-      break;
-      
-    case HAL_SD_CARD_DISCONNECTED:
-      status = HAL_TIMEOUT;
-      break;
-      
-    case HAL_SD_CARD_ERROR:
-#ifdef DEBUG
-      printf("[SD] SD卡状态异常: %lu\r\n", (uint32_t)card_state);
-      SD_ErrorHandler("检查");
-#endif
-      status = HAL_ERROR;
-      break;
-      
-    default:
-      status = HAL_ERROR;
-      break;
+    return HAL_ERROR;
   }
 
-  return status;
+  return HAL_SDEx_ChangeDMABuffer(hdev->hsd, (BufferIndex == 0U) ? SD_DMA_BUFFER0 : SD_DMA_BUFFER1, (uint32_t *)pBuf);
 }
 
-
+HAL_StatusTypeDef SD_ChangeDoubleBuffer(uint32_t BufferIndex, uint8_t *pBuf)
+{
+  return SD_Dev_ChangeDoubleBuffer(&sddev1, BufferIndex, pBuf);
+}
 
 /**
-  * @brief  等待SD卡就绪
-  * @param  Timeout: 超时时间（毫秒）
+  * @brief  中止正在进行的异步请求
+  * @param  pReq: 完成令牌
+  * @param  Status: 写入令牌的完成状态
   * @retval HAL_StatusTypeDef 返回操作状态
-  * @note   等待SD卡进入传输状态，支持超时机制
+  * @note   按令牌记下的实例中止，适用于任一实例的令牌
   */
-HAL_StatusTypeDef SD_WaitReady(uint32_t Timeout)
+HAL_StatusTypeDef SD_AbortRequest(SD_RequestTypeDef *pReq, HAL_StatusTypeDef Status)
 {
-  uint32_t tickstart_local;
-  HAL_StatusTypeDef status = HAL_TIMEOUT;
-  
-  tickstart_local = HAL_GetTick();
-  
-  while ((HAL_GetTick() - tickstart_local) < Timeout)
+  SD_DeviceTypeDef *hdev = (pReq != NULL) ? pReq->pDev : NULL;
+
+  if ((hdev == NULL) || (hdev->ActiveReq != pReq))
   {
-    if (HAL_SD_GetCardState(&hsd1) == HAL_SD_CARD_TRANSFER)
-    {
-      status = HAL_OK;
-      break;
-    }
+    return HAL_ERROR;
   }
-  
-#ifdef DEBUG
-  if (status != HAL_OK)
+
+  (void)HAL_SD_Abort(hdev->hsd);
+  SD_CompleteRequest(hdev, Status);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  查询异步请求状态
+  * @param  pReq: 完成令牌
+  * @retval HAL_StatusTypeDef 未完成返回HAL_BUSY
+  */
+HAL_StatusTypeDef SD_PollRequest(const SD_RequestTypeDef *pReq)
+{
+  if (pReq == NULL)
   {
-    printf("[SD] [FAIL] 等待SD卡就绪超时 (%lu ms)\r\n", Timeout);
+    return HAL_ERROR;
   }
-#endif
-  
-  return status;
-}
 
+  return (pReq->Done != 0U) ? pReq->Status : HAL_BUSY;
+}
 
 /**
-  * @brief  查询模式多块写入（避免FIFO溢出）
-  * @param  pData: 数据缓冲区指针（必须4字节对齐）
-  * @param  BlockAdd: 起始块地址
-  * @param  NumberOfBlocks: 块数量
-  * @param  Timeout: 超时时间（毫秒）
+  * @brief  等待异步请求完成
+  * @param  pReq: 完成令牌
+  * @param  Timeout: 超时时间上限（毫秒）
   * @retval HAL_StatusTypeDef 返回操作状态
-  * @note   使用查询模式进行多块写入，避免FIFO溢出
+  * @note   超时取Timeout与启动时算出的pReq->TimeoutMs中较小的一个（从调用时算起）
+  * @note   超时后中止IDMA传输，令牌状态置为HAL_TIMEOUT；适用于任一实例的令牌
   */
-HAL_StatusTypeDef SD_WriteBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+HAL_StatusTypeDef SD_WaitRequest(SD_RequestTypeDef *pReq, uint32_t Timeout)
 {
-  HAL_StatusTypeDef status;
-  
-  /* 参数验证 */
-  if (pData == NULL)
+  uint32_t tickstart_local;
+
+  if (pReq == NULL)
   {
-#ifdef DEBUG
-    printf("[SD] [FAIL] 参数错误: pData为NULL\r\n");
-#endif
     return HAL_ERROR;
   }
-  
-  if (NumberOfBlocks == 0U)
+
+  Timeout = SD_LimitTimeout(Timeout, pReq->TimeoutMs);
+  tickstart_local = HAL_GetTick();
+#if (SD_STATS_ENABLE != 0U)
+  uint32_t t0 = DWT->CYCCNT;
+#endif
+  while (pReq->Done == 0U)
   {
+#if (SD_CRC_ENABLE != 0U)
+    SD_Crc_Poll();
+#endif
+    if ((HAL_GetTick() - tickstart_local) >= Timeout)
+    {
+      (void)SD_AbortRequest(pReq, HAL_TIMEOUT);
 #ifdef DEBUG
-    printf("[SD] [FAIL] 参数错误: NumberOfBlocks为0\r\n");
+      printf("[SD] [FAIL] IDMA传输超时 (%lu ms)\r\n", Timeout);
 #endif
-    return HAL_ERROR;
+      break;
+    }
   }
-  
-  /* 等待SD卡就绪 */
-  status = SD_WaitReady(Timeout);
-  if (status != HAL_OK)
+#if (SD_STATS_ENABLE != 0U)
+  if (pReq->pDev != NULL)
   {
-    return status;
+    pReq->pDev->Stats.RequestWaitCycles += DWT->CYCCNT - t0;
   }
-  
-  /* 关闭中断，避免FIFO溢出 */
-  __disable_irq();
-  
-  /* 多块写入 */
-  status = HAL_SD_WriteBlocks(&hsd1, pData, BlockAdd, NumberOfBlocks, Timeout);
-  if (status != HAL_OK)
-  {
-#ifdef DEBUG
-    printf("[SD] [FAIL] 多块写入失败，状态: %d\r\n", status);
-    SD_ErrorHandler("写入");
 #endif
+
+  return pReq->Status;
+}
+
+/**
+  * @brief  IDMA写入完成回调（覆盖HAL弱定义）
+  */
+void HAL_SD_TxCpltCallback(SD_HandleTypeDef *hsd)
+{
+  SD_DeviceTypeDef *hdev = SD_FindDevice(hsd);
+
+  if (hdev != NULL)
+  {
+    SD_CompleteRequest(hdev, HAL_OK);
   }
-  
-  /* 重新使能中断 */
-  __enable_irq();
-  
-  return status;
 }
 
 /**
-  * @brief  查询模式多块读取（避免FIFO溢出）
-  * @param  pData: 数据缓冲区指针（必须4字节对齐）
-  * @param  BlockAdd: 起始块地址
-  * @param  NumberOfBlocks: 块数量
-  * @param  Timeout: 超时时间（毫秒）
-  * @retval HAL_StatusTypeDef 返回操作状态
-  * @note   使用查询模式进行多块读取，避免FIFO溢出
+  * @brief  IDMA读取完成回调（覆盖HAL弱定义）
   */
-HAL_StatusTypeDef SD_ReadBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+void HAL_SD_RxCpltCallback(SD_HandleTypeDef *hsd)
 {
-  HAL_StatusTypeDef status;
-  
-  /* 参数验证 */
-  if (pData == NULL)
+  SD_DeviceTypeDef *hdev = SD_FindDevice(hsd);
+
+  if (hdev != NULL)
   {
-#ifdef DEBUG
-    printf("[SD] [FAIL] 参数错误: pData为NULL\r\n");
-#endif
-    return HAL_ERROR;
+    SD_CompleteRequest(hdev, HAL_OK);
   }
-  
-  if (NumberOfBlocks == 0U)
+}
+
+/**
+  * @brief  双缓冲写入时缓冲区0取空回调（覆盖HAL弱定义）
+  */
+void HAL_SDEx_Write_DMADoubleBuf0CpltCallback(SD_HandleTypeDef *hsd)
+{
+  SD_DeviceTypeDef *hdev = SD_FindDevice(hsd);
+  SD_RequestTypeDef *req = (hdev != NULL) ? hdev->ActiveReq : NULL;
+
+  if ((req != NULL) && (req->BufferCallback != NULL))
   {
-#ifdef DEBUG
-    printf("[SD] [FAIL] 参数错误: NumberOfBlocks为0\r\n");
-#endif
-    return HAL_ERROR;
+    req->BufferCallback(req, 0U);
   }
-  
-  /* 等待SD卡就绪 */
-  status = SD_WaitReady(Timeout);
-  if (status != HAL_OK)
+}
+
+/**
+  * @brief  双缓冲写入时缓冲区1取空回调（覆盖HAL弱定义）
+  */
+void HAL_SDEx_Write_DMADoubleBuf1CpltCallback(SD_HandleTypeDef *hsd)
+{
+  SD_DeviceTypeDef *hdev = SD_FindDevice(hsd);
+  SD_RequestTypeDef *req = (hdev != NULL) ? hdev->ActiveReq : NULL;
+
+  if ((req != NULL) && (req->BufferCallback != NULL))
   {
-    return status;
+    req->BufferCallback(req, 1U);
   }
+}
 
-  /* 关闭中断，避免FIFO溢出 */
-  __disable_irq();
-  
-  /* 多块读取 */
-  status = HAL_SD_ReadBlocks(&hsd1, pData, BlockAdd, NumberOfBlocks, Timeout);
-  if (status != HAL_OK)
+/**
+  * @brief  双缓冲读取时缓冲区0填满回调（覆盖HAL弱定义）
+  */
+void HAL_SDEx_Read_DMADoubleBuf0CpltCallback(SD_HandleTypeDef *hsd)
+{
+  HAL_SDEx_Write_DMADoubleBuf0CpltCallback(hsd);
+}
+
+/**
+  * @brief  双缓冲读取时缓冲区1填满回调（覆盖HAL弱定义）
+  */
+void HAL_SDEx_Read_DMADoubleBuf1CpltCallback(SD_HandleTypeDef *hsd)
+{
+  HAL_SDEx_Write_DMADoubleBuf1CpltCallback(hsd);
+}
+
+/**
+  * @brief  传输错误回调（覆盖HAL弱定义）
+  */
+void HAL_SD_ErrorCallback(SD_HandleTypeDef *hsd)
+{
+  SD_DeviceTypeDef *hdev = SD_FindDevice(hsd);
+
+  if (hdev != NULL)
   {
-#ifdef DEBUG
-    printf("[SD] [FAIL] 多块读取失败，状态: %d\r\n", status);
-    SD_ErrorHandler("读取");
-#endif
+    SD_CompleteRequest(hdev, HAL_ERROR);
   }
-  
-  /* 重新使能中断 */
-  __enable_irq();
-  
-  return status;
 }
 
 
@@ -321,7 +2456,7 @@ HAL_StatusTypeDef SD_ReadBlocks(uint8_t *pData, uint32_t BlockAdd, uint32_t Numb
   #warning "SD_TEST_BLOCKS is less than 32. The test data volume is too small and may not accurately reflect SD card performance"
 #endif
 
-static uint8_t sd_backup_buf[SD_TEST_BLOCKS * 512];     /* 备份缓冲区 */
+ALIGN_32BYTES(static uint8_t sd_backup_buf[SD_TEST_BLOCKS * 512]);  /* 备份缓冲区 */
 static uint8_t sd_read_buf[512];                        /* 读取缓冲区（单块） */
 
 /**
@@ -331,11 +2466,16 @@ static uint8_t sd_read_buf[512];                        /* 读取缓冲区（单
   */
 HAL_StatusTypeDef SD_MeasureTest(void)
 {
+    SD_DeviceTypeDef *hdev = &sddev1;
     HAL_StatusTypeDef status;
     uint32_t i;
     uint32_t tick_start, tick_end;
     uint32_t write_time_ms, read_time_ms;
+    uint32_t write_open_ms = 0U;   /* 不预告块数时的写入时间 */
+    uint32_t write_mode;
+    uint32_t k;
     uint32_t backup_read_time_ms;  /* 备份时的读取时间 */
+    uint32_t verify_time_ms;       /* 逐块读取校验的时间 */
     uint32_t total_bytes = SD_TEST_BLOCKS * SD_BLOCK_SIZE;
     uint32_t verify_errors = 0;
     uint32_t j;
@@ -358,7 +2498,7 @@ HAL_StatusTypeDef SD_MeasureTest(void)
     
     /* 1. 检查SD卡就绪 */
     printf("[SD] 检查SD卡就绪状态\r\n");
-    card_state = HAL_SD_GetCardState(&hsd1);
+    card_state = HAL_SD_GetCardState(hdev->hsd);
     if (card_state != HAL_SD_CARD_TRANSFER)
     {
         printf("[SD] [FAIL] SD卡未就绪，状态: %lu\r\n", (uint32_t)card_state);
@@ -373,7 +2513,7 @@ HAL_StatusTypeDef SD_MeasureTest(void)
     /* 执行4遍备份 */
     for (j = 0U; j < 4U; j++)
     {
-        status = SD_ReadBlocks(sd_backup_buf, SD_TEST_BLOCK_START, SD_TEST_BLOCKS, SD_TIMEOUT_MS);
+        status = SD_ReadBlocks(sd_backup_buf, SD_TEST_BLOCK_START, SD_TEST_BLOCKS, SD_TIMEOUT_LONG);
         if (status != HAL_OK)
         {
             printf("[SD] [FAIL] 备份读取失败: %d\r\n", status);
@@ -381,7 +2521,7 @@ HAL_StatusTypeDef SD_MeasureTest(void)
         }
     } 
     
-    status = SD_WaitReady(SD_TIMEOUT_MS * 15U);  /* 使用15代替0xF，更符合MISRA-C */
+    status = SD_WaitReady(SD_TIMEOUT_LONG);
     if (status != HAL_OK) 
     {
         return status;
@@ -399,57 +2539,73 @@ HAL_StatusTypeDef SD_MeasureTest(void)
         sd_backup_buf[i] += 0x0AU;  /* 备份值增加0xA作为写入值 */
     }
     
-    /* 4. 写入测试数据 - 使用连续多块写入 */
+    /* 4. 写入测试数据 - 使用连续多块写入，先不预告块数，再用ACMD23/CMD23预告块数 */
     printf("[SD] 开始写入测试数据（连续多块写入）\r\n");
-    tick_start = HAL_GetTick();
-    
-    /* 使用连续多块写入 */
-    /* 执行4次连续多块写入操作 */
-    for (j = 0U; j < 4U; j++) 
+    write_mode = SD_GetWriteMode();
+    for (k = 0U; k < 2U; k++)
     {
-        status = SD_WriteBlocks(sd_backup_buf, SD_TEST_BLOCK_START, SD_TEST_BLOCKS, SD_TIMEOUT_MS);
-        if (status != HAL_OK)
+        (void)SD_SetWriteMode((k == 0U) ? SD_WRITE_MODE_OPEN_ENDED : SD_WRITE_MODE_PREDEFINED);
+        tick_start = HAL_GetTick();
+        
+        /* 执行4次连续多块写入操作 */
+        for (j = 0U; j < 4U; j++) 
+        {
+            status = SD_WriteBlocks(sd_backup_buf, SD_TEST_BLOCK_START, SD_TEST_BLOCKS, SD_TIMEOUT_LONG);
+            if (status != HAL_OK)
+            {
+                printf("[SD] [FAIL] 第 %lu 次连续多块写入失败: %d\r\n", (uint32_t)(j + 1U), status);
+                (void)SD_SetWriteMode(write_mode);
+                goto restore_data;
+            }
+        }
+        
+        status = SD_WaitReady(SD_TIMEOUT_LONG);
+        if (status != HAL_OK) 
         {
-            printf("[SD] [FAIL] 第 %lu 次连续多块写入失败: %d\r\n", (uint32_t)(j + 1U), status);
+            printf("[SD] [FAIL] 写入完成后SD卡未能恢复就绪\r\n");
+            (void)SD_SetWriteMode(write_mode);
             goto restore_data;
         }
+        
+        tick_end = HAL_GetTick();
+        write_time_ms = tick_end - tick_start;
+        if (k == 0U)
+        {
+            write_open_ms = write_time_ms;
+        }
+        printf("[SD] [PASS] 写入完成(4次, %s)，耗时: %lu ms\r\n",
+               (k == 0U) ? "CMD25+CMD12" :
+               ((SD_USE_IDMA != 0U) && (hdev->Cmd23Supported != 0U)) ? "ACMD23+CMD23+CMD25" : "ACMD23+CMD25",
+               write_time_ms);
     }
-    
-    status = SD_WaitReady(SD_TIMEOUT_MS * 15U);
-    if (status != HAL_OK) 
-    {
-        printf("[SD] [FAIL] 写入完成后SD卡未能恢复就绪\r\n");
-        goto restore_data;
-    }
-    
-    tick_end = HAL_GetTick();
-    write_time_ms = tick_end - tick_start;
-    printf("[SD] [PASS] 写入完成(4次)，耗时: %lu ms\r\n", write_time_ms);
+    (void)SD_SetWriteMode(write_mode);
     
     /* 5. 读取并检验数据 */
     printf("[SD] 开始读取并检验数据\r\n");
     
-    /* 使用备份时的读取时间，不再重新测量 */
+    /* 多块读取速度取备份时的4次读取；校验逐块读取，单独计时 */
     read_time_ms = backup_read_time_ms;
+    tick_start = HAL_GetTick();
     
     /* 逐块读取并立即验证 */
     for (i = 0U; i < SD_TEST_BLOCKS; i++)
     {
-        status = HAL_SD_ReadBlocks(&hsd1, sd_read_buf, SD_TEST_BLOCK_START + i, 1, SD_TIMEOUT_MS);
+        status = HAL_SD_ReadBlocks(hdev->hsd, sd_read_buf, SD_TEST_BLOCK_START + i, 1,
+                                   SD_Dev_GetTimeout(hdev, SD_OP_READ, 1U));
         if (status != HAL_OK)
         {
 #ifdef DEBUG
-          SD_ErrorHandler("读取");
+          SD_ErrorHandler(hdev, "读取");
 #endif
           goto restore_data;
         }
         
         /* 等待读取完成 */
-        status = SD_WaitReady(SD_TIMEOUT_MS);
+        status = SD_WaitReady(SD_TIMEOUT_DEFAULT);
         if (status != HAL_OK) {
 #ifdef DEBUG
             printf("[SD] [FAIL] 块%lu读取超时\r\n", (uint32_t)(SD_TEST_BLOCK_START + i));
-            SD_ErrorHandler("读取超时");
+            SD_ErrorHandler(hdev, "读取超时");
 #endif
             goto restore_data;
         }
@@ -470,9 +2626,11 @@ HAL_StatusTypeDef SD_MeasureTest(void)
         }
     }
     
+    verify_time_ms = HAL_GetTick() - tick_start;
+    
     if (verify_errors == 0)
     {
-        printf("[SD] [PASS] 数据校验通过 \r\n");
+        printf("[SD] [PASS] 数据校验通过，逐块读取耗时: %lu ms\r\n", verify_time_ms);
         
         /* 输出读写速度（使用整数运算，保留一位小数精度） */
         /* 由于之前4重执行，等价于传输的字节数x4，因此总数据量需要乘以4 */
@@ -498,6 +2656,13 @@ HAL_StatusTypeDef SD_MeasureTest(void)
         printf("[SD] 写入速度: %lu.%lu MB/s (%lu.%lu KB/s)\r\n",
                write_speed_mbps_int, write_speed_mbps_dec, 
                write_speed_kbps_int, write_speed_kbps_dec);
+        if (write_open_ms != 0U)
+        {
+            uint32_t open_speed_kbps = (total_kb * 1000) / write_open_ms;  /* 不预告块数时的KB/s */
+            printf("[SD] 写入速度(不预告块数): %lu.%lu MB/s (%lu.%lu KB/s)\r\n",
+                   open_speed_kbps / 1024, ((open_speed_kbps % 1024) * 10) / 1024,
+                   open_speed_kbps / 10, open_speed_kbps % 10);
+        }
         printf("[SD] 读取速度: %lu.%lu MB/s (%lu.%lu KB/s)\r\n",
                read_speed_mbps_int, read_speed_mbps_dec, 
                read_speed_kbps_int, read_speed_kbps_dec);
@@ -523,16 +2688,16 @@ restore_data:
     tick_start = HAL_GetTick();
     
     /* 使用连续多块写入还原数据 */
-    status = SD_WriteBlocks(sd_backup_buf, SD_TEST_BLOCK_START, SD_TEST_BLOCKS, SD_TIMEOUT_MS);
+    status = SD_WriteBlocks(sd_backup_buf, SD_TEST_BLOCK_START, SD_TEST_BLOCKS, SD_TIMEOUT_LONG);
     if (status != HAL_OK)
     {
 #ifdef DEBUG
-      SD_ErrorHandler("数据还原");
+      SD_ErrorHandler(hdev, "数据还原");
 #endif
       goto end_test;
     }
     
-    status = SD_WaitReady(SD_TIMEOUT_MS * 15U);
+    status = SD_WaitReady(SD_TIMEOUT_LONG);
     if (status != HAL_OK)
     {
       goto end_test;
@@ -552,23 +2717,24 @@ end_test:
 
 /**
  * @brief  SD卡错误诊断入口函数
+ * @param  hdev: 设备实例
  * @param  operation: 操作类型字符串，如"写入"、"读取"等
  * @retval 无
  * @note   根据 HAL_SD_GetError 返回值，对照完整位表输出详细错误原因
  * @note   符合MISRA-C规范，使用const静态表避免RAM占用
  */
-static void SD_ErrorHandler(const char* operation)
+static void SD_ErrorHandler(SD_DeviceTypeDef *hdev, const char* operation)
 {
     uint32_t error_code;
     uint8_t found_error = 0U;
     
     /* 在函数内部获取错误码 */
-    error_code = HAL_SD_GetError(&hsd1);
+    error_code = HAL_SD_GetError(hdev->hsd);
     
     /* 打印基本错误信息 */
     printf("\r\n[SD] === SD卡%s操作[FAIL]诊断开始 ===\r\n", operation);
     printf("[SD] HAL_SD_GetError() = 0x%08lX\r\n", error_code);
-    printf("[SD] hsd1.State = %d, hsd1.ErrorCode = 0x%08lX\r\n", hsd1.State, hsd1.ErrorCode);
+    printf("[SD] hsd->State = %d, hsd->ErrorCode = 0x%08lX\r\n", hdev->hsd->State, hdev->hsd->ErrorCode);
     
     /* 如果错误码为0，可能是HAL状态错误而非SD错误 */
     if (error_code == 0U)
@@ -576,7 +2742,7 @@ static void SD_ErrorHandler(const char* operation)
         printf("[SD] [WARN] SD错误码为0，可能是HAL层返回状态错误\r\n");
         printf("[SD] 建议检查：\r\n");
         printf("[SD] 1. HAL_SD_GetCardState() 返回值\r\n");
-        printf("[SD] 2. hsd1.State 和 hsd1.ErrorCode 状态\r\n");
+        printf("[SD] 2. hsd->State 和 hsd->ErrorCode 状态\r\n");
         printf("[SD] 3. 调用栈中的HAL状态返回值\r\n");
         printf("[SD] === SD卡[FAIL]诊断结束 ===\r\n\r\n");
         return;
@@ -653,11 +2819,12 @@ static void SD_ErrorHandler(const char* operation)
 
 /**
  * @brief 获取SD卡信息
+  * @param  hdev: 设备实例
  * @param  pCardInfo: 指向SD卡信息结构体的指针
  * @retval HAL_StatusTypeDef 返回操作状态
  * @note 获取SD卡的详细信息，包括容量、类型等
  */
-HAL_StatusTypeDef SD_GetCardInfo(SD_CardInfoTypeDef *pCardInfo)
+HAL_StatusTypeDef SD_Dev_GetCardInfo(const SD_DeviceTypeDef *hdev, SD_CardInfoTypeDef *pCardInfo)
 {
   HAL_StatusTypeDef status;
   HAL_SD_CardInfoTypeDef hal_card_info;
@@ -672,7 +2839,7 @@ HAL_StatusTypeDef SD_GetCardInfo(SD_CardInfoTypeDef *pCardInfo)
   }
   
   /* 获取HAL层卡信息 */
-  status = HAL_SD_GetCardInfo(&hsd1, &hal_card_info);
+  status = HAL_SD_GetCardInfo(hdev->hsd, &hal_card_info);
   if (status != HAL_OK)
   {
 #ifdef DEBUG
@@ -690,8 +2857,106 @@ HAL_StatusTypeDef SD_GetCardInfo(SD_CardInfoTypeDef *pCardInfo)
   pCardInfo->BlockSize    = hal_card_info.BlockSize;
   pCardInfo->LogBlockNbr  = hal_card_info.LogBlockNbr;
   pCardInfo->LogBlockSize = hal_card_info.LogBlockSize;
+  pCardInfo->Cmd23Supported = hdev->Cmd23Supported;
+  pCardInfo->BusSpeedMode = hdev->BusSpeed;
+  pCardInfo->BusClockHz   = SD_ClockDivToHz(hdev->hsd->Instance->CLKCR & SDMMC_CLKCR_CLKDIV);
+  pCardInfo->AuBlocks     = SD_AuSizeToBlocks(hdev);
+  pCardInfo->SpeedClass   = 0U;
+  pCardInfo->UhsSpeedGrade = 0U;
+  pCardInfo->VideoSpeedClass = 0U;
+  if (hdev->CardStatusValid != 0U)
+  {
+    static const uint8_t speed_class[5] = {0U, 2U, 4U, 6U, 10U};
+
+    pCardInfo->SpeedClass = (hdev->CardStatus.SpeedClass < 5U) ? speed_class[hdev->CardStatus.SpeedClass] : 0U;
+    pCardInfo->UhsSpeedGrade = hdev->CardStatus.UhsSpeedGrade;
+    pCardInfo->VideoSpeedClass = hdev->CardStatus.VideoSpeedClass;
+  }
+  pCardInfo->ReadAccessUs  = SD_AccessTimeoutUs(hdev, 0U);
+  pCardInfo->WriteBusyUs   = SD_AccessTimeoutUs(hdev, 1U);
+  pCardInfo->EraseAuMs     = SD_EraseAuTimeoutMs(hdev);
+  pCardInfo->EraseOffsetMs = (hdev->CardStatusValid != 0U) ? ((uint32_t)hdev->CardStatus.EraseOffset * 1000U) : 0U;
   
   return HAL_OK;
 }
 
+HAL_StatusTypeDef SD_GetCardInfo(SD_CardInfoTypeDef *pCardInfo)
+{
+  return SD_Dev_GetCardInfo(&sddev1, pCardInfo);
+}
+
+#if (SD_STATS_ENABLE != 0U)
+/**
+  * @brief  记录一次操作
+  * @param  pOp: 操作统计
+  * @param  Start: 开始时的DWT->CYCCNT
+  * @param  Bytes: 字节数，失败时不计
+  * @param  Status: 操作状态
+  */
+static void SD_StatsRecord(SD_OpStatsTypeDef *pOp, uint32_t Start, uint32_t Bytes, HAL_StatusTypeDef Status)
+{
+  uint32_t cycles = DWT->CYCCNT - Start;
+
+  pOp->Ops++;
+  pOp->Cycles += cycles;
+  pOp->Hist[(cycles == 0U) ? 0U : (31U - __CLZ(cycles))]++;
+  if (cycles > pOp->MaxCycles)
+  {
+    pOp->MaxCycles = cycles;
+  }
+  if (Status == HAL_OK)
+  {
+    pOp->Bytes += Bytes;
+  }
+  else
+  {
+    pOp->Errors++;
+  }
+}
+#endif
+
+/**
+  * @brief  读取运行统计
+  * @param  hdev: 设备实例
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Dev_GetStats(const SD_DeviceTypeDef *hdev, SD_StatsTypeDef *pStats)
+{
+  if (pStats == NULL)
+  {
+    return;
+  }
+
+#if (SD_STATS_ENABLE != 0U)
+  *pStats = hdev->Stats;
+#else
+  (void)hdev;
+  (void)memset(pStats, 0, sizeof(*pStats));
+#endif
+  pStats->CyclesPerUs = SystemCoreClock / 1000000U;
+}
+
+void SD_GetStats(SD_StatsTypeDef *pStats)
+{
+  SD_Dev_GetStats(&sddev1, pStats);
+}
+
+/**
+  * @brief  清零运行统计
+  * @param  hdev: 设备实例
+  */
+void SD_Dev_ResetStats(SD_DeviceTypeDef *hdev)
+{
+#if (SD_STATS_ENABLE != 0U)
+  (void)memset(&hdev->Stats, 0, sizeof(hdev->Stats));
+#else
+  (void)hdev;
+#endif
+}
+
+void SD_ResetStats(void)
+{
+  SD_Dev_ResetStats(&sddev1);
+}
+
 /* USER CODE END 1 */
@@ -0,0 +1,224 @@
+/**
+  ******************************************************************************
+  * @file    sd_bench.c
+  * @brief   SD卡性能测试套件实现
+  * @author  STMicroelectronics
+  * @date    2025-10-31
+  * @version 1.0
+  * @note    每次传输单独计时（DWT周期数），总耗时为各次之和，不含地址生成等测试自身的开销
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_bench.h"
+
+#if (SD_BENCH_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <stdio.h>
+
+#define SD_BENCH_DWT_UNLOCK   0xC5ACCE55U   /* Cortex-M7 DWT锁存访问密钥 */
+
+static uint32_t sd_bench_lat[SD_BENCH_MAX_OPS];   /* 本项各次传输的延迟（周期数） */
+static uint32_t sd_bench_rng;                     /* 随机地址序列 */
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  下一个伪随机数
+  */
+static uint32_t SD_Bench_Rand(void)
+{
+  sd_bench_rng = (sd_bench_rng * 1664525U) + 1013904223U;
+  return sd_bench_rng >> 8;
+}
+
+/**
+  * @brief  周期数换算为微秒
+  */
+static uint32_t SD_Bench_CyclesToUs(uint64_t Cycles)
+{
+  uint32_t per_us = SystemCoreClock / 1000000U;
+
+  return (uint32_t)(Cycles / ((per_us != 0U) ? per_us : 1U));
+}
+
+/**
+  * @brief  运行一项测试
+  * @param  pConfig: 测试配置
+  * @param  pTest: 测试名
+  * @param  Blocks: 每次传输块数
+  * @param  ReadPercent: 读所占百分比
+  * @param  Random: 0为顺序地址，1为随机地址（按Blocks对齐）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_Bench_Row(const SD_BenchConfigTypeDef *pConfig, const char *pTest, uint32_t Blocks,
+                                      uint32_t ReadPercent, uint8_t Random)
+{
+  SD_BenchResultTypeDef result;
+  HAL_StatusTypeDef status;
+  uint64_t total = 0U;
+  uint32_t slots = pConfig->AreaBlocks / Blocks;
+  uint32_t addr;
+  uint32_t t0;
+  uint32_t i;
+  uint32_t j;
+  uint32_t key;
+  uint8_t is_read;
+  uint8_t wrote = 0U;
+
+  for (i = 0U; i < pConfig->Ops; i++)
+  {
+    addr = pConfig->StartBlock + (((Random != 0U) ? (SD_Bench_Rand() % slots) : (i % slots)) * Blocks);
+    is_read = ((SD_Bench_Rand() % 100U) < ReadPercent) ? 1U : 0U;
+
+    t0 = DWT->CYCCNT;
+    status = (is_read != 0U) ? SD_ReadBlocks(pConfig->pBuf, addr, Blocks, SD_TIMEOUT_LONG) :
+                               SD_WriteBlocks(pConfig->pBuf, addr, Blocks, SD_TIMEOUT_LONG);
+    if (status == HAL_OK)
+    {
+      status = SD_WaitReady(SD_TIMEOUT_LONG);
+    }
+    sd_bench_lat[i] = DWT->CYCCNT - t0;
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+    total += sd_bench_lat[i];
+    wrote |= (uint8_t)(is_read ^ 1U);
+  }
+
+  /* 缓存/写合并队列中剩余的数据也算在本项内 */
+  if (wrote != 0U)
+  {
+    t0 = DWT->CYCCNT;
+    status = SD_Flush(SD_TIMEOUT_LONG);
+    if (status == HAL_OK)
+    {
+      status = SD_WaitReady(SD_TIMEOUT_LONG);
+    }
+    total += DWT->CYCCNT - t0;
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+  }
+
+  /* 延迟插入排序取分位数 */
+  for (i = 1U; i < pConfig->Ops; i++)
+  {
+    key = sd_bench_lat[i];
+    j = i;
+    while ((j > 0U) && (sd_bench_lat[j - 1U] > key))
+    {
+      sd_bench_lat[j] = sd_bench_lat[j - 1U];
+      j--;
+    }
+    sd_bench_lat[j] = key;
+  }
+
+  result.Test        = pTest;
+  result.Blocks      = Blocks;
+  result.ReadPercent = ReadPercent;
+  result.Ops         = pConfig->Ops;
+  result.Bytes       = pConfig->Ops * Blocks * SD_BLOCK_SIZE;
+  result.TotalUs     = SD_Bench_CyclesToUs(total);
+  if (result.TotalUs == 0U)
+  {
+    result.TotalUs = 1U;
+  }
+  result.KBps        = (uint32_t)(((uint64_t)result.Bytes * 1000U) / result.TotalUs);
+  result.Iops        = (uint32_t)(((uint64_t)result.Ops * 1000000U) / result.TotalUs);
+  result.P50Us       = SD_Bench_CyclesToUs(sd_bench_lat[((pConfig->Ops * 50U) + 99U) / 100U - 1U]);
+  result.P99Us       = SD_Bench_CyclesToUs(sd_bench_lat[((pConfig->Ops * 99U) + 99U) / 100U - 1U]);
+  result.MaxUs       = SD_Bench_CyclesToUs(sd_bench_lat[pConfig->Ops - 1U]);
+
+  SD_Bench_Output(&result);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  运行全部测试项
+  * @param  pConfig: 测试配置
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Bench_Run(const SD_BenchConfigTypeDef *pConfig)
+{
+  static const uint32_t mix_read[3] = {75U, 50U, 25U};
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t pass;
+  uint32_t blocks;
+  uint32_t i;
+
+  if ((pConfig == NULL) || (pConfig->pBuf == NULL) || (pConfig->MaxBlocks == 0U) ||
+      (pConfig->AreaBlocks < pConfig->MaxBlocks) || (pConfig->AreaBlocks < SD_BENCH_MIX_BLOCKS) ||
+      (pConfig->Ops == 0U) || (pConfig->Ops > SD_BENCH_MAX_OPS))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 启动DWT周期计数器 */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = SD_BENCH_DWT_UNLOCK;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  sd_bench_rng = pConfig->Seed;
+  SD_Bench_Output(NULL);
+
+  /* 顺序读、顺序写、随机读、随机写：传输大小1、2、4 ... MaxBlocks */
+  for (pass = 0U; (pass < 4U) && (status == HAL_OK); pass++)
+  {
+    blocks = 1U;
+    for (;;)
+    {
+      status = SD_Bench_Row(pConfig, (pass < 2U) ? "seq" : "rand", blocks,
+                            ((pass & 1U) == 0U) ? 100U : 0U, (pass < 2U) ? 0U : 1U);
+      if ((status != HAL_OK) || (blocks == pConfig->MaxBlocks))
+      {
+        break;
+      }
+      blocks = ((blocks * 2U) < pConfig->MaxBlocks) ? (blocks * 2U) : pConfig->MaxBlocks;
+    }
+  }
+
+  /* 混合读写：SD_BENCH_MIX_BLOCKS块随机地址 */
+  for (i = 0U; (i < 3U) && (status == HAL_OK) && (SD_BENCH_MIX_BLOCKS <= pConfig->MaxBlocks); i++)
+  {
+    status = SD_Bench_Row(pConfig, "mix", SD_BENCH_MIX_BLOCKS, mix_read[i], 1U);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  输出一项结果（弱定义）
+  * @param  pResult: 测试结果，NULL时输出表头
+  */
+__weak void SD_Bench_Output(const SD_BenchResultTypeDef *pResult)
+{
+  if (pResult == NULL)
+  {
+    printf("sdbench,test,blocks,read_pct,ops,bytes,us,mbps,iops,p50_us,p99_us,max_us\r\n");
+    return;
+  }
+
+  printf("sdbench,%s,%lu,%lu,%lu,%lu,%lu,%lu.%03lu,%lu,%lu,%lu,%lu\r\n",
+         pResult->Test, pResult->Blocks, pResult->ReadPercent, pResult->Ops,
+         pResult->Bytes, pResult->TotalUs, pResult->KBps / 1000U, pResult->KBps % 1000U, pResult->Iops,
+         pResult->P50Us, pResult->P99Us, pResult->MaxUs);
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_BENCH_ENABLE */
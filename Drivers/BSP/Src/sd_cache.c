@@ -0,0 +1,409 @@
+/**
+  ******************************************************************************
+  * @file    sd_cache.c
+  * @brief   SD卡组相联写回块缓存实现
+  * @author  STMicroelectronics
+  * @date    2025-10-24
+  * @version 1.0
+  * @note    组号 = 块地址 & (SD_CACHE_SETS - 1)，组内按访问时间戳做LRU替换
+  * @note    缓存行数据直接作为IDMA的源/目的，32字节对齐以便做D-Cache维护
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_cache.h"
+
+#if (SD_CACHE_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#if (SD_QUEUE_ENABLE != 0U)
+#include "sd_queue.h"
+#define SD_CACHE_FILL       SD_Queue_Read         /* 未命中读取叠加写合并队列中的数据 */
+#define SD_CACHE_DRAIN      SD_Queue_Write        /* 写回经过写合并队列 */
+#elif (SD_PREFETCH_ENABLE != 0U)
+#include "sd_prefetch.h"
+#define SD_CACHE_FILL       SD_Prefetch_Read      /* 未命中经过顺序读预取器 */
+#define SD_CACHE_DRAIN      SD_WriteBlocksDirect
+#else
+#define SD_CACHE_FILL       SD_ReadBlocksDirect
+#define SD_CACHE_DRAIN      SD_WriteBlocksDirect
+#endif
+
+/**
+ * @brief 缓存行标签
+ */
+typedef struct {
+    uint32_t Block;   /*!< 缓存的块地址 */
+    uint32_t Stamp;   /*!< 最近访问时间戳，越小越久未用 */
+    uint8_t  Valid;   /*!< 行有效 */
+    uint8_t  Dirty;   /*!< 行已修改未写回 */
+} SD_CacheLineTypeDef;
+
+ALIGN_32BYTES(static uint8_t sd_cache_data[SD_CACHE_LINES][SD_BLOCK_SIZE]) SD_CACHE_SECTION;  /* 行数据 */
+static SD_CacheLineTypeDef sd_cache_tag[SD_CACHE_LINES];                                     /* 行标签 */
+static uint32_t sd_cache_clock;                                                              /* LRU时间戳 */
+static SD_CacheStatsTypeDef sd_cache_stats;
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  查找块所在的缓存行
+  * @param  BlockAdd: 块地址
+  * @retval int32_t 行号，未命中返回-1
+  */
+static int32_t SD_Cache_Lookup(uint32_t BlockAdd)
+{
+  uint32_t base = (BlockAdd & (SD_CACHE_SETS - 1U)) * SD_CACHE_WAYS;
+  uint32_t way;
+
+  for (way = 0U; way < SD_CACHE_WAYS; way++)
+  {
+    if ((sd_cache_tag[base + way].Valid != 0U) && (sd_cache_tag[base + way].Block == BlockAdd))
+    {
+      return (int32_t)(base + way);
+    }
+  }
+
+  return -1;
+}
+
+/**
+  * @brief  更新行的LRU时间戳
+  */
+static void SD_Cache_Touch(uint32_t line)
+{
+  sd_cache_clock++;
+  sd_cache_tag[line].Stamp = sd_cache_clock;
+}
+
+/**
+  * @brief  写回一个脏行
+  */
+static HAL_StatusTypeDef SD_Cache_WriteBack(uint32_t line, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+  status = SD_CACHE_DRAIN(sd_cache_data[line], sd_cache_tag[line].Block, 1U, Timeout);
+  if (status == HAL_OK)
+  {
+    sd_cache_tag[line].Dirty = 0U;
+    sd_cache_stats.DirtyLines--;
+    sd_cache_stats.WriteBacks++;
+  }
+
+  return status;
+}
+
+/**
+  * @brief  为块分配缓存行（必要时替换组内最久未用的行）
+  * @param  BlockAdd: 块地址
+  * @param  pSrc: 行的新内容
+  * @param  Dirty: 新行是否为脏
+  * @param  Timeout: 写回超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 写回被替换的脏行失败时返回错误，此时不分配
+  */
+static HAL_StatusTypeDef SD_Cache_Install(uint32_t BlockAdd, const uint8_t *pSrc, uint8_t Dirty, uint32_t Timeout)
+{
+  uint32_t base = (BlockAdd & (SD_CACHE_SETS - 1U)) * SD_CACHE_WAYS;
+  uint32_t victim = base;
+  uint32_t way;
+  HAL_StatusTypeDef status;
+
+  for (way = 0U; way < SD_CACHE_WAYS; way++)
+  {
+    if (sd_cache_tag[base + way].Valid == 0U)
+    {
+      victim = base + way;
+      break;
+    }
+    if (sd_cache_tag[base + way].Stamp < sd_cache_tag[victim].Stamp)
+    {
+      victim = base + way;
+    }
+  }
+
+  if (sd_cache_tag[victim].Valid != 0U)
+  {
+    if (sd_cache_tag[victim].Dirty != 0U)
+    {
+      status = SD_Cache_WriteBack(victim, Timeout);
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+    }
+    sd_cache_stats.Evictions++;
+  }
+
+  memcpy(sd_cache_data[victim], pSrc, SD_BLOCK_SIZE);
+  sd_cache_tag[victim].Block = BlockAdd;
+  sd_cache_tag[victim].Valid = 1U;
+  sd_cache_tag[victim].Dirty = Dirty;
+  if (Dirty != 0U)
+  {
+    sd_cache_stats.DirtyLines++;
+  }
+  SD_Cache_Touch(victim);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  经缓存读取
+  * @param  pData: 数据缓冲区指针
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Cache_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t i;
+  uint32_t j;
+  int32_t line;
+
+  if ((pData == NULL) || (NumberOfBlocks == 0U))
+  {
+    return SD_CACHE_FILL(pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+
+  /* 大块读取：直接读卡，再用缓存中较新的内容覆盖 */
+  if (NumberOfBlocks >= SD_CACHE_BYPASS_BLOCKS)
+  {
+    sd_cache_stats.Bypasses++;
+    status = SD_CACHE_FILL(pData, BlockAdd, NumberOfBlocks, Timeout);
+    if (status == HAL_OK)
+    {
+      for (i = 0U; i < NumberOfBlocks; i++)
+      {
+        line = SD_Cache_Lookup(BlockAdd + i);
+        if ((line >= 0) && (sd_cache_tag[line].Dirty != 0U))
+        {
+          memcpy(&pData[i * SD_BLOCK_SIZE], sd_cache_data[line], SD_BLOCK_SIZE);
+        }
+      }
+    }
+    return status;
+  }
+
+  i = 0U;
+  while (i < NumberOfBlocks)
+  {
+    line = SD_Cache_Lookup(BlockAdd + i);
+    if (line >= 0)
+    {
+      memcpy(&pData[i * SD_BLOCK_SIZE], sd_cache_data[line], SD_BLOCK_SIZE);
+      SD_Cache_Touch((uint32_t)line);
+      sd_cache_stats.Hits++;
+      i++;
+      continue;
+    }
+
+    /* 连续未命中的块合并为一次多块读取，直接读入用户缓冲区 */
+    j = i + 1U;
+    while ((j < NumberOfBlocks) && (SD_Cache_Lookup(BlockAdd + j) < 0))
+    {
+      j++;
+    }
+
+    status = SD_CACHE_FILL(&pData[i * SD_BLOCK_SIZE], BlockAdd + i, j - i, Timeout);
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+    sd_cache_stats.Misses += j - i;
+
+    for (; i < j; i++)
+    {
+      status = SD_Cache_Install(BlockAdd + i, &pData[i * SD_BLOCK_SIZE], 0U, Timeout);
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  经缓存写入（写回）
+  * @param  pData: 数据缓冲区指针
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Cache_Write(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t i;
+  int32_t line;
+
+  if ((pData == NULL) || (NumberOfBlocks == 0U))
+  {
+    return SD_CACHE_DRAIN((uint8_t *)pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+
+  /* 大块写入：直接写卡，已缓存的行同步为新内容并变为干净 */
+  if (NumberOfBlocks >= SD_CACHE_BYPASS_BLOCKS)
+  {
+    sd_cache_stats.Bypasses++;
+    status = SD_CACHE_DRAIN((uint8_t *)pData, BlockAdd, NumberOfBlocks, Timeout);
+    if (status == HAL_OK)
+    {
+      for (i = 0U; i < NumberOfBlocks; i++)
+      {
+        line = SD_Cache_Lookup(BlockAdd + i);
+        if (line >= 0)
+        {
+          memcpy(sd_cache_data[line], &pData[i * SD_BLOCK_SIZE], SD_BLOCK_SIZE);
+          if (sd_cache_tag[line].Dirty != 0U)
+          {
+            sd_cache_tag[line].Dirty = 0U;
+            sd_cache_stats.DirtyLines--;
+          }
+        }
+      }
+    }
+    return status;
+  }
+
+  for (i = 0U; i < NumberOfBlocks; i++)
+  {
+    line = SD_Cache_Lookup(BlockAdd + i);
+    if (line >= 0)
+    {
+      memcpy(sd_cache_data[line], &pData[i * SD_BLOCK_SIZE], SD_BLOCK_SIZE);
+      if (sd_cache_tag[line].Dirty == 0U)
+      {
+        sd_cache_tag[line].Dirty = 1U;
+        sd_cache_stats.DirtyLines++;
+      }
+      SD_Cache_Touch((uint32_t)line);
+      sd_cache_stats.Hits++;
+    }
+    else
+    {
+      /* 整块覆盖，无需先读 */
+      status = SD_Cache_Install(BlockAdd + i, &pData[i * SD_BLOCK_SIZE], 1U, Timeout);
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+      sd_cache_stats.Misses++;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  按块地址升序写回全部脏行
+  * @param  Timeout: 每次写入的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Cache_Flush(uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t line;
+  uint32_t next;
+
+  while (sd_cache_stats.DirtyLines != 0U)
+  {
+    next = SD_CACHE_LINES;
+    for (line = 0U; line < SD_CACHE_LINES; line++)
+    {
+      if ((sd_cache_tag[line].Dirty != 0U) &&
+          ((next == SD_CACHE_LINES) || (sd_cache_tag[line].Block < sd_cache_tag[next].Block)))
+      {
+        next = line;
+      }
+    }
+
+    if (next == SD_CACHE_LINES)
+    {
+      sd_cache_stats.DirtyLines = 0U;  /* 计数与标签不一致，以标签为准 */
+      break;
+    }
+
+    status = SD_Cache_WriteBack(next, Timeout);
+    if (status != HAL_OK)
+    {
+#ifdef DEBUG
+      printf("[SD] [FAIL] 缓存写回块%lu失败，状态: %d\r\n", sd_cache_tag[next].Block, status);
+#endif
+      return status;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  作废指定区间的缓存行
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  */
+void SD_Cache_Invalidate(uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+  uint32_t line;
+
+  for (line = 0U; line < SD_CACHE_LINES; line++)
+  {
+    if ((sd_cache_tag[line].Valid != 0U) && (sd_cache_tag[line].Block >= BlockAdd) &&
+        ((sd_cache_tag[line].Block - BlockAdd) < NumberOfBlocks))
+    {
+      if (sd_cache_tag[line].Dirty != 0U)
+      {
+        sd_cache_stats.DirtyLines--;
+      }
+      sd_cache_tag[line].Valid = 0U;
+      sd_cache_tag[line].Dirty = 0U;
+    }
+  }
+}
+
+/**
+  * @brief  读取缓存统计
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Cache_GetStats(SD_CacheStatsTypeDef *pStats)
+{
+  if (pStats != NULL)
+  {
+    *pStats = sd_cache_stats;
+  }
+}
+
+/**
+  * @brief  清零缓存统计（DirtyLines除外）
+  */
+void SD_Cache_ResetStats(void)
+{
+  uint32_t dirty = sd_cache_stats.DirtyLines;
+
+  memset(&sd_cache_stats, 0, sizeof(sd_cache_stats));
+  sd_cache_stats.DirtyLines = dirty;
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_CACHE_ENABLE */
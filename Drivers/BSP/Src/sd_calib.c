@@ -0,0 +1,347 @@
+/**
+  ******************************************************************************
+  * @file    sd_calib.c
+  * @brief   SD卡总线时钟自校准实现
+  * @author  STMicroelectronics
+  * @date    2025-10-29
+  * @version 1.0
+  * @note    分频从快到慢逐级测试，第一个全部轮次通过的分频即为最高稳定时钟；
+  *          越过板级极限的时钟往往只是偶发CRC错误，因此每级要跑多轮、多种图案
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_calib.h"
+
+#if (SD_CALIB_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#if (SD_RECOVER_ENABLE != 0U)
+#include "sd_recover.h"
+#endif
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#define SD_CALIB_CRC_ERRORS  (HAL_SD_ERROR_DATA_CRC_FAIL | HAL_SD_ERROR_CMD_CRC_FAIL)
+
+ALIGN_32BYTES(static uint8_t sd_calib_backup[SD_CALIB_BLOCKS * SD_BLOCK_SIZE]) SD_CALIB_SECTION;   /* 暂存区原数据 */
+ALIGN_32BYTES(static uint8_t sd_calib_pattern[SD_CALIB_BLOCKS * SD_BLOCK_SIZE]) SD_CALIB_SECTION;  /* 写入图案 */
+ALIGN_32BYTES(static uint8_t sd_calib_readback[SD_CALIB_BLOCKS * SD_BLOCK_SIZE]) SD_CALIB_SECTION; /* 读回数据 */
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  生成第Round轮的测试图案
+  * @param  Round: 轮次
+  * @note   0x55/0xAA交替（每个时钟都翻转）、走1、0x00/0xFF成段交替、伪随机
+  */
+static void SD_Calib_Fill(uint32_t Round)
+{
+  uint32_t seed = 0x12345678U ^ (Round * 0x9E3779B9U);
+  uint32_t i;
+
+  for (i = 0U; i < sizeof(sd_calib_pattern); i++)
+  {
+    switch (Round % 4U)
+    {
+      case 0U:
+        sd_calib_pattern[i] = ((i & 1U) == 0U) ? 0x55U : 0xAAU;
+        break;
+      case 1U:
+        sd_calib_pattern[i] = (uint8_t)(1U << (i % 8U));
+        break;
+      case 2U:
+        sd_calib_pattern[i] = ((i & 32U) == 0U) ? 0x00U : 0xFFU;
+        break;
+      default:
+        seed = (seed * 1664525U) + 1013904223U;
+        sd_calib_pattern[i] = (uint8_t)(seed >> 24);
+        break;
+    }
+  }
+}
+
+/**
+  * @brief  在指定分频下跑完全部轮次
+  * @param  ClkDiv: 分频
+  * @param  ScratchBlock: 暂存区起始块
+  * @param  pResult: 累计CRC错误
+  * @retval HAL_StatusTypeDef 任一轮出错或数据不一致返回HAL_ERROR
+  */
+static HAL_StatusTypeDef SD_Calib_TestDiv(uint32_t ClkDiv, uint32_t ScratchBlock, SD_CalibResultTypeDef *pResult)
+{
+  HAL_StatusTypeDef status;
+  uint32_t round;
+#if (SD_RECOVER_ENABLE != 0U)
+  uint8_t recover;
+#endif
+
+  for (round = 0U; round < SD_CALIB_ROUNDS; round++)
+  {
+    /* 上一轮出错时驱动可能已自动退回SD_Init时的分频，每轮重新设置 */
+    status = SD_SetClockDiv(ClkDiv);
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+
+    SD_Calib_Fill(round);
+#if (SD_RECOVER_ENABLE != 0U)
+    /* 要测的正是这个分频下的原始错误，不能被重试或降频掩盖 */
+    recover = SD_Recover_Enable(0U);
+#endif
+    status = SD_WriteBlocksDirect(sd_calib_pattern, ScratchBlock, SD_CALIB_BLOCKS, SD_TIMEOUT_DEFAULT);
+    if (status == HAL_OK)
+    {
+      status = SD_ReadBlocksDirect(sd_calib_readback, ScratchBlock, SD_CALIB_BLOCKS, SD_TIMEOUT_DEFAULT);
+    }
+#if (SD_RECOVER_ENABLE != 0U)
+    (void)SD_Recover_Enable(recover);
+#endif
+
+    if (status != HAL_OK)
+    {
+      if ((HAL_SD_GetError(sddev1.hsd) & SD_CALIB_CRC_ERRORS) != 0U)
+      {
+        pResult->CrcErrors++;
+      }
+      return HAL_ERROR;
+    }
+
+    if (memcmp(sd_calib_pattern, sd_calib_readback, sizeof(sd_calib_pattern)) != 0)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  计算结果记录的校验
+  */
+static uint32_t SD_Calib_Checksum(const SD_CalibResultTypeDef *pResult)
+{
+  const uint32_t *w = (const uint32_t *)pResult;
+  uint32_t sum = 0U;
+  uint32_t i;
+
+  for (i = 0U; i < ((sizeof(*pResult) / sizeof(uint32_t)) - 1U); i++)
+  {
+    sum = ((sum << 5) | (sum >> 27)) ^ w[i];
+  }
+
+  return ~sum;
+}
+
+/**
+  * @brief  校准并应用最高稳定时钟
+  * @param  ScratchBlock: 暂存区起始块
+  * @param  pResult: 输出，校准结果
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Calibrate(uint32_t ScratchBlock, SD_CalibResultTypeDef *pResult)
+{
+  SD_CardInfoTypeDef info;
+  HAL_StatusTypeDef status;
+  HAL_StatusTypeDef restore;
+  uint32_t safe_div;
+  uint32_t safe_hz;
+  uint32_t div;
+  uint32_t best;
+  uint8_t found = 0U;
+
+  if ((pResult == NULL) || (SD_GetCardInfo(&info) != HAL_OK) ||
+      (ScratchBlock >= info.LogBlockNbr) || ((info.LogBlockNbr - ScratchBlock) < SD_CALIB_BLOCKS))
+  {
+    return HAL_ERROR;
+  }
+
+  (void)memset(pResult, 0, sizeof(*pResult));
+  pResult->Magic = SD_CALIB_MAGIC;
+  pResult->KernelClockHz = SD_ClockDivToHz(0U);
+  pResult->BusSpeedMode = info.BusSpeedMode;
+
+  /* 1. 在SD_Init时的时钟下备份暂存区 */
+  status = SD_SetClockDiv(SD_CLOCKDIV_DEFAULT);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+  safe_div = SD_GetClockDiv();
+  safe_hz = SD_ClockDivToHz(safe_div);
+
+  status = SD_ReadBlocksDirect(sd_calib_backup, ScratchBlock, SD_CALIB_BLOCKS, SD_TIMEOUT_DEFAULT);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  /* 2. 从速度模式允许的最快分频开始逐级降低，直到SD_Init时的时钟 */
+  div = SD_ClockDivForHz((info.BusSpeedMode == SD_BUS_SPEED_HIGH) ? SD_HIGH_SPEED_MAX_HZ : SD_DEFAULT_SPEED_MAX_HZ);
+  if (SD_ClockDivToHz(div) < safe_hz)
+  {
+    div = safe_div;
+  }
+  best = safe_div;
+  for (;;)
+  {
+    pResult->StepsTried++;
+    if (SD_Calib_TestDiv(div, ScratchBlock, pResult) == HAL_OK)
+    {
+      best = div;
+      found = 1U;
+    }
+#ifdef DEBUG
+    printf("[SD] 校准 %lu Hz: %s\r\n", SD_ClockDivToHz(div), (found != 0U) ? "通过" : "失败");
+#endif
+    if ((found != 0U) || (SD_ClockDivToHz(div) <= safe_hz) || (div >= SDMMC_CLKCR_CLKDIV))
+    {
+      break;
+    }
+    div++;
+  }
+
+  /* 3. 有更快的分频失败过才说明碰到了板级极限，此时留出余量，但不低于SD_Init时的时钟；
+   *    第一级就通过时受限的是卡的规范上限，不需要余量 */
+  if (found != 0U)
+  {
+    pResult->MaxStableDiv = best;
+    pResult->MaxStableHz = SD_ClockDivToHz(best);
+    div = best;
+    if (pResult->StepsTried > 1U)
+    {
+      div = SD_ClockDivForHz((pResult->MaxStableHz / 100U) * (100U - SD_CALIB_MARGIN_PERCENT));
+    }
+    if (SD_ClockDivToHz(div) < safe_hz)
+    {
+      div = safe_div;
+    }
+    pResult->ClockDiv = div;
+    pResult->ClockHz = SD_ClockDivToHz(div);
+  }
+  else
+  {
+    pResult->ClockDiv = safe_div;
+    pResult->ClockHz = safe_hz;
+    status = HAL_ERROR;
+  }
+
+  /* 4. 在SD_Init时的时钟下还原暂存区，再切换到选定时钟 */
+  restore = SD_SetClockDiv(safe_div);
+  if (restore == HAL_OK)
+  {
+    restore = SD_WriteBlocksDirect(sd_calib_backup, ScratchBlock, SD_CALIB_BLOCKS, SD_TIMEOUT_DEFAULT);
+  }
+  if (restore == HAL_OK)
+  {
+    restore = SD_WaitReady(SD_TIMEOUT_DEFAULT);
+  }
+  if (restore != HAL_OK)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 校准暂存区还原失败: %d\r\n", restore);
+#endif
+    return restore;
+  }
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  status = SD_SetClockDiv(pResult->ClockDiv);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  pResult->Checksum = SD_Calib_Checksum(pResult);
+#ifdef DEBUG
+  printf("[SD] [PASS] 最高稳定时钟 %lu Hz，选用 %lu Hz（余量%lu%%）\r\n",
+         pResult->MaxStableHz, pResult->ClockHz, (uint32_t)SD_CALIB_MARGIN_PERCENT);
+#endif
+
+  (void)SD_Calib_SaveHook(pResult);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  套用已保存的校准结果
+  * @param  pResult: 校准结果
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Calib_Apply(const SD_CalibResultTypeDef *pResult)
+{
+  SD_CardInfoTypeDef info;
+
+  if ((pResult == NULL) || (pResult->Magic != SD_CALIB_MAGIC) ||
+      (pResult->Checksum != SD_Calib_Checksum(pResult)) || (SD_GetCardInfo(&info) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 内核时钟或速度模式变了，分频的含义也就变了 */
+  if ((pResult->KernelClockHz != SD_ClockDivToHz(0U)) || (pResult->BusSpeedMode != info.BusSpeedMode))
+  {
+    return HAL_ERROR;
+  }
+
+  return SD_SetClockDiv(pResult->ClockDiv);
+}
+
+/**
+  * @brief  读取并套用保存的结果
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Calib_Restore(void)
+{
+  SD_CalibResultTypeDef result;
+
+  if (SD_Calib_LoadHook(&result) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  return SD_Calib_Apply(&result);
+}
+
+/**
+  * @brief  保存校准结果（弱定义）
+  * @param  pResult: 校准结果
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+__weak HAL_StatusTypeDef SD_Calib_SaveHook(const SD_CalibResultTypeDef *pResult)
+{
+  (void)pResult;
+  return HAL_OK;
+}
+
+/**
+  * @brief  读取保存的校准结果（弱定义）
+  * @param  pResult: 输出，校准结果
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+__weak HAL_StatusTypeDef SD_Calib_LoadHook(SD_CalibResultTypeDef *pResult)
+{
+  (void)pResult;
+  return HAL_ERROR;
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_CALIB_ENABLE */
@@ -0,0 +1,958 @@
+/**
+  ******************************************************************************
+  * @file    sd_crc.c
+  * @brief   SD卡CRC32计算与逐块完整性校验实现
+  * @author  STMicroelectronics
+  * @date    2025-11-08
+  * @version 1.0
+  * @note    元数据区第0块是头块（魔数、数据区位置和CRC），之后第k块存放数据块 DataStart + k*128 起128个块的CRC。
+  *          表项0表示未记录；块的CRC恰为0时记为1
+  * @note    写入期间只在已缓存的CRC表行上计算：开始写入前先读入本次写入涉及的行（整行被覆盖时不读），
+  *          IDMA传输期间不能再读写元数据块
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_crc.h"
+
+/* USER CODE BEGIN 0 */
+#include "sd_iovec.h"
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#if (SD_CRC_USE_HW == 0U)
+static uint32_t sd_crc_table[4][256];   /* 4路查表，第一次计算时生成 */
+static uint8_t sd_crc_table_ready;
+#endif
+
+/* USER CODE BEGIN 1 */
+
+#if (SD_CRC_USE_HW == 0U)
+/**
+  * @brief  生成查表：table[0]为逐字节表，table[k][i]为字节i后再经过k个0字节的CRC
+  */
+static void SD_Crc_BuildTable(void)
+{
+  uint32_t i;
+  uint32_t k;
+  uint32_t c;
+
+  for (i = 0U; i < 256U; i++)
+  {
+    c = i;
+    for (k = 0U; k < 8U; k++)
+    {
+      c = ((c & 1U) != 0U) ? ((c >> 1) ^ 0xEDB88320U) : (c >> 1);
+    }
+    sd_crc_table[0][i] = c;
+  }
+  for (i = 0U; i < 256U; i++)
+  {
+    for (k = 1U; k < 4U; k++)
+    {
+      c = sd_crc_table[k - 1U][i];
+      sd_crc_table[k][i] = (c >> 8) ^ sd_crc_table[0][c & 0xFFU];
+    }
+  }
+  sd_crc_table_ready = 1U;
+}
+#endif
+
+/**
+  * @brief  计算CRC32
+  * @param  Crc: 初值，首次为0
+  * @param  pData: 数据
+  * @param  Length: 字节数
+  * @retval uint32_t 累计的CRC
+  */
+uint32_t SD_Crc32(uint32_t Crc, const uint8_t *pData, uint32_t Length)
+{
+#if (SD_CRC_USE_HW != 0U)
+  static uint8_t hw_ready;
+  uint32_t i = 0U;
+
+  if (hw_ready == 0U)
+  {
+    __HAL_RCC_CRC_CLK_ENABLE();
+    CRC->POL = 0x04C11DB7U;
+    hw_ready = 1U;
+  }
+
+  /* 外设按非反射方式计算：初值取反后按位反转，输入按字反转、输出反转即为反射CRC */
+  CRC->INIT = __RBIT(~Crc);
+  CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_IN_1 | CRC_CR_REV_OUT | CRC_CR_RESET;
+  for (; (i + 4U) <= Length; i += 4U)
+  {
+    CRC->DR = (uint32_t)pData[i] | ((uint32_t)pData[i + 1U] << 8) |
+              ((uint32_t)pData[i + 2U] << 16) | ((uint32_t)pData[i + 3U] << 24);
+  }
+  if (i < Length)
+  {
+    CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_OUT;  /* 剩余字节按字节反转，不复位 */
+    for (; i < Length; i++)
+    {
+      *(__IO uint8_t *)&CRC->DR = pData[i];
+    }
+  }
+
+  return ~CRC->DR;
+#else
+  uint32_t c = ~Crc;
+  uint32_t i = 0U;
+
+  if (sd_crc_table_ready == 0U)
+  {
+    SD_Crc_BuildTable();
+  }
+  SD_CRC_COST(Length);
+
+  for (; (i + 4U) <= Length; i += 4U)
+  {
+    c ^= (uint32_t)pData[i] | ((uint32_t)pData[i + 1U] << 8) |
+         ((uint32_t)pData[i + 2U] << 16) | ((uint32_t)pData[i + 3U] << 24);
+    c = sd_crc_table[3][c & 0xFFU] ^ sd_crc_table[2][(c >> 8) & 0xFFU] ^
+        sd_crc_table[1][(c >> 16) & 0xFFU] ^ sd_crc_table[0][c >> 24];
+  }
+  for (; i < Length; i++)
+  {
+    c = (c >> 8) ^ sd_crc_table[0][(c ^ pData[i]) & 0xFFU];
+  }
+
+  return ~c;
+#endif
+}
+
+/* USER CODE END 1 */
+
+#if (SD_CRC_ENABLE != 0U)
+
+/* USER CODE BEGIN 2 */
+
+#define SD_CRC_MAGIC      0x43524353U   /* "SCRC" */
+#define SD_CRC_NO_LINE    0xFFFFFFFFU
+
+/**
+ * @brief 元数据区头块
+ */
+typedef struct {
+  uint32_t Magic;
+  uint32_t DataStart;
+  uint32_t DataBlocks;
+  uint32_t Crc;
+} SD_CrcHeaderTypeDef;
+
+ALIGN_32BYTES(static uint32_t sd_crc_lines[SD_CRC_META_LINES][SD_CRC_PER_BLOCK]) SD_CRC_SECTION;  /* CRC表缓存 */
+static uint32_t sd_crc_tag[SD_CRC_META_LINES];     /* 行对应的CRC表块号，SD_CRC_NO_LINE为空行 */
+static uint32_t sd_crc_age[SD_CRC_META_LINES];     /* 最近使用时刻，LRU替换 */
+static uint8_t  sd_crc_dirty[SD_CRC_META_LINES];
+static uint32_t sd_crc_clock;
+
+static uint32_t sd_crc_start;          /* 数据区起始块 */
+static uint32_t sd_crc_blocks;         /* 数据区块数，0表示未使能 */
+static uint32_t sd_crc_meta;           /* 元数据区起始块 */
+static uint8_t  sd_crc_pipeline = 1U;
+static volatile uint8_t sd_crc_meta_io;  /* 正在读写元数据块：SD_Crc_Poll()不动缓存，SD_Crc_Flush()不重入 */
+
+/* 进行中的前门写入 */
+static const uint8_t *sd_crc_job_data; /* 块sd_crc_job_start的数据 */
+static uint32_t sd_crc_job_start;
+static uint32_t sd_crc_job_next;       /* 下一个要计算的块 */
+static uint32_t sd_crc_job_end;        /* 等于sd_crc_job_next表示没有待计算的块 */
+static uint8_t  sd_crc_job_active;
+
+#if (SD_USE_IDMA != 0U)
+/* 流水读取 */
+static uint8_t *sd_crc_rd_buf;
+static uint32_t sd_crc_rd_chunks;
+static volatile uint32_t sd_crc_rd_landed;   /* 已收到的分片数（中断中递增） */
+static SD_RequestTypeDef sd_crc_rd_req;
+#endif
+
+static SD_CrcStatsTypeDef sd_crc_stats;
+
+/**
+  * @brief  块的CRC表项：以块地址为初值，0留给未记录
+  */
+static uint32_t SD_Crc_Block(const uint8_t *pData, uint32_t BlockAdd)
+{
+  uint32_t c = SD_Crc32(BlockAdd, pData, SD_BLOCK_SIZE);
+
+  return (c == 0U) ? 1U : c;
+}
+
+/**
+  * @brief  查找已缓存的CRC表块
+  * @retval uint32_t 行号，未缓存返回SD_CRC_NO_LINE
+  */
+static uint32_t SD_Crc_Find(uint32_t MetaIdx)
+{
+  uint32_t i;
+
+  for (i = 0U; i < SD_CRC_META_LINES; i++)
+  {
+    if (sd_crc_tag[i] == MetaIdx)
+    {
+      return i;
+    }
+  }
+
+  return SD_CRC_NO_LINE;
+}
+
+/**
+  * @brief  把一行连同表块号与它相邻、也被修改过的行一起写回元数据区（一条多块写命令）
+  * @note   先写回驱动中缓存的数据，保证CRC表不先于数据落盘
+  */
+static HAL_StatusTypeDef SD_Crc_WriteLine(uint32_t Line, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  SD_IoVecTypeDef vec[SD_CRC_META_LINES];
+  uint32_t run[SD_CRC_META_LINES];
+  uint32_t first = sd_crc_tag[Line];
+  uint32_t line;
+  uint32_t n = 0U;
+  uint32_t i;
+
+  while ((first > 0U) && ((line = SD_Crc_Find(first - 1U)) != SD_CRC_NO_LINE) && (sd_crc_dirty[line] != 0U))
+  {
+    first--;
+  }
+  while ((n < SD_CRC_META_LINES) && ((line = SD_Crc_Find(first + n)) != SD_CRC_NO_LINE) && (sd_crc_dirty[line] != 0U))
+  {
+    run[n] = line;
+    vec[n].pBuf = (uint8_t *)sd_crc_lines[line];
+    vec[n].Length = SD_BLOCK_SIZE;
+    n++;
+  }
+
+  sd_crc_meta_io = 1U;
+  status = SD_Flush(Timeout);
+  if (status == HAL_OK)
+  {
+    status = SD_WriteBlocksV(vec, n, sd_crc_meta + 1U + first, Timeout);
+  }
+  sd_crc_meta_io = 0U;
+  if (status == HAL_OK)
+  {
+    for (i = 0U; i < n; i++)
+    {
+      sd_crc_dirty[run[i]] = 0U;
+    }
+    sd_crc_stats.MetaWrites++;
+  }
+
+  return status;
+}
+
+/**
+  * @brief  取得CRC表块所在的行，未缓存时替换最久未用的行
+  * @param  MetaIdx: CRC表块号
+  * @param  Load: 1从卡读入；0整行都将被改写，直接清零
+  * @param  Timeout: 超时时间（毫秒）
+  * @param  pLine: 返回行号
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_Crc_GetLine(uint32_t MetaIdx, uint8_t Load, uint32_t Timeout, uint32_t *pLine)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t line = SD_Crc_Find(MetaIdx);
+  uint32_t i;
+
+  if (line == SD_CRC_NO_LINE)
+  {
+    line = 0U;
+    for (i = 1U; i < SD_CRC_META_LINES; i++)
+    {
+      if ((sd_crc_tag[line] != SD_CRC_NO_LINE) &&
+          ((sd_crc_tag[i] == SD_CRC_NO_LINE) || (sd_crc_age[i] < sd_crc_age[line])))
+      {
+        line = i;
+      }
+    }
+    if (sd_crc_dirty[line] != 0U)
+    {
+      status = SD_Crc_WriteLine(line, Timeout);
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+    }
+
+    sd_crc_tag[line] = SD_CRC_NO_LINE;
+    if (Load != 0U)
+    {
+      sd_crc_meta_io = 1U;
+      status = SD_ReadBlocksDirect((uint8_t *)sd_crc_lines[line], sd_crc_meta + 1U + MetaIdx, 1U, Timeout);
+      sd_crc_meta_io = 0U;
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+      sd_crc_stats.MetaReads++;
+    }
+    else
+    {
+      (void)memset(sd_crc_lines[line], 0, SD_BLOCK_SIZE);
+    }
+    sd_crc_tag[line] = MetaIdx;
+  }
+
+  sd_crc_age[line] = ++sd_crc_clock;
+  *pLine = line;
+
+  return status;
+}
+
+/**
+  * @brief  区间与数据区的交集
+  * @retval uint8_t 1: 非空，交集为[*pFirst, *pEnd)
+  */
+static uint8_t SD_Crc_Clip(uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t *pFirst, uint32_t *pEnd)
+{
+  uint64_t end = (uint64_t)BlockAdd + NumberOfBlocks;
+  uint64_t data_end = (uint64_t)sd_crc_start + sd_crc_blocks;
+
+  if ((sd_crc_blocks == 0U) || (end <= sd_crc_start) || (BlockAdd >= data_end))
+  {
+    return 0U;
+  }
+
+  *pFirst = (BlockAdd > sd_crc_start) ? BlockAdd : sd_crc_start;
+  *pEnd = (uint32_t)((end < data_end) ? end : data_end);
+
+  return 1U;
+}
+
+/**
+  * @brief  [First, End)是否没有完全覆盖CRC表块MetaIdx，需要先读入
+  */
+static uint8_t SD_Crc_NeedLoad(uint32_t MetaIdx, uint32_t First, uint32_t End)
+{
+  uint64_t lo = (uint64_t)sd_crc_start + ((uint64_t)MetaIdx * SD_CRC_PER_BLOCK);
+  uint64_t hi = lo + SD_CRC_PER_BLOCK;
+
+  if (hi > ((uint64_t)sd_crc_start + sd_crc_blocks))
+  {
+    hi = (uint64_t)sd_crc_start + sd_crc_blocks;
+  }
+
+  return ((First <= lo) && (End >= hi)) ? 0U : 1U;
+}
+
+/**
+  * @brief  把[First, End)的表项设为Value（0为未记录）
+  */
+static HAL_StatusTypeDef SD_Crc_Fill(uint32_t First, uint32_t End, uint32_t Value, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t rel;
+  uint32_t line;
+
+  while ((First < End) && (status == HAL_OK))
+  {
+    rel = First - sd_crc_start;
+    status = SD_Crc_GetLine(rel / SD_CRC_PER_BLOCK, SD_Crc_NeedLoad(rel / SD_CRC_PER_BLOCK, First, End), Timeout, &line);
+    if (status == HAL_OK)
+    {
+      do
+      {
+        sd_crc_lines[line][rel % SD_CRC_PER_BLOCK] = Value;
+        First++;
+        rel++;
+      } while ((First < End) && ((rel % SD_CRC_PER_BLOCK) != 0U));
+      sd_crc_dirty[line] = 1U;
+    }
+  }
+
+  return status;
+}
+
+/**
+  * @brief  元数据区头块的CRC
+  */
+static uint32_t SD_Crc_HeaderCrc(const SD_CrcHeaderTypeDef *pHdr)
+{
+  return SD_Crc32(0U, (const uint8_t *)pHdr, (uint32_t)(sizeof(*pHdr) - sizeof(pHdr->Crc)));
+}
+
+/**
+  * @brief  元数据区需要的块数
+  * @param  DataBlocks: 受保护的数据块数
+  * @retval uint32_t 块数
+  */
+uint32_t SD_Crc_MetaBlocks(uint32_t DataBlocks)
+{
+  return 1U + ((DataBlocks + (SD_CRC_PER_BLOCK - 1U)) / SD_CRC_PER_BLOCK);
+}
+
+/**
+  * @brief  开始保护一段数据区
+  * @param  DataStart: 数据区起始块
+  * @param  DataBlocks: 数据区块数
+  * @param  MetaStart: 元数据区起始块
+  * @param  Format: 1清空CRC表 0沿用已有的表
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Crc_Attach(uint32_t DataStart, uint32_t DataBlocks, uint32_t MetaStart, uint8_t Format,
+                                uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  SD_CrcHeaderTypeDef hdr;
+  uint32_t meta_blocks = SD_Crc_MetaBlocks(DataBlocks);
+  uint32_t blk;
+  uint32_t n;
+  uint32_t i;
+
+  if ((DataBlocks == 0U) || (DataBlocks > (0xFFFFFFFFU - DataStart)) || (meta_blocks > (0xFFFFFFFFU - MetaStart)) ||
+      ((DataStart + DataBlocks) > sddev1.hsd->SdCard.LogBlockNbr) ||
+      ((MetaStart + meta_blocks) > sddev1.hsd->SdCard.LogBlockNbr) ||
+      ((MetaStart < (DataStart + DataBlocks)) && (DataStart < (MetaStart + meta_blocks))))
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: CRC保护区 %lu + %lu，元数据区 %lu\r\n", DataStart, DataBlocks, MetaStart);
+#endif
+    return HAL_ERROR;
+  }
+
+  status = SD_Crc_Detach(Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  /* 行缓存兼作格式化和头块的缓冲区 */
+  for (i = 0U; i < SD_CRC_META_LINES; i++)
+  {
+    sd_crc_tag[i] = SD_CRC_NO_LINE;
+    sd_crc_dirty[i] = 0U;
+  }
+  (void)memset(sd_crc_lines, 0, sizeof(sd_crc_lines));
+
+  hdr.Magic = SD_CRC_MAGIC;
+  hdr.DataStart = DataStart;
+  hdr.DataBlocks = DataBlocks;
+  hdr.Crc = SD_Crc_HeaderCrc(&hdr);
+
+  if (Format != 0U)
+  {
+    for (blk = 1U; (blk < meta_blocks) && (status == HAL_OK); blk += n)
+    {
+      n = ((meta_blocks - blk) < SD_CRC_META_LINES) ? (meta_blocks - blk) : SD_CRC_META_LINES;
+      status = SD_WriteBlocksDirect((uint8_t *)sd_crc_lines, MetaStart + blk, n, Timeout);
+    }
+    if (status == HAL_OK)
+    {
+      (void)memcpy(sd_crc_lines[0], &hdr, sizeof(hdr));
+      status = SD_WriteBlocksDirect((uint8_t *)sd_crc_lines[0], MetaStart, 1U, Timeout);
+    }
+  }
+  else
+  {
+    status = SD_ReadBlocksDirect((uint8_t *)sd_crc_lines[0], MetaStart, 1U, Timeout);
+    if ((status == HAL_OK) && (memcmp(sd_crc_lines[0], &hdr, sizeof(hdr)) != 0))
+    {
+#ifdef DEBUG
+      printf("[SD] [FAIL] 元数据区 %lu 不是这段数据区的CRC表\r\n", MetaStart);
+#endif
+      status = HAL_ERROR;
+    }
+  }
+
+  if (status == HAL_OK)
+  {
+    sd_crc_start = DataStart;
+    sd_crc_meta = MetaStart;
+    sd_crc_blocks = DataBlocks;
+  }
+
+  return status;
+}
+
+/**
+  * @brief  写回CRC表并停止保护
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Crc_Detach(uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = SD_Crc_Flush(Timeout);
+
+  if (status == HAL_OK)
+  {
+    sd_crc_blocks = 0U;
+  }
+
+  return status;
+}
+
+/**
+  * @brief  写回CRC表缓存中修改过的行
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Crc_Flush(uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t i;
+
+  /* SD_Crc_WriteLine()先调用SD_Flush()写回数据，此时不重入 */
+  if ((sd_crc_blocks == 0U) || (sd_crc_meta_io != 0U))
+  {
+    return HAL_OK;
+  }
+
+  for (i = 0U; (i < SD_CRC_META_LINES) && (status == HAL_OK); i++)
+  {
+    if (sd_crc_dirty[i] != 0U)
+    {
+      status = SD_Crc_WriteLine(i, Timeout);
+    }
+  }
+
+  return status;
+}
+
+/**
+  * @brief  打开或关闭CRC计算与IDMA传输的重叠
+  * @param  Enable: 1打开 0关闭
+  */
+void SD_Crc_SetPipeline(uint8_t Enable)
+{
+  sd_crc_pipeline = (Enable != 0U) ? 1U : 0U;
+}
+
+/**
+  * @brief  读取完整性校验统计
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Crc_GetStats(SD_CrcStatsTypeDef *pStats)
+{
+  if (pStats != NULL)
+  {
+    *pStats = sd_crc_stats;
+  }
+}
+
+/**
+  * @brief  前门写入开始前登记要计算CRC的块
+  * @param  pData: 写入的数据
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 读入CRC表的超时时间（毫秒）
+  */
+void SD_Crc_BeginWrite(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  uint32_t first;
+  uint32_t end;
+  uint32_t idx;
+  uint32_t last;
+  uint32_t line;
+
+  if ((pData == NULL) || (SD_Crc_Clip(BlockAdd, NumberOfBlocks, &first, &end) == 0U))
+  {
+    return;
+  }
+
+  sd_crc_job_data = &pData[(first - BlockAdd) * SD_BLOCK_SIZE];
+  sd_crc_job_start = first;
+  sd_crc_job_next = first;
+  sd_crc_job_end = first;
+
+  /* 先缓存前几行，传输期间只在这些行上计算 */
+  if (sd_crc_pipeline != 0U)
+  {
+    idx = (first - sd_crc_start) / SD_CRC_PER_BLOCK;
+    last = (end - 1U - sd_crc_start) / SD_CRC_PER_BLOCK;
+    if ((last - idx) >= SD_CRC_META_LINES)
+    {
+      last = idx + SD_CRC_META_LINES - 1U;
+    }
+    for (; idx <= last; idx++)
+    {
+      if (SD_Crc_GetLine(idx, SD_Crc_NeedLoad(idx, first, end), Timeout, &line) != HAL_OK)
+      {
+        break;
+      }
+    }
+  }
+  sd_crc_job_end = end;
+  sd_crc_job_active = 1U;
+}
+
+/**
+  * @brief  计算登记块中的下一个块并记入已缓存的行
+  * @retval uint8_t 1: 算了一个块；0: 没有待计算的块或所在行未缓存
+  */
+static uint8_t SD_Crc_Step(void)
+{
+  uint32_t rel;
+  uint32_t line;
+
+  if ((sd_crc_job_active == 0U) || (sd_crc_job_next >= sd_crc_job_end) || (sd_crc_meta_io != 0U))
+  {
+    return 0U;
+  }
+
+  rel = sd_crc_job_next - sd_crc_start;
+  line = SD_Crc_Find(rel / SD_CRC_PER_BLOCK);
+  if (line == SD_CRC_NO_LINE)
+  {
+    return 0U;
+  }
+
+  sd_crc_lines[line][rel % SD_CRC_PER_BLOCK] =
+      SD_Crc_Block(&sd_crc_job_data[(sd_crc_job_next - sd_crc_job_start) * SD_BLOCK_SIZE], sd_crc_job_next);
+  sd_crc_dirty[line] = 1U;
+  sd_crc_job_next++;
+  sd_crc_stats.BlocksHashed++;
+
+  return 1U;
+}
+
+/**
+  * @brief  等待IDMA传输期间计算一个登记块的CRC
+  */
+void SD_Crc_Poll(void)
+{
+  if ((sd_crc_pipeline != 0U) && (SD_Crc_Step() != 0U))
+  {
+    sd_crc_stats.Overlapped++;
+  }
+}
+
+/**
+  * @brief  前门写入结束后算完剩下的CRC并记入表中
+  * @param  Status: 写入的状态
+  * @param  Timeout: 读写CRC表的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Crc_EndWrite(HAL_StatusTypeDef Status, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t rel;
+  uint32_t line;
+
+  if (sd_crc_job_active == 0U)
+  {
+    return Status;
+  }
+
+  if (Status != HAL_OK)
+  {
+    /* 卡上的内容不确定，不再校验这些块 */
+    sd_crc_job_active = 0U;
+    (void)SD_Crc_Fill(sd_crc_job_start, sd_crc_job_end, 0U, Timeout);
+    return Status;
+  }
+
+  while ((sd_crc_job_next < sd_crc_job_end) && (status == HAL_OK))
+  {
+    if (SD_Crc_Step() == 0U)
+    {
+      rel = sd_crc_job_next - sd_crc_start;
+      status = SD_Crc_GetLine(rel / SD_CRC_PER_BLOCK,
+                              SD_Crc_NeedLoad(rel / SD_CRC_PER_BLOCK, sd_crc_job_next, sd_crc_job_end), Timeout, &line);
+    }
+  }
+  sd_crc_job_active = 0U;
+
+  return status;
+}
+
+/**
+  * @brief  校验一个块
+  * @retval uint8_t 1: 不一致
+  */
+static uint8_t SD_Crc_Check(const uint8_t *pData, uint32_t BlockAdd, uint32_t Expected)
+{
+  if (Expected == 0U)
+  {
+    sd_crc_stats.Unrecorded++;
+    return 0U;
+  }
+  if (SD_Crc_Block(pData, BlockAdd) == Expected)
+  {
+    sd_crc_stats.BlocksVerified++;
+    return 0U;
+  }
+
+  sd_crc_stats.Mismatches++;
+  sd_crc_stats.LastBadBlock = BlockAdd;
+#ifdef DEBUG
+  printf("[SD] [FAIL] 块%lu CRC校验失败\r\n", BlockAdd);
+#endif
+
+  return 1U;
+}
+
+/**
+  * @brief  校验已读出的块
+  * @param  Status: 读取的状态
+  * @param  pData: 读出的数据
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 读入CRC表的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Crc_Verify(HAL_StatusTypeDef Status, const uint8_t *pData, uint32_t BlockAdd,
+                                uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint8_t bad = 0U;
+  uint32_t first;
+  uint32_t end;
+  uint32_t rel;
+  uint32_t line = SD_CRC_NO_LINE;
+
+  if ((Status != HAL_OK) || (SD_Crc_Clip(BlockAdd, NumberOfBlocks, &first, &end) == 0U))
+  {
+    return Status;
+  }
+
+  for (; (first < end) && (status == HAL_OK); first++)
+  {
+    rel = first - sd_crc_start;
+    if ((line == SD_CRC_NO_LINE) || ((rel % SD_CRC_PER_BLOCK) == 0U))
+    {
+      status = SD_Crc_GetLine(rel / SD_CRC_PER_BLOCK, 1U, Timeout, &line);
+    }
+    if (status == HAL_OK)
+    {
+      bad |= SD_Crc_Check(&pData[(first - BlockAdd) * SD_BLOCK_SIZE], first, sd_crc_lines[line][rel % SD_CRC_PER_BLOCK]);
+    }
+  }
+
+  return ((status == HAL_OK) && (bad != 0U)) ? HAL_ERROR : status;
+}
+
+#if (SD_USE_IDMA != 0U)
+/**
+  * @brief  流水读取中缓冲区k收到一个分片（中断上下文）：把它改指向两片之后的位置
+  */
+static void SD_Crc_ReadBufferCallback(SD_RequestTypeDef *pReq, uint32_t BufferIndex)
+{
+  uint32_t next;
+
+  (void)pReq;
+  sd_crc_rd_landed++;
+  next = sd_crc_rd_landed + 1U;
+  if (next < sd_crc_rd_chunks)
+  {
+    (void)SD_ChangeDoubleBuffer(BufferIndex, &sd_crc_rd_buf[next * SD_CRC_CHUNK_BLOCKS * SD_BLOCK_SIZE]);
+  }
+}
+
+/**
+  * @brief  校验一个已收到的分片
+  * @retval uint8_t 不一致的块数
+  */
+static uint8_t SD_Crc_CheckChunk(uint32_t Chunk, uint32_t BlockAdd, uint32_t Line)
+{
+  const uint8_t *p = &sd_crc_rd_buf[Chunk * SD_CRC_CHUNK_BLOCKS * SD_BLOCK_SIZE];
+  uint32_t blk = BlockAdd + (Chunk * SD_CRC_CHUNK_BLOCKS);
+  uint32_t rel = blk - sd_crc_start;
+  uint8_t bad = 0U;
+  uint32_t k;
+
+  /* IDMA写入期间CPU可能推测读取了这片内存 */
+  SD_DCacheInvalidate(p, SD_CRC_CHUNK_BLOCKS * SD_BLOCK_SIZE, 0U);
+  for (k = 0U; k < SD_CRC_CHUNK_BLOCKS; k++)
+  {
+    bad |= SD_Crc_Check(&p[k * SD_BLOCK_SIZE], blk + k, sd_crc_lines[Line][(rel + k) % SD_CRC_PER_BLOCK]);
+  }
+
+  return bad;
+}
+
+/**
+  * @brief  流水读取同一CRC表块内的一段：双缓冲逐片接收，收到的分片就地校验
+  * @param  pData: 数据缓冲区（32字节对齐）
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数，SD_CRC_CHUNK_BLOCKS的整数倍且至少2片
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_Crc_ReadPiece(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t line;
+  uint32_t j = 0U;
+  uint32_t tickstart_local;
+  uint8_t bad = 0U;
+
+  status = SD_Crc_GetLine((BlockAdd - sd_crc_start) / SD_CRC_PER_BLOCK, 1U, Timeout, &line);
+  if (status == HAL_OK)
+  {
+    status = SD_WaitReady(Timeout);
+  }
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  sd_crc_rd_buf = pData;
+  sd_crc_rd_chunks = NumberOfBlocks / SD_CRC_CHUNK_BLOCKS;
+  sd_crc_rd_landed = 0U;
+  SD_DCacheInvalidate(pData, NumberOfBlocks * SD_BLOCK_SIZE, 1U);
+  sd_crc_rd_req.Callback = NULL;
+  sd_crc_rd_req.BufferCallback = SD_Crc_ReadBufferCallback;
+  sd_crc_rd_req.pContext = NULL;
+  status = SD_ReadBlocksDoubleBufferAsync(pData, &pData[SD_CRC_CHUNK_BLOCKS * SD_BLOCK_SIZE], SD_CRC_CHUNK_BLOCKS,
+                                          BlockAdd, NumberOfBlocks, &sd_crc_rd_req);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  /* IDMA接收后面的分片时校验已收到的分片 */
+  tickstart_local = HAL_GetTick();
+  while (sd_crc_rd_req.Done == 0U)
+  {
+    if (j < sd_crc_rd_landed)
+    {
+      bad |= SD_Crc_CheckChunk(j, BlockAdd, line);
+      sd_crc_stats.Overlapped += SD_CRC_CHUNK_BLOCKS;
+      j++;
+    }
+    else if ((HAL_GetTick() - tickstart_local) >= Timeout)
+    {
+      break;
+    }
+  }
+  status = SD_WaitRequest(&sd_crc_rd_req, Timeout);
+
+  for (; (j < sd_crc_rd_chunks) && (status == HAL_OK); j++)
+  {
+    bad |= SD_Crc_CheckChunk(j, BlockAdd, line);
+  }
+
+  return ((status == HAL_OK) && (bad != 0U)) ? HAL_ERROR : status;
+}
+#endif
+
+/**
+  * @brief  直接读卡并校验
+  * @param  pData: 数据缓冲区
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Crc_ReadDirect(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+#if (SD_USE_IDMA != 0U)
+  uint32_t first;
+  uint32_t end;
+  uint32_t n;
+
+  if ((sd_crc_pipeline != 0U) && (pData != NULL) && (NumberOfBlocks >= (2U * SD_CRC_CHUNK_BLOCKS)) &&
+      (SD_Crc_Clip(BlockAdd, NumberOfBlocks, &first, &end) != 0U) &&
+      (first == BlockAdd) && (end == (BlockAdd + NumberOfBlocks)) &&
+      (((uintptr_t)pData & (SD_DCACHE_LINE - 1U)) == 0U) &&
+      (SD_IsDmaReachable(pData, NumberOfBlocks * SD_BLOCK_SIZE) != 0U))
+  {
+    /* 按CRC表块分段，每段只用一行；段内不足2片的部分直接读 */
+    while ((NumberOfBlocks > 0U) && (status == HAL_OK))
+    {
+      n = SD_CRC_PER_BLOCK - ((BlockAdd - sd_crc_start) % SD_CRC_PER_BLOCK);
+      n = (n < NumberOfBlocks) ? n : NumberOfBlocks;
+      if (n >= (2U * SD_CRC_CHUNK_BLOCKS))
+      {
+        n -= n % SD_CRC_CHUNK_BLOCKS;
+        status = SD_Crc_ReadPiece(pData, BlockAdd, n, Timeout);
+      }
+      else
+      {
+        status = SD_Crc_Verify(SD_ReadBlocksDirect(pData, BlockAdd, n, Timeout), pData, BlockAdd, n, Timeout);
+      }
+      pData = &pData[n * SD_BLOCK_SIZE];
+      BlockAdd += n;
+      NumberOfBlocks -= n;
+    }
+
+    return status;
+  }
+#endif
+
+  status = SD_ReadBlocksDirect(pData, BlockAdd, NumberOfBlocks, Timeout);
+
+  return SD_Crc_Verify(status, pData, BlockAdd, NumberOfBlocks, Timeout);
+}
+
+/**
+  * @brief  按已写入卡的数据记下一段块的CRC
+  * @param  pData: 写入的数据
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 读写CRC表的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  * @note   先算出表项再取行：取行时可能写回CRC表，调用者的暂存缓冲区随之被改写
+  */
+HAL_StatusTypeDef SD_Crc_Record(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t first;
+  uint32_t end;
+  uint32_t rel;
+  uint32_t crc;
+  uint32_t line;
+
+  if ((pData == NULL) || (SD_Crc_Clip(BlockAdd, NumberOfBlocks, &first, &end) == 0U))
+  {
+    return HAL_OK;
+  }
+
+  for (; (first < end) && (status == HAL_OK); first++)
+  {
+    rel = first - sd_crc_start;
+    crc = SD_Crc_Block(&pData[(first - BlockAdd) * SD_BLOCK_SIZE], first);
+    status = SD_Crc_GetLine(rel / SD_CRC_PER_BLOCK, SD_Crc_NeedLoad(rel / SD_CRC_PER_BLOCK, first, end), Timeout, &line);
+    if (status == HAL_OK)
+    {
+      sd_crc_lines[line][rel % SD_CRC_PER_BLOCK] = crc;
+      sd_crc_dirty[line] = 1U;
+      sd_crc_stats.BlocksHashed++;
+    }
+  }
+
+  return status;
+}
+
+/**
+  * @brief  把被擦除或丢弃的块改为未记录
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 读写CRC表的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Crc_Forget(uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  uint32_t first;
+  uint32_t end;
+
+  if (SD_Crc_Clip(BlockAdd, NumberOfBlocks, &first, &end) == 0U)
+  {
+    return HAL_OK;
+  }
+
+  return SD_Crc_Fill(first, end, 0U, Timeout);
+}
+
+/* USER CODE END 2 */
+
+#endif /* SD_CRC_ENABLE */
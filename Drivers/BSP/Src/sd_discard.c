@@ -0,0 +1,437 @@
+/**
+  ******************************************************************************
+  * @file    sd_discard.c
+  * @brief   SD卡丢弃（TRIM）区间记录与批量后台擦除实现
+  * @author  STMicroelectronics
+  * @date    2025-11-06
+  * @version 1.0
+  * @note    区间表按起始地址升序排列，区间之间互不重叠也不相邻（插入时合并）。
+  *          SD_Discard_Forget()可能在IDMA完成回调中被调用，修改区间表时关中断，每次只搬移一次数组
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_discard.h"
+
+#if (SD_DISCARD_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#if (SD_CACHE_ENABLE != 0U)
+#include "sd_cache.h"
+#endif
+
+#if (SD_PREFETCH_ENABLE != 0U)
+#include "sd_prefetch.h"
+#endif
+
+#if (SD_QUEUE_ENABLE != 0U)
+#include "sd_queue.h"
+#endif
+
+#if (SD_CRC_ENABLE != 0U)
+#include "sd_crc.h"
+#endif
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#define SD_DISCARD_DEFAULT_ALIGN  8192U   /* AU未知时的对齐单元（4MB） */
+
+/**
+ * @brief 待擦除区间[Start, End)
+ */
+typedef struct {
+    uint32_t Start;
+    uint32_t End;
+} SD_DiscardExtentTypeDef;
+
+static SD_DiscardExtentTypeDef sd_discard_ext[SD_DISCARD_MAX_EXTENTS];
+static volatile uint32_t sd_discard_count;     /* 区间数 */
+static SD_DiscardStatsTypeDef sd_discard_stats;
+static uint32_t sd_discard_align;              /* 对齐单元（块），第一次使用时确定 */
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  删除第Index个区间（关中断调用）
+  */
+static void SD_Discard_RemoveAt(uint32_t Index)
+{
+  (void)memmove(&sd_discard_ext[Index], &sd_discard_ext[Index + 1U],
+                (sd_discard_count - Index - 1U) * sizeof(SD_DiscardExtentTypeDef));
+  sd_discard_count--;
+}
+
+/**
+  * @brief  在第Index个位置插入区间（关中断调用，调用者保证有空位）
+  */
+static void SD_Discard_InsertAt(uint32_t Index, uint32_t Start, uint32_t End)
+{
+  (void)memmove(&sd_discard_ext[Index + 1U], &sd_discard_ext[Index],
+                (sd_discard_count - Index) * sizeof(SD_DiscardExtentTypeDef));
+  sd_discard_ext[Index].Start = Start;
+  sd_discard_ext[Index].End = End;
+  sd_discard_count++;
+}
+
+/**
+  * @brief  插入区间并与重叠、相邻的区间合并（关中断调用）
+  * @retval uint8_t 0: 区间表已满且无法合并
+  */
+static uint8_t SD_Discard_Insert(uint32_t Start, uint32_t End)
+{
+  uint32_t first = 0U;
+  uint32_t last;
+
+  /* 第一个结束地址不小于Start的区间：可能与新区间重叠或相邻 */
+  while ((first < sd_discard_count) && (sd_discard_ext[first].End < Start))
+  {
+    first++;
+  }
+  last = first;
+  while ((last < sd_discard_count) && (sd_discard_ext[last].Start <= End))
+  {
+    last++;
+  }
+
+  if (last == first)
+  {
+    if (sd_discard_count >= SD_DISCARD_MAX_EXTENTS)
+    {
+      return 0U;
+    }
+    SD_Discard_InsertAt(first, Start, End);
+    return 1U;
+  }
+
+  /* [first, last)都与新区间重叠或相邻：合并到first */
+  sd_discard_stats.Merges++;
+  if (sd_discard_ext[first].Start < Start)
+  {
+    Start = sd_discard_ext[first].Start;
+  }
+  if (sd_discard_ext[last - 1U].End > End)
+  {
+    End = sd_discard_ext[last - 1U].End;
+  }
+  sd_discard_ext[first].Start = Start;
+  sd_discard_ext[first].End = End;
+  (void)memmove(&sd_discard_ext[first + 1U], &sd_discard_ext[last],
+                (sd_discard_count - last) * sizeof(SD_DiscardExtentTypeDef));
+  sd_discard_count -= last - first - 1U;
+
+  return 1U;
+}
+
+/**
+  * @brief  从区间表中去掉[Start, End)（关中断调用）
+  * @retval uint32_t 去掉的块数（不含因区间表满而放弃的部分）
+  */
+static uint32_t SD_Discard_Cut(uint32_t Start, uint32_t End)
+{
+  uint32_t removed = 0U;
+  uint32_t i = 0U;
+
+  while (i < sd_discard_count)
+  {
+    SD_DiscardExtentTypeDef *e = &sd_discard_ext[i];
+    uint32_t lo = (e->Start > Start) ? e->Start : Start;
+    uint32_t hi = (e->End < End) ? e->End : End;
+
+    if (e->Start >= End)
+    {
+      break;
+    }
+    if (lo >= hi)
+    {
+      i++;
+      continue;
+    }
+
+    removed += hi - lo;
+    if ((e->Start >= Start) && (e->End <= End))
+    {
+      SD_Discard_RemoveAt(i);
+      continue;
+    }
+    if (e->Start >= Start)
+    {
+      e->Start = End;
+    }
+    else if (e->End <= End)
+    {
+      e->End = Start;
+    }
+    else if (sd_discard_count < SD_DISCARD_MAX_EXTENTS)
+    {
+      /* 从中间去掉：拆成两段 */
+      SD_Discard_InsertAt(i + 1U, End, e->End);
+      sd_discard_ext[i].End = Start;
+    }
+    else
+    {
+      /* 没有空位拆分：保留较长的一段，另一段不再擦除 */
+      if ((Start - e->Start) >= (e->End - End))
+      {
+        sd_discard_stats.Dropped += e->End - End;
+        e->End = Start;
+      }
+      else
+      {
+        sd_discard_stats.Dropped += Start - e->Start;
+        e->Start = End;
+      }
+    }
+    i++;
+  }
+
+  return removed;
+}
+
+/**
+  * @brief  对齐单元：配置值或卡的AU大小
+  */
+static uint32_t SD_Discard_Align(void)
+{
+  SD_CardInfoTypeDef info;
+
+  if (sd_discard_align == 0U)
+  {
+    sd_discard_align = SD_DISCARD_ALIGN_BLOCKS;
+    if ((sd_discard_align == 0U) && (SD_GetCardInfo(&info) == HAL_OK))
+    {
+      sd_discard_align = info.AuBlocks;
+    }
+    if (sd_discard_align == 0U)
+    {
+      sd_discard_align = SD_DISCARD_DEFAULT_ALIGN;
+    }
+  }
+
+  return sd_discard_align;
+}
+
+/**
+  * @brief  擦除[Start, End)：先从区间表去掉再发命令（SD_EraseBlocks()不再把它计为Rewritten），失败时放回区间表
+  */
+static HAL_StatusTypeDef SD_Discard_Erase(uint32_t Start, uint32_t End, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  (void)SD_Discard_Cut(Start, End);
+  __set_PRIMASK(primask);
+
+  status = SD_EraseBlocks(Start, End - Start, Timeout);
+  if (status == HAL_OK)
+  {
+    sd_discard_stats.Erases++;
+    sd_discard_stats.ErasedBlocks += End - Start;
+    return HAL_OK;
+  }
+
+#ifdef DEBUG
+  printf("[SD] [FAIL] 丢弃区间擦除失败: %lu + %lu\r\n", Start, End - Start);
+#endif
+  /* 块内容仍然不需要：放回区间表，之后重试 */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (SD_Discard_Insert(Start, End) == 0U)
+  {
+    sd_discard_stats.Dropped += End - Start;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  丢弃块区间
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 区间表满时立即擦除的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Discard(uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t primask;
+  uint32_t largest;
+  uint32_t i;
+  uint8_t ok;
+
+  if ((NumberOfBlocks == 0U) || (BlockAdd > (0xFFFFFFFFU - NumberOfBlocks)) ||
+      ((BlockAdd + NumberOfBlocks) > sddev1.hsd->SdCard.LogBlockNbr))
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: 丢弃区间 %lu + %lu\r\n", BlockAdd, NumberOfBlocks);
+#endif
+    return HAL_ERROR;
+  }
+
+  /* 这些块的内容不再需要：驱动中缓存的副本直接作废，不写回 */
+#if (SD_CACHE_ENABLE != 0U)
+  SD_Cache_Invalidate(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_QUEUE_ENABLE != 0U)
+  SD_Queue_Discard(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_PREFETCH_ENABLE != 0U)
+  SD_Prefetch_Quiesce(Timeout);
+  SD_Prefetch_Invalidate(BlockAdd, NumberOfBlocks);
+#endif
+#if (SD_CRC_ENABLE != 0U)
+  (void)SD_Crc_Forget(BlockAdd, NumberOfBlocks, Timeout);
+#endif
+
+  sd_discard_stats.Discards++;
+  sd_discard_stats.DiscardBlocks += NumberOfBlocks;
+  for (;;)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    ok = SD_Discard_Insert(BlockAdd, BlockAdd + NumberOfBlocks);
+    __set_PRIMASK(primask);
+    if ((ok != 0U) || (status != HAL_OK))
+    {
+      break;
+    }
+
+    /* 区间表满：立即擦除最长的区间腾出位置 */
+    largest = 0U;
+    for (i = 1U; i < sd_discard_count; i++)
+    {
+      if ((sd_discard_ext[i].End - sd_discard_ext[i].Start) >
+          (sd_discard_ext[largest].End - sd_discard_ext[largest].Start))
+      {
+        largest = i;
+      }
+    }
+    sd_discard_stats.Forced++;
+    status = SD_Discard_Erase(sd_discard_ext[largest].Start, sd_discard_ext[largest].End, Timeout);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  空闲时擦除一段对齐的待擦除区间
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval uint8_t 1: 发出了擦除命令
+  */
+uint8_t SD_Discard_Idle(uint32_t Timeout)
+{
+  uint32_t align;
+  uint32_t best_start = 0U;
+  uint32_t best_end = 0U;
+  uint32_t start;
+  uint32_t end;
+  uint32_t i;
+
+  if ((sd_discard_count == 0U) || (SD_Check() != HAL_OK))
+  {
+    return 0U;
+  }
+
+  /* 取对齐部分最长的区间；不满一个单元的零头留待合并或SD_Discard_Flush() */
+  align = SD_Discard_Align();
+  for (i = 0U; i < sd_discard_count; i++)
+  {
+    start = ((sd_discard_ext[i].Start + align - 1U) / align) * align;
+    end = (sd_discard_ext[i].End / align) * align;
+    if ((end > start) && ((end - start) > (best_end - best_start)))
+    {
+      best_start = start;
+      best_end = end;
+    }
+  }
+  if (best_end == 0U)
+  {
+    return 0U;
+  }
+
+  (void)SD_Discard_Erase(best_start, best_end, Timeout);
+  return 1U;
+}
+
+/**
+  * @brief  立即擦除全部待擦除区间
+  * @param  Timeout: 每条擦除命令的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Discard_Flush(uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+
+  while ((sd_discard_count != 0U) && (status == HAL_OK))
+  {
+    sd_discard_stats.Forced++;
+    status = SD_Discard_Erase(sd_discard_ext[0].Start, sd_discard_ext[0].End, Timeout);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  从区间表中去掉将被写入或已擦除的块
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  */
+void SD_Discard_Forget(uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+  uint32_t primask;
+
+  if ((sd_discard_count == 0U) || (NumberOfBlocks == 0U))
+  {
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  sd_discard_stats.Rewritten += SD_Discard_Cut(BlockAdd, BlockAdd + NumberOfBlocks);
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  读取丢弃统计
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Discard_GetStats(SD_DiscardStatsTypeDef *pStats)
+{
+  uint32_t primask;
+  uint32_t i;
+
+  if (pStats == NULL)
+  {
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *pStats = sd_discard_stats;
+  pStats->Extents = sd_discard_count;
+  pStats->PendingBlocks = 0U;
+  for (i = 0U; i < sd_discard_count; i++)
+  {
+    pStats->PendingBlocks += sd_discard_ext[i].End - sd_discard_ext[i].Start;
+  }
+  __set_PRIMASK(primask);
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_DISCARD_ENABLE */
@@ -0,0 +1,347 @@
+/**
+  ******************************************************************************
+  * @file    sd_diskio.c
+  * @brief   FatFs底层接口（diskio）实现
+  * @author  STMicroelectronics
+  * @date    2025-11-05
+  * @version 1.0
+  * @note    扇区即512字节块，扇区号直接作为块地址；卡容量和AU大小在初始化时读出
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd.h"
+
+/* 未使能时不包含FatFs头文件，没有FatFs的工程也能编译本文件 */
+#if (SD_DISKIO_ENABLE != 0U)
+#include "sd_diskio.h"
+
+/* USER CODE BEGIN 0 */
+#if (SD_SCHED_ENABLE != 0U)
+#include "sd_sched.h"
+#include <string.h>
+#endif
+
+#if (SD_DISCARD_ENABLE != 0U)
+#include "sd_discard.h"
+#endif
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#if (FF_MIN_SS != 512) || (FF_MAX_SS != 512)
+  #error "sd_diskio requires FF_MIN_SS == FF_MAX_SS == 512"
+#endif
+
+#define SD_DISKIO_OP_READ   0U
+#define SD_DISKIO_OP_WRITE  1U
+#define SD_DISKIO_OP_ERASE  2U
+#define SD_DISKIO_OP_SYNC   3U
+
+static volatile DSTATUS sd_diskio_stat = STA_NOINIT;
+static uint32_t sd_diskio_blocks;       /* 卡的块数 */
+static uint32_t sd_diskio_au_blocks;    /* AU块数，0表示未知 */
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  HAL状态转换为DRESULT
+  */
+static DRESULT SD_DiskIo_Result(HAL_StatusTypeDef Status)
+{
+  if (Status == HAL_OK)
+  {
+    return RES_OK;
+  }
+
+  return (Status == HAL_TIMEOUT) ? RES_NOTRDY : RES_ERROR;
+}
+
+/**
+  * @brief  检查驱动器号、初始化状态和扇区范围
+  * @retval DRESULT RES_OK: 可以访问
+  */
+static DRESULT SD_DiskIo_Check(BYTE pdrv, LBA_t sector, uint32_t count)
+{
+  if ((pdrv != SD_DISKIO_PDRV) || (count == 0U))
+  {
+    return RES_PARERR;
+  }
+  if ((sd_diskio_stat & STA_NOINIT) != 0U)
+  {
+    return RES_NOTRDY;
+  }
+  if ((sector >= sd_diskio_blocks) || ((uint64_t)sector + count > sd_diskio_blocks))
+  {
+    return RES_PARERR;
+  }
+
+  return RES_OK;
+}
+
+/**
+  * @brief  执行一次访问：使能调度器时提交并等待，否则直接调用驱动
+  * @param  Op: SD_DISKIO_OP_xxx
+  * @param  pData: 数据缓冲区，擦除/同步时为NULL
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_DiskIo_Do(uint8_t Op, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+  HAL_StatusTypeDef status;
+#if (SD_SCHED_ENABLE != 0U)
+  static const uint8_t sched_op[4] = {
+#if (SD_DISCARD_ENABLE != 0U)
+    SD_SCHED_OP_READ, SD_SCHED_OP_WRITE, SD_SCHED_OP_DISCARD, SD_SCHED_OP_FLUSH
+#else
+    SD_SCHED_OP_READ, SD_SCHED_OP_WRITE, SD_SCHED_OP_ERASE, SD_SCHED_OP_FLUSH
+#endif
+  };
+  SD_SchedReqTypeDef req;
+
+  (void)memset(&req, 0, sizeof(req));
+  req.Op = sched_op[Op];
+  req.Priority = SD_DISKIO_PRIORITY;
+  req.pData = pData;
+  req.BlockAdd = BlockAdd;
+  req.NumberOfBlocks = NumberOfBlocks;
+  req.Timeout = SD_DISKIO_TIMEOUT;
+  status = SD_Sched_Submit(&req);
+  if (status == HAL_OK)
+  {
+    status = SD_Sched_Wait(&req, SD_DISKIO_TIMEOUT);
+  }
+#else
+  switch (Op)
+  {
+    case SD_DISKIO_OP_READ:
+      status = SD_ReadBlocks(pData, BlockAdd, NumberOfBlocks, SD_DISKIO_TIMEOUT);
+      break;
+    case SD_DISKIO_OP_WRITE:
+      status = SD_WriteBlocks(pData, BlockAdd, NumberOfBlocks, SD_DISKIO_TIMEOUT);
+      break;
+    case SD_DISKIO_OP_ERASE:
+#if (SD_DISCARD_ENABLE != 0U)
+      status = SD_Discard(BlockAdd, NumberOfBlocks, SD_DISKIO_TIMEOUT);
+#else
+      status = SD_EraseBlocks(BlockAdd, NumberOfBlocks, SD_DISKIO_TIMEOUT);
+#endif
+      break;
+    default:
+      /* 写回驱动中的数据，并等卡把最后一次写入编程完 */
+      status = SD_Flush(SD_DISKIO_TIMEOUT);
+      if (status == HAL_OK)
+      {
+        status = SD_WaitReady(SD_DISKIO_TIMEOUT);
+      }
+      break;
+  }
+#endif
+
+  return status;
+}
+
+/**
+  * @brief  初始化（disk_initialize）
+  * @param  pdrv: 物理驱动器号
+  * @retval DSTATUS 驱动器状态
+  */
+DSTATUS SD_DiskIo_Initialize(BYTE pdrv)
+{
+  SD_CardInfoTypeDef info;
+
+  if (pdrv != SD_DISKIO_PDRV)
+  {
+    return STA_NOINIT;
+  }
+
+  if ((sd_diskio_stat & STA_NOINIT) != 0U)
+  {
+    if ((SD_Init() == HAL_OK) && (SD_GetCardInfo(&info) == HAL_OK))
+    {
+      sd_diskio_blocks = info.LogBlockNbr;
+      sd_diskio_au_blocks = info.AuBlocks;
+      sd_diskio_stat &= (DSTATUS)~STA_NOINIT;
+    }
+#ifdef DEBUG
+    else
+    {
+      printf("[SD] [FAIL] diskio初始化失败\r\n");
+    }
+#endif
+  }
+
+  return sd_diskio_stat;
+}
+
+/**
+  * @brief  驱动器状态（disk_status）
+  * @param  pdrv: 物理驱动器号
+  * @retval DSTATUS 驱动器状态
+  */
+DSTATUS SD_DiskIo_Status(BYTE pdrv)
+{
+  return (pdrv == SD_DISKIO_PDRV) ? sd_diskio_stat : STA_NOINIT;
+}
+
+/**
+  * @brief  读扇区（disk_read）
+  * @param  pdrv: 物理驱动器号
+  * @param  buff: 数据缓冲区
+  * @param  sector: 起始扇区
+  * @param  count: 扇区数
+  * @retval DRESULT 返回操作结果
+  */
+DRESULT SD_DiskIo_Read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count)
+{
+  DRESULT res = SD_DiskIo_Check(pdrv, sector, count);
+
+  if (res == RES_OK)
+  {
+    res = SD_DiskIo_Result(SD_DiskIo_Do(SD_DISKIO_OP_READ, buff, (uint32_t)sector, count));
+  }
+
+  return res;
+}
+
+/**
+  * @brief  写扇区（disk_write）
+  * @param  pdrv: 物理驱动器号
+  * @param  buff: 数据缓冲区
+  * @param  sector: 起始扇区
+  * @param  count: 扇区数
+  * @retval DRESULT 返回操作结果
+  * @note   驱动写入时只读取缓冲区，去掉const不会改写FatFs的数据
+  */
+DRESULT SD_DiskIo_Write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
+{
+  DRESULT res = SD_DiskIo_Check(pdrv, sector, count);
+
+  if (res == RES_OK)
+  {
+    res = SD_DiskIo_Result(SD_DiskIo_Do(SD_DISKIO_OP_WRITE, (uint8_t *)(uintptr_t)buff, (uint32_t)sector, count));
+  }
+
+  return res;
+}
+
+/**
+  * @brief  控制命令（disk_ioctl）
+  * @param  pdrv: 物理驱动器号
+  * @param  cmd: 命令
+  * @param  buff: 命令参数
+  * @retval DRESULT 返回操作结果
+  */
+DRESULT SD_DiskIo_Ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+  DRESULT res;
+
+  if (pdrv != SD_DISKIO_PDRV)
+  {
+    return RES_PARERR;
+  }
+  if ((sd_diskio_stat & STA_NOINIT) != 0U)
+  {
+    return RES_NOTRDY;
+  }
+
+  switch (cmd)
+  {
+    case CTRL_SYNC:
+      res = SD_DiskIo_Result(SD_DiskIo_Do(SD_DISKIO_OP_SYNC, NULL, 0U, 0U));
+      break;
+
+    case GET_SECTOR_COUNT:
+      *(LBA_t *)buff = (LBA_t)sd_diskio_blocks;
+      res = RES_OK;
+      break;
+
+    case GET_SECTOR_SIZE:
+      *(WORD *)buff = (WORD)SD_BLOCK_SIZE;
+      res = RES_OK;
+      break;
+
+    case GET_BLOCK_SIZE:
+      *(DWORD *)buff = (sd_diskio_au_blocks != 0U) ? (DWORD)sd_diskio_au_blocks : 1U;
+      res = RES_OK;
+      break;
+
+#if (FF_USE_TRIM != 0)
+    case CTRL_TRIM:
+    {
+      /* buff为{起始扇区, 结束扇区}，含结束扇区 */
+      const LBA_t *range = (const LBA_t *)buff;
+
+      res = (range[1] >= range[0]) ? SD_DiskIo_Check(pdrv, range[0], (uint32_t)(range[1] - range[0] + 1U)) : RES_PARERR;
+      if (res == RES_OK)
+      {
+        res = SD_DiskIo_Result(SD_DiskIo_Do(SD_DISKIO_OP_ERASE, NULL, (uint32_t)range[0],
+                                            (uint32_t)(range[1] - range[0] + 1U)));
+      }
+      break;
+    }
+#endif
+
+    default:
+      res = RES_PARERR;
+      break;
+  }
+
+  return res;
+}
+
+#if (SD_DISKIO_GLUE != 0U)
+DSTATUS disk_initialize(BYTE pdrv)
+{
+  return SD_DiskIo_Initialize(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+  return SD_DiskIo_Status(pdrv);
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count)
+{
+  return SD_DiskIo_Read(pdrv, buff, sector, count);
+}
+
+#if (FF_FS_READONLY == 0)
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count)
+{
+  return SD_DiskIo_Write(pdrv, buff, sector, count);
+}
+#endif
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+  return SD_DiskIo_Ioctl(pdrv, cmd, buff);
+}
+
+#if (FF_FS_READONLY == 0) && (FF_FS_NORTC == 0)
+/**
+  * @brief  FatFs时间戳（弱定义）：有RTC时重新实现
+  * @retval DWORD 固定为2025-01-01 00:00:00
+  */
+__weak DWORD get_fattime(void)
+{
+  return ((DWORD)(2025U - 1980U) << 25) | ((DWORD)1U << 21) | ((DWORD)1U << 16);
+}
+#endif
+#endif /* SD_DISKIO_GLUE */
+
+/* USER CODE END 1 */
+
+#endif /* SD_DISKIO_ENABLE */
@@ -0,0 +1,617 @@
+/**
+  ******************************************************************************
+  * @file    sd_iovec.c
+  * @brief   SD卡分散/聚集（iovec）读写实现
+  * @author  STMicroelectronics
+  * @date    2025-11-03
+  * @version 1.0
+  * @note    分片k固定交给缓冲区k & 1，与IDMA在IDMABASE0/IDMABASE1之间的切换顺序一致；
+  *          缓冲区k传完的中断里先处理它刚传完的分片（读取时作废D-Cache、暂存槽的数据分散到各段），
+  *          再把它改指向分片k + 2。暂存槽k只给缓冲区k用，IDMA正在传输的那个槽不会被改写
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_iovec.h"
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#if (SD_CACHE_ENABLE != 0U)
+#include "sd_cache.h"
+#endif
+#if (SD_QUEUE_ENABLE != 0U)
+#include "sd_queue.h"
+#endif
+#if (SD_PREFETCH_ENABLE != 0U)
+#include "sd_prefetch.h"
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+#include "sd_discard.h"
+#endif
+#if (SD_CRC_ENABLE != 0U)
+#include "sd_crc.h"
+#endif
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#define SD_IOVEC_POST_NONE    0U   /* 分片传完后无需处理（写入） */
+#define SD_IOVEC_POST_DIRECT  1U   /* 直接读入段中：作废D-Cache */
+#define SD_IOVEC_POST_STAGED  2U   /* 读入暂存槽：作废D-Cache后分散到各段 */
+
+/**
+ * @brief 段数组中的位置
+ */
+typedef struct {
+  const SD_IoVecTypeDef *pVec;
+  uint32_t Count;
+  uint32_t Seg;                    /* 当前段，等于Count表示已到末尾 */
+  uint32_t Offset;                 /* 段内偏移，总小于当前段长度 */
+} SD_IoVecCursorTypeDef;
+
+#if (SD_USE_IDMA != 0U)
+/**
+ * @brief 进行中的分片链传输
+ */
+typedef struct {
+  SD_IoVecCursorTypeDef Cur;       /* 下一个分片的起点 */
+  SD_IoVecCursorTypeDef From[2];   /* 缓冲区k上暂存分片在段数组中的起点 */
+  uint8_t  *pChunk[2];             /* 缓冲区k上的分片 */
+  uint8_t   Post[2];               /* 缓冲区k上的分片传完后的处理：SD_IOVEC_POST_xxx */
+  uint32_t  ChunkBytes;            /* 分片字节数 */
+  uint32_t  Next;                  /* 下一个要交给IDMA的分片号 */
+  uint32_t  Total;                 /* 分片总数 */
+  uint8_t   IsRead;
+  uint8_t   Staging;               /* 1: 单块分片，逐块判断能否直接传输 */
+  SD_RequestTypeDef Req;           /* 内部IDMA请求 */
+} SD_IoVecXferTypeDef;
+
+static SD_IoVecXferTypeDef sd_iovec;
+#endif
+ALIGN_32BYTES(static uint8_t sd_iovec_stage[2][SD_BLOCK_SIZE]) SD_BOUNCE_SECTION;  /* 暂存槽，槽k对应缓冲区k */
+#if (SD_CRC_ENABLE != 0U)
+static uint8_t sd_iovec_crc_block[SD_BLOCK_SIZE];  /* 计算CRC时聚集跨段的块；写回CRC表会再进入本模块，不能用暂存槽 */
+#endif
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  跳过长度为0的段
+  * @param  pCur: 游标
+  */
+static void SD_IoVec_Skip(SD_IoVecCursorTypeDef *pCur)
+{
+  while ((pCur->Seg < pCur->Count) && (pCur->Offset == pCur->pVec[pCur->Seg].Length))
+  {
+    pCur->Seg++;
+    pCur->Offset = 0U;
+  }
+}
+
+/**
+  * @brief  在段数组与连续缓冲区之间复制，并推进游标
+  * @param  pCur: 游标
+  * @param  pBuf: 连续缓冲区，NULL时只推进游标
+  * @param  Length: 字节数（不超过剩余长度）
+  * @param  ToVec: 1: 从pBuf分散到各段；0: 从各段聚集到pBuf
+  */
+static void SD_IoVec_Copy(SD_IoVecCursorTypeDef *pCur, uint8_t *pBuf, uint32_t Length, uint8_t ToVec)
+{
+  const SD_IoVecTypeDef *seg;
+  uint32_t n;
+
+  while (Length != 0U)
+  {
+    seg = &pCur->pVec[pCur->Seg];
+    n = seg->Length - pCur->Offset;
+    if (n > Length)
+    {
+      n = Length;
+    }
+
+    if (pBuf != NULL)
+    {
+      if (ToVec != 0U)
+      {
+        (void)memcpy(&seg->pBuf[pCur->Offset], pBuf, n);
+      }
+      else
+      {
+        (void)memcpy(pBuf, &seg->pBuf[pCur->Offset], n);
+      }
+      pBuf += n;
+    }
+
+    pCur->Offset += n;
+    Length -= n;
+    SD_IoVec_Skip(pCur);
+  }
+}
+
+/**
+  * @brief  检查段数组并选择分片大小
+  * @param  pVec: 段数组
+  * @param  VecCount: 段数
+  * @param  pBlocks: 输出总块数
+  * @param  pChunkBlocks: 输出分片块数，0表示不能整段零复制（按单块分片、经暂存槽）
+  * @param  pSegments: 输出非空段数
+  * @retval HAL_StatusTypeDef 参数非法返回HAL_ERROR
+  */
+static HAL_StatusTypeDef SD_IoVec_Check(const SD_IoVecTypeDef *pVec, uint32_t VecCount,
+                                        uint32_t *pBlocks, uint32_t *pChunkBlocks, uint32_t *pSegments)
+{
+  uint64_t bytes = 0U;
+  uint32_t gcd = 0U;
+  uint32_t a;
+  uint32_t b;
+  uint32_t t;
+  uint32_t i;
+  uint8_t chain = 1U;
+
+  if ((pVec == NULL) || (VecCount == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  *pSegments = 0U;
+  for (i = 0U; i < VecCount; i++)
+  {
+    if (pVec[i].Length == 0U)
+    {
+      continue;
+    }
+    if (pVec[i].pBuf == NULL)
+    {
+      return HAL_ERROR;
+    }
+
+    bytes += pVec[i].Length;
+    (*pSegments)++;
+    if (((pVec[i].Length % SD_BLOCK_SIZE) != 0U) || (((uintptr_t)pVec[i].pBuf & (SD_DCACHE_LINE - 1U)) != 0U) ||
+        (SD_IsDmaReachable(pVec[i].pBuf, pVec[i].Length) == 0U))
+    {
+      chain = 0U;
+      continue;
+    }
+
+    /* 各段块数的最大公约数 */
+    a = gcd;
+    b = pVec[i].Length / SD_BLOCK_SIZE;
+    while (b != 0U)
+    {
+      t = a % b;
+      a = b;
+      b = t;
+    }
+    gcd = a;
+  }
+
+  if ((bytes == 0U) || ((bytes % SD_BLOCK_SIZE) != 0U) || ((bytes / SD_BLOCK_SIZE) > SD_DOUBLEBUF_MAX_BLOCKS))
+  {
+    return HAL_ERROR;
+  }
+  *pBlocks = (uint32_t)(bytes / SD_BLOCK_SIZE);
+
+  /* 受IDMABSIZE限制时取不超过上限的最大约数 */
+  if (chain != 0U)
+  {
+    a = (gcd < SD_IOVEC_MAX_CHUNK_BLOCKS) ? gcd : SD_IOVEC_MAX_CHUNK_BLOCKS;
+    while ((gcd % a) != 0U)
+    {
+      a--;
+    }
+    *pChunkBlocks = a;
+  }
+  else
+  {
+    *pChunkBlocks = 0U;
+  }
+
+  return HAL_OK;
+}
+
+#if (SD_USE_IDMA != 0U)
+/**
+  * @brief  准备下一个分片并交给缓冲区k（线程或中断上下文）
+  * @param  k: 缓冲区号
+  * @retval uint8_t* 分片地址
+  */
+static uint8_t *SD_IoVec_NextChunk(uint32_t k)
+{
+  SD_IoVecXferTypeDef *x = &sd_iovec;
+  const SD_IoVecTypeDef *seg = &x->Cur.pVec[x->Cur.Seg];
+  uint8_t *p = &seg->pBuf[x->Cur.Offset];
+
+  if ((x->Staging == 0U) ||
+      (((seg->Length - x->Cur.Offset) >= SD_BLOCK_SIZE) && (((uintptr_t)p & (SD_DCACHE_LINE - 1U)) == 0U) &&
+       (SD_IsDmaReachable(p, SD_BLOCK_SIZE) != 0U)))
+  {
+    /* 分片整个落在一段内：直接传输 */
+    SD_IoVec_Copy(&x->Cur, NULL, x->ChunkBytes, 0U);
+    x->Post[k] = (x->IsRead != 0U) ? SD_IOVEC_POST_DIRECT : SD_IOVEC_POST_NONE;
+  }
+  else
+  {
+    /* 跨段或对齐不满足：写入时先聚集到暂存槽，读取时传完再分散 */
+    x->From[k] = x->Cur;
+    p = sd_iovec_stage[k];
+    SD_IoVec_Copy(&x->Cur, (x->IsRead != 0U) ? NULL : p, SD_BLOCK_SIZE, 0U);
+    x->Post[k] = (x->IsRead != 0U) ? SD_IOVEC_POST_STAGED : SD_IOVEC_POST_NONE;
+  }
+
+  if (x->IsRead != 0U)
+  {
+    SD_DCacheInvalidate(p, x->ChunkBytes, 1U);
+  }
+  else
+  {
+    SD_DCacheClean(p, x->ChunkBytes);
+  }
+  x->pChunk[k] = p;
+  x->Next++;
+
+  return p;
+}
+
+/**
+  * @brief  缓冲区k上的分片传完后的处理
+  * @param  k: 缓冲区号
+  */
+static void SD_IoVec_Finish(uint32_t k)
+{
+  SD_IoVecXferTypeDef *x = &sd_iovec;
+
+  if (x->Post[k] == SD_IOVEC_POST_NONE)
+  {
+    return;
+  }
+
+  /* IDMA写入期间CPU可能推测读取了这些行 */
+  SD_DCacheInvalidate(x->pChunk[k], x->ChunkBytes, 0U);
+  if (x->Post[k] == SD_IOVEC_POST_STAGED)
+  {
+    SD_IoVec_Copy(&x->From[k], sd_iovec_stage[k], SD_BLOCK_SIZE, 1U);
+  }
+  x->Post[k] = SD_IOVEC_POST_NONE;
+}
+
+/**
+  * @brief  缓冲区传完（中断上下文）：收尾刚传完的分片，把缓冲区改指向下一个分片
+  * @param  pReq: 内部IDMA请求
+  * @param  BufferIndex: 刚传完的缓冲区
+  */
+static void SD_IoVec_BufferCplt(SD_RequestTypeDef *pReq, uint32_t BufferIndex)
+{
+  SD_IoVec_Finish(BufferIndex);
+
+  if (sd_iovec.Next < sd_iovec.Total)
+  {
+    if (SD_ChangeDoubleBuffer(BufferIndex, SD_IoVec_NextChunk(BufferIndex)) != HAL_OK)
+    {
+      (void)SD_AbortRequest(pReq, HAL_ERROR);
+    }
+  }
+}
+
+/**
+  * @brief  一次CMD25/CMD18传完全部分片
+  * @param  pVec: 段数组
+  * @param  VecCount: 段数
+  * @param  BlockAdd: 起始块地址
+  * @param  Blocks: 总块数
+  * @param  ChunkBlocks: 分片块数，0表示按单块分片、经暂存槽
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_IoVec_Chain(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd,
+                                        uint32_t Blocks, uint32_t ChunkBlocks, uint8_t IsRead, uint32_t Timeout)
+{
+  SD_IoVecXferTypeDef *x = &sd_iovec;
+  HAL_StatusTypeDef status;
+  uint8_t *p0;
+  uint8_t *p1;
+
+#if (SD_PREFETCH_ENABLE != 0U)
+  SD_Prefetch_Quiesce(Timeout);
+#endif
+
+  status = SD_WaitReady(Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  (void)memset(x, 0, sizeof(*x));
+  x->Cur.pVec = pVec;
+  x->Cur.Count = VecCount;
+  SD_IoVec_Skip(&x->Cur);
+  x->Staging = (ChunkBlocks == 0U) ? 1U : 0U;
+  ChunkBlocks = (ChunkBlocks == 0U) ? 1U : ChunkBlocks;
+  x->ChunkBytes = ChunkBlocks * SD_BLOCK_SIZE;
+  x->Total = Blocks / ChunkBlocks;
+  x->IsRead = IsRead;
+  x->Req.BufferCallback = SD_IoVec_BufferCplt;
+  x->Req.pContext = x;
+
+  p0 = SD_IoVec_NextChunk(0U);
+  p1 = SD_IoVec_NextChunk(1U);
+  status = (IsRead != 0U) ?
+           SD_ReadBlocksDoubleBufferAsync(p0, p1, ChunkBlocks, BlockAdd, Blocks, &x->Req) :
+           SD_WriteBlocksDoubleBufferAsync(p0, p1, ChunkBlocks, BlockAdd, Blocks, &x->Req);
+  if (status == HAL_OK)
+  {
+    status = SD_WaitRequest(&x->Req, Timeout);
+  }
+
+  /* 最后两个分片不一定各有一次切换中断 */
+  SD_IoVec_Finish(0U);
+  SD_IoVec_Finish(1U);
+
+  return status;
+}
+#endif /* SD_USE_IDMA */
+
+/**
+  * @brief  按段拆成多次普通多块传输，跨段的块经暂存槽
+  * @param  pVec: 段数组
+  * @param  VecCount: 段数
+  * @param  BlockAdd: 起始块地址
+  * @param  Blocks: 总块数
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 每次传输的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_IoVec_Split(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd,
+                                        uint32_t Blocks, uint8_t IsRead, uint32_t Timeout)
+{
+  SD_IoVecCursorTypeDef cur = {pVec, VecCount, 0U, 0U};
+  HAL_StatusTypeDef status = HAL_OK;
+  uint8_t *p;
+  uint32_t n;
+
+  SD_IoVec_Skip(&cur);
+  while (Blocks != 0U)
+  {
+    n = (pVec[cur.Seg].Length - cur.Offset) / SD_BLOCK_SIZE;
+    if (n != 0U)
+    {
+      /* 本段内的整块：对齐与D-Cache由SD_xxxBlocksDirect()处理 */
+      p = &pVec[cur.Seg].pBuf[cur.Offset];
+      status = (IsRead != 0U) ? SD_ReadBlocksDirect(p, BlockAdd, n, Timeout) :
+                                SD_WriteBlocksDirect(p, BlockAdd, n, Timeout);
+      SD_IoVec_Copy(&cur, NULL, n * SD_BLOCK_SIZE, 0U);
+    }
+    else
+    {
+      n = 1U;
+      if (IsRead != 0U)
+      {
+        status = SD_ReadBlocksDirect(sd_iovec_stage[0], BlockAdd, 1U, Timeout);
+        SD_IoVec_Copy(&cur, (status == HAL_OK) ? sd_iovec_stage[0] : NULL, SD_BLOCK_SIZE, 1U);
+      }
+      else
+      {
+        SD_IoVec_Copy(&cur, sd_iovec_stage[0], SD_BLOCK_SIZE, 0U);
+        status = SD_WriteBlocksDirect(sd_iovec_stage[0], BlockAdd, 1U, Timeout);
+      }
+    }
+
+    if (status != HAL_OK)
+    {
+      break;
+    }
+    BlockAdd += n;
+    Blocks -= n;
+  }
+
+  return status;
+}
+
+/**
+  * @brief  传输前与前门各层保持一致：写入时作废区间内缓存的旧数据，读取时先写回未写卡的数据
+  * @param  BlockAdd: 起始块地址
+  * @param  Blocks: 块数
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_IoVec_Prepare(uint32_t BlockAdd, uint32_t Blocks, uint8_t IsRead, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+
+  if (IsRead != 0U)
+  {
+#if (SD_CACHE_ENABLE != 0U)
+    status = SD_Cache_Flush(Timeout);
+#endif
+#if (SD_QUEUE_ENABLE != 0U)
+    if (status == HAL_OK)
+    {
+      status = SD_Queue_Sync(Timeout);
+    }
+#endif
+  }
+  else
+  {
+#if (SD_CACHE_ENABLE != 0U)
+    SD_Cache_Invalidate(BlockAdd, Blocks);
+#endif
+#if (SD_QUEUE_ENABLE != 0U)
+    SD_Queue_Discard(BlockAdd, Blocks);
+#endif
+#if (SD_PREFETCH_ENABLE != 0U)
+    SD_Prefetch_Quiesce(Timeout);
+    SD_Prefetch_Invalidate(BlockAdd, Blocks);
+#endif
+#if (SD_DISCARD_ENABLE != 0U)
+    SD_Discard_Forget(BlockAdd, Blocks);
+#endif
+#if (SD_CRC_ENABLE != 0U)
+    /* 写入失败时卡上的内容不确定，不再校验这些块 */
+    status = SD_Crc_Forget(BlockAdd, Blocks, Timeout);
+#endif
+  }
+  (void)BlockAdd;
+  (void)Blocks;
+  (void)Timeout;
+
+  return status;
+}
+
+#if (SD_CRC_ENABLE != 0U)
+/**
+  * @brief  传输完成后写入时记下各块的CRC，读取时校验：段内的整块成段处理，跨段的块先聚集
+  * @param  pVec: 段数组
+  * @param  VecCount: 段数
+  * @param  BlockAdd: 起始块地址
+  * @param  Blocks: 总块数
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 读写CRC表的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 读取时CRC不一致返回HAL_ERROR
+  */
+static HAL_StatusTypeDef SD_IoVec_Crc(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd,
+                                      uint32_t Blocks, uint8_t IsRead, uint32_t Timeout)
+{
+  SD_IoVecCursorTypeDef cur = {pVec, VecCount, 0U, 0U};
+  HAL_StatusTypeDef status = HAL_OK;
+  HAL_StatusTypeDef result;
+  const uint8_t *p;
+  uint32_t n;
+
+  SD_IoVec_Skip(&cur);
+  while (Blocks != 0U)
+  {
+    n = (pVec[cur.Seg].Length - cur.Offset) / SD_BLOCK_SIZE;
+    if (n != 0U)
+    {
+      p = &pVec[cur.Seg].pBuf[cur.Offset];
+      SD_IoVec_Copy(&cur, NULL, n * SD_BLOCK_SIZE, 0U);
+    }
+    else
+    {
+      n = 1U;
+      p = sd_iovec_crc_block;
+      SD_IoVec_Copy(&cur, sd_iovec_crc_block, SD_BLOCK_SIZE, 0U);
+    }
+
+    /* 读取时校验完所有块，不一致的都计入统计 */
+    result = (IsRead != 0U) ? SD_Crc_Verify(HAL_OK, p, BlockAdd, n, Timeout) :
+                              SD_Crc_Record(p, BlockAdd, n, Timeout);
+    if (status == HAL_OK)
+    {
+      status = result;
+    }
+    if ((result != HAL_OK) && (IsRead == 0U))
+    {
+      break;
+    }
+    BlockAdd += n;
+    Blocks -= n;
+  }
+
+  return status;
+}
+#endif /* SD_CRC_ENABLE */
+
+/**
+  * @brief  分散/聚集传输
+  * @param  pVec: 段数组
+  * @param  VecCount: 段数
+  * @param  BlockAdd: 起始块地址
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_IoVec_Xfer(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd,
+                                       uint8_t IsRead, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t blocks;
+  uint32_t chunk;
+  uint32_t segments;
+
+  status = SD_IoVec_Check(pVec, VecCount, &blocks, &chunk, &segments);
+  if (status != HAL_OK)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 参数错误: 段数组为空或总长度不是整块\r\n");
+#endif
+    return status;
+  }
+
+  status = SD_IoVec_Prepare(BlockAdd, blocks, IsRead, Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+#if (SD_USE_IDMA != 0U)
+  /* 双缓冲至少两个分片 */
+  if ((segments > 1U) && ((blocks / ((chunk != 0U) ? chunk : 1U)) >= 2U))
+  {
+    status = SD_IoVec_Chain(pVec, VecCount, BlockAdd, blocks, chunk, IsRead, Timeout);
+#ifdef DEBUG
+    if (status != HAL_OK)
+    {
+      printf("[SD] [FAIL] 分散/聚集%s失败，状态: %d\r\n", (IsRead != 0U) ? "读取" : "写入", status);
+    }
+#endif
+  }
+  else
+#else
+  (void)segments;
+#endif
+  {
+    status = SD_IoVec_Split(pVec, VecCount, BlockAdd, blocks, IsRead, Timeout);
+  }
+
+#if (SD_CRC_ENABLE != 0U)
+  if (status == HAL_OK)
+  {
+    status = SD_IoVec_Crc(pVec, VecCount, BlockAdd, blocks, IsRead, Timeout);
+  }
+#endif
+
+  return status;
+}
+
+/**
+  * @brief  把各段依次拼接后写入连续的块区间
+  * @param  pVec: 段数组
+  * @param  VecCount: 段数
+  * @param  BlockAdd: 起始块地址
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_WriteBlocksV(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd, uint32_t Timeout)
+{
+  return SD_IoVec_Xfer(pVec, VecCount, BlockAdd, 0U, Timeout);
+}
+
+/**
+  * @brief  读取连续的块区间，依次分散到各段
+  * @param  pVec: 段数组
+  * @param  VecCount: 段数
+  * @param  BlockAdd: 起始块地址
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_ReadBlocksV(const SD_IoVecTypeDef *pVec, uint32_t VecCount, uint32_t BlockAdd, uint32_t Timeout)
+{
+  return SD_IoVec_Xfer(pVec, VecCount, BlockAdd, 1U, Timeout);
+}
+
+/* USER CODE END 1 */
@@ -0,0 +1,661 @@
+/**
+  ******************************************************************************
+  * @file    sd_log.c
+  * @brief   SD卡掉电安全的日志结构追加存储实现
+  * @author  STMicroelectronics
+  * @date    2025-11-07
+  * @version 1.0
+  * @note    段按序号循环使用：第一圈段0..k的序号依次加1，之后的段无效；绕回后最新的段之后是上一圈的旧段，
+  *          序号比按位置推算的小SegCount。因此“段头有效且序号等于段0序号加段号”对段号单调（先真后假），
+  *          可二分查找最新的段。段0正在被覆盖时掉电（段0无效）改用段1作参照
+  * @note    批头 + 记录：每条记录前是2字节小端长度；批头的数据CRC覆盖批头之后的全部记录字节，
+  *          批头CRC覆盖批头其余字段。CRC32为IEEE 802.3（反射多项式0xEDB88320）
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_log.h"
+
+#if (SD_LOG_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include "sd_crc.h"
+#include <stddef.h>
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#define SD_LOG_MAGIC          0x474F4C53U   /* "SLOG"：批头 */
+#define SD_LOG_SB_MAGIC       0x42534C53U   /* "SLSB"：超级块 */
+#define SD_LOG_VERSION        1U
+#define SD_LOG_DEFAULT_SEG    8192U         /* AU未知时的段块数（4MB） */
+
+/**
+ * @brief 批头（段内第一批的批头即段头），位于每批第一个块的开头
+ */
+typedef struct {
+    uint32_t Magic;        /* SD_LOG_MAGIC */
+    uint32_t LogId;        /* 格式化编号 */
+    uint32_t SegSeq;       /* 段序号 */
+    uint32_t Offset;       /* 本批在段内的块偏移 */
+    uint32_t Blocks;       /* 本批块数 */
+    uint32_t Bytes;        /* 批头之后的记录字节数 */
+    uint32_t Records;      /* 记录数 */
+    uint32_t FirstRecord;  /* 第一条记录的序号 */
+    uint32_t DataCrc;      /* 记录字节的CRC32 */
+    uint32_t HeaderCrc;    /* 以上字段的CRC32 */
+} SD_LogHeaderTypeDef;
+
+/**
+ * @brief 超级块，位于区域第一段的第一个块
+ */
+typedef struct {
+    uint32_t Magic;        /* SD_LOG_SB_MAGIC */
+    uint32_t Version;
+    uint32_t LogId;
+    uint32_t SegBlocks;
+    uint32_t SegCount;
+    uint32_t UnitBlocks;
+    uint32_t Crc;          /* 以上字段的CRC32 */
+} SD_LogSuperTypeDef;
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  向上对齐
+  */
+static uint32_t SD_Log_AlignUp(uint32_t Value, uint32_t Unit)
+{
+  uint32_t rem = Value % Unit;
+
+  return (rem == 0U) ? Value : (Value + (Unit - rem));
+}
+
+/**
+  * @brief  段的起始块
+  */
+static uint32_t SD_Log_SegBase(const SD_LogTypeDef *pLog, uint32_t Seg)
+{
+  return pLog->BaseBlock + (Seg * pLog->SegBlocks);
+}
+
+/**
+  * @brief  按卡的AU和缓冲区大小计算区域布局
+  * @retval HAL_StatusTypeDef 区域放不下超级块段和2个段时返回HAL_ERROR
+  */
+static HAL_StatusTypeDef SD_Log_Layout(SD_LogTypeDef *pLog, uint8_t *pBuf, uint32_t BufBlocks,
+                                       uint32_t RegionStart, uint32_t RegionBlocks)
+{
+  SD_CardInfoTypeDef info;
+  uint32_t seg;
+  uint32_t unit;
+  uint32_t start;
+  uint32_t end;
+
+  if ((pLog == NULL) || (pBuf == NULL) || (BufBlocks < SD_LOG_RU_BLOCKS) || (SD_GetCardInfo(&info) != HAL_OK) ||
+      (RegionStart >= info.LogBlockNbr) || (RegionBlocks > (info.LogBlockNbr - RegionStart)))
+  {
+    return HAL_ERROR;
+  }
+
+  seg = SD_LOG_SEG_BLOCKS;
+  if (seg == 0U)
+  {
+    seg = (info.AuBlocks != 0U) ? info.AuBlocks : SD_LOG_DEFAULT_SEG;
+  }
+  if ((seg % SD_LOG_RU_BLOCKS) != 0U)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 日志段%lu块不是RU的整数倍\r\n", seg);
+#endif
+    return HAL_ERROR;
+  }
+
+  /* 满批取RU的整数倍且整除段，满批不会跨段 */
+  unit = BufBlocks - (BufBlocks % SD_LOG_RU_BLOCKS);
+  while ((seg % unit) != 0U)
+  {
+    unit -= SD_LOG_RU_BLOCKS;
+  }
+
+  end = RegionStart + RegionBlocks;
+  start = SD_Log_AlignUp(RegionStart, seg);
+  if ((start >= end) || (((end - start) / seg) < 3U))
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 日志区域过小: %lu块\r\n", RegionBlocks);
+#endif
+    return HAL_ERROR;
+  }
+
+  (void)memset(pLog, 0, sizeof(*pLog));
+  pLog->pBuf = pBuf;
+  pLog->UnitBlocks = unit;
+  pLog->SegBlocks = seg;
+  pLog->SegCount = ((end - start) / seg) - 1U;
+  pLog->BaseBlock = start + seg;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  在当前位置开始一个空批
+  */
+static void SD_Log_StartBatch(SD_LogTypeDef *pLog)
+{
+  uint32_t left = pLog->SegBlocks - pLog->Offset;
+
+  pLog->BatchBlocks = (left < pLog->UnitBlocks) ? left : pLog->UnitBlocks;
+  pLog->Fill = SD_LOG_HEADER_SIZE;
+  pLog->Records = 0U;
+}
+
+/**
+  * @brief  转到下一段；覆盖到最旧的段时最旧的段后移
+  */
+static void SD_Log_Advance(SD_LogTypeDef *pLog)
+{
+  pLog->Seg = (pLog->Seg + 1U) % pLog->SegCount;
+  pLog->SegSeq++;
+  pLog->Offset = 0U;
+  if (pLog->Seg == pLog->Tail)
+  {
+    pLog->Tail = (pLog->Tail + 1U) % pLog->SegCount;
+  }
+}
+
+/**
+  * @brief  读出并检查批头
+  * @param  pLog: 日志对象
+  * @param  Seg: 段号
+  * @param  Offset: 段内块偏移
+  * @param  pHdr: 输出批头
+  * @param  pValid: 输出，1表示批头有效（魔数、格式化编号、批头CRC、位置和长度都对）
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 读卡状态
+  */
+static HAL_StatusTypeDef SD_Log_Probe(SD_LogTypeDef *pLog, uint32_t Seg, uint32_t Offset,
+                                      SD_LogHeaderTypeDef *pHdr, uint8_t *pValid, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+  *pValid = 0U;
+  status = SD_ReadBlocks(pLog->pBuf, SD_Log_SegBase(pLog, Seg) + Offset, 1U, Timeout);
+  pLog->RecoverReads++;
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  (void)memcpy(pHdr, pLog->pBuf, sizeof(*pHdr));
+  if ((pHdr->Magic == SD_LOG_MAGIC) && (pHdr->LogId == pLog->LogId) && (pHdr->Offset == Offset) &&
+      (pHdr->HeaderCrc == SD_Crc32(0U, (const uint8_t *)pHdr, offsetof(SD_LogHeaderTypeDef, HeaderCrc))) &&
+      (pHdr->Blocks != 0U) && (pHdr->Blocks <= pLog->UnitBlocks) && (pHdr->Blocks <= (pLog->SegBlocks - Offset)) &&
+      (pHdr->Bytes <= ((pHdr->Blocks * SD_BLOCK_SIZE) - SD_LOG_HEADER_SIZE)))
+  {
+    *pValid = 1U;
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  检查已读入缓冲区的整批数据CRC
+  */
+static uint8_t SD_Log_DataOk(const uint8_t *pBuf, const SD_LogHeaderTypeDef *pHdr)
+{
+  return (SD_Crc32(0U, &pBuf[SD_LOG_HEADER_SIZE], pHdr->Bytes) == pHdr->DataCrc) ? 1U : 0U;
+}
+
+/**
+  * @brief  把当前批的前Blocks块写卡，然后开始下一批
+  * @param  pLog: 日志对象
+  * @param  Blocks: 写卡块数，不超过BatchBlocks
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_Log_WriteBatch(SD_LogTypeDef *pLog, uint32_t Blocks, uint32_t Timeout)
+{
+  SD_LogHeaderTypeDef hdr;
+  HAL_StatusTypeDef status;
+
+  hdr.Magic = SD_LOG_MAGIC;
+  hdr.LogId = pLog->LogId;
+  hdr.SegSeq = pLog->SegSeq;
+  hdr.Offset = pLog->Offset;
+  hdr.Blocks = Blocks;
+  hdr.Bytes = pLog->Fill - SD_LOG_HEADER_SIZE;
+  hdr.Records = pLog->Records;
+  hdr.FirstRecord = pLog->NextRecord - pLog->Records;
+  hdr.DataCrc = SD_Crc32(0U, &pLog->pBuf[SD_LOG_HEADER_SIZE], hdr.Bytes);
+  hdr.HeaderCrc = SD_Crc32(0U, (const uint8_t *)&hdr, offsetof(SD_LogHeaderTypeDef, HeaderCrc));
+  (void)memcpy(pLog->pBuf, &hdr, sizeof(hdr));
+  (void)memset(&pLog->pBuf[pLog->Fill], SD_LOG_PAD_BYTE, (Blocks * SD_BLOCK_SIZE) - pLog->Fill);
+
+  status = SD_WriteBlocks(pLog->pBuf, SD_Log_SegBase(pLog, pLog->Seg) + pLog->Offset, Blocks, Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  pLog->Batches++;
+  pLog->PadBlocks += Blocks - ((pLog->Fill + (SD_BLOCK_SIZE - 1U)) / SD_BLOCK_SIZE);
+  pLog->Offset += Blocks;
+  if (pLog->Offset == pLog->SegBlocks)
+  {
+    SD_Log_Advance(pLog);
+  }
+  SD_Log_StartBatch(pLog);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  格式化区域并打开一个空日志
+  * @param  pLog: 日志对象
+  * @param  pBuf: 批缓冲区
+  * @param  BufBlocks: 缓冲区块数
+  * @param  RegionStart: 区域起始块
+  * @param  RegionBlocks: 区域块数
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Log_Format(SD_LogTypeDef *pLog, uint8_t *pBuf, uint32_t BufBlocks,
+                                uint32_t RegionStart, uint32_t RegionBlocks, uint32_t Timeout)
+{
+  SD_LogSuperTypeDef sb;
+  HAL_StatusTypeDef status;
+  uint32_t id = 0U;
+
+  status = SD_Log_Layout(pLog, pBuf, BufBlocks, RegionStart, RegionBlocks);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  /* 沿用旧超级块的编号加1，上一次格式化写下的段头全部作废 */
+  status = SD_ReadBlocks(pBuf, pLog->BaseBlock - pLog->SegBlocks, 1U, Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+  (void)memcpy(&sb, pBuf, sizeof(sb));
+  if ((sb.Magic == SD_LOG_SB_MAGIC) && (sb.Crc == SD_Crc32(0U, (const uint8_t *)&sb, offsetof(SD_LogSuperTypeDef, Crc))))
+  {
+    id = sb.LogId;
+  }
+
+  sb.Magic = SD_LOG_SB_MAGIC;
+  sb.Version = SD_LOG_VERSION;
+  sb.LogId = id + 1U;
+  sb.SegBlocks = pLog->SegBlocks;
+  sb.SegCount = pLog->SegCount;
+  sb.UnitBlocks = pLog->UnitBlocks;
+  sb.Crc = SD_Crc32(0U, (const uint8_t *)&sb, offsetof(SD_LogSuperTypeDef, Crc));
+  (void)memset(pBuf, 0, SD_BLOCK_SIZE);
+  (void)memcpy(pBuf, &sb, sizeof(sb));
+  status = SD_WriteBlocks(pBuf, pLog->BaseBlock - pLog->SegBlocks, 1U, Timeout);
+  if (status == HAL_OK)
+  {
+    status = SD_Flush(Timeout);
+  }
+  if (status == HAL_OK)
+  {
+    status = SD_WaitReady(Timeout);
+  }
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  pLog->LogId = sb.LogId;
+  pLog->SegSeq = 1U;
+  SD_Log_StartBatch(pLog);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  打开已格式化的区域，恢复写入位置
+  * @param  pLog: 日志对象
+  * @param  pBuf: 批缓冲区
+  * @param  BufBlocks: 缓冲区块数
+  * @param  RegionStart: 区域起始块
+  * @param  RegionBlocks: 区域块数
+  * @param  Timeout: 每次读卡的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Log_Open(SD_LogTypeDef *pLog, uint8_t *pBuf, uint32_t BufBlocks,
+                              uint32_t RegionStart, uint32_t RegionBlocks, uint32_t Timeout)
+{
+  SD_LogSuperTypeDef sb;
+  SD_LogHeaderTypeDef hdr;
+  SD_LogHeaderTypeDef last;
+  HAL_StatusTypeDef status;
+  uint32_t ref;
+  uint32_t ref_seq;
+  uint32_t lo;
+  uint32_t hi;
+  uint32_t mid;
+  uint32_t off;
+  uint8_t valid;
+
+  status = SD_Log_Layout(pLog, pBuf, BufBlocks, RegionStart, RegionBlocks);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  status = SD_ReadBlocks(pBuf, pLog->BaseBlock - pLog->SegBlocks, 1U, Timeout);
+  pLog->RecoverReads++;
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+  (void)memcpy(&sb, pBuf, sizeof(sb));
+  if ((sb.Magic != SD_LOG_SB_MAGIC) || (sb.Version != SD_LOG_VERSION) ||
+      (sb.Crc != SD_Crc32(0U, (const uint8_t *)&sb, offsetof(SD_LogSuperTypeDef, Crc))) ||
+      (sb.SegBlocks != pLog->SegBlocks) || (sb.SegCount != pLog->SegCount) || (sb.UnitBlocks > BufBlocks))
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 日志区域未格式化或布局不一致\r\n");
+#endif
+    return HAL_ERROR;
+  }
+  pLog->LogId = sb.LogId;
+  pLog->UnitBlocks = sb.UnitBlocks;
+  pLog->SegSeq = 1U;
+
+  /* 参照段：段0；段0正在被覆盖时掉电则用段1；两者都无效说明日志为空 */
+  ref = 0U;
+  status = SD_Log_Probe(pLog, 0U, 0U, &hdr, &valid, Timeout);
+  if ((status == HAL_OK) && (valid == 0U))
+  {
+    ref = 1U;
+    status = SD_Log_Probe(pLog, 1U, 0U, &hdr, &valid, Timeout);
+  }
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+  if (valid == 0U)
+  {
+    SD_Log_StartBatch(pLog);
+    return HAL_OK;
+  }
+  ref_seq = hdr.SegSeq;
+  last = hdr;
+
+  /* 二分查找最后一个“段头有效且序号连续”的段 */
+  lo = ref;
+  hi = pLog->SegCount - 1U;
+  while (lo < hi)
+  {
+    mid = lo + ((hi - lo + 1U) / 2U);
+    status = SD_Log_Probe(pLog, mid, 0U, &hdr, &valid, Timeout);
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+    if ((valid != 0U) && (hdr.SegSeq == (ref_seq + (mid - ref))))
+    {
+      lo = mid;
+      last = hdr;
+    }
+    else
+    {
+      hi = mid - 1U;
+    }
+  }
+  pLog->Seg = lo;
+  pLog->SegSeq = last.SegSeq;
+
+  /* 最旧的段：已绕回时是最新段的下一段，否则是参照段 */
+  pLog->Tail = ref;
+  mid = (lo + 1U) % pLog->SegCount;
+  if (mid != ref)
+  {
+    status = SD_Log_Probe(pLog, mid, 0U, &hdr, &valid, Timeout);
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+    if ((valid != 0U) && ((hdr.SegSeq + pLog->SegCount - 1U) == last.SegSeq))
+    {
+      pLog->Tail = mid;
+    }
+  }
+
+  /* 沿批头链找到段内最后一批 */
+  off = 0U;
+  while ((off + last.Blocks) < pLog->SegBlocks)
+  {
+    status = SD_Log_Probe(pLog, pLog->Seg, off + last.Blocks, &hdr, &valid, Timeout);
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+    if ((valid == 0U) || (hdr.SegSeq != last.SegSeq))
+    {
+      break;
+    }
+    off += last.Blocks;
+    last = hdr;
+  }
+
+  /* 只有最后一批可能写了一半：数据CRC不对就丢弃，从它的位置重写 */
+  status = SD_ReadBlocks(pBuf, SD_Log_SegBase(pLog, pLog->Seg) + off, last.Blocks, Timeout);
+  pLog->RecoverReads += last.Blocks;
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+  if (SD_Log_DataOk(pBuf, &last) != 0U)
+  {
+    pLog->Offset = off + last.Blocks;
+    pLog->NextRecord = last.FirstRecord + last.Records;
+  }
+  else
+  {
+    pLog->Offset = off;
+    pLog->NextRecord = last.FirstRecord;
+  }
+  if (pLog->Offset == pLog->SegBlocks)
+  {
+    SD_Log_Advance(pLog);
+  }
+  SD_Log_StartBatch(pLog);
+
+#ifdef DEBUG
+  printf("[SD] 日志恢复: 段%lu/%lu 偏移%lu块, 下一条记录%lu, 读卡%lu块\r\n", pLog->Seg, pLog->SegCount,
+         pLog->Offset, pLog->NextRecord, pLog->RecoverReads);
+#endif
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  追加一条记录
+  * @param  pLog: 日志对象
+  * @param  pData: 记录内容
+  * @param  Length: 字节数
+  * @param  Timeout: 写卡超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Log_Append(SD_LogTypeDef *pLog, const uint8_t *pData, uint32_t Length, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t need = SD_LOG_RECORD_HEADER + Length;
+
+  if ((pLog == NULL) || (pLog->pBuf == NULL) || (pData == NULL) || (Length == 0U) || (Length > 0xFFFFU) ||
+      (need > ((pLog->UnitBlocks * SD_BLOCK_SIZE) - SD_LOG_HEADER_SIZE)))
+  {
+    return HAL_ERROR;
+  }
+
+  while ((pLog->Fill + need) > (pLog->BatchBlocks * SD_BLOCK_SIZE))
+  {
+    if (pLog->Records != 0U)
+    {
+      status = SD_Log_WriteBatch(pLog, pLog->BatchBlocks, Timeout);
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+    }
+    else
+    {
+      /* 同步后段尾剩下的块放不下这条记录：留空，转到下一段 */
+      pLog->PadBlocks += pLog->SegBlocks - pLog->Offset;
+      SD_Log_Advance(pLog);
+      SD_Log_StartBatch(pLog);
+    }
+  }
+
+  pLog->pBuf[pLog->Fill] = (uint8_t)Length;
+  pLog->pBuf[pLog->Fill + 1U] = (uint8_t)(Length >> 8);
+  (void)memcpy(&pLog->pBuf[pLog->Fill + SD_LOG_RECORD_HEADER], pData, Length);
+  pLog->Fill += need;
+  pLog->Records++;
+  pLog->NextRecord++;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  把当前批补齐到RU边界后写卡，并等卡编程完成
+  * @param  pLog: 日志对象
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Log_Sync(SD_LogTypeDef *pLog, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t blocks;
+
+  if ((pLog == NULL) || (pLog->pBuf == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  if (pLog->Records != 0U)
+  {
+    blocks = SD_Log_AlignUp((pLog->Fill + (SD_BLOCK_SIZE - 1U)) / SD_BLOCK_SIZE, SD_LOG_RU_BLOCKS);
+    status = SD_Log_WriteBatch(pLog, blocks, Timeout);
+  }
+  if (status == HAL_OK)
+  {
+    status = SD_Flush(Timeout);
+  }
+  if (status == HAL_OK)
+  {
+    status = SD_WaitReady(Timeout);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  从最旧的记录起按顺序读出已写卡的全部记录
+  * @param  pLog: 日志对象
+  * @param  pBuf: 读缓冲区
+  * @param  Callback: 每条记录调用一次
+  * @param  pContext: 传给回调的参数
+  * @param  Timeout: 每次读卡的超时时间（毫秒）
+  * @retval uint32_t 读出的记录数
+  */
+uint32_t SD_Log_Walk(const SD_LogTypeDef *pLog, uint8_t *pBuf, SD_LogCallbackTypeDef Callback, void *pContext,
+                     uint32_t Timeout)
+{
+  SD_LogHeaderTypeDef hdr;
+  uint32_t count = 0U;
+  uint32_t seg;
+  uint32_t seq;
+  uint32_t off;
+  uint32_t end;
+  uint32_t pos;
+  uint32_t len;
+  uint32_t n;
+  uint32_t r;
+
+  if ((pLog == NULL) || (pBuf == NULL) || (pBuf == pLog->pBuf) || (Callback == NULL) || (pLog->SegCount == 0U))
+  {
+    return 0U;
+  }
+
+  seg = pLog->Tail;
+  seq = pLog->SegSeq - ((pLog->Seg + pLog->SegCount - pLog->Tail) % pLog->SegCount);
+  for (;;)
+  {
+    /* 当前段只读到批缓冲区对应的位置 */
+    end = (seg == pLog->Seg) ? pLog->Offset : pLog->SegBlocks;
+    off = 0U;
+    while (off < end)
+    {
+      n = end - off;
+      if (n > pLog->UnitBlocks)
+      {
+        n = pLog->UnitBlocks;
+      }
+      if (SD_ReadBlocks(pBuf, SD_Log_SegBase(pLog, seg) + off, n, Timeout) != HAL_OK)
+      {
+        return count;
+      }
+      (void)memcpy(&hdr, pBuf, sizeof(hdr));
+      if ((hdr.Magic != SD_LOG_MAGIC) || (hdr.LogId != pLog->LogId) || (hdr.SegSeq != seq) || (hdr.Offset != off) ||
+          (hdr.HeaderCrc != SD_Crc32(0U, (const uint8_t *)&hdr, offsetof(SD_LogHeaderTypeDef, HeaderCrc))) ||
+          (hdr.Blocks == 0U) || (hdr.Blocks > n) || (hdr.Bytes > ((hdr.Blocks * SD_BLOCK_SIZE) - SD_LOG_HEADER_SIZE)))
+      {
+        break;
+      }
+      if (SD_Log_DataOk(pBuf, &hdr) != 0U)
+      {
+        pos = SD_LOG_HEADER_SIZE;
+        for (r = 0U; r < hdr.Records; r++)
+        {
+          len = (uint32_t)pBuf[pos] | ((uint32_t)pBuf[pos + 1U] << 8);
+          pos += SD_LOG_RECORD_HEADER;
+          if ((pos + len) > (SD_LOG_HEADER_SIZE + hdr.Bytes))
+          {
+            break;
+          }
+          Callback(hdr.FirstRecord + r, &pBuf[pos], len, pContext);
+          pos += len;
+          count++;
+        }
+      }
+#ifdef DEBUG
+      else
+      {
+        printf("[SD] [FAIL] 日志批数据CRC错误: 段%lu 偏移%lu\r\n", seg, off);
+      }
+#endif
+      off += hdr.Blocks;
+    }
+
+    if (seg == pLog->Seg)
+    {
+      break;
+    }
+    seg = (seg + 1U) % pLog->SegCount;
+    seq++;
+  }
+
+  return count;
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_LOG_ENABLE */
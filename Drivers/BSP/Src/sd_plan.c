@@ -0,0 +1,260 @@
+/**
+  ******************************************************************************
+  * @file    sd_plan.c
+  * @brief   SD卡AU对齐写入规划实现
+  * @author  STMicroelectronics
+  * @date    2025-10-30
+  * @version 1.0
+  * @note    单元块数取RU的整数倍且整除AU，区域起点对齐到AU后，每个单元都不会跨越AU边界
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_plan.h"
+
+#if (SD_PLAN_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  向上对齐
+  * @param  BlockAdd: 块地址
+  * @param  Unit: 对齐单位（块）
+  * @retval uint32_t 不小于BlockAdd的最小Unit整数倍
+  */
+static uint32_t SD_Plan_AlignUp(uint32_t BlockAdd, uint32_t Unit)
+{
+  uint32_t rem = BlockAdd % Unit;
+
+  return (rem == 0U) ? BlockAdd : (BlockAdd + (Unit - rem));
+}
+
+/**
+  * @brief  从NextBlock到下一个单元边界（按区域起点计）的字节数
+  * @param  pPlan: 规划对象
+  * @retval uint32_t 字节数；SD_Plan_Sync()只补齐到RU，之后的一次写卡比单元短，单元仍不跨AU
+  */
+static uint32_t SD_Plan_Room(const SD_PlanTypeDef *pPlan)
+{
+  uint32_t used = (pPlan->NextBlock - pPlan->StartBlock) % pPlan->UnitBlocks;
+
+  return (pPlan->UnitBlocks - used) * SD_BLOCK_SIZE;
+}
+
+/**
+  * @brief  把缓冲区的前Blocks块写到NextBlock
+  * @param  pPlan: 规划对象
+  * @param  Blocks: 块数
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_Plan_Flush(SD_PlanTypeDef *pPlan, uint32_t Blocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+  if ((pPlan->EndBlock - pPlan->NextBlock) < Blocks)
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 写入规划区域已满: %lu\r\n", pPlan->EndBlock);
+#endif
+    return HAL_ERROR;
+  }
+
+  status = SD_WriteBlocks(pPlan->pBuf, pPlan->NextBlock, Blocks, Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  pPlan->NextBlock += Blocks;
+  pPlan->Fill = 0U;
+  pPlan->Units++;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  在区域内打开一个写入规划
+  * @param  pPlan: 规划对象
+  * @param  pBuf: 单元缓冲区
+  * @param  BufBlocks: 缓冲区块数
+  * @param  RegionStart: 区域起始块
+  * @param  RegionBlocks: 区域块数
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Plan_Open(SD_PlanTypeDef *pPlan, uint8_t *pBuf, uint32_t BufBlocks,
+                               uint32_t RegionStart, uint32_t RegionBlocks)
+{
+  SD_CardInfoTypeDef info;
+  uint32_t unit;
+  uint32_t au;
+  uint32_t start;
+  uint32_t end;
+
+  if ((pPlan == NULL) || (pBuf == NULL) || (BufBlocks < SD_PLAN_RU_BLOCKS) || (SD_GetCardInfo(&info) != HAL_OK) ||
+      (RegionStart >= info.LogBlockNbr) || (RegionBlocks > (info.LogBlockNbr - RegionStart)))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 单元取RU的整数倍；AU已知时还要整除AU，保证单元不跨AU */
+  unit = BufBlocks - (BufBlocks % SD_PLAN_RU_BLOCKS);
+  au = info.AuBlocks;
+  if ((au != 0U) && ((au % SD_PLAN_RU_BLOCKS) == 0U))
+  {
+    while ((au % unit) != 0U)
+    {
+      unit -= SD_PLAN_RU_BLOCKS;
+    }
+  }
+  else
+  {
+    au = 0U;
+  }
+
+  /* 起点优先对齐到AU，区域放不下一个单元时退而对齐到RU */
+  end = RegionStart + RegionBlocks;
+  start = (au != 0U) ? SD_Plan_AlignUp(RegionStart, au) : end;
+  if ((start >= end) || ((end - start) < unit))
+  {
+    start = SD_Plan_AlignUp(RegionStart, SD_PLAN_RU_BLOCKS);
+  }
+  if ((start >= end) || ((end - start) < unit))
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 写入规划区域过小: %lu块\r\n", RegionBlocks);
+#endif
+    return HAL_ERROR;
+  }
+
+  (void)memset(pPlan, 0, sizeof(*pPlan));
+  pPlan->pBuf = pBuf;
+  pPlan->UnitBlocks = unit;
+  pPlan->AuBlocks = au;
+  pPlan->StartBlock = start;
+  pPlan->EndBlock = end;
+  pPlan->NextBlock = start;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  追加数据，攒满一个单元即写卡
+  * @param  pPlan: 规划对象
+  * @param  pData: 数据
+  * @param  Length: 字节数
+  * @param  Timeout: 每次写卡的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Plan_Write(SD_PlanTypeDef *pPlan, const uint8_t *pData, uint32_t Length, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t room;
+  uint32_t n;
+
+  if (pPlan == NULL)
+  {
+    return HAL_ERROR;
+  }
+  pPlan->Accepted = 0U;
+  if ((pPlan->pBuf == NULL) || ((pData == NULL) && (Length != 0U)))
+  {
+    return HAL_ERROR;
+  }
+
+  while (Length != 0U)
+  {
+    room = SD_Plan_Room(pPlan);
+    if (pPlan->Fill == room)
+    {
+      /* 上次区域已满，缓冲区仍是满的 */
+      status = SD_Plan_Flush(pPlan, room / SD_BLOCK_SIZE, Timeout);
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+      continue;
+    }
+
+    n = room - pPlan->Fill;
+    if (n > Length)
+    {
+      n = Length;
+    }
+    (void)memcpy(&pPlan->pBuf[pPlan->Fill], pData, n);
+    pPlan->Fill += n;
+    pPlan->Accepted += n;
+    pData += n;
+    Length -= n;
+
+    if (pPlan->Fill == room)
+    {
+      status = SD_Plan_Flush(pPlan, room / SD_BLOCK_SIZE, Timeout);
+      if (status != HAL_OK)
+      {
+        return status;
+      }
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  把缓冲区中的数据补齐到RU边界后写卡
+  * @param  pPlan: 规划对象
+  * @param  Timeout: 写卡超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Plan_Sync(SD_PlanTypeDef *pPlan, uint32_t Timeout)
+{
+  uint32_t used;
+  uint32_t blocks;
+
+  if ((pPlan == NULL) || (pPlan->pBuf == NULL))
+  {
+    return HAL_ERROR;
+  }
+  if (pPlan->Fill == 0U)
+  {
+    return HAL_OK;
+  }
+
+  used = (pPlan->Fill + (SD_BLOCK_SIZE - 1U)) / SD_BLOCK_SIZE;
+  blocks = SD_Plan_AlignUp(used, SD_PLAN_RU_BLOCKS);
+  (void)memset(&pPlan->pBuf[pPlan->Fill], SD_PLAN_PAD_BYTE, (blocks * SD_BLOCK_SIZE) - pPlan->Fill);
+  pPlan->PadBlocks += blocks - used;
+
+  return SD_Plan_Flush(pPlan, blocks, Timeout);
+}
+
+/**
+  * @brief  区域中已写卡的块数
+  * @param  pPlan: 规划对象
+  * @retval uint32_t 块数
+  */
+uint32_t SD_Plan_GetWrittenBlocks(const SD_PlanTypeDef *pPlan)
+{
+  return (pPlan != NULL) ? (pPlan->NextBlock - pPlan->StartBlock) : 0U;
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_PLAN_ENABLE */
@@ -0,0 +1,345 @@
+/**
+  ******************************************************************************
+  * @file    sd_prefetch.c
+  * @brief   SD卡顺序读预取实现
+  * @author  STMicroelectronics
+  * @date    2025-10-26
+  * @version 1.0
+  * @note    每个流有一个预取缓冲；缓冲被读完时用IDMA异步读入下一个窗口，
+  *          调用者处理数据的同时卡在传输，下一次调用时通常已经完成
+  * @note    窗口大小全局自适应：一个窗口被完整用完时加倍，预取数据被丢弃时减半
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_prefetch.h"
+
+#if (SD_PREFETCH_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+/**
+ * @brief 顺序读流
+ */
+typedef struct {
+    uint32_t          Next;     /*!< 下一次顺序访问的块地址 */
+    uint32_t          Start;    /*!< 缓冲中第一个块的地址 */
+    uint32_t          Count;    /*!< 缓冲中有效（或正在读入）的块数 */
+    uint32_t          Used;     /*!< 本窗口已被读走的块数 */
+    uint32_t          SeqRun;   /*!< 连续顺序访问次数 */
+    uint32_t          Stamp;    /*!< 最近访问时间戳，用于替换 */
+    uint8_t           Valid;    /*!< 流在使用中 */
+    uint8_t           Loading;  /*!< 预取IDMA传输进行中 */
+    uint8_t           Stale;    /*!< 传输期间区间被写入/擦除，完成后丢弃 */
+    SD_RequestTypeDef Req;      /*!< 预取IDMA请求 */
+} SD_PrefetchStreamTypeDef;
+
+ALIGN_32BYTES(static uint8_t sd_prefetch_data[SD_PREFETCH_STREAMS][SD_PREFETCH_MAX_BLOCKS * SD_BLOCK_SIZE])
+    SD_PREFETCH_SECTION;                                                 /* 预取缓冲 */
+static SD_PrefetchStreamTypeDef sd_prefetch_stream[SD_PREFETCH_STREAMS];  /* 流状态 */
+static uint32_t sd_prefetch_window = SD_PREFETCH_MIN_BLOCKS;             /* 当前预取窗口（块） */
+static uint32_t sd_prefetch_clock;                                       /* 替换时间戳 */
+static uint32_t sd_prefetch_capacity;                                    /* 卡总块数，首次预取时读取 */
+static SD_PrefetchStatsTypeDef sd_prefetch_stats;
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  丢弃窗口中未被使用的预取数据
+  * @param  s: 流
+  * @note   有数据被浪费时窗口减半
+  */
+static void SD_Prefetch_Discard(SD_PrefetchStreamTypeDef *s)
+{
+  if (s->Count > s->Used)
+  {
+    sd_prefetch_stats.Wasted += s->Count - s->Used;
+    sd_prefetch_window = (sd_prefetch_window / 2U < SD_PREFETCH_MIN_BLOCKS) ?
+                         SD_PREFETCH_MIN_BLOCKS : (sd_prefetch_window / 2U);
+  }
+  s->Count = 0U;
+  s->Used = 0U;
+}
+
+/**
+  * @brief  回收已完成的预取传输
+  * @param  s: 流
+  */
+static void SD_Prefetch_Reap(SD_PrefetchStreamTypeDef *s)
+{
+  if ((s->Loading == 0U) || (s->Req.Done == 0U))
+  {
+    return;
+  }
+
+  s->Loading = 0U;
+  if ((s->Req.Status != HAL_OK) || (s->Stale != 0U))
+  {
+    s->Count = 0U;
+    s->Used = 0U;
+  }
+  else
+  {
+    sd_prefetch_stats.Prefetched += s->Count;
+  }
+  s->Stale = 0U;
+}
+
+/**
+  * @brief  为流启动下一个窗口的后台读取
+  * @param  s: 流
+  */
+static void SD_Prefetch_Kick(SD_PrefetchStreamTypeDef *s)
+{
+  SD_CardInfoTypeDef info;
+  uint32_t n;
+
+  if (sd_prefetch_capacity == 0U)
+  {
+    if (SD_GetCardInfo(&info) != HAL_OK)
+    {
+      return;
+    }
+    sd_prefetch_capacity = info.LogBlockNbr;
+  }
+
+  if (s->Next >= sd_prefetch_capacity)
+  {
+    return;
+  }
+
+  n = sd_prefetch_window;
+  if (n > (sd_prefetch_capacity - s->Next))
+  {
+    n = sd_prefetch_capacity - s->Next;
+  }
+
+  s->Start = s->Next;
+  s->Count = n;
+  s->Used = 0U;
+  s->Stale = 0U;
+  s->Req.Callback = NULL;
+  s->Loading = 1U;
+
+  /* 控制器或卡忙（例如刚写完还在编程）时本次不预取 */
+  if (SD_ReadBlocksAsync(sd_prefetch_data[s - sd_prefetch_stream], s->Start, n, &s->Req) != HAL_OK)
+  {
+    s->Loading = 0U;
+    s->Count = 0U;
+  }
+}
+
+/**
+  * @brief  查找请求所属的流，找不到时替换最久未用的流
+  * @param  BlockAdd: 起始块地址
+  * @param  Timeout: 等待被替换流的预取结束的超时时间（毫秒）
+  * @retval SD_PrefetchStreamTypeDef* 流
+  */
+static SD_PrefetchStreamTypeDef *SD_Prefetch_Find(uint32_t BlockAdd, uint32_t Timeout)
+{
+  SD_PrefetchStreamTypeDef *s;
+  SD_PrefetchStreamTypeDef *victim = &sd_prefetch_stream[0];
+  uint32_t i;
+
+  for (i = 0U; i < SD_PREFETCH_STREAMS; i++)
+  {
+    s = &sd_prefetch_stream[i];
+    if (s->Valid == 0U)
+    {
+      victim = s;
+      continue;
+    }
+    if ((BlockAdd == s->Next) || ((s->Count != 0U) && (BlockAdd >= s->Start) && ((BlockAdd - s->Start) < s->Count)))
+    {
+      return s;
+    }
+    if ((victim->Valid != 0U) && (s->Stamp < victim->Stamp))
+    {
+      victim = s;
+    }
+  }
+
+  /* 缓冲可能正被IDMA写入，必须等它结束才能复用 */
+  if (victim->Loading != 0U)
+  {
+    (void)SD_WaitRequest(&victim->Req, Timeout);
+    SD_Prefetch_Reap(victim);
+  }
+  if (victim->Valid != 0U)
+  {
+    SD_Prefetch_Discard(victim);
+  }
+
+  victim->Valid = 1U;
+  victim->Next = BlockAdd;
+  victim->Count = 0U;
+  victim->Used = 0U;
+  victim->SeqRun = 0U;
+
+  return victim;
+}
+
+/**
+  * @brief  经预取器读取
+  * @param  pData: 数据缓冲区指针
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Prefetch_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  SD_PrefetchStreamTypeDef *s;
+  HAL_StatusTypeDef status;
+  uint32_t done = 0U;
+  uint32_t n;
+
+  if ((pData == NULL) || (NumberOfBlocks == 0U))
+  {
+    return SD_ReadBlocksDirect(pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+
+  /* 大块读取本身已经足够高效 */
+  if (NumberOfBlocks >= SD_PREFETCH_MAX_BLOCKS)
+  {
+    sd_prefetch_stats.Bypasses++;
+    return SD_ReadBlocksDirect(pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+
+  s = SD_Prefetch_Find(BlockAdd, Timeout);
+  s->SeqRun = (BlockAdd == s->Next) ? (s->SeqRun + 1U) : 1U;
+  sd_prefetch_clock++;
+  s->Stamp = sd_prefetch_clock;
+
+  if ((s->Count != 0U) && (BlockAdd >= s->Start) && ((BlockAdd - s->Start) < s->Count))
+  {
+    if (s->Loading != 0U)
+    {
+      if (s->Req.Done == 0U)
+      {
+        sd_prefetch_stats.Waits++;
+        (void)SD_WaitRequest(&s->Req, Timeout);
+      }
+      SD_Prefetch_Reap(s);
+    }
+
+    if (s->Count != 0U)
+    {
+      n = s->Count - (BlockAdd - s->Start);
+      done = (NumberOfBlocks < n) ? NumberOfBlocks : n;
+      memcpy(pData, &sd_prefetch_data[s - sd_prefetch_stream][(BlockAdd - s->Start) * SD_BLOCK_SIZE],
+             done * SD_BLOCK_SIZE);
+      s->Used += done;
+      sd_prefetch_stats.Hits += done;
+    }
+  }
+
+  /* 缓冲之外的部分读卡 */
+  if (done < NumberOfBlocks)
+  {
+    status = SD_ReadBlocksDirect(&pData[done * SD_BLOCK_SIZE], BlockAdd + done, NumberOfBlocks - done, Timeout);
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+    sd_prefetch_stats.Misses += NumberOfBlocks - done;
+  }
+  s->Next = BlockAdd + NumberOfBlocks;
+
+  /* 顺序流且当前窗口已读完：用满则加大窗口，然后预取下一个窗口 */
+  if ((s->SeqRun >= SD_PREFETCH_TRIGGER) && (s->Loading == 0U) &&
+      ((s->Count == 0U) || (s->Next >= (s->Start + s->Count))))
+  {
+    if ((s->Count != 0U) && (s->Used >= s->Count))
+    {
+      sd_prefetch_window = ((sd_prefetch_window * 2U) > SD_PREFETCH_MAX_BLOCKS) ?
+                           SD_PREFETCH_MAX_BLOCKS : (sd_prefetch_window * 2U);
+    }
+    SD_Prefetch_Discard(s);
+    SD_Prefetch_Kick(s);
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  作废与指定区间重叠的预取数据
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  */
+void SD_Prefetch_Invalidate(uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+  SD_PrefetchStreamTypeDef *s;
+  uint32_t i;
+
+  for (i = 0U; i < SD_PREFETCH_STREAMS; i++)
+  {
+    s = &sd_prefetch_stream[i];
+    if ((s->Count == 0U) || (BlockAdd >= (s->Start + s->Count)) || ((BlockAdd + NumberOfBlocks) <= s->Start))
+    {
+      continue;
+    }
+
+    if (s->Loading != 0U)
+    {
+      s->Stale = 1U;
+    }
+    else
+    {
+      SD_Prefetch_Discard(s);
+    }
+  }
+}
+
+/**
+  * @brief  等待后台预取传输结束
+  * @param  Timeout: 超时时间（毫秒）
+  */
+void SD_Prefetch_Quiesce(uint32_t Timeout)
+{
+  uint32_t i;
+
+  for (i = 0U; i < SD_PREFETCH_STREAMS; i++)
+  {
+    if (sd_prefetch_stream[i].Loading != 0U)
+    {
+      (void)SD_WaitRequest(&sd_prefetch_stream[i].Req, Timeout);
+      SD_Prefetch_Reap(&sd_prefetch_stream[i]);
+    }
+  }
+}
+
+/**
+  * @brief  读取预取统计
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Prefetch_GetStats(SD_PrefetchStatsTypeDef *pStats)
+{
+  if (pStats != NULL)
+  {
+    *pStats = sd_prefetch_stats;
+  }
+}
+
+/**
+  * @brief  清零预取统计
+  */
+void SD_Prefetch_ResetStats(void)
+{
+  memset(&sd_prefetch_stats, 0, sizeof(sd_prefetch_stats));
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_PREFETCH_ENABLE */
@@ -0,0 +1,350 @@
+/**
+  ******************************************************************************
+  * @file    sd_queue.c
+  * @brief   SD卡写合并队列实现
+  * @author  STMicroelectronics
+  * @date    2025-10-27
+  * @version 1.0
+  * @note    暂存区每个槽位保存一个块，同一块再次写入时原地覆盖，因此槽位中的块地址互不相同
+  * @note    刷新时把槽位按块地址原地重排（只用一个块大小的临时区），地址连续的槽位正好在内存中连续，
+  *          可直接作为一次多块写入的源
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_queue.h"
+
+#if (SD_QUEUE_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#if (SD_PREFETCH_ENABLE != 0U)
+#include "sd_prefetch.h"
+#define SD_QUEUE_FILL       SD_Prefetch_Read      /* 读取经过顺序读预取器 */
+#else
+#define SD_QUEUE_FILL       SD_ReadBlocksDirect
+#endif
+
+ALIGN_32BYTES(static uint8_t sd_queue_data[SD_QUEUE_BLOCKS][SD_BLOCK_SIZE]) SD_QUEUE_SECTION;  /* 暂存区 */
+static uint32_t sd_queue_block[SD_QUEUE_BLOCKS];   /* 各槽位的块地址 */
+static uint32_t sd_queue_order[SD_QUEUE_BLOCKS];   /* 刷新时的排序下标 */
+static uint8_t  sd_queue_tmp[SD_BLOCK_SIZE];       /* 重排用临时块 */
+static uint32_t sd_queue_count;                    /* 已用槽位数 */
+static uint32_t sd_queue_oldest;                   /* 最早一块进入队列的时刻（毫秒） */
+static SD_QueueStatsTypeDef sd_queue_stats;
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  查找块所在的槽位
+  * @param  BlockAdd: 块地址
+  * @retval int32_t 槽位号，不在队列中返回-1
+  */
+static int32_t SD_Queue_Lookup(uint32_t BlockAdd)
+{
+  uint32_t i;
+
+  for (i = 0U; i < sd_queue_count; i++)
+  {
+    if (sd_queue_block[i] == BlockAdd)
+    {
+      return (int32_t)i;
+    }
+  }
+
+  return -1;
+}
+
+/**
+  * @brief  按块地址排序并写出全部槽位
+  * @param  Timeout: 每次写入的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态；失败时未写入的槽位移到前部保留
+  */
+static HAL_StatusTypeDef SD_Queue_Drain(uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t n = sd_queue_count;
+  uint32_t i;
+  uint32_t j;
+  uint32_t k;
+  uint32_t key;
+  uint32_t blk;
+
+  /* 1. 下标按块地址插入排序（槽位数小，且通常已基本有序） */
+  for (i = 0U; i < n; i++)
+  {
+    key = sd_queue_order[i] = i;
+    j = i;
+    while ((j > 0U) && (sd_queue_block[sd_queue_order[j - 1U]] > sd_queue_block[key]))
+    {
+      sd_queue_order[j] = sd_queue_order[j - 1U];
+      j--;
+    }
+    sd_queue_order[j] = key;
+  }
+
+  /* 2. 沿置换环原地重排：新槽位j = 原槽位order[j] */
+  for (i = 0U; i < n; i++)
+  {
+    if (sd_queue_order[i] == i)
+    {
+      continue;
+    }
+    memcpy(sd_queue_tmp, sd_queue_data[i], SD_BLOCK_SIZE);
+    blk = sd_queue_block[i];
+    j = i;
+    for (;;)
+    {
+      k = sd_queue_order[j];
+      sd_queue_order[j] = j;
+      if (k == i)
+      {
+        memcpy(sd_queue_data[j], sd_queue_tmp, SD_BLOCK_SIZE);
+        sd_queue_block[j] = blk;
+        break;
+      }
+      memcpy(sd_queue_data[j], sd_queue_data[k], SD_BLOCK_SIZE);
+      sd_queue_block[j] = sd_queue_block[k];
+      j = k;
+    }
+  }
+
+  /* 3. 地址连续的一段作为一次多块写入 */
+  i = 0U;
+  while (i < n)
+  {
+    j = i + 1U;
+    while ((j < n) && (sd_queue_block[j] == (sd_queue_block[j - 1U] + 1U)))
+    {
+      j++;
+    }
+
+    status = SD_WriteBlocksDirect(sd_queue_data[i], sd_queue_block[i], j - i, Timeout);
+    if (status != HAL_OK)
+    {
+#ifdef DEBUG
+      printf("[SD] [FAIL] 写合并队列刷新块%lu失败，状态: %d\r\n", sd_queue_block[i], status);
+#endif
+      memmove(sd_queue_data[0], sd_queue_data[i], (n - i) * SD_BLOCK_SIZE);
+      memmove(&sd_queue_block[0], &sd_queue_block[i], (n - i) * sizeof(sd_queue_block[0]));
+      sd_queue_count = n - i;
+      sd_queue_oldest = HAL_GetTick();
+      return status;
+    }
+
+    sd_queue_stats.Transfers++;
+    sd_queue_stats.TransferBlocks += j - i;
+    i = j;
+  }
+
+  sd_queue_count = 0U;
+  return HAL_OK;
+}
+
+/**
+  * @brief  最早一块是否已超过期限
+  */
+static uint8_t SD_Queue_Expired(void)
+{
+  return ((sd_queue_count != 0U) && ((HAL_GetTick() - sd_queue_oldest) >= SD_QUEUE_DEADLINE_MS)) ? 1U : 0U;
+}
+
+/**
+  * @brief  经写合并队列写入
+  * @param  pData: 数据缓冲区指针
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态；刷新失败时本次写入的块都未入队
+  */
+HAL_StatusTypeDef SD_Queue_Write(const uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t need = 0U;
+  uint32_t i;
+  int32_t slot;
+
+  if ((pData == NULL) || (NumberOfBlocks == 0U))
+  {
+    return SD_WriteBlocksDirect((uint8_t *)pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+
+  /* 大块写入（或比暂存区还大）：队列中被它覆盖的旧数据作废，直接写卡 */
+  if ((NumberOfBlocks >= SD_QUEUE_BYPASS_BLOCKS) || (NumberOfBlocks > SD_QUEUE_BLOCKS))
+  {
+    SD_Queue_Discard(BlockAdd, NumberOfBlocks);
+    sd_queue_stats.Bypasses++;
+    return SD_WriteBlocksDirect((uint8_t *)pData, BlockAdd, NumberOfBlocks, Timeout);
+  }
+
+  /* 放不下时先整体刷新再入队：刷新失败时不留下本次写入的一部分 */
+  for (i = 0U; i < NumberOfBlocks; i++)
+  {
+    if (SD_Queue_Lookup(BlockAdd + i) < 0)
+    {
+      need++;
+    }
+  }
+  if ((sd_queue_count + need) > SD_QUEUE_BLOCKS)
+  {
+    sd_queue_stats.FullFlushes++;
+    status = SD_Queue_Drain(Timeout);
+    if (status != HAL_OK)
+    {
+      return status;
+    }
+  }
+
+  for (i = 0U; i < NumberOfBlocks; i++)
+  {
+    slot = SD_Queue_Lookup(BlockAdd + i);
+    if (slot >= 0)
+    {
+      sd_queue_stats.Overwrites++;
+    }
+    else
+    {
+      if (sd_queue_count == 0U)
+      {
+        sd_queue_oldest = HAL_GetTick();
+      }
+      slot = (int32_t)sd_queue_count;
+      sd_queue_block[sd_queue_count] = BlockAdd + i;
+      sd_queue_count++;
+    }
+    memcpy(sd_queue_data[slot], &pData[i * SD_BLOCK_SIZE], SD_BLOCK_SIZE);
+  }
+
+  sd_queue_stats.SubmittedWrites++;
+  sd_queue_stats.SubmittedBlocks += NumberOfBlocks;
+
+  return SD_Queue_Poll(Timeout);
+}
+
+/**
+  * @brief  读取并叠加队列中尚未写卡的数据
+  * @param  pData: 数据缓冲区指针
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Queue_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t i;
+
+  status = SD_QUEUE_FILL(pData, BlockAdd, NumberOfBlocks, Timeout);
+  if (status != HAL_OK)
+  {
+    return status;
+  }
+
+  for (i = 0U; i < sd_queue_count; i++)
+  {
+    if ((sd_queue_block[i] >= BlockAdd) && ((sd_queue_block[i] - BlockAdd) < NumberOfBlocks))
+    {
+      memcpy(&pData[(sd_queue_block[i] - BlockAdd) * SD_BLOCK_SIZE], sd_queue_data[i], SD_BLOCK_SIZE);
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  立即刷新队列
+  * @param  Timeout: 每次写入的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Queue_Sync(uint32_t Timeout)
+{
+  if (sd_queue_count == 0U)
+  {
+    return HAL_OK;
+  }
+
+  sd_queue_stats.SyncFlushes++;
+  return SD_Queue_Drain(Timeout);
+}
+
+/**
+  * @brief  期限检查
+  * @param  Timeout: 每次写入的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Queue_Poll(uint32_t Timeout)
+{
+  if (SD_Queue_Expired() == 0U)
+  {
+    return HAL_OK;
+  }
+
+  sd_queue_stats.DeadlineFlushes++;
+  return SD_Queue_Drain(Timeout);
+}
+
+/**
+  * @brief  丢弃队列中指定区间的块
+  * @param  BlockAdd: 起始块地址
+  * @param  NumberOfBlocks: 块数量
+  */
+void SD_Queue_Discard(uint32_t BlockAdd, uint32_t NumberOfBlocks)
+{
+  uint32_t i = 0U;
+
+  while (i < sd_queue_count)
+  {
+    if ((sd_queue_block[i] >= BlockAdd) && ((sd_queue_block[i] - BlockAdd) < NumberOfBlocks))
+    {
+      /* 用最后一个槽位填补空洞，顺序在刷新时重排 */
+      sd_queue_count--;
+      if (i != sd_queue_count)
+      {
+        memcpy(sd_queue_data[i], sd_queue_data[sd_queue_count], SD_BLOCK_SIZE);
+        sd_queue_block[i] = sd_queue_block[sd_queue_count];
+      }
+      continue;
+    }
+    i++;
+  }
+}
+
+/**
+  * @brief  读取队列统计
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Queue_GetStats(SD_QueueStatsTypeDef *pStats)
+{
+  if (pStats != NULL)
+  {
+    *pStats = sd_queue_stats;
+    pStats->PendingBlocks = sd_queue_count;
+  }
+}
+
+/**
+  * @brief  清零队列统计
+  */
+void SD_Queue_ResetStats(void)
+{
+  memset(&sd_queue_stats, 0, sizeof(sd_queue_stats));
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_QUEUE_ENABLE */
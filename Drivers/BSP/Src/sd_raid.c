@@ -0,0 +1,461 @@
+/**
+  ******************************************************************************
+  * @file    sd_raid.c
+  * @brief   双卡条带（RAID-0）与镜像（RAID-1）实现
+  * @author  STMicroelectronics
+  * @date    2025-11-12
+  * @version 1.0
+  * @note    条带：虚拟块v在分片c = v / ChunkBlocks上，分片c放在成员c % 2、卡上的块StartBlock + (c / 2) * ChunkBlocks
+  *          + v % ChunkBlocks。每个成员按顺序取属于自己的分片，一个分片一条命令；两个成员各自独立推进，
+  *          一张卡编程忙时另一张卡照常传输
+  * @note    镜像读取的两个成员共用一个游标，哪个成员能提交请求（控制器空闲且卡在传输状态）就取下一个分片
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_raid.h"
+
+#if (SD_RAID_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#define SD_RAID_DEFAULT_CHUNK  8192U                    /* AU未知时的分片（4MB） */
+#define SD_RAID_MAX_XFER       SD_DOUBLEBUF_MAX_BLOCKS  /* 一条命令的块数上限（DLEN为25位） */
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  检查分片与区域起点相对一张卡的AU是否对齐
+  * @param  Au: AU块数，0表示未知（不检查）
+  * @param  Chunk: 分片块数
+  * @param  Start: 区域起点
+  * @retval uint8_t 1对齐
+  */
+static uint8_t SD_Raid_AuAligned(uint32_t Au, uint32_t Chunk, uint32_t Start)
+{
+  if (Au == 0U)
+  {
+    return 1U;
+  }
+  if (Chunk <= Au)
+  {
+    return (((Au % Chunk) == 0U) && ((Start % Chunk) == 0U)) ? 1U : 0U;
+  }
+
+  return (((Chunk % Au) == 0U) && ((Start % Au) == 0U)) ? 1U : 0U;
+}
+
+/**
+  * @brief  按配置组建条带或镜像
+  * @param  hraid: 实例存储
+  * @param  pConfig: 配置
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Raid_Init(SD_RaidTypeDef *hraid, const SD_RaidConfigTypeDef *pConfig)
+{
+  SD_CardInfoTypeDef info[SD_RAID_MEMBERS];
+  uint32_t chunk;
+  uint32_t region;
+  uint32_t k;
+
+  if ((hraid == NULL) || (pConfig == NULL) || (pConfig->pDev[0] == NULL) || (pConfig->pDev[1] == NULL) ||
+      (pConfig->pDev[0] == pConfig->pDev[1]) ||
+      ((pConfig->Mode != SD_RAID_MODE_STRIPE) && (pConfig->Mode != SD_RAID_MODE_MIRROR)))
+  {
+    return HAL_ERROR;
+  }
+
+  region = 0xFFFFFFFFU;
+  chunk = pConfig->ChunkBlocks;
+  for (k = 0U; k < SD_RAID_MEMBERS; k++)
+  {
+    if ((SD_Dev_GetCardInfo(pConfig->pDev[k], &info[k]) != HAL_OK) ||
+        (pConfig->StartBlock >= info[k].LogBlockNbr))
+    {
+      return HAL_ERROR;
+    }
+    if ((info[k].LogBlockNbr - pConfig->StartBlock) < region)
+    {
+      region = info[k].LogBlockNbr - pConfig->StartBlock;
+    }
+    /* 两张卡的AU不同时取较大的一个（AU都是2的幂或其1.5倍，较大的是较小的整数倍时两边都对齐） */
+    if ((pConfig->ChunkBlocks == 0U) && (info[k].AuBlocks > chunk))
+    {
+      chunk = info[k].AuBlocks;
+    }
+  }
+  if (chunk == 0U)
+  {
+    chunk = SD_RAID_DEFAULT_CHUNK;
+  }
+
+  if (pConfig->RegionBlocks != 0U)
+  {
+    if (pConfig->RegionBlocks > region)
+    {
+#ifdef DEBUG
+      printf("[SD] [FAIL] 条带/镜像区域超出卡容量: %lu块\r\n", pConfig->RegionBlocks);
+#endif
+      return HAL_ERROR;
+    }
+    region = pConfig->RegionBlocks;
+  }
+
+  for (k = 0U; k < SD_RAID_MEMBERS; k++)
+  {
+    if (SD_Raid_AuAligned(info[k].AuBlocks, chunk, pConfig->StartBlock) == 0U)
+    {
+#ifdef DEBUG
+      printf("[SD] [FAIL] 分片%lu块或起点%lu与成员%lu的AU（%lu块）不对齐\r\n", chunk, pConfig->StartBlock, k,
+             info[k].AuBlocks);
+#endif
+      return HAL_ERROR;
+    }
+  }
+
+  if (pConfig->Mode == SD_RAID_MODE_STRIPE)
+  {
+    region -= region % chunk;
+    if (region == 0U)
+    {
+#ifdef DEBUG
+      printf("[SD] [FAIL] 条带区域放不下一个分片\r\n");
+#endif
+      return HAL_ERROR;
+    }
+  }
+
+  (void)memset(hraid, 0, sizeof(*hraid));
+  hraid->pDev[0] = pConfig->pDev[0];
+  hraid->pDev[1] = pConfig->pDev[1];
+  hraid->Mode = pConfig->Mode;
+  hraid->ChunkBlocks = chunk;
+  hraid->StartBlock = pConfig->StartBlock;
+  hraid->MemberBlocks = region;
+  hraid->Blocks = (pConfig->Mode == SD_RAID_MODE_STRIPE) ? (region * SD_RAID_MEMBERS) : region;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  虚拟块设备的容量
+  * @param  hraid: 实例
+  * @retval uint32_t 块数
+  */
+uint32_t SD_Raid_GetBlockCount(const SD_RaidTypeDef *hraid)
+{
+  return (hraid != NULL) ? hraid->Blocks : 0U;
+}
+
+/**
+  * @brief  成员k的下一段：从*pNext起属于成员k、卡上连续的一段
+  * @param  hraid: 实例
+  * @param  k: 成员
+  * @param  pNext: 游标（虚拟块），条带时跳过其他成员的分片
+  * @param  End: 虚拟结束块（不含）
+  * @param  Shared: 1: 镜像读取，一段不超过一个分片
+  * @param  pPhys: 输出卡上的起始块
+  * @param  pCount: 输出块数
+  * @retval uint8_t 0表示成员k已没有要传输的块
+  */
+static uint8_t SD_Raid_Map(const SD_RaidTypeDef *hraid, uint32_t k, uint32_t *pNext, uint32_t End, uint8_t Shared,
+                           uint32_t *pPhys, uint32_t *pCount)
+{
+  uint32_t chunk = hraid->ChunkBlocks;
+  uint32_t v = *pNext;
+  uint32_t c;
+  uint32_t n;
+
+  if (hraid->Mode == SD_RAID_MODE_STRIPE)
+  {
+    c = v / chunk;
+    if ((c % SD_RAID_MEMBERS) != k)
+    {
+      c++;
+      v = (v < End) ? (c * chunk) : v;
+      *pNext = v;
+    }
+    if (v >= End)
+    {
+      return 0U;
+    }
+    n = ((c + 1U) * chunk) - v;
+    *pPhys = hraid->StartBlock + ((c / SD_RAID_MEMBERS) * chunk) + (v - (c * chunk));
+  }
+  else
+  {
+    if (v >= End)
+    {
+      return 0U;
+    }
+    n = (Shared != 0U) ? chunk : SD_RAID_MAX_XFER;
+    *pPhys = hraid->StartBlock + v;
+  }
+
+  if (n > (End - v))
+  {
+    n = End - v;
+  }
+  *pCount = (n > SD_RAID_MAX_XFER) ? SD_RAID_MAX_XFER : n;
+
+  return 1U;
+}
+
+/**
+  * @brief  读写虚拟块设备：两个成员各自一个请求，完成后立即提交下一段
+  * @param  hraid: 实例
+  * @param  pData: 数据缓冲区
+  * @param  BlockAdd: 虚拟起始块
+  * @param  NumberOfBlocks: 块数量
+  * @param  IsRead: 1读 0写
+  * @param  Timeout: 整次读写的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+static HAL_StatusTypeDef SD_Raid_Xfer(SD_RaidTypeDef *hraid, uint8_t *pData, uint32_t BlockAdd,
+                                      uint32_t NumberOfBlocks, uint8_t IsRead, uint32_t Timeout)
+{
+  uint32_t next[SD_RAID_MEMBERS] = {BlockAdd, BlockAdd};
+  uint8_t busy[SD_RAID_MEMBERS] = {0U, 0U};
+  uint8_t done[SD_RAID_MEMBERS] = {0U, 0U};
+  uint32_t end = BlockAdd + NumberOfBlocks;
+  uint32_t mask = (IsRead != 0U) ? (SD_DCACHE_LINE - 1U) : 3U;
+  uint32_t tickstart = HAL_GetTick();
+  uint8_t shared = ((hraid->Mode == SD_RAID_MODE_MIRROR) && (IsRead != 0U)) ? 1U : 0U;
+  uint32_t first = (shared != 0U) ? hraid->NextRead : 0U;
+  HAL_StatusTypeDef status = HAL_OK;
+  HAL_StatusTypeDef st;
+  SD_DeviceTypeDef *dev;
+  uint32_t *cur;
+  uint32_t phys;
+  uint32_t n;
+  uint32_t i;
+  uint32_t k;
+  uint8_t direct;
+  uint8_t progress;
+  uint8_t *p;
+
+  if ((pData == NULL) || (NumberOfBlocks == 0U) || (BlockAdd >= hraid->Blocks) ||
+      (NumberOfBlocks > (hraid->Blocks - BlockAdd)))
+  {
+    return HAL_ERROR;
+  }
+
+  /* 异步接口不经跳板缓冲区：不满足对齐时每段同步读写 */
+  direct = ((((uintptr_t)pData & mask) != 0U) ||
+            (SD_IsDmaReachable(pData, NumberOfBlocks * SD_BLOCK_SIZE) == 0U)) ? 1U : 0U;
+  if (direct != 0U)
+  {
+    hraid->Stats.Bounced++;
+  }
+
+  while ((busy[0] != 0U) || (busy[1] != 0U) || ((status == HAL_OK) && ((done[0] == 0U) || (done[1] == 0U))))
+  {
+    progress = 0U;
+    for (i = 0U; i < SD_RAID_MEMBERS; i++)
+    {
+      k = (first + i) % SD_RAID_MEMBERS;
+      dev = hraid->pDev[k];
+
+      if (busy[k] != 0U)
+      {
+        st = SD_PollRequest(&hraid->Req[k]);
+        if (st == HAL_BUSY)
+        {
+          continue;
+        }
+        busy[k] = 0U;
+        progress = 1U;
+        if ((st != HAL_OK) && (status == HAL_OK))
+        {
+          status = st;
+        }
+      }
+
+      /* 出错后不再提交，只等另一个成员的请求结束 */
+      if ((status != HAL_OK) || (done[k] != 0U))
+      {
+        continue;
+      }
+      cur = &next[(shared != 0U) ? 0U : k];
+      if (SD_Raid_Map(hraid, k, cur, end, shared, &phys, &n) == 0U)
+      {
+        done[k] = 1U;
+        continue;
+      }
+
+      p = &pData[(*cur - BlockAdd) * SD_BLOCK_SIZE];
+      if (direct != 0U)
+      {
+        st = (IsRead != 0U) ? SD_Dev_ReadBlocksDirect(dev, p, phys, n, Timeout) :
+                              SD_Dev_WriteBlocksDirect(dev, p, phys, n, Timeout);
+      }
+      else
+      {
+        st = (IsRead != 0U) ? SD_Dev_ReadBlocksAsync(dev, p, phys, n, &hraid->Req[k]) :
+                              SD_Dev_WriteBlocksAsync(dev, p, phys, n, &hraid->Req[k]);
+        if (st == HAL_BUSY)
+        {
+          /* 卡还在编程：镜像读取由另一个成员先取这一段 */
+          hraid->Stats.BusyRetries++;
+          continue;
+        }
+      }
+      if (st != HAL_OK)
+      {
+        status = st;
+        continue;
+      }
+
+      busy[k] = (direct != 0U) ? 0U : 1U;
+      progress = 1U;
+      *cur += n;
+      hraid->Stats.Commands[k]++;
+      hraid->Stats.Blocks[k] += n;
+      if (shared != 0U)
+      {
+        hraid->NextRead = (k + 1U) % SD_RAID_MEMBERS;
+      }
+    }
+
+    if ((HAL_GetTick() - tickstart) >= Timeout)
+    {
+      for (k = 0U; k < SD_RAID_MEMBERS; k++)
+      {
+        if (busy[k] != 0U)
+        {
+          (void)SD_AbortRequest(&hraid->Req[k], HAL_TIMEOUT);
+          busy[k] = 0U;
+        }
+      }
+      status = HAL_TIMEOUT;
+      break;
+    }
+    if (progress == 0U)
+    {
+      SD_WaitYield(SD_RAID_POLL_US);
+    }
+  }
+
+  if (status != HAL_OK)
+  {
+    hraid->Stats.Errors++;
+#ifdef DEBUG
+    printf("[SD] [FAIL] %s%s失败，状态: %d\r\n", (hraid->Mode == SD_RAID_MODE_STRIPE) ? "条带" : "镜像",
+           (IsRead != 0U) ? "读取" : "写入", status);
+#endif
+  }
+
+  return status;
+}
+
+/**
+  * @brief  写入虚拟块设备
+  * @param  hraid: 实例
+  * @param  pData: 数据缓冲区
+  * @param  BlockAdd: 虚拟起始块
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 整次写入的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Raid_WriteBlocks(SD_RaidTypeDef *hraid, const uint8_t *pData, uint32_t BlockAdd,
+                                      uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  if (hraid == NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  hraid->Stats.Writes++;
+  return SD_Raid_Xfer(hraid, (uint8_t *)pData, BlockAdd, NumberOfBlocks, 0U, Timeout);
+}
+
+/**
+  * @brief  读取虚拟块设备
+  * @param  hraid: 实例
+  * @param  pData: 数据缓冲区
+  * @param  BlockAdd: 虚拟起始块
+  * @param  NumberOfBlocks: 块数量
+  * @param  Timeout: 整次读取的超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Raid_ReadBlocks(SD_RaidTypeDef *hraid, uint8_t *pData, uint32_t BlockAdd,
+                                     uint32_t NumberOfBlocks, uint32_t Timeout)
+{
+  if (hraid == NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  hraid->Stats.Reads++;
+  return SD_Raid_Xfer(hraid, pData, BlockAdd, NumberOfBlocks, 1U, Timeout);
+}
+
+/**
+  * @brief  等待两张卡都结束编程
+  * @param  hraid: 实例
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Raid_WaitReady(SD_RaidTypeDef *hraid, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+  uint32_t k;
+
+  if (hraid != NULL)
+  {
+    for (k = 0U; k < SD_RAID_MEMBERS; k++)
+    {
+      status = SD_Dev_WaitReady(hraid->pDev[k], Timeout);
+      if (status != HAL_OK)
+      {
+        break;
+      }
+    }
+  }
+
+  return status;
+}
+
+/**
+  * @brief  读取统计
+  * @param  hraid: 实例
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Raid_GetStats(const SD_RaidTypeDef *hraid, SD_RaidStatsTypeDef *pStats)
+{
+  if ((hraid != NULL) && (pStats != NULL))
+  {
+    *pStats = hraid->Stats;
+  }
+}
+
+/**
+  * @brief  清零统计
+  * @param  hraid: 实例
+  */
+void SD_Raid_ResetStats(SD_RaidTypeDef *hraid)
+{
+  if (hraid != NULL)
+  {
+    (void)memset(&hraid->Stats, 0, sizeof(hraid->Stats));
+  }
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_RAID_ENABLE */
@@ -0,0 +1,393 @@
+/**
+  ******************************************************************************
+  * @file    sd_recover.c
+  * @brief   SD卡读写错误的分类与自适应恢复实现
+  * @author  STMicroelectronics
+  * @date    2025-11-10
+  * @version 1.0
+  * @note    降级从当前配置开始：先逐级加大分频，到SD_RECOVER_MIN_HZ后改用1线；恢复按相反顺序逐级进行，
+  *          不超过第一次降级前的配置。分频或线宽被SD_SetClockDiv()等外部调用改过时，以外部设置为准重新开始
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_recover.h"
+
+#if (SD_RECOVER_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#define SD_RECOVER_CRC_ERRORS     (HAL_SD_ERROR_CMD_CRC_FAIL | HAL_SD_ERROR_DATA_CRC_FAIL)
+#define SD_RECOVER_FIFO_ERRORS    (HAL_SD_ERROR_TX_UNDERRUN | HAL_SD_ERROR_RX_OVERRUN | HAL_SD_ERROR_DMA)
+#define SD_RECOVER_TIMEOUT_ERRORS (HAL_SD_ERROR_CMD_RSP_TIMEOUT | HAL_SD_ERROR_DATA_TIMEOUT | HAL_SD_ERROR_TIMEOUT)
+
+static SD_RecoverStatsTypeDef sd_recover_stats;
+static uint8_t  sd_recover_enabled = 1U;
+static uint8_t  sd_recover_shifted;      /* 处于降级状态 */
+static uint8_t  sd_recover_probing;      /* 刚恢复一级，还没跑满一轮无错传输 */
+static uint32_t sd_recover_base_div;     /* 第一次降级前的分频 */
+static uint32_t sd_recover_base_width;   /* 第一次降级前的线宽 */
+static uint32_t sd_recover_div;          /* 本模块最后设置的分频与线宽，与实际不符说明被外部改过 */
+static uint32_t sd_recover_width;
+static uint32_t sd_recover_link_errors;  /* 连续的CRC/FIFO错误 */
+static uint32_t sd_recover_clean;        /* 上次降级或恢复以来连续无错的次数 */
+static uint32_t sd_recover_run = SD_RECOVER_UPSHIFT_RUN;
+static uint32_t sd_recover_t0;           /* 第一次失败的时刻（DWT周期） */
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  退避：在Us微秒内反复调用SD_WaitYield()
+  * @param  Us: 退避时间（微秒）
+  */
+static void SD_Recover_Backoff(uint32_t Us)
+{
+  uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+  uint32_t t0 = DWT->CYCCNT;
+  uint32_t elapsed_us;
+
+  for (;;)
+  {
+    elapsed_us = (DWT->CYCCNT - t0) / cycles_per_us;
+    if (elapsed_us >= Us)
+    {
+      break;
+    }
+    SD_WaitYield(Us - elapsed_us);
+  }
+}
+
+/**
+  * @brief  记下当前分频与线宽
+  */
+static void SD_Recover_Note(void)
+{
+  sd_recover_div = SD_GetClockDiv();
+  sd_recover_width = SD_GetBusWidth();
+  sd_recover_clean = 0U;
+}
+
+/**
+  * @brief  分频或线宽被外部改过时放弃降级状态
+  */
+static void SD_Recover_Sync(void)
+{
+  if ((sd_recover_shifted != 0U) &&
+      ((SD_GetClockDiv() != sd_recover_div) || (SD_GetBusWidth() != sd_recover_width)))
+  {
+    sd_recover_shifted = 0U;
+    sd_recover_probing = 0U;
+    sd_recover_run = SD_RECOVER_UPSHIFT_RUN;
+  }
+}
+
+/**
+  * @brief  降一级：加大分频，到下限后改用1线
+  */
+static void SD_Recover_Downshift(void)
+{
+  uint32_t div = SD_GetClockDiv();
+  uint32_t width = SD_GetBusWidth();
+
+  if (sd_recover_shifted == 0U)
+  {
+    sd_recover_base_div = div;
+    sd_recover_base_width = width;
+  }
+
+  if ((div < SDMMC_CLKCR_CLKDIV) && (SD_ClockDivToHz(div + 1U) >= SD_RECOVER_MIN_HZ))
+  {
+    if (SD_SetClockDiv(div + 1U) != HAL_OK)
+    {
+      return;
+    }
+    sd_recover_stats.Downshifts++;
+  }
+  else if (width == SDMMC_BUS_WIDE_4B)
+  {
+    if (SD_SetBusWidth(SDMMC_BUS_WIDE_1B) != HAL_OK)
+    {
+      return;
+    }
+    sd_recover_stats.WidthFallbacks++;
+  }
+  else
+  {
+    return;  /* 已是最低一级，只能重试 */
+  }
+
+  /* 刚恢复的一级又出错：说明余量不足，下次要更长的无错运行才恢复 */
+  if (sd_recover_probing != 0U)
+  {
+    sd_recover_probing = 0U;
+    sd_recover_run = ((sd_recover_run * 2U) < SD_RECOVER_UPSHIFT_MAX) ? (sd_recover_run * 2U) : SD_RECOVER_UPSHIFT_MAX;
+  }
+  sd_recover_shifted = 1U;
+  SD_Recover_Note();
+
+#ifdef DEBUG
+  printf("[SD] [WARN] 连续链路错误，降为 %lu Hz %lu线\r\n", SD_ClockDivToHz(sd_recover_div),
+         (sd_recover_width == SDMMC_BUS_WIDE_4B) ? 4U : 1U);
+#endif
+}
+
+/**
+  * @brief  降级状态下无错运行够数后恢复一级：先恢复线宽，再减小分频
+  */
+static void SD_Recover_Upshift(void)
+{
+  HAL_StatusTypeDef status;
+
+  sd_recover_clean++;
+  if (sd_recover_clean < sd_recover_run)
+  {
+    return;
+  }
+
+  if (sd_recover_shifted == 0U)
+  {
+    sd_recover_probing = 0U;  /* 恢复后的一级已跑满一轮 */
+    return;
+  }
+
+  if (sd_recover_width != sd_recover_base_width)
+  {
+    status = SD_SetBusWidth(sd_recover_base_width);
+  }
+  else if (sd_recover_div > sd_recover_base_div)
+  {
+    status = SD_SetClockDiv(sd_recover_div - 1U);
+  }
+  else
+  {
+    status = HAL_OK;
+  }
+  if (status != HAL_OK)
+  {
+    return;  /* 控制器忙，下次成功时再试 */
+  }
+
+  sd_recover_stats.Upshifts++;
+  sd_recover_probing = 1U;
+  SD_Recover_Note();
+  if ((sd_recover_width == sd_recover_base_width) && (sd_recover_div <= sd_recover_base_div))
+  {
+    sd_recover_shifted = 0U;
+  }
+}
+
+/* USER CODE END 1 */
+
+/* USER CODE BEGIN 2 */
+
+/**
+  * @brief  按状态和HAL错误码给错误分类
+  * @param  Status: 读写返回的状态
+  * @param  ErrorCode: HAL_SD_GetError()
+  * @retval uint32_t SD_RECOVER_CLASS_xxx
+  * @note   CRC优先于FIFO，FIFO优先于超时：链路错误常伴随超时，按链路错误处理才会降级
+  */
+uint32_t SD_Recover_Classify(HAL_StatusTypeDef Status, uint32_t ErrorCode)
+{
+  if ((ErrorCode & SD_RECOVER_CRC_ERRORS) != 0U)
+  {
+    return SD_RECOVER_CLASS_CRC;
+  }
+  if ((ErrorCode & SD_RECOVER_FIFO_ERRORS) != 0U)
+  {
+    return SD_RECOVER_CLASS_FIFO;
+  }
+  if ((Status == HAL_TIMEOUT) || ((ErrorCode & SD_RECOVER_TIMEOUT_ERRORS) != 0U))
+  {
+    return SD_RECOVER_CLASS_TIMEOUT;
+  }
+  if ((Status == HAL_BUSY) || ((ErrorCode & HAL_SD_ERROR_BUSY) != 0U))
+  {
+    return SD_RECOVER_CLASS_BUSY;
+  }
+
+  return SD_RECOVER_CLASS_OTHER;
+}
+
+/**
+  * @brief  打开或暂停错误恢复
+  * @param  Enable: 1打开 0暂停
+  * @retval uint8_t 之前的设置，用于恢复
+  */
+uint8_t SD_Recover_Enable(uint8_t Enable)
+{
+  uint8_t prev = sd_recover_enabled;
+
+  sd_recover_enabled = (Enable != 0U) ? 1U : 0U;
+  return prev;
+}
+
+/**
+  * @brief  一次尝试失败后处理：分类记账，按类别降级、发CMD12或重新初始化，然后退避
+  * @param  Status: 本次尝试的状态
+  * @param  ErrorCode: HAL_SD_GetError()
+  * @param  Attempt: 已重试的次数，第一次失败为0
+  * @retval HAL_StatusTypeDef HAL_OK: 应重试；HAL_ERROR: 已暂停、不可重试、重试用尽或重新初始化失败
+  */
+HAL_StatusTypeDef SD_Recover_OnError(HAL_StatusTypeDef Status, uint32_t ErrorCode, uint32_t Attempt)
+{
+  HAL_SD_CardStateTypeDef state;
+  uint32_t cls;
+  uint32_t backoff;
+
+  if (sd_recover_enabled == 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  cls = SD_Recover_Classify(Status, ErrorCode);
+  sd_recover_stats.Errors[cls]++;
+  if (Attempt == 0U)
+  {
+    sd_recover_t0 = DWT->CYCCNT;
+  }
+  if ((cls == SD_RECOVER_CLASS_OTHER) || (Attempt >= SD_RECOVER_RETRIES))
+  {
+    return HAL_ERROR;
+  }
+
+  SD_Recover_Sync();
+  switch (cls)
+  {
+    case SD_RECOVER_CLASS_CRC:
+    case SD_RECOVER_CLASS_FIFO:
+      sd_recover_link_errors++;
+      if (sd_recover_link_errors >= SD_RECOVER_CRC_LIMIT)
+      {
+        sd_recover_link_errors = 0U;
+        SD_Recover_Downshift();
+      }
+      break;
+
+    case SD_RECOVER_CLASS_TIMEOUT:
+      /* 卡停在数据状态时先发CMD12；已经停过还超时、或卡不在传输模式（无响应、被复位）时重新初始化 */
+      state = HAL_SD_GetCardState(sddev1.hsd);
+      if (((state == HAL_SD_CARD_SENDING) || (state == HAL_SD_CARD_RECEIVING)) && (Attempt == 0U))
+      {
+        (void)HAL_SD_Abort(sddev1.hsd);
+        sd_recover_stats.Stops++;
+      }
+      else if ((state != HAL_SD_CARD_TRANSFER) && (state != HAL_SD_CARD_PROGRAMMING))
+      {
+        sd_recover_stats.Resets++;
+#ifdef DEBUG
+        printf("[SD] [WARN] 卡无响应（状态%lu），重新初始化\r\n", (uint32_t)state);
+#endif
+        if (SD_ResetCard() != HAL_OK)
+        {
+          return HAL_ERROR;
+        }
+        SD_Recover_Sync();
+      }
+      else
+      {
+        /* 卡在传输或编程状态，只是慢：重试时再等 */
+      }
+      break;
+
+    default:
+      /* 忙：只退避 */
+      break;
+  }
+
+  sd_recover_stats.Retries++;
+  backoff = ((SD_RECOVER_BACKOFF_US << Attempt) < SD_RECOVER_BACKOFF_MAX_US) ?
+            (SD_RECOVER_BACKOFF_US << Attempt) : SD_RECOVER_BACKOFF_MAX_US;
+  SD_Recover_Backoff(backoff);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  一次读写结束后记账：失败计数，成功时累计恢复耗时与无错次数
+  * @param  Status: 最终状态
+  * @param  Attempts: 重试次数
+  */
+void SD_Recover_OnDone(HAL_StatusTypeDef Status, uint32_t Attempts)
+{
+  uint32_t cycles;
+
+  if (sd_recover_enabled == 0U)
+  {
+    return;
+  }
+
+  if (Status != HAL_OK)
+  {
+    sd_recover_stats.Failed++;
+    return;
+  }
+
+  sd_recover_link_errors = 0U;
+  if (Attempts != 0U)
+  {
+    cycles = DWT->CYCCNT - sd_recover_t0;
+    sd_recover_stats.Recovered++;
+    sd_recover_stats.RecoverCycles += cycles;
+    if (cycles > sd_recover_stats.MaxRecoverCycles)
+    {
+      sd_recover_stats.MaxRecoverCycles = cycles;
+    }
+  }
+
+  if ((sd_recover_shifted != 0U) || (sd_recover_probing != 0U))
+  {
+    SD_Recover_Sync();
+    if (SD_RECOVER_UPSHIFT_RUN != 0U)
+    {
+      SD_Recover_Upshift();
+    }
+  }
+}
+
+/**
+  * @brief  读取错误恢复统计，附带当前分频、线宽与恢复一级所需的无错次数
+  * @param  pStats: 统计结构体指针
+  * @retval HAL_StatusTypeDef HAL_OK: 成功；HAL_ERROR: pStats为空
+  */
+HAL_StatusTypeDef SD_Recover_GetStats(SD_RecoverStatsTypeDef *pStats)
+{
+  if (pStats == NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  *pStats = sd_recover_stats;
+  pStats->ClockDiv = SD_GetClockDiv();
+  pStats->BusWidth = (SD_GetBusWidth() == SDMMC_BUS_WIDE_4B) ? 4U : 1U;
+  pStats->UpshiftRun = sd_recover_run;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  清零错误恢复统计（不影响当前降级状态）
+  */
+void SD_Recover_ResetStats(void)
+{
+  (void)memset(&sd_recover_stats, 0, sizeof(sd_recover_stats));
+}
+
+/* USER CODE END 2 */
+
+#endif /* SD_RECOVER_ENABLE */
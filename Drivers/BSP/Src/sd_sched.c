@@ -0,0 +1,625 @@
+/**
+  ******************************************************************************
+  * @file    sd_sched.c
+  * @brief   SD卡多任务I/O调度器实现
+  * @author  STMicroelectronics
+  * @date    2025-11-04
+  * @version 1.0
+  * @note    每个优先级一个按提交顺序排列的单链表，选取时遍历全部排队请求（O(n^2)，排队请求通常只有几十个）。
+  *          同一时刻只有一个请求在执行（sd_sched_busy），执行时不持锁，驱动只在执行者的上下文中被调用
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_sched.h"
+
+#if (SD_SCHED_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#if (SD_DISCARD_ENABLE != 0U)
+#include "sd_discard.h"
+#define SD_SCHED_OP_LAST  SD_SCHED_OP_DISCARD
+#else
+#define SD_SCHED_OP_LAST  SD_SCHED_OP_FLUSH
+#endif
+
+static SD_SchedReqTypeDef *sd_sched_head[SD_SCHED_PRIO_COUNT];   /* 各优先级队列，按提交顺序 */
+static SD_SchedReqTypeDef *sd_sched_tail[SD_SCHED_PRIO_COUNT];
+static SD_SchedReqTypeDef *sd_sched_active;                      /* 正在执行的请求 */
+static SD_SchedStatsTypeDef sd_sched_stats;
+static uint32_t sd_sched_seq;                                    /* 下一个提交序号 */
+static uint32_t sd_sched_pos;                                    /* 电梯位置：上一个请求之后的块地址 */
+static uint8_t sd_sched_busy;                                    /* 有请求正在执行 */
+static uint8_t sd_sched_worker;                                  /* SD_Sched_Run()正在运行 */
+static uint8_t sd_sched_stop;                                    /* 已调用SD_Sched_Stop() */
+static uint32_t sd_sched_primask;                                /* 默认锁保存的PRIMASK */
+
+static const uint32_t sd_sched_deadline[SD_SCHED_PRIO_COUNT] = {
+  SD_SCHED_DEADLINE_RT_MS, SD_SCHED_DEADLINE_NORMAL_MS, SD_SCHED_DEADLINE_BACKGROUND_MS
+};
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  请求是否修改卡内容（写、擦除；刷新按覆盖全部块处理）
+  */
+static uint8_t SD_Sched_IsWrite(const SD_SchedReqTypeDef *pReq)
+{
+  return (pReq->Op != SD_SCHED_OP_READ) ? 1U : 0U;
+}
+
+/**
+  * @brief  两个请求是否必须按提交顺序执行
+  * @param  pEarly: 先提交的请求
+  * @param  pLate: 后提交的请求
+  * @retval uint8_t 1: 至少一个修改卡内容且区间重叠，或其中一个是刷新
+  */
+static uint8_t SD_Sched_Conflict(const SD_SchedReqTypeDef *pEarly, const SD_SchedReqTypeDef *pLate)
+{
+  if ((pEarly->Op == SD_SCHED_OP_FLUSH) || (pLate->Op == SD_SCHED_OP_FLUSH))
+  {
+    return 1U;
+  }
+
+  if ((SD_Sched_IsWrite(pEarly) == 0U) && (SD_Sched_IsWrite(pLate) == 0U))
+  {
+    return 0U;
+  }
+
+  return (((uint64_t)pEarly->BlockAdd < ((uint64_t)pLate->BlockAdd + pLate->NumberOfBlocks)) &&
+          ((uint64_t)pLate->BlockAdd < ((uint64_t)pEarly->BlockAdd + pEarly->NumberOfBlocks))) ? 1U : 0U;
+}
+
+/**
+  * @brief  请求是否被更早提交的排队请求挡住（持锁调用）
+  */
+static uint8_t SD_Sched_Blocked(const SD_SchedReqTypeDef *pReq)
+{
+  const SD_SchedReqTypeDef *r;
+  uint32_t p;
+
+  for (p = 0U; p < SD_SCHED_PRIO_COUNT; p++)
+  {
+    for (r = sd_sched_head[p]; r != NULL; r = r->pNext)
+    {
+      if (((int32_t)(r->Seq - pReq->Seq) < 0) && (SD_Sched_Conflict(r, pReq) != 0U))
+      {
+        return 1U;
+      }
+    }
+  }
+
+  return 0U;
+}
+
+/**
+  * @brief  请求是否被挡住；第一次被挡住时计入统计（持锁调用）
+  * @param  pReq: 排队中的请求
+  * @retval uint8_t 1: 被挡住
+  */
+static uint8_t SD_Sched_Hold(SD_SchedReqTypeDef *pReq)
+{
+  if (SD_Sched_Blocked(pReq) == 0U)
+  {
+    return 0U;
+  }
+
+  if (pReq->Held == 0U)
+  {
+    pReq->Held = 1U;
+    sd_sched_stats.Held++;
+  }
+  return 1U;
+}
+
+/**
+  * @brief  选出下一个要执行的请求（持锁调用）
+  * @param  Now: 当前时刻
+  * @retval SD_SchedReqTypeDef* 请求，没有排队请求时返回NULL
+  * @note   所有排队请求中提交最早的那个总不会被挡住，因此有排队请求时一定能选出一个
+  */
+static SD_SchedReqTypeDef *SD_Sched_Select(uint32_t Now)
+{
+  SD_SchedReqTypeDef *best = NULL;
+  SD_SchedReqTypeDef *up;
+  SD_SchedReqTypeDef *low;
+  SD_SchedReqTypeDef *r;
+  uint32_t p;
+
+  /* 已超过截止时间的请求：截止时间最早的优先 */
+  for (p = 0U; p < SD_SCHED_PRIO_COUNT; p++)
+  {
+    for (r = sd_sched_head[p]; r != NULL; r = r->pNext)
+    {
+      if (((int32_t)(Now - r->Deadline) >= 0) &&
+          ((best == NULL) || ((int32_t)(r->Deadline - best->Deadline) < 0)) && (SD_Sched_Hold(r) == 0U))
+      {
+        best = r;
+      }
+    }
+  }
+  if (best != NULL)
+  {
+    sd_sched_stats.Expedited++;
+    return best;
+  }
+
+  /* 最高优先级的非空队列内单向电梯：取电梯位置之后最近的，没有则回到最低地址 */
+  for (p = 0U; p < SD_SCHED_PRIO_COUNT; p++)
+  {
+    up = NULL;
+    low = NULL;
+    for (r = sd_sched_head[p]; r != NULL; r = r->pNext)
+    {
+      if (SD_Sched_Hold(r) != 0U)
+      {
+        continue;
+      }
+      if (r->BlockAdd >= sd_sched_pos)
+      {
+        if ((up == NULL) || (r->BlockAdd < up->BlockAdd))
+        {
+          up = r;
+        }
+      }
+      else if ((low == NULL) || (r->BlockAdd < low->BlockAdd))
+      {
+        low = r;
+      }
+    }
+
+    if (up != NULL)
+    {
+      return up;
+    }
+    if (low != NULL)
+    {
+      return low;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  * @brief  从队列中摘除请求（持锁调用）
+  * @retval uint8_t 1: 已摘除；0: 不在队列中
+  */
+static uint8_t SD_Sched_Remove(SD_SchedReqTypeDef *pReq)
+{
+  uint32_t p = pReq->Priority;
+  SD_SchedReqTypeDef *prev = NULL;
+  SD_SchedReqTypeDef *r;
+
+  for (r = sd_sched_head[p]; r != NULL; r = r->pNext)
+  {
+    if (r == pReq)
+    {
+      if (prev == NULL)
+      {
+        sd_sched_head[p] = r->pNext;
+      }
+      else
+      {
+        prev->pNext = r->pNext;
+      }
+      if (sd_sched_tail[p] == r)
+      {
+        sd_sched_tail[p] = prev;
+      }
+      r->pNext = NULL;
+      sd_sched_stats.Pending--;
+      return 1U;
+    }
+    prev = r;
+  }
+
+  return 0U;
+}
+
+/**
+  * @brief  调用驱动执行请求（不持锁）
+  */
+static HAL_StatusTypeDef SD_Sched_Execute(const SD_SchedReqTypeDef *pReq)
+{
+  uint32_t timeout = (pReq->Timeout != 0U) ? pReq->Timeout : SD_TIMEOUT_LONG;
+  HAL_StatusTypeDef status;
+
+  switch (pReq->Op)
+  {
+    case SD_SCHED_OP_READ:
+      return SD_ReadBlocks(pReq->pData, pReq->BlockAdd, pReq->NumberOfBlocks, timeout);
+    case SD_SCHED_OP_WRITE:
+      return SD_WriteBlocks(pReq->pData, pReq->BlockAdd, pReq->NumberOfBlocks, timeout);
+    case SD_SCHED_OP_ERASE:
+      return SD_EraseBlocks(pReq->BlockAdd, pReq->NumberOfBlocks, timeout);
+#if (SD_DISCARD_ENABLE != 0U)
+    case SD_SCHED_OP_DISCARD:
+      return SD_Discard(pReq->BlockAdd, pReq->NumberOfBlocks, timeout);
+#endif
+    default:
+      /* 刷新后等卡把最后一次写入编程完，返回后数据已落盘 */
+      status = SD_Flush(timeout);
+      return (status == HAL_OK) ? SD_WaitReady(timeout) : status;
+  }
+}
+
+/**
+  * @brief  初始化调度器
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Sched_Init(void)
+{
+  SD_Sched_OsLock();
+  memset(sd_sched_head, 0, sizeof(sd_sched_head));
+  memset(sd_sched_tail, 0, sizeof(sd_sched_tail));
+  memset(&sd_sched_stats, 0, sizeof(sd_sched_stats));
+  sd_sched_active = NULL;
+  sd_sched_seq = 0U;
+  sd_sched_pos = 0U;
+  sd_sched_busy = 0U;
+  sd_sched_stop = 0U;
+  SD_Sched_OsUnlock();
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  提交请求
+  * @param  pReq: 请求
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Sched_Submit(SD_SchedReqTypeDef *pReq)
+{
+  SD_SchedClassStatsTypeDef *cs;
+  uint32_t now;
+
+  if ((pReq == NULL) || (pReq->Priority >= SD_SCHED_PRIO_COUNT) || (pReq->Op > SD_SCHED_OP_LAST) ||
+      ((pReq->Op != SD_SCHED_OP_FLUSH) && (pReq->NumberOfBlocks == 0U)) ||
+      ((pReq->Op <= SD_SCHED_OP_WRITE) && (pReq->pData == NULL)))
+  {
+    return HAL_ERROR;
+  }
+
+  now = SD_Sched_OsGetTick();
+  pReq->Done = 0U;
+  pReq->Status = HAL_BUSY;
+  pReq->pNext = NULL;
+  pReq->SubmitTick = now;
+  pReq->Held = 0U;
+  pReq->Deadline = now + ((pReq->DeadlineMs != 0U) ? pReq->DeadlineMs : sd_sched_deadline[pReq->Priority]);
+  if (pReq->Op == SD_SCHED_OP_FLUSH)
+  {
+    pReq->BlockAdd = 0U;
+    pReq->NumberOfBlocks = 0U;
+  }
+
+  SD_Sched_OsLock();
+  if (sd_sched_stop != 0U)
+  {
+    SD_Sched_OsUnlock();
+    return HAL_ERROR;
+  }
+
+  pReq->Seq = sd_sched_seq++;
+  if (sd_sched_tail[pReq->Priority] == NULL)
+  {
+    sd_sched_head[pReq->Priority] = pReq;
+  }
+  else
+  {
+    sd_sched_tail[pReq->Priority]->pNext = pReq;
+  }
+  sd_sched_tail[pReq->Priority] = pReq;
+
+  cs = &sd_sched_stats.Class[pReq->Priority];
+  cs->Submitted++;
+  sd_sched_stats.Pending++;
+  if (sd_sched_stats.Pending > sd_sched_stats.MaxPending)
+  {
+    sd_sched_stats.MaxPending = sd_sched_stats.Pending;
+  }
+  SD_Sched_OsNotify();
+  SD_Sched_OsUnlock();
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  执行一个请求
+  * @retval uint8_t 1: 执行了一个请求或发出了一条空闲擦除命令
+  */
+uint8_t SD_Sched_Poll(void)
+{
+  SD_SchedClassStatsTypeDef *cs;
+  SD_SchedReqTypeDef *req;
+  HAL_StatusTypeDef status;
+  uint32_t now;
+  uint32_t wait;
+#if (SD_DISCARD_ENABLE != 0U)
+  uint8_t erased;
+#endif
+
+  SD_Sched_OsLock();
+  if (sd_sched_busy != 0U)
+  {
+    SD_Sched_OsUnlock();
+    return 0U;
+  }
+
+  now = SD_Sched_OsGetTick();
+  req = SD_Sched_Select(now);
+  if (req == NULL)
+  {
+#if (SD_DISCARD_ENABLE != 0U)
+    /* 没有请求：用空闲时间擦除丢弃的区间，期间到达的请求等擦除命令发出后再执行 */
+    sd_sched_busy = 1U;
+    SD_Sched_OsUnlock();
+    erased = SD_Discard_Idle(SD_TIMEOUT_LONG);
+    SD_Sched_OsLock();
+    sd_sched_busy = 0U;
+    SD_Sched_OsNotify();
+    SD_Sched_OsUnlock();
+    return erased;
+#else
+    SD_Sched_OsUnlock();
+    return 0U;
+#endif
+  }
+
+  (void)SD_Sched_Remove(req);
+  sd_sched_busy = 1U;
+  sd_sched_active = req;
+  cs = &sd_sched_stats.Class[req->Priority];
+  wait = now - req->SubmitTick;
+  cs->WaitMs += wait;
+  if (wait > cs->MaxWaitMs)
+  {
+    cs->MaxWaitMs = wait;
+  }
+  if ((int32_t)(now - req->Deadline) > 0)
+  {
+    cs->DeadlineMisses++;
+  }
+  SD_Sched_OsUnlock();
+
+  /* 驱动只在这里被调用，同一时刻只有一个 */
+  status = SD_Sched_Execute(req);
+
+  /* 回调在Done置1之前：置1后等待者可能立即释放请求 */
+  req->Status = status;
+  if (req->Callback != NULL)
+  {
+    req->Callback(req);
+  }
+
+  SD_Sched_OsLock();
+  if (req->Op != SD_SCHED_OP_FLUSH)
+  {
+    sd_sched_pos = req->BlockAdd + req->NumberOfBlocks;
+  }
+  cs->Completed++;
+  if (status != HAL_OK)
+  {
+    cs->Errors++;
+  }
+  sd_sched_active = NULL;
+  sd_sched_busy = 0U;
+  req->Done = 1U;
+  SD_Sched_OsNotify();
+  SD_Sched_OsUnlock();
+
+  return 1U;
+}
+
+/**
+  * @brief  执行者主循环
+  */
+void SD_Sched_Run(void)
+{
+  SD_Sched_OsLock();
+  sd_sched_worker = 1U;
+  for (;;)
+  {
+    SD_Sched_OsUnlock();
+    while (SD_Sched_Poll() != 0U)
+    {
+    }
+    SD_Sched_OsLock();
+
+    if ((sd_sched_stop != 0U) && (sd_sched_stats.Pending == 0U) && (sd_sched_busy == 0U))
+    {
+      break;
+    }
+    if ((sd_sched_stats.Pending == 0U) || (sd_sched_busy != 0U))
+    {
+      SD_Sched_OsWait(SD_SCHED_IDLE_MS);
+    }
+  }
+  sd_sched_worker = 0U;
+  SD_Sched_OsNotify();
+  SD_Sched_OsUnlock();
+}
+
+/**
+  * @brief  停止调度器
+  */
+void SD_Sched_Stop(void)
+{
+  SD_Sched_OsLock();
+  sd_sched_stop = 1U;
+  SD_Sched_OsNotify();
+  SD_Sched_OsUnlock();
+}
+
+/**
+  * @brief  等待请求完成
+  * @param  pReq: 已提交的请求
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 请求的完成状态
+  */
+HAL_StatusTypeDef SD_Sched_Wait(SD_SchedReqTypeDef *pReq, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+  uint32_t start;
+  uint32_t elapsed;
+
+  if (pReq == NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  start = SD_Sched_OsGetTick();
+  SD_Sched_OsLock();
+  while (pReq->Done == 0U)
+  {
+    elapsed = SD_Sched_OsGetTick() - start;
+    if ((elapsed >= Timeout) && (sd_sched_active != pReq) && (SD_Sched_Remove(pReq) != 0U))
+    {
+      /* 还在排队：撤销 */
+      sd_sched_stats.Class[pReq->Priority].Cancelled++;
+      pReq->Status = HAL_TIMEOUT;
+      pReq->Done = 1U;
+      break;
+    }
+
+    if ((sd_sched_worker == 0U) && (sd_sched_busy == 0U))
+    {
+      /* 没有执行者任务：自己执行 */
+      SD_Sched_OsUnlock();
+      (void)SD_Sched_Poll();
+      SD_Sched_OsLock();
+    }
+    else
+    {
+      SD_Sched_OsWait((elapsed < Timeout) ? (Timeout - elapsed) : SD_SCHED_IDLE_MS);
+    }
+  }
+  status = pReq->Status;
+  SD_Sched_OsUnlock();
+
+  return status;
+}
+
+/**
+  * @brief  同步传输：提交并等待
+  */
+static HAL_StatusTypeDef SD_Sched_Sync(uint8_t Op, uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks,
+                                       uint8_t Priority, uint32_t Timeout)
+{
+  SD_SchedReqTypeDef req;
+  HAL_StatusTypeDef status;
+
+  memset(&req, 0, sizeof(req));
+  req.Op = Op;
+  req.Priority = Priority;
+  req.pData = pData;
+  req.BlockAdd = BlockAdd;
+  req.NumberOfBlocks = NumberOfBlocks;
+  req.Timeout = Timeout;
+
+  status = SD_Sched_Submit(&req);
+  if (status == HAL_OK)
+  {
+    /* 请求在栈上：超时后只在撤销成功或执行完毕时返回 */
+    status = SD_Sched_Wait(&req, Timeout);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  同步读取
+  */
+HAL_StatusTypeDef SD_Sched_Read(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint8_t Priority,
+                                uint32_t Timeout)
+{
+  return SD_Sched_Sync(SD_SCHED_OP_READ, pData, BlockAdd, NumberOfBlocks, Priority, Timeout);
+}
+
+/**
+  * @brief  同步写入
+  */
+HAL_StatusTypeDef SD_Sched_Write(uint8_t *pData, uint32_t BlockAdd, uint32_t NumberOfBlocks, uint8_t Priority,
+                                 uint32_t Timeout)
+{
+  return SD_Sched_Sync(SD_SCHED_OP_WRITE, pData, BlockAdd, NumberOfBlocks, Priority, Timeout);
+}
+
+/**
+  * @brief  读取调度器统计
+  * @param  pStats: 统计结构体指针
+  */
+void SD_Sched_GetStats(SD_SchedStatsTypeDef *pStats)
+{
+  if (pStats == NULL)
+  {
+    return;
+  }
+
+  SD_Sched_OsLock();
+  *pStats = sd_sched_stats;
+  SD_Sched_OsUnlock();
+}
+
+/**
+  * @brief  加锁（弱定义）：关中断
+  */
+__weak void SD_Sched_OsLock(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  sd_sched_primask = primask;
+}
+
+/**
+  * @brief  解锁（弱定义）
+  */
+__weak void SD_Sched_OsUnlock(void)
+{
+  __set_PRIMASK(sd_sched_primask);
+}
+
+/**
+  * @brief  等待唤醒（弱定义）：裸机下短暂开锁后返回
+  * @param  Timeout: 最长等待时间（毫秒）
+  */
+__weak void SD_Sched_OsWait(uint32_t Timeout)
+{
+  (void)Timeout;
+  SD_Sched_OsUnlock();
+  SD_Sched_OsLock();
+}
+
+/**
+  * @brief  唤醒等待者（弱定义）：裸机下无需操作
+  */
+__weak void SD_Sched_OsNotify(void)
+{
+}
+
+/**
+  * @brief  当前时刻（弱定义）
+  * @retval uint32_t HAL_GetTick()
+  */
+__weak uint32_t SD_Sched_OsGetTick(void)
+{
+  return HAL_GetTick();
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_SCHED_ENABLE */
@@ -0,0 +1,238 @@
+/**
+  ******************************************************************************
+  * @file    sd_stream.c
+  * @brief   SD卡双缓冲流式写入实现
+  * @author  STMicroelectronics
+  * @date    2025-10-22
+  * @version 1.0
+  * @note    半缓冲k固定使用pBuf[k & 1]，与IDMA在IDMABASE0/IDMABASE1之间的切换顺序一致
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_stream.h"
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  一个半缓冲被IDMA取空（中断上下文）
+  * @param  pReq: 内部IDMA请求
+  * @param  BufferIndex: 刚取空的缓冲区
+  * @note   此时IDMA已经开始发送另一个缓冲区，若它还没提交说明应用跟不上，立即结束会话
+  */
+static void SD_Stream_BufferCplt(SD_RequestTypeDef *pReq, uint32_t BufferIndex)
+{
+  SD_StreamTypeDef *stream = (SD_StreamTypeDef *)pReq->pContext;
+
+  stream->Filled[BufferIndex] = 0U;
+  stream->Written++;
+
+  if (stream->Written >= stream->TotalHalves)
+  {
+    return;  /* 最后一半，等待DATAEND */
+  }
+
+  if (stream->Filled[BufferIndex ^ 1U] == 0U)
+  {
+    if (stream->Closing == 0U)
+    {
+      stream->Underruns++;
+    }
+    (void)SD_AbortRequest(pReq, HAL_OK);
+  }
+}
+
+/**
+  * @brief  会话结束（中断上下文）
+  * @param  pReq: 内部IDMA请求
+  */
+static void SD_Stream_Cplt(SD_RequestTypeDef *pReq)
+{
+  SD_StreamTypeDef *stream = (SD_StreamTypeDef *)pReq->pContext;
+
+  stream->Running = 0U;
+}
+
+/**
+  * @brief  打开流式写入会话
+  * @param  pStream: 流对象
+  * @param  pBuf0: 半缓冲区0
+  * @param  pBuf1: 半缓冲区1
+  * @param  HalfBlocks: 每个半缓冲区的块数
+  * @param  StartBlock: 会话起始块地址
+  * @param  TotalBlocks: 会话总块数
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Stream_Open(SD_StreamTypeDef *pStream, uint8_t *pBuf0, uint8_t *pBuf1,
+                                 uint32_t HalfBlocks, uint32_t StartBlock, uint32_t TotalBlocks)
+{
+  /* 参数验证 */
+  if ((pStream == NULL) || (pBuf0 == NULL) || (pBuf1 == NULL) || (HalfBlocks == 0U) ||
+      (TotalBlocks == 0U) || (TotalBlocks > SD_DOUBLEBUF_MAX_BLOCKS) || ((TotalBlocks % HalfBlocks) != 0U) ||
+      (((uintptr_t)pBuf0 & (SD_DCACHE_LINE - 1U)) != 0U) || (((uintptr_t)pBuf1 & (SD_DCACHE_LINE - 1U)) != 0U) ||
+      (SD_IsDmaReachable(pBuf0, HalfBlocks * SD_BLOCK_SIZE) == 0U) ||
+      (SD_IsDmaReachable(pBuf1, HalfBlocks * SD_BLOCK_SIZE) == 0U))
+  {
+#ifdef DEBUG
+    printf("[SD] [FAIL] 流参数错误: 半缓冲%lu块, 总%lu块（缓冲区须32字节对齐且IDMA可访问）\r\n", HalfBlocks, TotalBlocks);
+#endif
+    return HAL_ERROR;
+  }
+
+  memset(pStream, 0, sizeof(*pStream));
+  pStream->pBuf[0] = pBuf0;
+  pStream->pBuf[1] = pBuf1;
+  pStream->HalfBlocks = HalfBlocks;
+  pStream->StartBlock = StartBlock;
+  pStream->TotalHalves = TotalBlocks / HalfBlocks;
+  pStream->Req.Callback = SD_Stream_Cplt;
+  pStream->Req.BufferCallback = SD_Stream_BufferCplt;
+  pStream->Req.pContext = pStream;
+
+  /* 会话启动时卡必须已处于传输状态 */
+  return SD_WaitReady(SD_TIMEOUT_DEFAULT);
+}
+
+/**
+  * @brief  获取可以填充的半缓冲区
+  * @param  pStream: 流对象
+  * @retval uint8_t* 空闲半缓冲区或NULL
+  */
+uint8_t *SD_Stream_GetBuffer(SD_StreamTypeDef *pStream)
+{
+  uint32_t idx;
+
+  if ((pStream == NULL) || (pStream->Req.Done != 0U) || (pStream->Committed >= pStream->TotalHalves))
+  {
+    return NULL;
+  }
+
+  idx = pStream->Committed & 1U;
+  return (pStream->Filled[idx] == 0U) ? pStream->pBuf[idx] : NULL;
+}
+
+/**
+  * @brief  提交已填好的半缓冲区
+  * @param  pStream: 流对象
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Stream_Commit(SD_StreamTypeDef *pStream)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t idx;
+  uint32_t prefill;
+
+  if ((pStream == NULL) || (pStream->Req.Done != 0U) || (pStream->Committed >= pStream->TotalHalves))
+  {
+    return HAL_ERROR;
+  }
+
+  idx = pStream->Committed & 1U;
+  if (pStream->Filled[idx] != 0U)
+  {
+    return HAL_BUSY;
+  }
+
+  /* IDMA从内存取数，填好的数据须先写回D-Cache */
+  SD_DCacheClean(pStream->pBuf[idx], pStream->HalfBlocks * SD_BLOCK_SIZE);
+
+  /* 先置位再计数：中断里据此判断下一半是否就绪 */
+  pStream->Filled[idx] = 1U;
+  pStream->Committed++;
+
+  /* 两半都填好（或会话只有一半）后启动CMD25 */
+  prefill = (pStream->TotalHalves < 2U) ? pStream->TotalHalves : 2U;
+  if ((pStream->Running == 0U) && (pStream->Committed == prefill))
+  {
+    pStream->Running = 1U;
+    status = SD_WriteBlocksDoubleBufferAsync(pStream->pBuf[0], pStream->pBuf[1], pStream->HalfBlocks,
+                                             pStream->StartBlock, pStream->TotalHalves * pStream->HalfBlocks,
+                                             &pStream->Req);
+    if (status != HAL_OK)
+    {
+      pStream->Running = 0U;
+#ifdef DEBUG
+      printf("[SD] [FAIL] 流式写入启动失败，状态: %d\r\n", status);
+#endif
+    }
+  }
+
+  return status;
+}
+
+/**
+  * @brief  结束会话
+  * @param  pStream: 流对象
+  * @param  Timeout: 超时时间（毫秒）
+  * @retval HAL_StatusTypeDef 返回操作状态
+  */
+HAL_StatusTypeDef SD_Stream_Close(SD_StreamTypeDef *pStream, uint32_t Timeout)
+{
+  HAL_StatusTypeDef status;
+
+  if (pStream == NULL)
+  {
+    return HAL_ERROR;
+  }
+
+  if (pStream->Committed == 0U)
+  {
+    return HAL_OK;
+  }
+
+  /* 只提交了一半，CMD25尚未启动：普通多块写入 */
+  if ((pStream->Running == 0U) && (pStream->Req.Done == 0U))
+  {
+    status = SD_WriteBlocks(pStream->pBuf[0], pStream->StartBlock, pStream->HalfBlocks, Timeout);
+    if (status == HAL_OK)
+    {
+      pStream->Written = 1U;
+      pStream->Filled[0] = 0U;
+    }
+    pStream->Req.Status = status;
+    pStream->Req.Done = 1U;
+    return status;
+  }
+
+  /* 最后一个已提交的半缓冲传完后由中断发CMD12 */
+  pStream->Closing = 1U;
+  status = SD_WaitRequest(&pStream->Req, Timeout);
+
+#ifdef DEBUG
+  if (pStream->Underruns != 0U)
+  {
+    printf("[SD] [WARN] 流式写入欠载，会话在%lu块处提前结束\r\n", SD_Stream_GetWrittenBlocks(pStream));
+  }
+#endif
+
+  return status;
+}
+
+/**
+  * @brief  已写入卡的块数
+  * @param  pStream: 流对象
+  * @retval uint32_t 块数
+  */
+uint32_t SD_Stream_GetWrittenBlocks(const SD_StreamTypeDef *pStream)
+{
+  return (pStream != NULL) ? (pStream->Written * pStream->HalfBlocks) : 0U;
+}
+
+/* USER CODE END 1 */
@@ -0,0 +1,152 @@
+/**
+  ******************************************************************************
+  * @file    sd_trace.c
+  * @brief   SD卡二进制事件跟踪实现
+  * @author  STMicroelectronics
+  * @date    2025-11-01
+  * @version 1.0
+  * @note    sd_trace_head为累计领取的槽位数，槽位号取低位；中断可以在线程领取槽位之后、填写之前插入，
+  *          相邻事件的时间戳因此可能略有倒序，解析时按有符号差值处理
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2025 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_trace.h"
+
+#if (SD_TRACE_ENABLE != 0U)
+
+/* USER CODE BEGIN 0 */
+#include <string.h>
+
+#define SD_TRACE_DWT_UNLOCK   0xC5ACCE55U   /* Cortex-M7 DWT锁存访问密钥 */
+
+static SD_TraceEventTypeDef sd_trace_buf[SD_TRACE_DEPTH];   /* 环形缓冲区 */
+static volatile uint32_t sd_trace_head;                     /* 累计领取的槽位数 */
+static volatile uint8_t sd_trace_on;                        /* 正在记录 */
+
+/* USER CODE BEGIN 1 */
+
+/**
+  * @brief  清空缓冲区并开始记录
+  */
+void SD_Trace_Start(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = SD_TRACE_DWT_UNLOCK;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  sd_trace_on = 0U;
+  sd_trace_head = 0U;
+  sd_trace_on = 1U;
+}
+
+/**
+  * @brief  停止记录
+  */
+void SD_Trace_Stop(void)
+{
+  sd_trace_on = 0U;
+}
+
+/**
+  * @brief  记录一个事件
+  * @param  Type: SD_TRACE_EV_xxx
+  * @param  Cmd: 命令号
+  * @param  BlockAdd: 块地址
+  * @param  Count: 块数或查询次数
+  * @param  Arg: 状态、错误位或用户数据
+  */
+void SD_Trace_Record(uint8_t Type, uint8_t Cmd, uint32_t BlockAdd, uint32_t Count, uint32_t Arg)
+{
+  SD_TraceEventTypeDef *ev;
+  uint32_t idx;
+
+  if (sd_trace_on == 0U)
+  {
+    return;
+  }
+
+  /* 领取槽位：被中断打断时STREX失败，重新读取 */
+  do
+  {
+    idx = __LDREXW(&sd_trace_head);
+  } while (__STREXW(idx + 1U, &sd_trace_head) != 0U);
+
+  ev = &sd_trace_buf[idx & (SD_TRACE_DEPTH - 1U)];
+  ev->Cycles   = DWT->CYCCNT;
+  ev->Type     = Type;
+  ev->Cmd      = Cmd;
+  ev->Count    = (uint16_t)((Count > 0xFFFFU) ? 0xFFFFU : Count);
+  ev->BlockAdd = BlockAdd;
+  ev->Arg      = Arg;
+}
+
+/**
+  * @brief  记录用户标记
+  * @param  Id: 标记号
+  * @param  Arg: 用户数据
+  */
+void SD_Trace_Mark(uint8_t Id, uint32_t Arg)
+{
+  SD_Trace_Record(SD_TRACE_EV_MARK, Id, 0U, 0U, Arg);
+}
+
+/**
+  * @brief  导出缓冲区
+  * @param  pBuf: 输出缓冲区
+  * @param  Size: 输出缓冲区字节数
+  * @retval uint32_t 写入的字节数
+  */
+uint32_t SD_Trace_Dump(uint8_t *pBuf, uint32_t Size)
+{
+  SD_TraceHeaderTypeDef hdr;
+  uint8_t on = sd_trace_on;
+  uint32_t head;
+  uint32_t n;
+  uint32_t i;
+
+  if ((pBuf == NULL) || (Size < sizeof(hdr)))
+  {
+    return 0U;
+  }
+
+  /* 暂停记录，避免复制过程中最旧的事件被覆盖 */
+  sd_trace_on = 0U;
+  head = sd_trace_head;
+  n = (head < SD_TRACE_DEPTH) ? head : SD_TRACE_DEPTH;
+  if (n > ((Size - sizeof(hdr)) / sizeof(SD_TraceEventTypeDef)))
+  {
+    n = (Size - sizeof(hdr)) / sizeof(SD_TraceEventTypeDef);
+  }
+
+  hdr.Magic       = SD_TRACE_MAGIC;
+  hdr.Version     = (uint16_t)SD_TRACE_VERSION;
+  hdr.EventSize   = (uint16_t)sizeof(SD_TraceEventTypeDef);
+  hdr.Count       = n;
+  hdr.Lost        = head - n;
+  hdr.CyclesPerUs = SystemCoreClock / 1000000U;
+  (void)memcpy(pBuf, &hdr, sizeof(hdr));
+
+  for (i = 0U; i < n; i++)
+  {
+    (void)memcpy(&pBuf[sizeof(hdr) + (i * sizeof(SD_TraceEventTypeDef))],
+                 &sd_trace_buf[(head - n + i) & (SD_TRACE_DEPTH - 1U)], sizeof(SD_TraceEventTypeDef));
+  }
+  sd_trace_on = on;
+
+  return sizeof(hdr) + (n * sizeof(SD_TraceEventTypeDef));
+}
+
+/* USER CODE END 1 */
+
+#endif /* SD_TRACE_ENABLE */
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+SD卡事件跟踪解析工具
+
+解析SD_Trace_Dump()导出的二进制映像（目标板经串口/文件导出，或仿真的 -t 选项），
+输出文本时间线，或转换为Chrome trace JSON（chrome://tracing、https://ui.perfetto.dev 打开）。
+
+用法:
+    sd_trace.py trace.bin                  # 文本时间线，卡忙超过--slow微秒的行加标记
+    sd_trace.py trace.bin --chrome out.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x52544453
+HEADER = struct.Struct('<IHHIII')
+EVENT = struct.Struct('<IBBHII')
+
+EV_CMD, EV_IDMA_START, EV_IDMA_DONE, EV_BUSY_START, EV_BUSY_END, EV_ERROR, EV_MARK = range(1, 8)
+
+EV_NAMES = {
+    EV_CMD: 'CMD',
+    EV_IDMA_START: 'IDMA+',
+    EV_IDMA_DONE: 'IDMA-',
+    EV_BUSY_START: 'BUSY+',
+    EV_BUSY_END: 'BUSY-',
+    EV_ERROR: 'ERROR',
+    EV_MARK: 'MARK',
+}
+
+STATUS_NAMES = {0: 'OK', 1: 'ERROR', 2: 'BUSY', 3: 'TIMEOUT'}
+
+# HAL_SD_ERROR_xxx（stm32h7xx_hal_sd.h）
+ERROR_BITS = [
+    (0x00000001, 'CMD_CRC_FAIL'),
+    (0x00000002, 'DATA_CRC_FAIL'),
+    (0x00000004, 'CMD_RSP_TIMEOUT'),
+    (0x00000008, 'DATA_TIMEOUT'),
+    (0x00000010, 'TX_UNDERRUN'),
+    (0x00000020, 'RX_OVERRUN'),
+    (0x00000040, 'ADDR_MISALIGNED'),
+    (0x00000080, 'BLOCK_LEN_ERR'),
+    (0x00000100, 'ERASE_SEQ_ERR'),
+    (0x00000200, 'BAD_ERASE_PARAM'),
+    (0x00000400, 'WRITE_PROT_VIOLATION'),
+    (0x00000800, 'LOCK_UNLOCK_FAILED'),
+    (0x00001000, 'COM_CRC_FAILED'),
+    (0x00002000, 'ILLEGAL_CMD'),
+    (0x00004000, 'CARD_ECC_FAILED'),
+    (0x00008000, 'CC_ERR'),
+    (0x00010000, 'GENERAL_UNKNOWN_ERR'),
+    (0x00020000, 'STREAM_READ_UNDERRUN'),
+    (0x00040000, 'STREAM_WRITE_OVERRUN'),
+    (0x00080000, 'CID_CSD_OVERWRITE'),
+    (0x00100000, 'WP_ERASE_SKIP'),
+    (0x00200000, 'CARD_ECC_DISABLED'),
+    (0x00400000, 'ERASE_RESET'),
+    (0x00800000, 'AKE_SEQ_ERR'),
+    (0x01000000, 'INVALID_VOLTRANGE'),
+    (0x02000000, 'ADDR_OUT_OF_RANGE'),
+    (0x04000000, 'REQUEST_NOT_APPLICABLE'),
+    (0x08000000, 'PARAM'),
+    (0x10000000, 'UNSUPPORTED_FEATURE'),
+    (0x20000000, 'BUSY'),
+    (0x40000000, 'DMA'),
+    (0x80000000, 'TIMEOUT'),
+]
+
+
+def error_text(bits):
+    names = [name for bit, name in ERROR_BITS if bits & bit]
+    return '|'.join(names) if names else 'NONE'
+
+
+def load(path):
+    """读取映像，返回(头部字典, 事件列表)；事件时间戳展开为从第一个事件起的微秒数"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.exit('%s: 文件过短' % path)
+    magic, version, event_size, count, lost, cycles_per_us = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        sys.exit('%s: 不是SD_Trace_Dump()映像' % path)
+    if event_size != EVENT.size:
+        sys.exit('%s: 事件大小%d，工具只支持%d' % (path, event_size, EVENT.size))
+    count = min(count, (len(data) - HEADER.size) // EVENT.size)
+    cycles_per_us = cycles_per_us or 1
+
+    events = []
+    cycles = 0
+    prev = None
+    for i in range(count):
+        raw, ev_type, cmd, n, block, arg = EVENT.unpack_from(data, HEADER.size + i * EVENT.size)
+        if prev is not None:
+            # 32位回绕；中断插入造成的少量倒序按负数处理
+            delta = (raw - prev) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            cycles += delta
+        prev = raw
+        events.append({'us': cycles / cycles_per_us, 'type': ev_type, 'cmd': cmd,
+                       'count': n, 'block': block, 'arg': arg})
+
+    header = {'version': version, 'count': count, 'lost': lost, 'cycles_per_us': cycles_per_us}
+    return header, events
+
+
+def describe(ev):
+    t = ev['type']
+    if t in (EV_CMD, EV_IDMA_START):
+        text = '%sCMD%d blk=%d n=%d' % ('A' if (t == EV_CMD and ev['arg'] == 1) else '', ev['cmd'],
+                                        ev['block'], ev['count'])
+        if t == EV_IDMA_START and ev['arg'] != 0:
+            text += ' buf=%d' % ev['arg']
+        return text
+    if t == EV_IDMA_DONE:
+        return 'CMD%d %s' % (ev['cmd'], STATUS_NAMES.get(ev['arg'], ev['arg']))
+    if t == EV_BUSY_START:
+        return ''
+    if t == EV_BUSY_END:
+        return 'polls=%d %s' % (ev['count'], STATUS_NAMES.get(ev['arg'], ev['arg']))
+    if t == EV_ERROR:
+        return 'CMD%d blk=%d 0x%08X %s' % (ev['cmd'], ev['block'], ev['arg'], error_text(ev['arg']))
+    if t == EV_MARK:
+        return 'id=%d arg=0x%08X' % (ev['cmd'], ev['arg'])
+    return 'type=%d' % t
+
+
+def timeline(header, events, slow_us):
+    print('# %d个事件，丢失%d个，%d周期/us' % (header['count'], header['lost'], header['cycles_per_us']))
+    prev = None
+    busy_start = None
+    for ev in events:
+        delta = 0.0 if prev is None else ev['us'] - prev
+        note = ''
+        if ev['type'] == EV_BUSY_START:
+            busy_start = ev['us']
+        elif ev['type'] == EV_BUSY_END and busy_start is not None:
+            busy = ev['us'] - busy_start
+            busy_start = None
+            note = '  卡忙 %.1f us' % busy
+            if busy >= slow_us:
+                note += '  <<<'
+        print('%12.1f %+10.1f  %-6s %s%s' % (ev['us'], delta, EV_NAMES.get(ev['type'], '?'), describe(ev), note))
+        prev = ev['us']
+
+
+def chrome(events, path):
+    """IDMA传输和卡忙画成区间，命令、错误和标记画成瞬时事件"""
+    out = []
+    tracks = {1: '命令/IDMA', 2: '卡忙', 3: '错误/标记'}
+    for tid, name in tracks.items():
+        out.append({'ph': 'M', 'name': 'thread_name', 'pid': 1, 'tid': tid, 'args': {'name': name}})
+
+    idma = None
+    busy = None
+    for ev in events:
+        t = ev['type']
+        if t == EV_IDMA_START:
+            idma = ev
+        elif t == EV_IDMA_DONE and idma is not None:
+            out.append({'ph': 'X', 'pid': 1, 'tid': 1, 'ts': idma['us'], 'dur': ev['us'] - idma['us'],
+                        'name': 'CMD%d x%d' % (idma['cmd'], idma['count']),
+                        'args': {'block': idma['block'], 'blocks': idma['count'],
+                                 'status': STATUS_NAMES.get(ev['arg'], ev['arg'])}})
+            idma = None
+        elif t == EV_BUSY_START:
+            busy = ev
+        elif t == EV_BUSY_END and busy is not None:
+            out.append({'ph': 'X', 'pid': 1, 'tid': 2, 'ts': busy['us'], 'dur': ev['us'] - busy['us'],
+                        'name': 'busy', 'args': {'polls': ev['count'],
+                                                 'status': STATUS_NAMES.get(ev['arg'], ev['arg'])}})
+            busy = None
+        elif t == EV_CMD:
+            out.append({'ph': 'i', 's': 't', 'pid': 1, 'tid': 1, 'ts': ev['us'], 'name': describe(ev)})
+        elif t == EV_ERROR:
+            out.append({'ph': 'i', 's': 'g', 'pid': 1, 'tid': 3, 'ts': ev['us'], 'name': 'error',
+                        'args': {'cmd': ev['cmd'], 'block': ev['block'], 'bits': '0x%08X' % ev['arg'],
+                                 'errors': error_text(ev['arg'])}})
+        elif t == EV_MARK:
+            out.append({'ph': 'i', 's': 'p', 'pid': 1, 'tid': 3, 'ts': ev['us'], 'name': 'mark %d' % ev['cmd'],
+                        'args': {'arg': '0x%08X' % ev['arg']}})
+
+    with open(path, 'w') as f:
+        json.dump({'traceEvents': out, 'displayTimeUnit': 'ms'}, f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='解析SD_Trace_Dump()导出的事件跟踪')
+    parser.add_argument('dump', help='二进制映像')
+    parser.add_argument('--chrome', metavar='JSON', help='输出Chrome trace JSON，而不是文本时间线')
+    parser.add_argument('--slow', type=float, default=10000.0, metavar='US',
+                        help='文本时间线中标记超过该时长的卡忙（默认10000us）')
+    args = parser.parse_args()
+
+    header, events = load(args.dump)
+    if args.chrome:
+        chrome(events, args.chrome)
+        print('%d个事件 -> %s' % (len(events), args.chrome))
+    else:
+        timeline(header, events, args.slow)
+
+
+if __name__ == '__main__':
+    main()